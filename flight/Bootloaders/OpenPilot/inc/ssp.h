@@ -35,6 +35,8 @@
 #define SSP_RX_ACK        	6
 #define SSP_RX_SYNCH      	7
 
+#define SSP_MAX_WINDOW		16	// most packets that may be waiting for an ACK at once, must stay below half the sequence space
+
 typedef enum decodeState_ {
 	decode_len1_e = 0,
 	decode_seqNo_e,
@@ -61,11 +63,13 @@ typedef struct {
 	uint16_t rxBufSize; // rcv buffer size.
 	uint8_t *txBuf; // Length of data in buffer
 	uint16_t txBufSize; // CRC for data in Packet buff
+	uint8_t txWindow; // number of packets of txBufSize + 2 bytes txBuf can hold, 0 or 1 = stop and wait
 	uint16_t max_retry; // Maximum number of retrys for a single transmit.
 	int32_t timeoutLen; //  how long to wait for each retry to succeed
 	void (*pfCallBack)(uint8_t *, uint16_t); // call back function that is called when a full packet has been received
 	int16_t (*pfSerialRead)(void); // function to call to read a byte from serial hardware
 	void (*pfSerialWrite)( uint8_t); // function used to write a byte to serial hardware for transmission
+	void (*pfSerialWriteBuffer)(const uint8_t *, uint16_t); // optional, writes a whole block to serial hardware
 	uint32_t (*pfGetTime)(void); // function returns time in number of seconds that has elapsed from a given reference point
 } PortConfig_t;
 
@@ -73,6 +77,7 @@ typedef struct Port_tag {
 	void (*pfCallBack)(uint8_t *, uint16_t); // call back function that is called when a full packet has been received
 	int16_t (*pfSerialRead)(void); // function to read a character from the serial input stream
 	void (*pfSerialWrite)( uint8_t); // function to write a byte to be sent out the serial port
+	void (*pfSerialWriteBuffer)(const uint8_t *, uint16_t); // function to write a block to be sent out the serial port, may be NULL
 	uint32_t (*pfGetTime)(void); // function returns time in number of seconds that has elapsed from a given reference point
 	uint8_t retryCount; // how many times have we tried to transmit the 'send' packet
 	uint8_t maxRetryCount; // max. times to try to transmit the 'send' packet
@@ -85,6 +90,10 @@ typedef struct Port_tag {
 	uint16_t rxBufSize; // size of the receive buffer.
 	uint16_t txBufSize; // size of the transmit buffer.
 	uint8_t *txBuf; // transmit buffer. REquired to store a copy of packet data in case a retry is needed.
+	uint8_t txWindow; // number of packets the transmit buffer can hold
+	uint8_t window; // number of packets that may be waiting for an ACK, agreed on at synchronisation
+	uint8_t txHead; // transmit buffer slot of the oldest packet waiting for an ACK
+	uint8_t txCount; // number of packets waiting for an ACK
 	uint8_t *rxBuf; // receive buffer. Used to store data as a packet is received.
 	uint16_t sendSynch; // flag to indicate that we should send a synchronize packet to the host
 	// this is required when switching from the application to the bootloader
@@ -64,21 +64,25 @@ uint8_t tempcount = 0;
 uint32_t ssp_time = 0;
 #define MAX_PACKET_DATA_LEN	255
 #define MAX_PACKET_BUF_SIZE	(1+1+MAX_PACKET_DATA_LEN+2)
+#define SSP_WINDOW	4	// packets in flight, they have to fit in the USART receive buffer
 #define UART_BUFFER_SIZE 1024
 uint8_t rx_buffer[UART_BUFFER_SIZE] __attribute__ ((aligned(4)));
 // align to 32-bit to try and provide speed improvement;
 // master buffers...
-uint8_t SSP_TxBuf[MAX_PACKET_BUF_SIZE];
+uint8_t SSP_TxBuf[SSP_WINDOW * MAX_PACKET_BUF_SIZE];
 uint8_t SSP_RxBuf[MAX_PACKET_BUF_SIZE];
 void SSP_CallBack(uint8_t *buf, uint16_t len);
 int16_t SSP_SerialRead(void);
 void SSP_SerialWrite( uint8_t);
+void SSP_SerialWriteBuffer(const uint8_t *, uint16_t);
 uint32_t SSP_GetTime(void);
 PortConfig_t SSP_PortConfig = { .rxBuf = SSP_RxBuf,
 		.rxBufSize = MAX_PACKET_DATA_LEN, .txBuf = SSP_TxBuf,
-		.txBufSize = MAX_PACKET_DATA_LEN, .max_retry = 10, .timeoutLen = 1000,
+		.txBufSize = MAX_PACKET_DATA_LEN, .txWindow = SSP_WINDOW,
+		.max_retry = 10, .timeoutLen = 1000,
 		.pfCallBack = SSP_CallBack, .pfSerialRead = SSP_SerialRead,
-		.pfSerialWrite = SSP_SerialWrite, .pfGetTime = SSP_GetTime, };
+		.pfSerialWrite = SSP_SerialWrite,
+		.pfSerialWriteBuffer = SSP_SerialWriteBuffer, .pfGetTime = SSP_GetTime, };
 Port_t ssp_port;
 t_fifo_buffer ssp_buffer;
 
@@ -286,6 +290,9 @@ int16_t SSP_SerialRead(void) {
 void SSP_SerialWrite(uint8_t value) {
 	PIOS_COM_SendChar(PIOS_COM_TELEM_RF, value);
 }
+void SSP_SerialWriteBuffer(const uint8_t *buf, uint16_t len) {
+	PIOS_COM_SendBuffer(PIOS_COM_TELEM_RF, buf, len);
+}
 uint32_t SSP_GetTime(void) {
 	return sspTimeSource();
 }
@@ -37,6 +37,14 @@
  * This protocol is best used in cases where one device is the master and the other is the slave, or a don't
  * speak unless spoken to type of approach.
  *
+ * Windowed mode: a synch request may carry one data byte, the number of packets the sender can keep waiting
+ * for an ACK. A receiver that understands it answers with an ACK carrying the smaller of that and its own
+ * window. Both ends may then have that many data packets outstanding, an ACK acknowledges its packet and all
+ * the ones sent before it, and data packets are only accepted in sequence so a lost packet makes the sender
+ * go back and resend everything from the oldest unacked packet on its timeout. A synch request without the
+ * data byte, or an ACK without it, means the other end is an older stop and wait implementation and the
+ * window stays at 1.
+ *
  * The following are items are required to initialize a port for communications:
  * 1. The number attempts for each packet
  * 2. time to wait for an ack.
@@ -108,14 +116,19 @@
 /** PRIVATE FUNCTIONS **/
 //static void   	sf_SendSynchPacket( Port_t *thisport );
 static uint16_t sf_crc16(uint16_t crc, uint8_t data);
-static void sf_write_byte(Port_t *thisport, uint8_t c);
+static uint16_t sf_EscapeByte(uint8_t *out, uint8_t c);
+static void sf_WriteBuffer(Port_t *thisport, const uint8_t *buf, uint16_t length);
 static void sf_SetSendTimeout(Port_t *thisport);
 static uint16_t sf_CheckTimeout(Port_t *thisport);
 static int16_t sf_DecodeState(Port_t *thisport, uint8_t c);
 static int16_t sf_ReceiveState(Port_t *thisport, uint8_t c);
 
-static void sf_SendPacket(Port_t *thisport);
-static void sf_SendAckPacket(Port_t *thisport, uint8_t seqNumber);
+static void sf_SendPacket(Port_t *thisport, const uint8_t *packet);
+static void sf_SendAckPacket(Port_t *thisport, uint8_t seqNumber,
+		const uint8_t *pdata, uint16_t length);
+static uint8_t *sf_TxSlot(Port_t *thisport, uint8_t n);
+static uint8_t sf_NextSeqNo(uint8_t seqNo);
+static uint8_t sf_NegotiateWindow(Port_t *thisport);
 static void sf_MakePacket(uint8_t *buf, const uint8_t * pdata, uint16_t length,
 		uint8_t seqNo);
 static int16_t sf_ReceivePacket(Port_t *thisport);
@@ -129,6 +142,8 @@ static int16_t sf_ReceivePacket(Port_t *thisport);
 #define SSP_ACKED			1
 #define SSP_IDLE			2
 
+#define SSP_WRITE_CHUNK		64	// packets are escaped into chunks of this size and written a chunk at a time
+
 /** PRIVATE DATA **/
 static const uint16_t CRC_TABLE[] = { 0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301,
 		0x03C0, 0x0280, 0xC241, 0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1,
@@ -182,6 +197,7 @@ void ssp_Init(Port_t *thisport, const PortConfig_t* const info) {
 	thisport->pfCallBack = info->pfCallBack;
 	thisport->pfSerialRead = info->pfSerialRead;
 	thisport->pfSerialWrite = info->pfSerialWrite;
+	thisport->pfSerialWriteBuffer = info->pfSerialWriteBuffer;
 	thisport->pfGetTime = info->pfGetTime;
 
 	thisport->maxRetryCount = info->max_retry;
@@ -190,6 +206,15 @@ void ssp_Init(Port_t *thisport, const PortConfig_t* const info) {
 	thisport->rxBufSize = info->rxBufSize;
 	thisport->txBuf = info->txBuf;
 	thisport->rxBuf = info->rxBuf;
+	thisport->txWindow = info->txWindow;
+	if (thisport->txWindow < 1) {
+		thisport->txWindow = 1;
+	} else if (thisport->txWindow > SSP_MAX_WINDOW) {
+		thisport->txWindow = SSP_MAX_WINDOW;
+	}
+	thisport->window = 1; // stop and wait until the other end agrees on more
+	thisport->txHead = 0;
+	thisport->txCount = 0;
 	thisport->retryCount = 0;
 	thisport->sendSynch = FALSE; //TRUE;
 	thisport->rxSeqNo = 255;
@@ -214,8 +239,11 @@ int16_t ssp_SendProcess(Port_t *thisport) {
 	if (thisport->SendState == SSP_AWAITING_ACK) {
 		if (sf_CheckTimeout(thisport) == TRUE) {
 			if (thisport->retryCount < thisport->maxRetryCount) {
-				// Try again
-				sf_SendPacket(thisport);
+				// Try again, starting from the oldest packet that was not acked
+				for (uint8_t x = 0; x < thisport->txCount; x++) {
+					sf_SendPacket(thisport, sf_TxSlot(thisport, x));
+				}
+				thisport->retryCount++;
 				sf_SetSendTimeout(thisport);
 				value = SSP_TX_WAITING;
 			} else {
@@ -227,6 +255,7 @@ int16_t ssp_SendProcess(Port_t *thisport) {
 #endif
 				value = SSP_TX_TIMEOUT;
 				CLEARBIT( thisport->flags, ACK_RECEIVED);
+				thisport->txCount = 0;
 				thisport->SendState = SSP_IDLE;
 			}
 		} else {
@@ -320,10 +349,10 @@ uint16_t ssp_SendDataBlock(Port_t *thisport, uint8_t *data, uint16_t length) {
  * \param	length = number of bytes to send
  * \return	SSP_TX_BUFOVERRUN = tried to send too much data
  * \return	SSP_TX_WAITING = data sent and waiting for an ack to arrive
- * \return	SSP_TX_BUSY = a packet has already been sent, but not yet acked
+ * \return	SSP_TX_BUSY = the window is full of packets that are not yet acked
  *
  * \note
- *
+ * With a window of 1 this is stop and wait, only one packet can be waiting for its ack.
  */
 int16_t ssp_SendData(Port_t *thisport, const uint8_t *data,
 		const uint16_t length) {
@@ -333,7 +362,8 @@ int16_t ssp_SendData(Port_t *thisport, const uint8_t *data,
 	if ((length + 2) > thisport->txBufSize) {
 		// TRYING to send too much data.
 		value = SSP_TX_BUFOVERRUN;
-	} else if (thisport->SendState == SSP_IDLE) {
+	} else if (thisport->SendState != SSP_ACKED
+			&& thisport->txCount < thisport->window) {
 #ifdef ACTIVE_SYNCH
 		if( thisport->sendSynch == TRUE ) {
 			sf_SendSynchPacket(thisport);
@@ -369,10 +399,14 @@ int16_t ssp_SendData(Port_t *thisport, const uint8_t *data,
 		CLEARBIT( thisport->flags, ACK_RECEIVED);
 		thisport->SendState = SSP_AWAITING_ACK;
 		value = SSP_TX_WAITING;
-		thisport->retryCount = 0; // zero out the retry counter for this transmission
-		sf_MakePacket(thisport->txBuf, data, length, thisport->txSeqNo);
-		sf_SendPacket(thisport); // punch out the packet to the serial port
-		sf_SetSendTimeout(thisport); // do the timeout values
+		uint8_t *packet = sf_TxSlot(thisport, thisport->txCount);
+		sf_MakePacket(packet, data, length, thisport->txSeqNo);
+		sf_SendPacket(thisport, packet); // punch out the packet to the serial port
+		if (thisport->txCount++ == 0) {
+			// the timeout runs for the oldest packet in the window
+			thisport->retryCount = 1;
+			sf_SetSendTimeout(thisport); // do the timeout values
+		}
 #ifdef DEBUG_SSP
 		char str[63]= {0};
 		sprintf(str,"Sent DATA PACKET:%d|",thisport->txSeqNo);
@@ -403,6 +437,9 @@ int16_t ssp_SendData(Port_t *thisport, const uint8_t *data,
  * 		increment try counter
  * 		if number of tries exceed maximum try limit then exit
  * C. goto A
+ *
+ * When the port can hold more than one packet the request offers that window to the other end, the window
+ * it agrees on comes back with the ACK.
  */
 uint16_t ssp_Synchronise(Port_t *thisport) {
 	int16_t packet_status;
@@ -412,8 +449,13 @@ uint16_t ssp_Synchronise(Port_t *thisport) {
 	thisport->txSeqNo = 0; // make this zero to cause the other end to re-synch with us
 	SETBIT(thisport->flags, SENT_SYNCH);
 	// TODO - should this be using ssp_SendPacketData()??
-	sf_MakePacket(thisport->txBuf, NULL, 0, thisport->txSeqNo); // construct the packet
-	sf_SendPacket(thisport);
+	thisport->window = 1;
+	thisport->txHead = 0;
+	thisport->txCount = 1;
+	sf_MakePacket(thisport->txBuf, &thisport->txWindow,
+			(thisport->txWindow > 1) ? 1 : 0, thisport->txSeqNo); // construct the packet
+	sf_SendPacket(thisport, thisport->txBuf);
+	thisport->retryCount = 1;
 	sf_SetSendTimeout(thisport);
 	thisport->SendState = SSP_AWAITING_ACK;
 	packet_status = SSP_TX_WAITING;
@@ -444,21 +486,79 @@ uint16_t ssp_Synchronise(Port_t *thisport) {
 /*!
  * \brief   sends out a preformatted packet for a give port
  * \param   thisport = which port to use.
+ * \param	packet = the packet to send
  * \return  none.
  *
  * \note
  * Packet should be formed through the use of sf_MakePacket before calling this function.
+ * The packet is escaped into a chunk buffer and written out a chunk at a time.
  */
-static void sf_SendPacket(Port_t *thisport) {
+static void sf_SendPacket(Port_t *thisport, const uint8_t *packet) {
+	uint8_t chunk[SSP_WRITE_CHUNK];
 	// add 3 to packet data length for: 1 length + 2 CRC (packet overhead)
-	uint8_t packetLen = thisport->txBuf[LENGTH] + 3;
+	uint16_t packetLen = packet[LENGTH] + 3;
+	uint16_t n = 0;
+
+	// the SYNC byte starts the packet so it does not get 'escaped'
+	chunk[n++] = SYNC;
+	for (uint16_t x = 0; x < packetLen; x++) {
+		if (n > sizeof(chunk) - 2) {
+			sf_WriteBuffer(thisport, chunk, n);
+			n = 0;
+		}
+		n += sf_EscapeByte(&chunk[n], packet[x]);
+	}
+	sf_WriteBuffer(thisport, chunk, n);
+}
+
+/*!
+ * \brief   returns a slot of the transmit buffer
+ * \param   thisport = which port to use
+ * \param	n = how many slots after the oldest packet waiting for an ack
+ * \return  pointer to the slot
+ *
+ * \note
+ * Each slot holds a packet of up to txBufSize + 2 bytes.
+ */
+static uint8_t *sf_TxSlot(Port_t *thisport, uint8_t n) {
+	uint8_t slot = (thisport->txHead + n) % thisport->txWindow;
+	return &thisport->txBuf[slot * (thisport->txBufSize + 2)];
+}
+
+/*!
+ * \brief   returns the sequence number that follows seqNo
+ * \param   seqNo = sequence number, 0 right after a synchronisation
+ * \return  next sequence number, 1..127
+ *
+ * \note
+ *
+ */
+static uint8_t sf_NextSeqNo(uint8_t seqNo) {
+	seqNo = (seqNo & 0x7F) + 1;
+	if (seqNo > 0x7F) {
+		seqNo = 1; // zero is reserved for synchronization requests
+	}
+	return seqNo;
+}
+
+/*!
+ * \brief   works out the window from the one offered in the received synch request or ACK
+ * \param   thisport = which port to use
+ * \return  the window both ends can handle
+ *
+ * \note
+ * The offer is the only data byte of the packet, older implementations send no data and get a window of 1.
+ */
+static uint8_t sf_NegotiateWindow(Port_t *thisport) {
+	uint8_t window = 1;
 
-	// use the raw serial write function so the SYNC byte does not get 'escaped'
-	thisport->pfSerialWrite(SYNC);
-	for (uint8_t x = 0; x < packetLen; x++) {
-		sf_write_byte(thisport, thisport->txBuf[x]);
+	if (thisport->rxBufLen >= 1 && thisport->rxBuf[DATA] > 1) {
+		window = thisport->rxBuf[DATA];
+		if (window > thisport->txWindow) {
+			window = thisport->txWindow;
+		}
 	}
-	thisport->retryCount++;
+	return window;
 }
 
 /*!
@@ -503,13 +603,18 @@ void sf_MakePacket(uint8_t *txBuf, const uint8_t * pdata, uint16_t length,
  * \brief   sends out an ack packet to given sequence number
  * \param   thisport = which port to use
  * \param	seqNumber = sequence number of the packet we would like to ack
+ * \param	pdata = data to send with the ack, only used to answer a windowed synch request
+ * \param	length = number of data bytes
  * \return  none.
  *
  * \note
- *
+ * The ack is built in its own buffer so the packets waiting for their ack are kept.
  */
 
-static void sf_SendAckPacket(Port_t *thisport, uint8_t seqNumber) {
+static void sf_SendAckPacket(Port_t *thisport, uint8_t seqNumber,
+		const uint8_t *pdata, uint16_t length) {
+	uint8_t ackBuf[5];
+
 #ifdef DEBUG_SSP
 	char str[63]= {0};
 	sprintf(str,"Sent ACK PACKET:%d|",seqNumber);
@@ -518,29 +623,51 @@ static void sf_SendAckPacket(Port_t *thisport, uint8_t seqNumber) {
 	uint8_t AckSeqNumber = SETBIT( seqNumber, ACK_BIT );
 
 	// create the packet, note we pass AckSequenceNumber directly
-	sf_MakePacket(thisport->txBuf, NULL, 0, AckSeqNumber);
-	sf_SendPacket(thisport);
+	sf_MakePacket(ackBuf, pdata, length, AckSeqNumber);
+	sf_SendPacket(thisport, ackBuf);
 	// we don't set the timeout for an ACK because we don't ACK our ACKs in this protocol
 }
 
 /*!
- * \brief   writes a byte out the output channel. Adds escape byte where needed
- * \param   thisport = which port to use
+ * \brief   escapes a byte for the output channel. Adds escape byte where needed
+ * \param   out = where to put the escaped byte, room for 2 bytes
  * \param	c = byte to send
- * \return  none.
+ * \return  number of bytes put in out
  *
  * \note
  *
  */
-static void sf_write_byte(Port_t *thisport, uint8_t c) {
+static uint16_t sf_EscapeByte(uint8_t *out, uint8_t c) {
 	if (c == SYNC) { // check for SYNC byte
-		thisport->pfSerialWrite(ESC); // since we are not starting a packet we must ESCAPE the SYNCH byte
-		thisport->pfSerialWrite(ESC_SYNC); // now send the escaped synch char
+		out[0] = ESC; // since we are not starting a packet we must ESCAPE the SYNCH byte
+		out[1] = ESC_SYNC; // now send the escaped synch char
+		return 2;
 	} else if (c == ESC) { // Check for ESC character
-		thisport->pfSerialWrite(ESC); // if it is, we need to send it twice
-		thisport->pfSerialWrite(ESC);
+		out[0] = ESC; // if it is, we need to send it twice
+		out[1] = ESC;
+		return 2;
+	}
+	out[0] = c; // otherwise send the byte as it is
+	return 1;
+}
+
+/*!
+ * \brief   writes a block out the output channel
+ * \param   thisport = which port to use
+ * \param	buf = bytes to send, already escaped
+ * \param	length = number of bytes
+ * \return  none.
+ *
+ * \note
+ * Falls back to writing a byte at a time if the port has no block write function.
+ */
+static void sf_WriteBuffer(Port_t *thisport, const uint8_t *buf, uint16_t length) {
+	if (thisport->pfSerialWriteBuffer != NULL) {
+		thisport->pfSerialWriteBuffer(buf, length);
 	} else {
-		thisport->pfSerialWrite(c); // otherwise write the byte to serial port
+		for (uint16_t x = 0; x < length; x++) {
+			thisport->pfSerialWrite(buf[x]);
+		}
 	}
 }
 
@@ -766,17 +893,33 @@ static int16_t sf_ReceivePacket(Port_t *thisport) {
 	int16_t value = FALSE;
 
 	if (ISBITSET(thisport->rxBuf[SEQNUM], ACK_BIT )) {
-		//  Received an ACK packet, need to check if it matches the previous sent packet
-		if ((thisport->rxBuf[SEQNUM] & 0x7F) == (thisport->txSeqNo & 0x7f)) {
-			//  It matches the last packet sent by us
-			SETBIT( thisport->txSeqNo, ACK_BIT );
-			thisport->SendState = SSP_ACKED;
+		//  Received an ACK packet, need to check if it matches a packet waiting for its ACK,
+		//  which also acknowledges all the packets sent before it
+		uint8_t ackSeqNo = thisport->rxBuf[SEQNUM] & 0x7F;
+		for (uint8_t x = 0; x < thisport->txCount; x++) {
+			if (sf_TxSlot(thisport, x)[SEQNUM] != ackSeqNo) {
+				continue;
+			}
+			if (ackSeqNo == 0) {
+				// the answer to our synch request
+				thisport->window = sf_NegotiateWindow(thisport);
+			}
+			thisport->txHead = (thisport->txHead + x + 1) % thisport->txWindow;
+			thisport->txCount -= x + 1;
+			if (thisport->txCount == 0) {
+				thisport->SendState = SSP_ACKED;
+			} else {
+				// restart the timeout for what is now the oldest packet
+				thisport->retryCount = 1;
+				sf_SetSendTimeout(thisport);
+			}
 #ifdef DEBUG_SSP
 			char str[63]= {0};
-			sprintf(str,"Received ACK:%d|",(thisport->txSeqNo & 0x7F));
+			sprintf(str,"Received ACK:%d|",ackSeqNo);
 			PIOS_COM_SendString(PIOS_COM_TELEM_USB,str);
 #endif
 			value = FALSE;
+			break;
 		}
 		// else ignore the ACK packet
 	} else {
@@ -789,12 +932,25 @@ static int16_t sf_ReceivePacket(Port_t *thisport) {
 #ifdef ACTIVE_SYNCH
 			thisport->sendSynch = TRUE;
 #endif
-			sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM]);
+			thisport->window = sf_NegotiateWindow(thisport);
+			// only a request that offered a window gets one back
+			sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM], &thisport->window,
+					(thisport->rxBufLen >= 1) ? 1 : 0);
 			thisport->rxSeqNo = 0;
 			value = FALSE;
 		} else if (thisport->rxBuf[SEQNUM] == thisport->rxSeqNo) {
 			// Already seen this packet, just ack it, don't act on the packet.
-			sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM]);
+			sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM], NULL, 0);
+			value = FALSE;
+		} else if (thisport->window > 1
+				&& thisport->rxBuf[SEQNUM] != sf_NextSeqNo(thisport->rxSeqNo)) {
+			// Out of sequence, either a resent packet we already have or one that came after
+			// a lost packet. Ack the first kind again, drop the second, the sender goes back
+			// to the lost packet when it times out.
+			uint8_t behind = (thisport->rxSeqNo + 0x7F - thisport->rxBuf[SEQNUM]) % 0x7F;
+			if (thisport->rxSeqNo != 0 && behind < thisport->window) {
+				sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM], NULL, 0);
+			}
 			value = FALSE;
 		} else {
 			//New Packet
@@ -812,7 +968,7 @@ static int16_t sf_ReceivePacket(Port_t *thisport) {
 			// after we send the ACK, it is possible for the host to send a new packet.
 			// Thus the application needs to copy the data and reset the receive buffer
 			// inside of thisport->pfCallBack()
-			sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM]);
+			sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM], NULL, 0);
 			value = TRUE;
 		}
 	}
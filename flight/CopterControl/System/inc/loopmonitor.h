@@ -0,0 +1,48 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotSystem OpenPilot System
+ * @{
+ * @addtogroup OpenPilotLibraries OpenPilot System Libraries
+ * @{
+ * @file       loopmonitor.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Include file of the loop timing library
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef LOOPMONITOR_H
+#define LOOPMONITOR_H
+
+#include "looptiming.h"
+#include "eventqueuestats.h"
+#include "eventdispatcher.h"
+
+int32_t LoopMonitorInitialize(void);
+void LoopMonitorStart(LoopTimingPeriodMeanElem loop);
+void LoopMonitorEnd(LoopTimingPeriodMeanElem loop);
+int32_t LoopMonitorAddQueue(EventQueueStatsDroppedElem index, xQueueHandle queue);
+void LoopMonitorQueueReceived(EventQueueStatsDroppedElem index, const UAVObjEvent * ev);
+void LoopMonitorEventStats(const EventStats * stats);
+void LoopMonitorUpdateAll(void);
+
+#endif // LOOPMONITOR_H
+
+/**
+ * @}
+ * @}
+ */
@@ -41,6 +41,7 @@
 #include "eventdispatcher.h"
 #include "alarms.h"
 #include "taskmonitor.h"
+#include "loopmonitor.h"
 #include "uavtalk.h"
 
 /* Global Functions */
@@ -24,6 +24,7 @@
 #include <unistd.h>
 #include <signal.h>
 #include <string.h>
+#include <sys/time.h>
 
 #include "pm.h"
 
@@ -144,6 +145,18 @@ plat_getMsTicks(uint32_t *r_ticks)
 }
 
 
+PmReturn_t
+plat_getUsTicks(uint32_t *r_ticks)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    *r_ticks = (uint32_t)tv.tv_sec * 1000000 + (uint32_t)tv.tv_usec;
+
+    return PM_RET_OK;
+}
+
+
 void
 plat_reportError(PmReturn_t result)
 {
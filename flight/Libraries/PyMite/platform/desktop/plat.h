@@ -17,6 +17,7 @@
 
 #define PM_HEAP_SIZE 0x2000
 #define PM_FLOAT_LITTLE_ENDIAN
+#define PM_PLAT_PROG_DIRECT
 #define PM_PLAT_HEAP_ATTR __attribute__((aligned (4)))
 
 #endif /* _PLAT_H_ */
@@ -99,6 +99,12 @@ PmReturn_t plat_getMsTicks(uint32_t *r_ticks)
     return PM_RET_OK;
 }
 
+PmReturn_t plat_getUsTicks(uint32_t *r_ticks)
+{
+    *r_ticks = PIOS_DELAY_GetTimeuS();
+    return PM_RET_OK;
+}
+
 void plat_reportError(PmReturn_t result)
 {
 #ifdef HAVE_DEBUG_INFO
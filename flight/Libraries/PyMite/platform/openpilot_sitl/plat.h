@@ -27,5 +27,6 @@
 
 #define PM_HEAP_SIZE 0x20000
 #define PM_FLOAT_LITTLE_ENDIAN
+#define PM_PLAT_PROG_DIRECT
 
 #endif /* _PLAT_H_ */
@@ -217,6 +217,22 @@ plat_getMsTicks(uint32_t *r_ticks)
 }
 
 
+PmReturn_t
+plat_getUsTicks(uint32_t *r_ticks)
+{
+    LARGE_INTEGER count;
+    LARGE_INTEGER freq;
+
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    *r_ticks = (uint32_t)((count.QuadPart / freq.QuadPart) * 1000000
+                          + (count.QuadPart % freq.QuadPart) * 1000000
+                            / freq.QuadPart);
+
+    return PM_RET_OK;
+}
+
+
 void
 plat_reportError(PmReturn_t result)
 {
@@ -226,7 +226,7 @@ def PmObjectClass(dumpversion, features):
             PmTypeInfo("FLT", "val:f"),
             PmTypeInfo("STR", "len:H,"+
                        (features.USE_STRING_CACHE and "cache_next:P," or "") +
-                       "val:B:len"),
+                       "hash:H,val:B:len"),
             PmTypeInfo("TUP", "len:H,items:P:len"),
             PmTypeInfo("COB", "codeimg:P,names:P,consts:P,code:P"),
             PmTypeInfo("MOD", "co:P,attrs:P,globals:P," +
@@ -246,7 +246,7 @@ def PmObjectClass(dumpversion, features):
             PmTypeInfo("CIO", "data:B:*"),
             PmTypeInfo("MTH", "instance:P,func:P,attrs:P"),
             PmTypeInfo("LST", "len:H,sgl:P"),
-            PmTypeInfo("DIC", "len:H,keys:P,vals:P"),
+            PmTypeInfo("DIC", "len:H,keys:P,vals:P,index:P"),
             PmTypeInfo("x", ""),
             PmTypeInfo("x", ""),
             PmTypeInfo("x", ""),
@@ -262,6 +262,7 @@ def PmObjectClass(dumpversion, features):
             PmTypeInfo("SQI", "sequence:P,index:H"),
             PmTypeInfo("NFM", "back:P,func:P,stack:P,active:B,numlocals:B,"
                               "locals:P:8"),
+            PmTypeInfo("DIX", "size:H,slots:B:size"),
             )
 
         FREE_TYPE = PmTypeInfo("FRE", "prev:P,next:P")
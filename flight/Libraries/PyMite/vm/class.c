@@ -78,6 +78,7 @@ class_instantiate(pPmObj_t pclass, pPmObj_t *r_pobj)
 
     /* Set the instance's class */
     ((pPmInstance_t)pobj)->cli_class = (pPmClass_t)pclass;
+    ((pPmInstance_t)pobj)->cli_attrs = C_NULL;
 
     /* Create the attributes dict */
     heap_gcPushTempRoot(pobj, &objid);
@@ -110,6 +111,7 @@ class_method(pPmObj_t pinstance, pPmObj_t pfunc, pPmObj_t *r_pmeth)
     pmeth = (pPmMethod_t)pchunk;
     pmeth->m_instance = (pPmInstance_t)pinstance;
     pmeth->m_func = (pPmFunc_t)pfunc;
+    pmeth->m_attrs = C_NULL;
 
     /* Create the attributes dict */
     heap_gcPushTempRoot((pPmObj_t)pmeth, &objid);
@@ -124,6 +126,20 @@ class_method(pPmObj_t pinstance, pPmObj_t pfunc, pPmObj_t *r_pmeth)
 
 PmReturn_t
 class_getAttr(pPmObj_t pobj, pPmObj_t pname, pPmObj_t *r_pobj)
+{
+    PmReturn_t retval;
+    pPmObj_t *pslot;
+
+    retval = class_getAttrSlot(pobj, pname, &pslot);
+    PM_RETURN_IF_ERROR(retval);
+
+    *r_pobj = *pslot;
+    return retval;
+}
+
+
+PmReturn_t
+class_getAttrSlot(pPmObj_t pobj, pPmObj_t pname, pPmObj_t **r_pslot)
 {
     PmReturn_t retval;
     uint16_t i;
@@ -132,8 +148,8 @@ class_getAttr(pPmObj_t pobj, pPmObj_t pname, pPmObj_t *r_pobj)
     /* If the given obj is an instance, check its attrs */
     if (OBJ_GET_TYPE(pobj) == OBJ_TYPE_CLI)
     {
-        retval = dict_getItem((pPmObj_t)((pPmInstance_t)pobj)->cli_attrs, pname,
-                              r_pobj);
+        retval = dict_getSlot((pPmObj_t)((pPmInstance_t)pobj)->cli_attrs,
+                              pname, r_pslot);
         if (retval == PM_RET_OK)
         {
             return retval;
@@ -145,8 +161,8 @@ class_getAttr(pPmObj_t pobj, pPmObj_t pname, pPmObj_t *r_pobj)
 
     C_ASSERT(OBJ_GET_TYPE(pobj) == OBJ_TYPE_CLO);
 
-    retval = dict_getItem((pPmObj_t)((pPmClass_t)pobj)->cl_attrs, pname,
-                          r_pobj);
+    retval = dict_getSlot((pPmObj_t)((pPmClass_t)pobj)->cl_attrs, pname,
+                          r_pslot);
 
     /* If attr is not found, search parent(s) */
     if ((retval == PM_RET_EX_KEY) && (((pPmClass_t)pobj)->cl_bases != C_NULL))
@@ -154,7 +170,7 @@ class_getAttr(pPmObj_t pobj, pPmObj_t pname, pPmObj_t *r_pobj)
         for (i = 0; i < ((pPmClass_t)pobj)->cl_bases->length; i++)
         {
             pparent = ((pPmClass_t)pobj)->cl_bases->val[i];
-            retval = class_getAttr(pparent, pname, r_pobj);
+            retval = class_getAttrSlot(pparent, pname, r_pslot);
             if (retval == PM_RET_OK)
             {
                 break;
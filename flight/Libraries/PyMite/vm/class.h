@@ -115,6 +115,18 @@ PmReturn_t class_method(pPmObj_t pinstance, pPmObj_t pfunc, pPmObj_t *r_pmeth);
  */
 PmReturn_t class_getAttr(pPmObj_t pobj, pPmObj_t pname, pPmObj_t *r_pobj);
 
+/**
+ * Like class_getAttr(), but returns where the attribute is held
+ * in the attrs dict it was found in (see dict_getSlot()).
+ *
+ * @param   pobj ptr to class or instance to search
+ * @param   pname ptr to name of attr to find
+ * @param   r_pslot Return by ref, ptr to slot of attr if found
+ * @return  Return status
+ */
+PmReturn_t class_getAttrSlot(pPmObj_t pobj, pPmObj_t pname,
+                             pPmObj_t **r_pslot);
+
 /**
  * Returns a C boolean if the base class is found in the inheritance tree
  * of the test class.  NOTE: This function is recursive.
@@ -28,6 +28,236 @@
 #include "pm.h"
 
 
+/** Dicts up to this length are scanned, the keys fill one segment */
+#define DICT_INDEX_MIN_LENGTH SEGLIST_OBJS_PER_SEG
+
+/** Longer dicts are scanned, the slots number the keys from 1 in a byte */
+#define DICT_INDEX_MAX_LENGTH 254
+
+/** Number of lookup cache entries, a power of two */
+#define DICT_CACHE_SIZE 16
+
+
+/**
+ * Lookup cache entry
+ *
+ * Remembers where the value of a key was found the last time
+ * the bytecode at a site looked the key up starting from a dict.
+ */
+typedef struct PmDictCache_s
+{
+    /** address of the bytecode doing the lookup */
+    uint8_t const *psite;
+    /** dict the lookup starts from */
+    pPmObj_t pdict;
+    /** key looked up */
+    pPmObj_t pkey;
+    /** where the value was found */
+    pPmObj_t *pslot;
+    /** dictEpoch when the entry was made */
+    uint16_t epoch;
+} PmDictCache_t;
+
+
+/**
+ * Lookup cache.  Code images are in flash, so the lookups are
+ * cached here by bytecode address instead of in the bytecode.
+ */
+static PmDictCache_t dictCache[DICT_CACHE_SIZE];
+
+/**
+ * Bumped whenever a dict gains or loses a key or may have been freed,
+ * which expires every entry in the lookup cache.
+ */
+static uint16_t dictEpoch;
+
+
+/*
+ * Hashes a key the way obj_compare() matches keys:
+ * keys that compare the same hash the same.
+ */
+static uint16_t
+dict_hashKey(pPmObj_t pkey)
+{
+    uint16_t hash;
+    int16_t i;
+
+    switch (OBJ_GET_TYPE(pkey))
+    {
+        case OBJ_TYPE_NON:
+            return 0;
+
+        case OBJ_TYPE_INT:
+            return (uint16_t)(((pPmInt_t)pkey)->val
+                              ^ (((pPmInt_t)pkey)->val >> 16));
+
+#ifdef HAVE_FLOAT
+        case OBJ_TYPE_FLT:
+        {
+            union
+            {
+                float f;
+                uint32_t u;
+            } v;
+
+            /* 0.0 and -0.0 compare the same */
+            if (((pPmFloat_t)pkey)->val == 0.0)
+            {
+                return 0;
+            }
+            v.f = ((pPmFloat_t)pkey)->val;
+            return (uint16_t)(v.u ^ (v.u >> 16));
+        }
+#endif /* HAVE_FLOAT */
+
+        case OBJ_TYPE_STR:
+            return ((pPmString_t)pkey)->hash;
+
+        case OBJ_TYPE_TUP:
+            hash = ((pPmTuple_t)pkey)->length;
+            for (i = 0; i < ((pPmTuple_t)pkey)->length; i++)
+            {
+                hash = hash * 31 + dict_hashKey(((pPmTuple_t)pkey)->val[i]);
+            }
+            return hash;
+
+        /* Mutable items of a tuple key compare by their contents */
+        case OBJ_TYPE_LST:
+        case OBJ_TYPE_DIC:
+#ifdef HAVE_BYTEARRAY
+        case OBJ_TYPE_BYA:
+        /* A bytearray instance compares by the bytearray it holds */
+        case OBJ_TYPE_CLI:
+#endif /* HAVE_BYTEARRAY */
+            return 1;
+
+        /* All other types compare by identity */
+        default:
+            return (uint16_t)((intptr_t)pkey >> 2);
+    }
+}
+
+
+/*
+ * Puts the key at the given seglist index in the dict's hash index.
+ * The hash index must have an empty slot.
+ */
+static void
+dict_indexKey(pPmDictIndex_t pindex, pPmObj_t pkey, int16_t indx)
+{
+    uint16_t mask = pindex->size - 1;
+    uint16_t i;
+
+    i = dict_hashKey(pkey) & mask;
+    while (pindex->slot[i] != 0)
+    {
+        i = (i + 1) & mask;
+    }
+    pindex->slot[i] = (uint8_t)(indx + 1);
+}
+
+
+/*
+ * Builds the hash index of a dict anew, sized to stay at most half full.
+ * Frees the old index.  Small and very large dicts get no index and
+ * neither does a dict when the heap has no room for one; their keys
+ * are scanned instead.
+ */
+static PmReturn_t
+dict_indexBuild(pPmDict_t pdict)
+{
+    PmReturn_t retval = PM_RET_OK;
+    pPmDictIndex_t pindex;
+    pSegment_t pseg;
+    uint8_t *pchunk;
+    uint16_t size;
+    int16_t i;
+
+    /* Free the old index */
+    if (pdict->d_index != C_NULL)
+    {
+        retval = heap_freeChunk((pPmObj_t)pdict->d_index);
+        PM_RETURN_IF_ERROR(retval);
+        pdict->d_index = C_NULL;
+    }
+
+    if ((pdict->length <= DICT_INDEX_MIN_LENGTH)
+        || (pdict->length > DICT_INDEX_MAX_LENGTH))
+    {
+        return retval;
+    }
+
+    size = DICT_INDEX_MIN_LENGTH * 2;
+    while (size < pdict->length * 2)
+    {
+        size <<= 1;
+    }
+
+    retval = heap_getChunk(sizeof(PmDictIndex_t) + size - 1, &pchunk);
+    if (retval == PM_RET_EX_MEM)
+    {
+        return PM_RET_OK;
+    }
+    PM_RETURN_IF_ERROR(retval);
+    pindex = (pPmDictIndex_t)pchunk;
+    OBJ_SET_TYPE(pindex, OBJ_TYPE_DIX);
+    pindex->size = size;
+    sli_memset(pindex->slot, 0, size);
+
+    /* Index every key, walking the segments in order */
+    pseg = pdict->d_keys->sl_rootseg;
+    for (i = 0; i < pdict->length; i++)
+    {
+        if ((i > 0) && ((i % SEGLIST_OBJS_PER_SEG) == 0))
+        {
+            pseg = pseg->next;
+        }
+        dict_indexKey(pindex, pseg->s_val[i % SEGLIST_OBJS_PER_SEG], i);
+    }
+
+    pdict->d_index = pindex;
+    heap_gcWriteBarrier((pPmObj_t)pindex);
+    return retval;
+}
+
+
+/*
+ * Finds the index of the key in the keys seglist of a dict.
+ * Probes the hash index if the dict has one, else scans the keys.
+ * Returns PM_RET_NO if the key is not in the dict.
+ */
+static PmReturn_t
+dict_findKey(pPmDict_t pdict, pPmObj_t pkey, int16_t *r_indx)
+{
+    PmReturn_t retval = PM_RET_OK;
+    pPmDictIndex_t pindex = pdict->d_index;
+    pPmObj_t pobj;
+    uint16_t mask;
+    uint16_t i;
+
+    if (pindex == C_NULL)
+    {
+        *r_indx = 0;
+        return seglist_findEqual(pdict->d_keys, pkey, r_indx);
+    }
+
+    mask = pindex->size - 1;
+    for (i = dict_hashKey(pkey) & mask;
+         pindex->slot[i] != 0; i = (i + 1) & mask)
+    {
+        retval = seglist_getItem(pdict->d_keys, pindex->slot[i] - 1, &pobj);
+        PM_RETURN_IF_ERROR(retval);
+
+        if (obj_compare(pkey, pobj) == C_SAME)
+        {
+            *r_indx = pindex->slot[i] - 1;
+            return PM_RET_OK;
+        }
+    }
+    return PM_RET_NO;
+}
+
+
 PmReturn_t
 dict_new(pPmObj_t *r_pdict)
 {
@@ -45,6 +275,7 @@ dict_new(pPmObj_t *r_pdict)
     pdict->length = 0;
     pdict->d_keys = C_NULL;
     pdict->d_vals = C_NULL;
+    pdict->d_index = C_NULL;
 
     *r_pdict = (pPmObj_t)pchunk;
     return retval;
@@ -82,7 +313,12 @@ dict_clear(pPmObj_t pdict)
         retval = heap_freeChunk((pPmObj_t)((pPmDict_t)pdict)->d_vals);
         ((pPmDict_t)pdict)->d_vals = C_NULL;
     }
-    return retval;
+    PM_RETURN_IF_ERROR(retval);
+
+    dict_cacheInvalidate();
+
+    /* Free the hash index (the dict is now too small to have one) */
+    return dict_indexBuild((pPmDict_t)pdict);
 }
 
 
@@ -141,8 +377,7 @@ dict_setItem(pPmObj_t pdict, pPmObj_t pkey, pPmObj_t pval)
     else
     {
         /* Check for matching key */
-        indx = 0;
-        retval = seglist_findEqual(((pPmDict_t)pdict)->d_keys, pkey, &indx);
+        retval = dict_findKey((pPmDict_t)pdict, pkey, &indx);
 
         /* If found a matching key, replace val obj */
         if (retval == PM_RET_OK)
@@ -152,11 +387,27 @@ dict_setItem(pPmObj_t pdict, pPmObj_t pkey, pPmObj_t pval)
         }
     }
 
-    /* Otherwise, insert the key,val pair */
-    retval = seglist_insertItem(((pPmDict_t)pdict)->d_keys, pkey, 0);
+    /* Otherwise, append the key,val pair */
+    retval = seglist_appendItem(((pPmDict_t)pdict)->d_keys, pkey);
     PM_RETURN_IF_ERROR(retval);
-    retval = seglist_insertItem(((pPmDict_t)pdict)->d_vals, pval, 0);
-    ((pPmDict_t)pdict)->length++;
+    retval = seglist_appendItem(((pPmDict_t)pdict)->d_vals, pval);
+    PM_RETURN_IF_ERROR(retval);
+    indx = ((pPmDict_t)pdict)->length++;
+
+    /* A lookup that missed this key may now find it */
+    dict_cacheInvalidate();
+
+    /* Index the key, rebuild the index when it would get over half full */
+    if ((((pPmDict_t)pdict)->d_index != C_NULL)
+        && (((pPmDict_t)pdict)->length * 2
+            <= ((pPmDict_t)pdict)->d_index->size))
+    {
+        dict_indexKey(((pPmDict_t)pdict)->d_index, pkey, indx);
+    }
+    else
+    {
+        retval = dict_indexBuild((pPmDict_t)pdict);
+    }
 
     return retval;
 }
@@ -164,8 +415,23 @@ dict_setItem(pPmObj_t pdict, pPmObj_t pkey, pPmObj_t pval)
 
 PmReturn_t
 dict_getItem(pPmObj_t pdict, pPmObj_t pkey, pPmObj_t *r_pobj)
+{
+    PmReturn_t retval;
+    pPmObj_t *pslot;
+
+    retval = dict_getSlot(pdict, pkey, &pslot);
+    PM_RETURN_IF_ERROR(retval);
+
+    *r_pobj = *pslot;
+    return retval;
+}
+
+
+PmReturn_t
+dict_getSlot(pPmObj_t pdict, pPmObj_t pkey, pPmObj_t **r_pslot)
 {
     PmReturn_t retval = PM_RET_OK;
+    pSegment_t pseg;
     int16_t indx = 0;
 
 /*    C_ASSERT(pdict != C_NULL);*/
@@ -195,7 +461,7 @@ dict_getItem(pPmObj_t pdict, pPmObj_t pkey, pPmObj_t *r_pobj)
     }
 
     /* check for matching key */
-    retval = seglist_findEqual(((pPmDict_t)pdict)->d_keys, pkey, &indx);
+    retval = dict_findKey((pPmDict_t)pdict, pkey, &indx);
     /* if key not found, raise KeyError */
     if (retval == PM_RET_NO)
     {
@@ -204,12 +470,58 @@ dict_getItem(pPmObj_t pdict, pPmObj_t pkey, pPmObj_t *r_pobj)
     /* return any other error */
     PM_RETURN_IF_ERROR(retval);
 
-    /* key was found, get obj from vals */
-    retval = seglist_getItem(((pPmDict_t)pdict)->d_vals, indx, r_pobj);
+    /* key was found, walk out to its slot in the vals */
+    pseg = ((pPmDict_t)pdict)->d_vals->sl_rootseg;
+    for (; indx >= SEGLIST_OBJS_PER_SEG; indx -= SEGLIST_OBJS_PER_SEG)
+    {
+        pseg = pseg->next;
+    }
+    *r_pslot = &pseg->s_val[indx];
     return retval;
 }
 
 
+pPmObj_t *
+dict_cacheGet(uint8_t const *psite, pPmObj_t pdict, pPmObj_t pkey)
+{
+    PmDictCache_t *pentry;
+
+    pentry = &dictCache[((uintptr_t)psite >> 1) & (DICT_CACHE_SIZE - 1)];
+    if ((pentry->psite == psite) && (pentry->pdict == pdict)
+        && (pentry->pkey == pkey) && (pentry->epoch == dictEpoch))
+    {
+        return pentry->pslot;
+    }
+    return C_NULL;
+}
+
+
+void
+dict_cachePut(uint8_t const *psite, pPmObj_t pdict, pPmObj_t pkey,
+              pPmObj_t *pslot)
+{
+    PmDictCache_t *pentry;
+
+    pentry = &dictCache[((uintptr_t)psite >> 1) & (DICT_CACHE_SIZE - 1)];
+    pentry->psite = psite;
+    pentry->pdict = pdict;
+    pentry->pkey = pkey;
+    pentry->pslot = pslot;
+    pentry->epoch = dictEpoch;
+}
+
+
+void
+dict_cacheInvalidate(void)
+{
+    /* Once the epoch wraps, old entries could look current again */
+    if (++dictEpoch == 0)
+    {
+        sli_memset((unsigned char *)dictCache, 0, sizeof(dictCache));
+    }
+}
+
+
 #ifdef HAVE_DEL
 PmReturn_t
 dict_delItem(pPmObj_t pdict, pPmObj_t pkey)
@@ -220,7 +532,7 @@ dict_delItem(pPmObj_t pdict, pPmObj_t pkey)
     C_ASSERT(pdict != C_NULL);
 
     /* Check for matching key */
-    retval = seglist_findEqual(((pPmDict_t)pdict)->d_keys, pkey, &indx);
+    retval = dict_findKey((pPmDict_t)pdict, pkey, &indx);
 
     /* Raise KeyError if key is not found */
     if (retval == PM_RET_NO)
@@ -235,11 +547,14 @@ dict_delItem(pPmObj_t pdict, pPmObj_t pkey)
     retval = seglist_removeItem(((pPmDict_t)pdict)->d_keys, indx);
     PM_RETURN_IF_ERROR(retval);
     retval = seglist_removeItem(((pPmDict_t)pdict)->d_vals, indx);
+    PM_RETURN_IF_ERROR(retval);
 
     /* Reduce the item count */
     ((pPmDict_t)pdict)->length--;
+    dict_cacheInvalidate();
 
-    return retval;
+    /* The keys after the removed one moved down, index them anew */
+    return dict_indexBuild((pPmDict_t)pdict);
 }
 #endif /* HAVE_DEL */
 
@@ -25,12 +25,34 @@
  */
 
 
+/**
+ * Dict hash index
+ *
+ * Open addressing table over the keys seglist of a dict.
+ * Each slot holds the index of a key in the seglist plus one,
+ * zero marks an empty slot.  A key is looked for by probing
+ * the slots linearly from its hash.
+ */
+typedef struct PmDictIndex_s
+{
+    /** object descriptor */
+    PmObjDesc_t od;
+    /** number of slots, a power of two */
+    uint16_t size;
+    /** slots */
+    uint8_t slot[1];
+} PmDictIndex_t,
+ *pPmDictIndex_t;
+
+
 /**
  * Dict
  *
  * Contains ptr to two seglists,
  * one for keys, the other for values;
  * and a length, the number of key/value pairs.
+ * Dicts with more than a segment of keys also get a hash index
+ * so lookups need not compare the key with every key in the dict.
  */
 typedef struct PmDict_s
 {
@@ -42,6 +64,8 @@ typedef struct PmDict_s
     pSeglist_t d_keys;
     /** ptr to seglist containing values */
     pSeglist_t d_vals;
+    /** ptr to hash index of the keys, C_NULL if the keys are scanned */
+    pPmDictIndex_t d_index;
 } PmDict_t,
  *pPmDict_t;
 
@@ -66,6 +90,46 @@ PmReturn_t dict_clear(pPmObj_t pdict);
  */
 PmReturn_t dict_getItem(pPmObj_t pdict, pPmObj_t pkey, pPmObj_t *r_pobj);
 
+/**
+ * Gets where the value for the given key is held in the dict.
+ * The slot stays valid until the dict loses a key or is cleared.
+ *
+ * @param   pdict ptr to dict to search
+ * @param   pkey ptr to key obj
+ * @param   r_pslot Return; addr of ptr to the slot of the value
+ * @return  Return status
+ */
+PmReturn_t dict_getSlot(pPmObj_t pdict, pPmObj_t pkey, pPmObj_t **r_pslot);
+
+/**
+ * Looks in the lookup cache for the slot found the last time
+ * the bytecode at psite looked up pkey starting from pdict.
+ *
+ * @param   psite address of the bytecode doing the lookup
+ * @param   pdict ptr to dict the lookup starts from
+ * @param   pkey ptr to key obj
+ * @return  ptr to the slot of the value, or C_NULL if not cached
+ */
+pPmObj_t *dict_cacheGet(uint8_t const *psite, pPmObj_t pdict, pPmObj_t pkey);
+
+/**
+ * Puts the slot a lookup found in the lookup cache.
+ *
+ * @param   psite address of the bytecode doing the lookup
+ * @param   pdict ptr to dict the lookup started from
+ * @param   pkey ptr to key obj
+ * @param   pslot ptr to the slot of the value found
+ */
+void dict_cachePut(uint8_t const *psite, pPmObj_t pdict, pPmObj_t pkey,
+                   pPmObj_t *pslot);
+
+/**
+ * Expires every entry in the lookup cache.  Called when any dict
+ * gains or loses a key, since that can change where a lookup ends,
+ * and when the heap is initialized or swept.
+ */
+void dict_cacheInvalidate(void);
+
 #ifdef HAVE_DEL
 /**
  * Removes a key and value from the dict.
@@ -92,8 +156,8 @@ PmReturn_t dict_new(pPmObj_t *r_pdict);
  * Sets a value in the dict using the given key.
  *
  * If the dict already contains a matching key, the value is
- * replaced; otherwise the new key,val pair is inserted
- * at the front of the dict (for fast lookup).
+ * replaced; otherwise the new key,val pair is appended
+ * to the end of the dict.
  * In the later case, the length of the dict is incremented.
  *
  * @param   pdict ptr to dict in which (key,val) will go
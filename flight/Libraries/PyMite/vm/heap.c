@@ -60,6 +60,21 @@
 /** The minimum size a chunk can be (rounded up to a multiple of 4) */
 #define HEAP_MIN_CHUNK_SIZE ((sizeof(PmHeapDesc_t) + 3) & ~3)
 
+/**
+ * Free chunks smaller than this many bytes are kept in one free list
+ * per size (multiples of four), so a small object is an exact fit.
+ */
+#define HEAP_EXACT_CLASS_LIMIT 64
+
+/**
+ * The number of free lists: one per size below HEAP_EXACT_CLASS_LIMIT,
+ * then one per power of two up to HEAP_MAX_FREE_CHUNK_SIZE
+ */
+#define HEAP_NUM_SIZE_CLASSES ((HEAP_EXACT_CLASS_LIMIT >> 2) + 10)
+
+/** The size of the GC's stack of gray (marked, but not scanned) objects */
+#define HEAP_GC_GRAY_STACK_SIZE 32
+
 
 /**
  * Gets the GC's mark bit for the object.
@@ -118,6 +133,19 @@ typedef struct PmHeapDesc_s
 } PmHeapDesc_t,
  *pPmHeapDesc_t;
 
+/** The phases of an incremental garbage collection cycle */
+typedef enum PmGcPhase_e
+{
+    /** No cycle is running; allocations get the current mark */
+    GC_PHASE_IDLE = 0,
+
+    /** Marking; allocations are unmarked until the remark finds them */
+    GC_PHASE_MARKING,
+
+    /** Sweeping; allocations get the current mark and survive the sweep */
+    GC_PHASE_SWEEPING
+} PmGcPhase_t;
+
 typedef struct PmHeap_s
 {
     /*
@@ -128,8 +156,11 @@ typedef struct PmHeap_s
     /** Global declaration of heap. */
     uint8_t base[PM_HEAP_SIZE];
 
-    /** Ptr to list of free chunks; sorted smallest to largest. */
-    pPmHeapDesc_t pfreelist;
+    /** Free lists of chunks; the size class gives the index */
+    pPmHeapDesc_t freelist[HEAP_NUM_SIZE_CLASSES];
+
+    /** Bit n is set when freelist[n] is not empty */
+    uint32_t freemap;
 
     /** The amount of heap space available in free list */
 #if PM_HEAP_SIZE > 65535
@@ -150,6 +181,30 @@ typedef struct PmHeap_s
     pPmObj_t temp_roots[HEAP_NUM_TEMP_ROOTS];
 
     uint8_t temp_root_index;
+
+    /** The phase of the current collection cycle */
+    PmGcPhase_t phase;
+
+    /** Objects that are marked but whose references are not yet marked */
+    pPmObj_t gray[HEAP_GC_GRAY_STACK_SIZE];
+
+    uint8_t gray_index;
+
+    /** The lowest and highest marked objects that did not fit on it */
+    pPmObj_t gray_lo;
+
+    pPmObj_t gray_hi;
+
+    /** The next and last chunks of a rescan for them, or C_NULL */
+    pPmObj_t prescan;
+
+    pPmObj_t prescan_end;
+
+    /** The next chunk to be swept */
+    pPmObj_t psweep;
+
+    /** Collector statistics */
+    PmGcStats_t stats;
 #endif                          /* HAVE_GC */
 
 } PmHeap_t,
@@ -160,19 +215,32 @@ typedef struct PmHeap_s
 static PmHeap_t pmHeap PM_PLAT_HEAP_ATTR;
 
 
+#ifdef HAVE_GC
+#ifdef HAVE_INCREMENTAL_GC
+static PmReturn_t heap_gcStep(void);
+static PmReturn_t heap_gcFinishCycle(void);
+#endif /* HAVE_INCREMENTAL_GC */
+static void heap_gcUngray(pPmObj_t pobj);
+#endif /* HAVE_GC */
+
+
 #if 0
 static void
 heap_gcPrintFreelist(void)
 {
-    pPmHeapDesc_t pchunk = pmHeap.pfreelist;
+    pPmHeapDesc_t pchunk;
+    uint8_t sc;
 
     printf("DEBUG: pmHeap.avail = %d\n", pmHeap.avail);
     printf("DEBUG: freelist:\n");
-    while (pchunk != C_NULL)
+    for (sc = 0; sc < HEAP_NUM_SIZE_CLASSES; sc++)
     {
-        printf("DEBUG:     free chunk (%d bytes) @ 0x%0x\n",
-               OBJ_GET_SIZE(pchunk), (int)pchunk);
-        pchunk = pchunk->next;
+        for (pchunk = pmHeap.freelist[sc]; pchunk != C_NULL;
+             pchunk = pchunk->next)
+        {
+            printf("DEBUG:     free chunk (%d bytes) @ 0x%0x\n",
+                   OBJ_GET_SIZE(pchunk), (int)pchunk);
+        }
     }
 }
 #endif
@@ -254,10 +322,36 @@ heap_dump(void)
 #endif
 
 
-/* Removes the given chunk from the free list; leaves list in sorted order */
+/*
+ * Returns the index of the free list that holds chunks of the given size.
+ * Small sizes each have their own list; larger sizes share a list
+ * per power of two: [64, 128) is HEAP_EXACT_CLASS_LIMIT >> 2, and so on.
+ */
+static uint8_t
+heap_getSizeClass(uint16_t size)
+{
+    uint8_t sc;
+
+    if (size < HEAP_EXACT_CLASS_LIMIT)
+    {
+        return (uint8_t)(size >> 2);
+    }
+
+    sc = HEAP_EXACT_CLASS_LIMIT >> 2;
+    for (size /= (HEAP_EXACT_CLASS_LIMIT << 1); size != 0; size >>= 1)
+    {
+        sc++;
+    }
+    return sc;
+}
+
+
+/* Removes the given chunk from its free list */
 static PmReturn_t
 heap_unlinkFromFreelist(pPmHeapDesc_t pchunk)
 {
+    uint8_t sc;
+
     C_ASSERT(pchunk != C_NULL);
 
     pmHeap.avail -= OBJ_GET_SIZE(pchunk);
@@ -267,10 +361,15 @@ heap_unlinkFromFreelist(pPmHeapDesc_t pchunk)
         pchunk->next->prev = pchunk->prev;
     }
 
-    /* If pchunk was the first chunk in the free list, update the heap ptr */
+    /* If pchunk was the first chunk in its free list, update the list head */
     if (pchunk->prev == C_NULL)
     {
-        pmHeap.pfreelist = pchunk->next;
+        sc = heap_getSizeClass(OBJ_GET_SIZE(pchunk));
+        pmHeap.freelist[sc] = pchunk->next;
+        if (pchunk->next == C_NULL)
+        {
+            pmHeap.freemap &= ~((uint32_t)1 << sc);
+        }
     }
     else
     {
@@ -281,65 +380,26 @@ heap_unlinkFromFreelist(pPmHeapDesc_t pchunk)
 }
 
 
-/* Inserts in order a chunk into the free list.  Caller adjusts heap state */
+/* Puts a chunk at the head of its free list.  Caller adjusts heap state */
 static PmReturn_t
 heap_linkToFreelist(pPmHeapDesc_t pchunk)
 {
-    uint16_t size;
-    pPmHeapDesc_t pscan;
+    uint8_t sc;
 
     /* Ensure the object is already free */
     C_ASSERT(OBJ_GET_FREE(pchunk) != 0);
 
     pmHeap.avail += OBJ_GET_SIZE(pchunk);
 
-    /* If free list is empty, add to head of list */
-    if (pmHeap.pfreelist == C_NULL)
-    {
-        pmHeap.pfreelist = pchunk;
-        pchunk->next = C_NULL;
-        pchunk->prev = C_NULL;
-
-        return PM_RET_OK;
-    }
-
-    /* Scan free list for insertion point */
-    pscan = pmHeap.pfreelist;
-    size = OBJ_GET_SIZE(pchunk);
-    while ((OBJ_GET_SIZE(pscan) < size) && (pscan->next != C_NULL))
-    {
-        pscan = pscan->next;
-    }
-
-    /*
-     * Insert chunk after the scan chunk (next is NULL).
-     * This is a slightly rare case where the last chunk in the free list
-     * is smaller than the chunk being freed.
-     */
-    if (size > OBJ_GET_SIZE(pscan))
+    sc = heap_getSizeClass(OBJ_GET_SIZE(pchunk));
+    pchunk->prev = C_NULL;
+    pchunk->next = pmHeap.freelist[sc];
+    if (pchunk->next != C_NULL)
     {
-        pchunk->next = pscan->next;
-        pscan->next = pchunk;
-        pchunk->prev = pscan;
-    }
-
-    /* Insert chunk before the scan chunk */
-    else
-    {
-        pchunk->next = pscan;
-        pchunk->prev = pscan->prev;
-
-        /* If chunk will be first item in free list */
-        if (pscan->prev == C_NULL)
-        {
-            pmHeap.pfreelist = pchunk;
-        }
-        else
-        {
-            pscan->prev->next = pchunk;
-        }
-        pscan->prev = pchunk;
+        pchunk->next->prev = pchunk;
     }
+    pmHeap.freelist[sc] = pchunk;
+    pmHeap.freemap |= (uint32_t)1 << sc;
 
     return PM_RET_OK;
 }
@@ -365,11 +425,18 @@ heap_init(void)
 #endif
 
     /* Init heap globals */
-    pmHeap.pfreelist = C_NULL;
+    sli_memset((unsigned char *)pmHeap.freelist, 0, sizeof(pmHeap.freelist));
+    pmHeap.freemap = 0;
     pmHeap.avail = 0;
 #ifdef HAVE_GC
     pmHeap.gcval = (uint8_t)0;
     pmHeap.temp_root_index = (uint8_t)0;
+    pmHeap.phase = GC_PHASE_IDLE;
+    pmHeap.gray_index = (uint8_t)0;
+    pmHeap.gray_lo = C_NULL;
+    pmHeap.gray_hi = C_NULL;
+    pmHeap.prescan = C_NULL;
+    sli_memset((unsigned char *)&pmHeap.stats, 0, sizeof(pmHeap.stats));
     heap_gcSetAuto(C_TRUE);
 #endif /* HAVE_GC */
 
@@ -398,16 +465,18 @@ heap_init(void)
                   pmHeap.base, pmHeap.avail);
 
     string_cacheInit();
+    dict_cacheInvalidate();
 
     return PM_RET_OK;
 }
 
 
 /**
- * Obtains a chunk of memory from the free list
+ * Obtains a chunk of memory from the free lists
  *
- * Performs the Best Fit algorithm.
- * Iterates through the freelist to see if a chunk of suitable size exists.
+ * Takes the first chunk that fits from the requested size's free list,
+ * else the head of the next larger non-empty free list.
+ * The small size classes hold one size only, so they are an exact fit.
  * Shaves a chunk to perfect size iff the remainder is greater than
  * the minimum chunk size.
  *
@@ -421,16 +490,27 @@ heap_getChunkImpl(uint16_t size, uint8_t **r_pchunk)
     PmReturn_t retval;
     pPmHeapDesc_t pchunk;
     pPmHeapDesc_t premainderChunk;
+    uint8_t sc;
 
     C_ASSERT(r_pchunk != C_NULL);
 
-    /* Skip to the first chunk that can hold the requested size */
-    pchunk = pmHeap.pfreelist;
+    /* Look for a chunk that can hold the requested size in its own class */
+    sc = heap_getSizeClass(size);
+    pchunk = pmHeap.freelist[sc];
     while ((pchunk != C_NULL) && (OBJ_GET_SIZE(pchunk) < size))
     {
         pchunk = pchunk->next;
     }
 
+    /* Else any chunk of the smallest larger class will do */
+    while ((pchunk == C_NULL) && (++sc < HEAP_NUM_SIZE_CLASSES))
+    {
+        if (pmHeap.freemap & ((uint32_t)1 << sc))
+        {
+            pchunk = pmHeap.freelist[sc];
+        }
+    }
+
     /* No chunk of appropriate size was found, raise OutOfMemory exception */
     if (pchunk == C_NULL)
     {
@@ -477,9 +557,13 @@ heap_getChunkImpl(uint16_t size, uint8_t **r_pchunk)
 
     /*
      * Set the chunk's GC mark so it will be collected during the next GC cycle
-     * if it is not reachable
+     * if it is not reachable.  While marking, a new chunk is left unmarked
+     * until the remark finds it; while sweeping it is marked so it survives.
      */
-    OBJ_SET_GCVAL(pchunk, pmHeap.gcval);
+#ifdef HAVE_GC
+    OBJ_SET_GCVAL(pchunk, (pmHeap.phase == GC_PHASE_MARKING)
+                  ? (pmHeap.gcval ^ 1) : pmHeap.gcval);
+#endif /* HAVE_GC */
 
     /* Return the chunk */
     *r_pchunk = (uint8_t *)pchunk;
@@ -518,9 +602,36 @@ heap_getChunk(uint16_t requestedsize, uint8_t **r_pchunk)
      */
     adjustedsize = ((requestedsize + 3) & ~3);
 
+#ifdef HAVE_INCREMENTAL_GC
+    /*
+     * Do a step of the incremental GC before the allocation, so the new chunk
+     * gets the mark of the phase the step leaves the collector in
+     */
+    if ((pmHeap.auto_gc == C_TRUE)
+        && (gVmGlobal.nativeframe.nf_active == C_FALSE))
+    {
+        retval = heap_gcStep();
+        PM_RETURN_IF_ERROR(retval);
+    }
+#endif /* HAVE_INCREMENTAL_GC */
+
     /* Attempt to get a chunk */
     retval = heap_getChunkImpl(adjustedsize, r_pchunk);
 
+#ifdef HAVE_INCREMENTAL_GC
+    /* If out of memory, first finish the incremental cycle in progress */
+    if ((retval == PM_RET_EX_MEM) && (pmHeap.phase != GC_PHASE_IDLE)
+        && (pmHeap.auto_gc == C_TRUE)
+        && (gVmGlobal.nativeframe.nf_active == C_FALSE))
+    {
+        retval = heap_gcFinishCycle();
+        PM_RETURN_IF_ERROR(retval);
+
+        /* Attempt to get a chunk */
+        retval = heap_getChunkImpl(adjustedsize, r_pchunk);
+    }
+#endif /* HAVE_INCREMENTAL_GC */
+
 #ifdef HAVE_GC
     /* Perform GC if out of memory, gc is enabled and not in native session */
     if ((retval == PM_RET_EX_MEM) && (pmHeap.auto_gc == C_TRUE)
@@ -557,6 +668,14 @@ heap_freeChunk(pPmObj_t ptr)
     C_ASSERT(((uint8_t *)ptr >= pmHeap.base)
              && ((uint8_t *)ptr < pmHeap.base + PM_HEAP_SIZE));
 
+#ifdef HAVE_GC
+    /* Frames and blocks are freed while still reachable; don't scan them */
+    if (pmHeap.phase == GC_PHASE_MARKING)
+    {
+        heap_gcUngray(ptr);
+    }
+#endif /* HAVE_GC */
+
     /* Insert the chunk into the freelist */
     OBJ_SET_FREE(ptr, 1);
 
@@ -583,27 +702,52 @@ heap_getAvail(void)
 
 #ifdef HAVE_GC
 /*
- * Marks the given object and the objects it references.
- *
- * @param   pobj Any non-free heap object
- * @return  Return code
+ * Puts a marked object on the gray stack.  If the gray stack is full, the
+ * marking finds the object again by rescanning the part of the heap where
+ * objects were dropped: the rescan that is running if it has yet to reach
+ * the object, else the next one.
  */
-static PmReturn_t
-heap_gcMarkObj(pPmObj_t pobj)
+static void
+heap_gcPushGray(pPmObj_t pobj)
 {
-    PmReturn_t retval = PM_RET_OK;
-    int16_t i = 0;
-    int16_t n;
-    PmType_t type;
-
-    /* Return if ptr is null or object is already marked */
-    if (pobj == C_NULL)
+    if (pmHeap.gray_index < HEAP_GC_GRAY_STACK_SIZE)
     {
-        return retval;
+        pmHeap.gray[pmHeap.gray_index++] = pobj;
     }
-    if (OBJ_GET_GCVAL(pobj) == pmHeap.gcval)
+    else if ((pmHeap.prescan != C_NULL) && (pobj >= pmHeap.prescan))
     {
-        return retval;
+        if (pobj > pmHeap.prescan_end)
+        {
+            pmHeap.prescan_end = pobj;
+        }
+    }
+    else
+    {
+        if ((pmHeap.gray_lo == C_NULL) || (pobj < pmHeap.gray_lo))
+        {
+            pmHeap.gray_lo = pobj;
+        }
+        if ((pmHeap.gray_hi == C_NULL) || (pobj > pmHeap.gray_hi))
+        {
+            pmHeap.gray_hi = pobj;
+        }
+    }
+}
+
+
+/*
+ * Marks the given object and, unless it holds no references, puts it on
+ * the gray stack so the objects it references get marked by a later step.
+ *
+ * @param   pobj Any non-free heap object or C_NULL
+ */
+static void
+heap_gcShade(pPmObj_t pobj)
+{
+    /* Return if ptr is null or object is already marked */
+    if ((pobj == C_NULL) || (OBJ_GET_GCVAL(pobj) == pmHeap.gcval))
+    {
+        return;
     }
 
     /* The pointer must be within the heap (native frame is special case) */
@@ -614,10 +758,14 @@ heap_gcMarkObj(pPmObj_t pobj)
     /* The object must not already be free */
     C_ASSERT(OBJ_GET_FREE(pobj) == 0);
 
-    type = (PmType_t)OBJ_GET_TYPE(pobj);
-    switch (type)
+    OBJ_SET_GCVAL(pobj, pmHeap.gcval);
+
+    switch (OBJ_GET_TYPE(pobj))
     {
-            /* Objects with no references to other objects */
+            /*
+             * Objects with no references to other objects are done.
+             * A segment's items are marked with its seglist.
+             */
         case OBJ_TYPE_NON:
         case OBJ_TYPE_INT:
         case OBJ_TYPE_FLT:
@@ -625,140 +773,154 @@ heap_gcMarkObj(pPmObj_t pobj)
         case OBJ_TYPE_NOB:
         case OBJ_TYPE_BOOL:
         case OBJ_TYPE_CIO:
-            OBJ_SET_GCVAL(pobj, pmHeap.gcval);
+        case OBJ_TYPE_DIX:
+        case OBJ_TYPE_SEG:
+#ifdef HAVE_BYTEARRAY
+        case OBJ_TYPE_BYS:
+#endif /* HAVE_BYTEARRAY */
             break;
 
-        case OBJ_TYPE_TUP:
-            i = ((pPmTuple_t)pobj)->length;
+        default:
+            heap_gcPushGray(pobj);
+            break;
+    }
+}
+
+
+/*
+ * Removes an object that is being freed from the gray stack.
+ * A frame can be on it more than once (see heap_gcFrameBarrier()).
+ */
+static void
+heap_gcUngray(pPmObj_t pobj)
+{
+    uint8_t i = 0;
+
+    while (i < pmHeap.gray_index)
+    {
+        if (pmHeap.gray[i] == pobj)
+        {
+            pmHeap.gray[i] = pmHeap.gray[--pmHeap.gray_index];
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
 
-            /* Mark tuple head */
-            OBJ_SET_GCVAL(pobj, pmHeap.gcval);
+/*
+ * Marks the objects the given object references.
+ *
+ * @param   pobj Any marked heap object
+ * @param   r_work Return by reference; the number of references marked
+ * @return  Return code
+ */
+static PmReturn_t
+heap_gcScanObj(pPmObj_t pobj, int16_t *r_work)
+{
+    PmReturn_t retval = PM_RET_OK;
+    int16_t i = 0;
+    int16_t n;
+
+    *r_work = 1;
+    switch (OBJ_GET_TYPE(pobj))
+    {
+            /* Objects with no references to other objects */
+        case OBJ_TYPE_NON:
+        case OBJ_TYPE_INT:
+        case OBJ_TYPE_FLT:
+        case OBJ_TYPE_STR:
+        case OBJ_TYPE_NOB:
+        case OBJ_TYPE_BOOL:
+        case OBJ_TYPE_CIO:
+        case OBJ_TYPE_DIX:
+        case OBJ_TYPE_SEG:
+#ifdef HAVE_BYTEARRAY
+        case OBJ_TYPE_BYS:
+#endif /* HAVE_BYTEARRAY */
+            break;
 
+        case OBJ_TYPE_TUP:
             /* Mark each obj in tuple */
+            i = ((pPmTuple_t)pobj)->length;
+            *r_work += i;
             while (--i >= 0)
             {
-                retval = heap_gcMarkObj(((pPmTuple_t)pobj)->val[i]);
-                PM_RETURN_IF_ERROR(retval);
+                heap_gcShade(((pPmTuple_t)pobj)->val[i]);
             }
             break;
 
         case OBJ_TYPE_LST:
-
-            /* Mark the list */
-            OBJ_SET_GCVAL(pobj, pmHeap.gcval);
-
             /* Mark the seglist */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmList_t)pobj)->val);
+            heap_gcShade((pPmObj_t)((pPmList_t)pobj)->val);
             break;
 
         case OBJ_TYPE_DIC:
-            /* Mark the dict head */
-            OBJ_SET_GCVAL(pobj, pmHeap.gcval);
-
-            /* Mark the keys seglist */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmDict_t)pobj)->d_keys);
-            PM_RETURN_IF_ERROR(retval);
-
-            /* Mark the vals seglist */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmDict_t)pobj)->d_vals);
+            /* Mark the keys and vals seglists and the hash index */
+            heap_gcShade((pPmObj_t)((pPmDict_t)pobj)->d_keys);
+            heap_gcShade((pPmObj_t)((pPmDict_t)pobj)->d_vals);
+            heap_gcShade((pPmObj_t)((pPmDict_t)pobj)->d_index);
             break;
 
         case OBJ_TYPE_COB:
-            /* Mark the code obj head */
-            OBJ_SET_GCVAL(pobj, pmHeap.gcval);
-
             /* Mark the names tuple */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmCo_t)pobj)->co_names);
-            PM_RETURN_IF_ERROR(retval);
+            heap_gcShade((pPmObj_t)((pPmCo_t)pobj)->co_names);
 
             /* Mark the consts tuple */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmCo_t)pobj)->co_consts);
-            PM_RETURN_IF_ERROR(retval);
+            heap_gcShade((pPmObj_t)((pPmCo_t)pobj)->co_consts);
 
             /* #122: Mark the code image if it is in RAM */
             if (((pPmCo_t)pobj)->co_memspace == MEMSPACE_RAM)
             {
-                retval = heap_gcMarkObj((pPmObj_t)
-                                        (((pPmCo_t)pobj)->co_codeimgaddr));
-                PM_RETURN_IF_ERROR(retval);
+                heap_gcShade((pPmObj_t)(((pPmCo_t)pobj)->co_codeimgaddr));
             }
 
 #ifdef HAVE_CLOSURES
             /* #256: Add support for closures */
             /* Mark the cellvars tuple */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmCo_t)pobj)->co_cellvars);
+            heap_gcShade((pPmObj_t)((pPmCo_t)pobj)->co_cellvars);
 #endif /* HAVE_CLOSURES */
             break;
 
         case OBJ_TYPE_MOD:
         case OBJ_TYPE_FXN:
             /* Module and Func objs are implemented via the PmFunc_t */
-            /* Mark the func obj head */
-            OBJ_SET_GCVAL(pobj, pmHeap.gcval);
-
-            /* Mark the code obj */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmFunc_t)pobj)->f_co);
-            PM_RETURN_IF_ERROR(retval);
-
-            /* Mark the attr dict */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmFunc_t)pobj)->f_attrs);
-            PM_RETURN_IF_ERROR(retval);
-
-            /* Mark the globals dict */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmFunc_t)pobj)->f_globals);
-            PM_RETURN_IF_ERROR(retval);
+            /* Mark the code obj, the attr dict and the globals dict */
+            heap_gcShade((pPmObj_t)((pPmFunc_t)pobj)->f_co);
+            heap_gcShade((pPmObj_t)((pPmFunc_t)pobj)->f_attrs);
+            heap_gcShade((pPmObj_t)((pPmFunc_t)pobj)->f_globals);
 
 #ifdef HAVE_DEFAULTARGS
             /* Mark the default args tuple */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmFunc_t)pobj)->f_defaultargs);
-            PM_RETURN_IF_ERROR(retval);
+            heap_gcShade((pPmObj_t)((pPmFunc_t)pobj)->f_defaultargs);
 #endif /* HAVE_DEFAULTARGS */
 
 #ifdef HAVE_CLOSURES
             /* #256: Mark the closure tuple */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmFunc_t)pobj)->f_closure);
+            heap_gcShade((pPmObj_t)((pPmFunc_t)pobj)->f_closure);
 #endif /* HAVE_CLOSURES */
             break;
 
 #ifdef HAVE_CLASSES
         case OBJ_TYPE_CLI:
-            /* Mark the obj head */
-            OBJ_SET_GCVAL(pobj, pmHeap.gcval);
-
-            /* Mark the class */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmInstance_t)pobj)->cli_class);
-            PM_RETURN_IF_ERROR(retval);
-
-            /* Mark the attrs dict */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmInstance_t)pobj)->cli_attrs);
+            /* Mark the class and the attrs dict */
+            heap_gcShade((pPmObj_t)((pPmInstance_t)pobj)->cli_class);
+            heap_gcShade((pPmObj_t)((pPmInstance_t)pobj)->cli_attrs);
             break;
 
         case OBJ_TYPE_MTH:
-            /* Mark the obj head */
-            OBJ_SET_GCVAL(pobj, pmHeap.gcval);
-
-            /* Mark the instance */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmMethod_t)pobj)->m_instance);
-            PM_RETURN_IF_ERROR(retval);
-
-            /* Mark the func */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmMethod_t)pobj)->m_func);
-            PM_RETURN_IF_ERROR(retval);
-
-            /* Mark the attrs dict */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmMethod_t)pobj)->m_attrs);
+            /* Mark the instance, the func and the attrs dict */
+            heap_gcShade((pPmObj_t)((pPmMethod_t)pobj)->m_instance);
+            heap_gcShade((pPmObj_t)((pPmMethod_t)pobj)->m_func);
+            heap_gcShade((pPmObj_t)((pPmMethod_t)pobj)->m_attrs);
             break;
 
         case OBJ_TYPE_CLO:
-            /* Mark the obj head */
-            OBJ_SET_GCVAL(pobj, pmHeap.gcval);
-
-            /* Mark the attrs dict */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmClass_t)pobj)->cl_attrs);
-            PM_RETURN_IF_ERROR(retval);
-
-            /* Mark the base tuple */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmClass_t)pobj)->cl_bases);
+            /* Mark the attrs dict and the base tuple */
+            heap_gcShade((pPmObj_t)((pPmClass_t)pobj)->cl_attrs);
+            heap_gcShade((pPmObj_t)((pPmClass_t)pobj)->cl_bases);
             break;
 #endif /* HAVE_CLASSES */
 
@@ -775,70 +937,49 @@ heap_gcMarkObj(pPmObj_t pobj)
         {
             pPmObj_t *ppobj2 = C_NULL;
 
-            /* Mark the frame obj head */
-            OBJ_SET_GCVAL(pobj, pmHeap.gcval);
-
             /* Mark the previous frame, if this isn't a generator's frame */
             /* Issue #129: Fix iterator losing its object */
             if ((((pPmFrame_t)pobj)->fo_func->f_co->co_flags & CO_GENERATOR) == 0)
             {
-                retval = heap_gcMarkObj((pPmObj_t)((pPmFrame_t)pobj)->fo_back);
-                PM_RETURN_IF_ERROR(retval);
+                heap_gcShade((pPmObj_t)((pPmFrame_t)pobj)->fo_back);
             }
 
-            /* Mark the fxn obj */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmFrame_t)pobj)->fo_func);
-            PM_RETURN_IF_ERROR(retval);
-
-            /* Mark the blockstack */
-            retval = heap_gcMarkObj((pPmObj_t)
-                                    ((pPmFrame_t)pobj)->fo_blockstack);
-            PM_RETURN_IF_ERROR(retval);
-
-            /* Mark the attrs dict */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmFrame_t)pobj)->fo_attrs);
-            PM_RETURN_IF_ERROR(retval);
-
-            /* Mark the globals dict */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmFrame_t)pobj)->fo_globals);
-            PM_RETURN_IF_ERROR(retval);
+            /* Mark the fxn obj, the blockstack, the attrs and globals dicts */
+            heap_gcShade((pPmObj_t)((pPmFrame_t)pobj)->fo_func);
+            heap_gcShade((pPmObj_t)((pPmFrame_t)pobj)->fo_blockstack);
+            heap_gcShade((pPmObj_t)((pPmFrame_t)pobj)->fo_attrs);
+            heap_gcShade((pPmObj_t)((pPmFrame_t)pobj)->fo_globals);
 
             /* Mark each obj in the locals list and the stack */
             ppobj2 = ((pPmFrame_t)pobj)->fo_locals;
             while (ppobj2 < ((pPmFrame_t)pobj)->fo_sp)
             {
-                retval = heap_gcMarkObj(*ppobj2);
-                PM_RETURN_IF_ERROR(retval);
+                heap_gcShade(*ppobj2);
                 ppobj2++;
+                (*r_work)++;
             }
             break;
         }
 
         case OBJ_TYPE_BLK:
-            /* Mark the block obj head */
-            OBJ_SET_GCVAL(pobj, pmHeap.gcval);
-
             /* Mark the next block in the stack */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmBlock_t)pobj)->next);
+            heap_gcShade((pPmObj_t)((pPmBlock_t)pobj)->next);
             break;
 
         case OBJ_TYPE_SGL:
-            /* Mark the seglist obj head */
-            OBJ_SET_GCVAL(pobj, pmHeap.gcval);
-
             /* Mark the seglist's segments */
             n = ((pSeglist_t)pobj)->sl_length;
+            *r_work += n;
             pobj = (pPmObj_t)((pSeglist_t)pobj)->sl_rootseg;
             for (i = 0; i < n; i++)
             {
                 /* Mark the segment item */
-                retval = heap_gcMarkObj(((pSegment_t)pobj)->s_val[i % SEGLIST_OBJS_PER_SEG]);
-                PM_RETURN_IF_ERROR(retval);
+                heap_gcShade(((pSegment_t)pobj)->s_val[i % SEGLIST_OBJS_PER_SEG]);
 
                 /* Mark the segment obj head */
                 if ((i % SEGLIST_OBJS_PER_SEG) == 0)
                 {
-                    OBJ_SET_GCVAL(pobj, pmHeap.gcval);
+                    heap_gcShade(pobj);
                 }
 
                 /* Point to the next segment */
@@ -855,65 +996,48 @@ heap_gcMarkObj(pPmObj_t pobj)
             break;
 
         case OBJ_TYPE_SQI:
-            /* Mark the sequence iterator obj head */
-            OBJ_SET_GCVAL(pobj, pmHeap.gcval);
-
             /* Mark the sequence */
-            retval = heap_gcMarkObj(((pPmSeqIter_t)pobj)->si_sequence);
+            heap_gcShade(((pPmSeqIter_t)pobj)->si_sequence);
             break;
 
         case OBJ_TYPE_THR:
-            /* Mark the thread obj head */
-            OBJ_SET_GCVAL(pobj, pmHeap.gcval);
-
-            /* Mark the current frame */
-            retval = heap_gcMarkObj((pPmObj_t)((pPmThread_t)pobj)->pframe);
-            break;
+        {
+            pPmFrame_t pframe;
 
-        case OBJ_TYPE_NFM:
             /*
-             * Mark the obj desc.  This doesn't really do much since the
-             * native frame is declared static (not from the heap), but this
-             * is here in case that ever changes
+             * Mark the current frame and the frames it returns through.
+             * A generator's frame doesn't mark its fo_back (#129), but while
+             * it runs, its fo_back is its caller, which only it refers to.
              */
-            OBJ_SET_GCVAL(pobj, pmHeap.gcval);
+            for (pframe = ((pPmThread_t)pobj)->pframe; pframe != C_NULL;
+                 pframe = pframe->fo_back)
+            {
+                heap_gcShade((pPmObj_t)pframe);
+                (*r_work)++;
+            }
+            break;
+        }
 
+        case OBJ_TYPE_NFM:
             /* Mark the native frame's remaining fields if active */
             if (gVmGlobal.nativeframe.nf_active)
             {
-                /* Mark the frame stack */
-                retval = heap_gcMarkObj((pPmObj_t)
-                                        gVmGlobal.nativeframe.nf_back);
-                PM_RETURN_IF_ERROR(retval);
-
-                /* Mark the function object */
-                retval = heap_gcMarkObj((pPmObj_t)
-                                        gVmGlobal.nativeframe.nf_func);
-                PM_RETURN_IF_ERROR(retval);
-
-                /* Mark the stack object */
-                retval = heap_gcMarkObj(gVmGlobal.nativeframe.nf_stack);
-                PM_RETURN_IF_ERROR(retval);
+                /* Mark the frame stack, the function and the stack object */
+                heap_gcShade((pPmObj_t)gVmGlobal.nativeframe.nf_back);
+                heap_gcShade((pPmObj_t)gVmGlobal.nativeframe.nf_func);
+                heap_gcShade(gVmGlobal.nativeframe.nf_stack);
 
                 /* Mark the args to the native func */
                 for (i = 0; i < NATIVE_GET_NUM_ARGS(); i++)
                 {
-                    retval =
-                        heap_gcMarkObj(gVmGlobal.nativeframe.nf_locals[i]);
-                    PM_RETURN_IF_ERROR(retval);
+                    heap_gcShade(gVmGlobal.nativeframe.nf_locals[i]);
                 }
             }
             break;
 
 #ifdef HAVE_BYTEARRAY
         case OBJ_TYPE_BYA:
-            OBJ_SET_GCVAL(pobj, pmHeap.gcval);
-
-            retval = heap_gcMarkObj((pPmObj_t)((pPmBytearray_t)pobj)->val);
-            break;
-
-        case OBJ_TYPE_BYS:
-            OBJ_SET_GCVAL(pobj, pmHeap.gcval);
+            heap_gcShade((pPmObj_t)((pPmBytearray_t)pobj)->val);
             break;
 #endif /* HAVE_BYTEARRAY */
 
@@ -928,52 +1052,150 @@ heap_gcMarkObj(pPmObj_t pobj)
 
 /*
  * Marks the root objects so they won't be collected during the sweep phase.
- * Recursively marks all objects reachable from the roots.
+ * The native frame is scanned every time, even if it is already marked,
+ * because it is reused by every native call.
  */
 static PmReturn_t
 heap_gcMarkRoots(void)
 {
-    PmReturn_t retval;
-    uint8_t i;
-
-    /* Toggle the GC marking value so it differs from the last run */
-    pmHeap.gcval ^= 1;
+    int16_t work;
 
     /* Mark the constant objects */
-    retval = heap_gcMarkObj(PM_NONE);
-    PM_RETURN_IF_ERROR(retval);
-    retval = heap_gcMarkObj(PM_FALSE);
-    PM_RETURN_IF_ERROR(retval);
-    retval = heap_gcMarkObj(PM_TRUE);
-    PM_RETURN_IF_ERROR(retval);
-    retval = heap_gcMarkObj(PM_ZERO);
-    PM_RETURN_IF_ERROR(retval);
-    retval = heap_gcMarkObj(PM_ONE);
-    PM_RETURN_IF_ERROR(retval);
-    retval = heap_gcMarkObj(PM_NEGONE);
-    PM_RETURN_IF_ERROR(retval);
-    retval = heap_gcMarkObj(PM_CODE_STR);
-    PM_RETURN_IF_ERROR(retval);
+    heap_gcShade(PM_NONE);
+    heap_gcShade(PM_FALSE);
+    heap_gcShade(PM_TRUE);
+    heap_gcShade(PM_ZERO);
+    heap_gcShade(PM_ONE);
+    heap_gcShade(PM_NEGONE);
+    heap_gcShade(PM_CODE_STR);
 
     /* Mark the builtins dict */
-    retval = heap_gcMarkObj(PM_PBUILTINS);
-    PM_RETURN_IF_ERROR(retval);
+    heap_gcShade(PM_PBUILTINS);
+
+    /* Mark the thread list */
+    heap_gcShade((pPmObj_t)gVmGlobal.threadList);
 
     /* Mark the native frame if it is active */
-    retval = heap_gcMarkObj((pPmObj_t)&gVmGlobal.nativeframe);
-    PM_RETURN_IF_ERROR(retval);
+    OBJ_SET_GCVAL(&gVmGlobal.nativeframe, pmHeap.gcval);
+    return heap_gcScanObj((pPmObj_t)&gVmGlobal.nativeframe, &work);
+}
 
-    /* Mark the thread list */
-    retval = heap_gcMarkObj((pPmObj_t)gVmGlobal.threadList);
-    PM_RETURN_IF_ERROR(retval);
 
-    /* Mark the temporary roots */
-    for (i = 0; i < pmHeap.temp_root_index; i++)
+/*
+ * Scans the marked object at the rescan position to find the ones dropped
+ * from a full gray stack.  Visiting a chunk is one unit of work, and
+ * scanning an object costs what it costs from the gray stack, so a rescan
+ * is spread over as many steps as it takes.  The position stays on a chunk
+ * boundary because chunks are only split or merged by the sweep.
+ */
+static PmReturn_t
+heap_gcRescanStep(int16_t *r_done)
+{
+    PmReturn_t retval = PM_RET_OK;
+    pPmObj_t pobj;
+
+    pobj = pmHeap.prescan;
+    pmHeap.prescan = (pPmObj_t)((uint8_t *)pobj + OBJ_GET_SIZE(pobj));
+    if (pmHeap.prescan > pmHeap.prescan_end)
+    {
+        pmHeap.prescan = C_NULL;
+    }
+
+    *r_done = 0;
+    if (!OBJ_GET_FREE(pobj) && (OBJ_GET_GCVAL(pobj) == pmHeap.gcval))
+    {
+        retval = heap_gcScanObj(pobj, r_done);
+    }
+    (*r_done)++;
+    return retval;
+}
+
+
+/*
+ * Scans gray objects, then rescans the heap if the gray stack overflowed,
+ * until the work is done or there is nothing left to scan.
+ * A negative amount of work runs until there is nothing left to scan.
+ */
+static PmReturn_t
+heap_gcMarkStep(int16_t work)
+{
+    PmReturn_t retval = PM_RET_OK;
+    int16_t done;
+
+    while (work != 0)
     {
-        retval = heap_gcMarkObj(pmHeap.temp_roots[i]);
+        if (pmHeap.gray_index > 0)
+        {
+            retval = heap_gcScanObj(pmHeap.gray[--pmHeap.gray_index], &done);
+        }
+        else if (pmHeap.prescan != C_NULL)
+        {
+            retval = heap_gcRescanStep(&done);
+        }
+        else if (pmHeap.gray_lo != C_NULL)
+        {
+            pmHeap.prescan = pmHeap.gray_lo;
+            pmHeap.prescan_end = pmHeap.gray_hi;
+            pmHeap.gray_lo = C_NULL;
+            pmHeap.gray_hi = C_NULL;
+            continue;
+        }
+        else
+        {
+            break;
+        }
         PM_RETURN_IF_ERROR(retval);
+
+        if (work > 0)
+        {
+            work = (work > done) ? work - done : 0;
+        }
     }
+    return retval;
+}
+
+
+/* Returns true when the marking has nothing left to scan */
+static uint8_t
+heap_gcMarkDone(void)
+{
+    return (pmHeap.gray_index == 0) && (pmHeap.prescan == C_NULL)
+        && (pmHeap.gray_lo == C_NULL);
+}
+
+
+/*
+ * Scans the threads and their current frames again.  They change without
+ * a write barrier: a thread when it switches frames and the current frame
+ * whenever its code runs.  A frame that stops being current is grayed
+ * again by heap_gcFrameBarrier(), so the others need no rescan.
+ */
+static PmReturn_t
+heap_gcRescanThreads(void)
+{
+    PmReturn_t retval = PM_RET_OK;
+    pPmObj_t pthread;
+    pPmObj_t pframe;
+    int16_t work;
+    int16_t i;
+
+    for (i = 0; i < gVmGlobal.threadList->length; i++)
+    {
+        retval = list_getItem((pPmObj_t)gVmGlobal.threadList, i, &pthread);
+        PM_RETURN_IF_ERROR(retval);
+
+        heap_gcShade(pthread);
+        retval = heap_gcScanObj(pthread, &work);
+        PM_RETURN_IF_ERROR(retval);
 
+        /* The scan above shades the frame; it must be scanned if it was black */
+        pframe = (pPmObj_t)((pPmThread_t)pthread)->pframe;
+        if ((pframe != C_NULL) && (OBJ_GET_GCVAL(pframe) == pmHeap.gcval))
+        {
+            retval = heap_gcScanObj(pframe, &work);
+            PM_RETURN_IF_ERROR(retval);
+        }
+    }
     return retval;
 }
 
@@ -1033,35 +1255,85 @@ heap_purgeStringCache(uint8_t gcval)
 
 
 /*
- * Reclaims any object that does not have a current mark.
- * Puts it in the free list.  Coalesces all contiguous free chunks.
+ * Ends the marking phase without interruption: marks the roots and rescans
+ * the threads and their current frames, then finishes marking what they
+ * reference.
+ * Must only be called where every live object is reachable from the roots.
  */
 static PmReturn_t
-heap_gcSweep(void)
+heap_gcRemark(void)
 {
     PmReturn_t retval;
-    pPmObj_t pobj;
-    pPmHeapDesc_t pchunk;
-    uint16_t totalchunksize;
+    uint8_t i;
+
+    /* #239: Fix GC when 2+ unlinked allocs occur */
+    /* This assertion fails when there are too many objects on the temporary
+     * root stack and a GC occurs; consider increasing PM_HEAP_NUM_TEMP_ROOTS
+     */
+    C_ASSERT(pmHeap.temp_root_index < HEAP_NUM_TEMP_ROOTS);
+
+    retval = heap_gcMarkRoots();
+    PM_RETURN_IF_ERROR(retval);
+
+    /*
+     * Mark the temporary roots.  They hold objects that are still being
+     * filled in without a write barrier, so they are only marked here and
+     * not when the cycle starts, where a scan would miss what they get later.
+     */
+    for (i = 0; i < pmHeap.temp_root_index; i++)
+    {
+        heap_gcShade(pmHeap.temp_roots[i]);
+    }
+
+    retval = heap_gcRescanThreads();
+    PM_RETURN_IF_ERROR(retval);
+    retval = heap_gcMarkStep(-1);
+    PM_RETURN_IF_ERROR(retval);
 
 #if USE_STRING_CACHE
     retval = heap_purgeStringCache(pmHeap.gcval);
 #endif
 
-    /* Start at the base of the heap */
-    pobj = (pPmObj_t)pmHeap.base;
-    while ((uint8_t *)pobj < &pmHeap.base[PM_HEAP_SIZE])
+    pmHeap.phase = GC_PHASE_SWEEPING;
+    pmHeap.psweep = (pPmObj_t)pmHeap.base;
+    return retval;
+}
+
+
+/*
+ * Reclaims any object that does not have a current mark, starting at the
+ * sweep position and visiting about the given number of chunks.
+ * Puts it in the free list.  Coalesces all contiguous free chunks.
+ * A negative amount of work sweeps to the end of the heap.
+ */
+static PmReturn_t
+heap_gcSweepStep(int16_t work)
+{
+    PmReturn_t retval;
+    pPmObj_t pobj;
+    pPmHeapDesc_t pchunk;
+    uint16_t totalchunksize;
+    uint8_t freed = C_FALSE;
+
+    /* Start where the last step stopped */
+    pobj = pmHeap.psweep;
+    while (((uint8_t *)pobj < &pmHeap.base[PM_HEAP_SIZE]) && (work != 0))
     {
         /* Skip to the next unmarked or free chunk within the heap */
-        while (!OBJ_GET_FREE(pobj)
+        while (((uint8_t *)pobj < &pmHeap.base[PM_HEAP_SIZE])
+               && !OBJ_GET_FREE(pobj)
                && (OBJ_GET_GCVAL(pobj) == pmHeap.gcval)
-               && ((uint8_t *)pobj < &pmHeap.base[PM_HEAP_SIZE]))
+               && (work != 0))
         {
             pobj = (pPmObj_t)((uint8_t *)pobj + OBJ_GET_SIZE(pobj));
+            if (work > 0)
+            {
+                work--;
+            }
         }
 
-        /* Stop if reached the end of the heap */
-        if ((uint8_t *)pobj >= &pmHeap.base[PM_HEAP_SIZE])
+        /* Stop if reached the end of the heap or of the work */
+        if (((uint8_t *)pobj >= &pmHeap.base[PM_HEAP_SIZE]) || (work == 0))
         {
             break;
         }
@@ -1097,6 +1369,7 @@ heap_gcSweep(void)
             {
                 OBJ_SET_TYPE(pchunk, 0);
                 OBJ_SET_FREE(pchunk, 1);
+                freed = C_TRUE;
             }
 
             C_DEBUG_PRINT(VERBOSITY_HIGH, "heap_gcSweep(), id=%p, s=%d\n",
@@ -1105,9 +1378,14 @@ heap_gcSweep(void)
             /* Proceed to the next chunk */
             pchunk = (pPmHeapDesc_t)
                 ((uint8_t *)pchunk + OBJ_GET_SIZE(pchunk));
+            if (work > 0)
+            {
+                work--;
+            }
 
-            /* Stop if it's past the end of the heap */
-            if ((uint8_t *)pchunk >= &pmHeap.base[PM_HEAP_SIZE])
+            /* Stop if it's past the end of the heap or the work is done */
+            if (((uint8_t *)pchunk >= &pmHeap.base[PM_HEAP_SIZE])
+                || (work == 0))
             {
                 break;
             }
@@ -1124,35 +1402,230 @@ heap_gcSweep(void)
         /* Continue to the next chunk */
         pobj = (pPmObj_t)pchunk;
     }
+    pmHeap.psweep = pobj;
+
+    /* Freed dicts and values may be reallocated at the same addresses */
+    if (freed)
+    {
+        dict_cacheInvalidate();
+    }
+
+    /* The cycle ends when the whole heap has been swept */
+    if ((uint8_t *)pobj >= &pmHeap.base[PM_HEAP_SIZE])
+    {
+        pmHeap.phase = GC_PHASE_IDLE;
+    }
 
     return PM_RET_OK;
 }
 
 
-/* Runs the mark-sweep garbage collector */
+/* Starts a collection cycle: unmarks every object and marks the roots */
+static PmReturn_t
+heap_gcStart(void)
+{
+    /* Toggle the GC marking value so it differs from the last run */
+    pmHeap.gcval ^= 1;
+    pmHeap.phase = GC_PHASE_MARKING;
+    pmHeap.gray_index = 0;
+    pmHeap.gray_lo = C_NULL;
+    pmHeap.gray_hi = C_NULL;
+    pmHeap.prescan = C_NULL;
+    pmHeap.stats.cycles++;
+
+    return heap_gcMarkRoots();
+}
+
+
+/* Records how long the collector held the interpreter since start, in us */
+static void
+heap_gcEndPause(uint32_t start)
+{
+    uint32_t now;
+
+    plat_getUsTicks(&now);
+    if (now - start > pmHeap.stats.maxPause)
+    {
+        pmHeap.stats.maxPause = now - start;
+    }
+}
+
+
+#ifdef HAVE_INCREMENTAL_GC
+/*
+ * Does a bounded share of the incremental collection.  Runs from
+ * heap_getChunk(), where the marking and sweeping are safe because newly
+ * allocated objects can't be lost: an object allocated while marking is
+ * unmarked only until the remark, which waits for heap_gcSafePoint().
+ */
+static PmReturn_t
+heap_gcStep(void)
+{
+    PmReturn_t retval = PM_RET_OK;
+    uint32_t start;
+
+    if ((pmHeap.phase == GC_PHASE_IDLE)
+        && (pmHeap.avail >= HEAP_GC_START_THRESHOLD))
+    {
+        return retval;
+    }
+
+    plat_getUsTicks(&start);
+    switch (pmHeap.phase)
+    {
+        case GC_PHASE_IDLE:
+            retval = heap_gcStart();
+            break;
+
+        case GC_PHASE_MARKING:
+            retval = heap_gcMarkStep(HEAP_GC_STEP_WORK);
+
+            /* Ask the interpreter for a safe point to remark at */
+            if (heap_gcMarkDone())
+            {
+                interp_setRescheduleFlag((uint8_t)1);
+            }
+            break;
+
+        case GC_PHASE_SWEEPING:
+            retval = heap_gcSweepStep(HEAP_GC_STEP_WORK);
+            break;
+    }
+    heap_gcEndPause(start);
+
+    return retval;
+}
+
+
+/* Remarks once the marking has caught up, then starts sweeping */
 PmReturn_t
-heap_gcRun(void)
+heap_gcSafePoint(void)
+{
+    PmReturn_t retval = PM_RET_OK;
+    uint32_t start;
+
+    if ((pmHeap.phase == GC_PHASE_MARKING) && heap_gcMarkDone())
+    {
+        plat_getUsTicks(&start);
+        retval = heap_gcRemark();
+        heap_gcEndPause(start);
+    }
+    return retval;
+}
+#endif /* HAVE_INCREMENTAL_GC */
+
+
+/* Finishes the collection cycle in progress without interruption */
+static PmReturn_t
+heap_gcFinish(void)
+{
+    PmReturn_t retval = PM_RET_OK;
+
+    if (pmHeap.phase == GC_PHASE_MARKING)
+    {
+        retval = heap_gcMarkStep(-1);
+        PM_RETURN_IF_ERROR(retval);
+        retval = heap_gcRemark();
+        PM_RETURN_IF_ERROR(retval);
+    }
+    if (pmHeap.phase == GC_PHASE_SWEEPING)
+    {
+        retval = heap_gcSweepStep(-1);
+    }
+    return retval;
+}
+
+
+#ifdef HAVE_INCREMENTAL_GC
+/*
+ * Finishes the collection cycle in progress when memory runs out.  This is
+ * shorter than a whole collection, which heap_getChunk() still runs if
+ * finishing the cycle does not free enough.
+ */
+static PmReturn_t
+heap_gcFinishCycle(void)
 {
     PmReturn_t retval;
+    uint32_t start;
 
-    /* #239: Fix GC when 2+ unlinked allocs occur */
-    /* This assertion fails when there are too many objects on the temporary
-     * root stack and a GC occurs; consider increasing PM_HEAP_NUM_TEMP_ROOTS
-     */
-    C_ASSERT(pmHeap.temp_root_index < HEAP_NUM_TEMP_ROOTS);
+    plat_getUsTicks(&start);
+    retval = heap_gcFinish();
+    heap_gcEndPause(start);
+    return retval;
+}
+#endif /* HAVE_INCREMENTAL_GC */
+
+
+/*
+ * Runs a complete mark-sweep garbage collection without interruption.
+ * A cycle in progress is finished first; it can't collect what died
+ * after it started, so a new cycle is run after it.
+ */
+PmReturn_t
+heap_gcRun(void)
+{
+    PmReturn_t retval;
+    uint32_t start;
 
     C_DEBUG_PRINT(VERBOSITY_LOW, "heap_gcRun()\n");
     /*heap_dump();*/
 
-    retval = heap_gcMarkRoots();
+    plat_getUsTicks(&start);
+    pmHeap.stats.fullCollections++;
+
+    /* Finish the cycle in progress */
+    retval = heap_gcFinish();
     PM_RETURN_IF_ERROR(retval);
 
-    retval = heap_gcSweep();
+    /* Run a whole cycle */
+    retval = heap_gcStart();
+    PM_RETURN_IF_ERROR(retval);
+    retval = heap_gcMarkStep(-1);
+    PM_RETURN_IF_ERROR(retval);
+    retval = heap_gcRemark();
+    PM_RETURN_IF_ERROR(retval);
+    retval = heap_gcSweepStep(-1);
     /*heap_dump();*/
+
+    heap_gcEndPause(start);
     return retval;
 }
 
 
+/* Collects garbage before a native session if the heap is low on memory */
+PmReturn_t
+heap_gcReserve(void)
+{
+    PmReturn_t retval = PM_RET_OK;
+
+    if (pmHeap.avail >= HEAP_GC_NF_THRESHOLD)
+    {
+        return retval;
+    }
+
+#ifdef HAVE_INCREMENTAL_GC
+    if (pmHeap.phase != GC_PHASE_IDLE)
+    {
+        retval = heap_gcFinishCycle();
+        if ((retval != PM_RET_OK) || (pmHeap.avail >= HEAP_GC_NF_THRESHOLD))
+        {
+            return retval;
+        }
+    }
+#endif /* HAVE_INCREMENTAL_GC */
+
+    return heap_gcRun();
+}
+
+
+/* Returns, by reference, the collector's statistics */
+void
+heap_gcGetStats(pPmGcStats_t r_stats)
+{
+    *r_stats = pmHeap.stats;
+}
+
+
 /* Enables or disables automatic garbage collection */
 PmReturn_t
 heap_gcSetAuto(uint8_t auto_gc)
@@ -1178,9 +1651,31 @@ void heap_gcPopTempRoot(uint8_t objid)
     pmHeap.temp_root_index = objid;
 }
 
+
+void heap_gcWriteBarrier(pPmObj_t pobj)
+{
+    if (pmHeap.phase == GC_PHASE_MARKING)
+    {
+        heap_gcShade(pobj);
+    }
+}
+
+
+void heap_gcFrameBarrier(pPmObj_t pframe)
+{
+    /* A marked frame may have been scanned before its last stores */
+    if ((pmHeap.phase == GC_PHASE_MARKING)
+        && (OBJ_GET_GCVAL(pframe) == pmHeap.gcval))
+    {
+        heap_gcPushGray(pframe);
+    }
+}
+
 #else
 
 void heap_gcPushTempRoot(pPmObj_t pobj, uint8_t *r_objid) {}
 void heap_gcPopTempRoot(uint8_t objid) {}
+void heap_gcWriteBarrier(pPmObj_t pobj) {}
+void heap_gcFrameBarrier(pPmObj_t pframe) {}
 
 #endif /* HAVE_GC */
@@ -31,6 +31,33 @@
  */
 #define HEAP_GC_NF_THRESHOLD (512)
 
+/**
+ * The threshold of heap.avail under which an allocation starts an
+ * incremental collection cycle.
+ */
+#define HEAP_GC_START_THRESHOLD (PM_HEAP_SIZE / 4)
+
+/**
+ * The work each allocation does for an incremental collection cycle:
+ * the number of references marked or of chunks rescanned or swept.
+ */
+#define HEAP_GC_STEP_WORK (32)
+
+
+/** Garbage collector statistics */
+typedef struct PmGcStats_s
+{
+    /** Number of collection cycles started */
+    uint32_t cycles;
+
+    /** Number of them that ran without interruption (gc(), out of memory) */
+    uint32_t fullCollections;
+
+    /** The longest time the collector has held the interpreter, in us */
+    uint32_t maxPause;
+} PmGcStats_t,
+ *pPmGcStats_t;
+
 
 #ifdef __DEBUG__
 #define DEBUG_PRINT_HEAP_AVAIL(s) \
@@ -77,12 +104,40 @@ uint16_t
 
 #ifdef HAVE_GC
 /**
- * Runs the mark-sweep garbage collector
+ * Runs the mark-sweep garbage collector to completion
  *
  * @return  Return code
  */
 PmReturn_t heap_gcRun(void);
 
+#ifdef HAVE_INCREMENTAL_GC
+/**
+ * Finishes the marking of an incremental collection cycle, once it has
+ * caught up, and starts its sweep.  The interpreter calls this between
+ * bytecodes, where every live object is reachable from the roots.
+ *
+ * @return  Return code
+ */
+PmReturn_t heap_gcSafePoint(void);
+#endif /* HAVE_INCREMENTAL_GC */
+
+/**
+ * Collects garbage if less than HEAP_GC_NF_THRESHOLD bytes are available,
+ * before a native session, during which the GC can't run.
+ * Finishing an incremental cycle in progress is tried before a whole
+ * collection.
+ *
+ * @return  Return code
+ */
+PmReturn_t heap_gcReserve(void);
+
+/**
+ * Gets the garbage collector's statistics
+ *
+ * @param   r_stats Return by reference; the statistics
+ */
+void heap_gcGetStats(pPmGcStats_t r_stats);
+
 /**
  * Enables (if true) or disables automatic garbage collection
  *
@@ -110,4 +165,22 @@ void heap_gcPushTempRoot(pPmObj_t pobj, uint8_t *r_objid);
  */
 void heap_gcPopTempRoot(uint8_t objid);
 
+/**
+ * Tells the incremental garbage collector that a reference to the object
+ * was stored in an object that may already be marked, so the object gets
+ * marked too.  Frames and threads don't need this; see heap_gcFrameBarrier().
+ *
+ * @param pobj Object whose reference was stored
+ */
+void heap_gcWriteBarrier(pPmObj_t pobj);
+
+/**
+ * Tells the incremental garbage collector that the frame stops being the
+ * current frame of its thread.  Stores into the current frame have no write
+ * barrier, so a frame that was already marked is scanned again.
+ *
+ * @param pframe Frame that is left
+ */
+void heap_gcFrameBarrier(pPmObj_t pframe);
+
 #endif /* __HEAP_H__ */
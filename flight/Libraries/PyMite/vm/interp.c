@@ -28,6 +28,29 @@
 #include "pm.h"
 
 
+#ifdef INTERP_THREADED_DISPATCH
+/** Labels the handler of a bytecode for the switch and the dispatch table */
+#define TARGET(bc) case bc: TARGET_##bc:
+
+/**
+ * Goes straight to the handler of the next bytecode, or back around
+ * the interpreter loop when the threads are due to be rescheduled.
+ */
+#define DISPATCH() \
+    { \
+        if (gVmGlobal.reschedule) \
+        { \
+            continue; \
+        } \
+        bc = GET_BYTECODE(); \
+        goto *targets[bc]; \
+    }
+#else
+#define TARGET(bc) case bc:
+#define DISPATCH() continue
+#endif /* INTERP_THREADED_DISPATCH */
+
+
 PmReturn_t
 interpret(const uint8_t returnOnNoThreads)
 {
@@ -35,11 +58,136 @@ interpret(const uint8_t returnOnNoThreads)
     pPmObj_t pobj1 = C_NULL;
     pPmObj_t pobj2 = C_NULL;
     pPmObj_t pobj3 = C_NULL;
+    pPmObj_t *pslot;
     int16_t t16 = 0;
     int8_t t8 = 0;
     uint8_t bc;
     uint8_t objid, objid2;
 
+#ifdef INTERP_THREADED_DISPATCH
+    /* Handler of each bytecode; unknown bytecodes raise a SystemError */
+    static void *const targets[256] =
+    {
+        [0 ... 255] = &&TARGET_default,
+        [POP_TOP] = &&TARGET_POP_TOP,
+        [ROT_TWO] = &&TARGET_ROT_TWO,
+        [ROT_THREE] = &&TARGET_ROT_THREE,
+        [DUP_TOP] = &&TARGET_DUP_TOP,
+        [ROT_FOUR] = &&TARGET_ROT_FOUR,
+        [NOP] = &&TARGET_NOP,
+        [UNARY_POSITIVE] = &&TARGET_UNARY_POSITIVE,
+        [UNARY_NEGATIVE] = &&TARGET_UNARY_NEGATIVE,
+        [UNARY_NOT] = &&TARGET_UNARY_NOT,
+#ifdef HAVE_BACKTICK
+        [UNARY_CONVERT] = &&TARGET_UNARY_CONVERT,
+#endif /* HAVE_BACKTICK */
+        [UNARY_INVERT] = &&TARGET_UNARY_INVERT,
+        [LIST_APPEND] = &&TARGET_LIST_APPEND,
+        [BINARY_POWER] = &&TARGET_BINARY_POWER,
+        [INPLACE_POWER] = &&TARGET_INPLACE_POWER,
+        [GET_ITER] = &&TARGET_GET_ITER,
+        [BINARY_MULTIPLY] = &&TARGET_BINARY_MULTIPLY,
+        [INPLACE_MULTIPLY] = &&TARGET_INPLACE_MULTIPLY,
+        [BINARY_DIVIDE] = &&TARGET_BINARY_DIVIDE,
+        [INPLACE_DIVIDE] = &&TARGET_INPLACE_DIVIDE,
+        [BINARY_FLOOR_DIVIDE] = &&TARGET_BINARY_FLOOR_DIVIDE,
+        [INPLACE_FLOOR_DIVIDE] = &&TARGET_INPLACE_FLOOR_DIVIDE,
+        [BINARY_MODULO] = &&TARGET_BINARY_MODULO,
+        [INPLACE_MODULO] = &&TARGET_INPLACE_MODULO,
+        [STORE_MAP] = &&TARGET_STORE_MAP,
+        [BINARY_ADD] = &&TARGET_BINARY_ADD,
+        [INPLACE_ADD] = &&TARGET_INPLACE_ADD,
+        [BINARY_SUBTRACT] = &&TARGET_BINARY_SUBTRACT,
+        [INPLACE_SUBTRACT] = &&TARGET_INPLACE_SUBTRACT,
+        [BINARY_SUBSCR] = &&TARGET_BINARY_SUBSCR,
+#ifdef HAVE_FLOAT
+        [BINARY_TRUE_DIVIDE] = &&TARGET_BINARY_TRUE_DIVIDE,
+        [INPLACE_TRUE_DIVIDE] = &&TARGET_INPLACE_TRUE_DIVIDE,
+#endif /* HAVE_FLOAT */
+        [STORE_SUBSCR] = &&TARGET_STORE_SUBSCR,
+#ifdef HAVE_DEL
+        [DELETE_SUBSCR] = &&TARGET_DELETE_SUBSCR,
+#endif /* HAVE_DEL */
+        [BINARY_LSHIFT] = &&TARGET_BINARY_LSHIFT,
+        [INPLACE_LSHIFT] = &&TARGET_INPLACE_LSHIFT,
+        [BINARY_RSHIFT] = &&TARGET_BINARY_RSHIFT,
+        [INPLACE_RSHIFT] = &&TARGET_INPLACE_RSHIFT,
+        [BINARY_AND] = &&TARGET_BINARY_AND,
+        [INPLACE_AND] = &&TARGET_INPLACE_AND,
+        [BINARY_XOR] = &&TARGET_BINARY_XOR,
+        [INPLACE_XOR] = &&TARGET_INPLACE_XOR,
+        [BINARY_OR] = &&TARGET_BINARY_OR,
+        [INPLACE_OR] = &&TARGET_INPLACE_OR,
+#ifdef HAVE_PRINT
+        [PRINT_EXPR] = &&TARGET_PRINT_EXPR,
+        [PRINT_ITEM] = &&TARGET_PRINT_ITEM,
+        [PRINT_NEWLINE] = &&TARGET_PRINT_NEWLINE,
+#endif /* HAVE_PRINT */
+        [BREAK_LOOP] = &&TARGET_BREAK_LOOP,
+        [LOAD_LOCALS] = &&TARGET_LOAD_LOCALS,
+        [RETURN_VALUE] = &&TARGET_RETURN_VALUE,
+#ifdef HAVE_IMPORTS
+        [IMPORT_STAR] = &&TARGET_IMPORT_STAR,
+#endif /* HAVE_IMPORTS */
+#ifdef HAVE_GENERATORS
+        [YIELD_VALUE] = &&TARGET_YIELD_VALUE,
+#endif /* HAVE_GENERATORS */
+        [POP_BLOCK] = &&TARGET_POP_BLOCK,
+#ifdef HAVE_CLASSES
+        [BUILD_CLASS] = &&TARGET_BUILD_CLASS,
+#endif /* HAVE_CLASSES */
+        [STORE_NAME] = &&TARGET_STORE_NAME,
+#ifdef HAVE_DEL
+        [DELETE_NAME] = &&TARGET_DELETE_NAME,
+#endif /* HAVE_DEL */
+        [UNPACK_SEQUENCE] = &&TARGET_UNPACK_SEQUENCE,
+        [FOR_ITER] = &&TARGET_FOR_ITER,
+        [STORE_ATTR] = &&TARGET_STORE_ATTR,
+#ifdef HAVE_DEL
+        [DELETE_ATTR] = &&TARGET_DELETE_ATTR,
+#endif /* HAVE_DEL */
+        [STORE_GLOBAL] = &&TARGET_STORE_GLOBAL,
+#ifdef HAVE_DEL
+        [DELETE_GLOBAL] = &&TARGET_DELETE_GLOBAL,
+#endif /* HAVE_DEL */
+        [DUP_TOPX] = &&TARGET_DUP_TOPX,
+        [LOAD_CONST] = &&TARGET_LOAD_CONST,
+        [LOAD_NAME] = &&TARGET_LOAD_NAME,
+        [BUILD_TUPLE] = &&TARGET_BUILD_TUPLE,
+        [BUILD_LIST] = &&TARGET_BUILD_LIST,
+        [BUILD_MAP] = &&TARGET_BUILD_MAP,
+        [LOAD_ATTR] = &&TARGET_LOAD_ATTR,
+        [COMPARE_OP] = &&TARGET_COMPARE_OP,
+        [IMPORT_NAME] = &&TARGET_IMPORT_NAME,
+#ifdef HAVE_IMPORTS
+        [IMPORT_FROM] = &&TARGET_IMPORT_FROM,
+#endif /* HAVE_IMPORTS */
+        [JUMP_FORWARD] = &&TARGET_JUMP_FORWARD,
+        [JUMP_IF_FALSE] = &&TARGET_JUMP_IF_FALSE,
+        [JUMP_IF_TRUE] = &&TARGET_JUMP_IF_TRUE,
+        [JUMP_ABSOLUTE] = &&TARGET_JUMP_ABSOLUTE,
+        [CONTINUE_LOOP] = &&TARGET_CONTINUE_LOOP,
+        [LOAD_GLOBAL] = &&TARGET_LOAD_GLOBAL,
+        [SETUP_LOOP] = &&TARGET_SETUP_LOOP,
+        [LOAD_FAST] = &&TARGET_LOAD_FAST,
+        [STORE_FAST] = &&TARGET_STORE_FAST,
+#ifdef HAVE_DEL
+        [DELETE_FAST] = &&TARGET_DELETE_FAST,
+#endif /* HAVE_DEL */
+#ifdef HAVE_ASSERT
+        [RAISE_VARARGS] = &&TARGET_RAISE_VARARGS,
+#endif /* HAVE_ASSERT */
+        [CALL_FUNCTION] = &&TARGET_CALL_FUNCTION,
+        [MAKE_FUNCTION] = &&TARGET_MAKE_FUNCTION,
+#ifdef HAVE_CLOSURES
+        [MAKE_CLOSURE] = &&TARGET_MAKE_CLOSURE,
+        [LOAD_CLOSURE] = &&TARGET_LOAD_CLOSURE,
+        [LOAD_DEREF] = &&TARGET_LOAD_DEREF,
+        [STORE_DEREF] = &&TARGET_STORE_DEREF,
+#endif /* HAVE_CLOSURES */
+    };
+#endif /* INTERP_THREADED_DISPATCH */
+
     /* Activate a thread the first time */
     retval = interp_reschedule();
     PM_RETURN_IF_ERROR(retval);
@@ -67,48 +215,57 @@ interpret(const uint8_t returnOnNoThreads)
         /* Reschedule threads if flag is true? */
         if (gVmGlobal.reschedule)
         {
+#ifdef HAVE_INCREMENTAL_GC
+            /*
+             * Between bytecodes every live object is reachable, so the GC
+             * can finish marking here; it sets the flag when it is ready
+             */
+            retval = heap_gcSafePoint();
+            PM_BREAK_IF_ERROR(retval);
+#endif /* HAVE_INCREMENTAL_GC */
+
             retval = interp_reschedule();
             PM_BREAK_IF_ERROR(retval);
         }
 
         /* Get byte; the func post-incrs PM_IP */
-        bc = mem_getByte(PM_FP->fo_memspace, &PM_IP);
+        bc = GET_BYTECODE();
         switch (bc)
         {
-            case POP_TOP:
+            TARGET(POP_TOP)
                 pobj1 = PM_POP();
-                continue;
+                DISPATCH();
 
-            case ROT_TWO:
+            TARGET(ROT_TWO)
                 pobj1 = TOS;
                 TOS = TOS1;
                 TOS1 = pobj1;
-                continue;
+                DISPATCH();
 
-            case ROT_THREE:
+            TARGET(ROT_THREE)
                 pobj1 = TOS;
                 TOS = TOS1;
                 TOS1 = TOS2;
                 TOS2 = pobj1;
-                continue;
+                DISPATCH();
 
-            case DUP_TOP:
+            TARGET(DUP_TOP)
                 pobj1 = TOS;
                 PM_PUSH(pobj1);
-                continue;
+                DISPATCH();
 
-            case ROT_FOUR:
+            TARGET(ROT_FOUR)
                 pobj1 = TOS;
                 TOS = TOS1;
                 TOS1 = TOS2;
                 TOS2 = TOS3;
                 TOS3 = pobj1;
-                continue;
+                DISPATCH();
 
-            case NOP:
-                continue;
+            TARGET(NOP)
+                DISPATCH();
 
-            case UNARY_POSITIVE:
+            TARGET(UNARY_POSITIVE)
                 /* Raise TypeError if TOS is not an int */
                 if ((OBJ_GET_TYPE(TOS) != OBJ_TYPE_INT)
 #ifdef HAVE_FLOAT
@@ -121,9 +278,9 @@ interpret(const uint8_t returnOnNoThreads)
                 }
 
                 /* When TOS is an int, this is a no-op */
-                continue;
+                DISPATCH();
 
-            case UNARY_NEGATIVE:
+            TARGET(UNARY_NEGATIVE)
 #ifdef HAVE_FLOAT
                 if (OBJ_GET_TYPE(TOS) == OBJ_TYPE_FLT)
                 {
@@ -136,9 +293,9 @@ interpret(const uint8_t returnOnNoThreads)
                 }
                 PM_BREAK_IF_ERROR(retval);
                 TOS = pobj2;
-                continue;
+                DISPATCH();
 
-            case UNARY_NOT:
+            TARGET(UNARY_NOT)
                 pobj1 = PM_POP();
                 if (obj_isFalse(pobj1))
                 {
@@ -148,18 +305,18 @@ interpret(const uint8_t returnOnNoThreads)
                 {
                     PM_PUSH(PM_FALSE);
                 }
-                continue;
+                DISPATCH();
 
 #ifdef HAVE_BACKTICK
             /* #244 Add support for the backtick operation (UNARY_CONVERT) */
-            case UNARY_CONVERT:
+            TARGET(UNARY_CONVERT)
                 retval = obj_repr(TOS, &pobj3);
                 PM_BREAK_IF_ERROR(retval);
                 TOS = pobj3;
-                continue;
+                DISPATCH();
 #endif /* HAVE_BACKTICK */
 
-            case UNARY_INVERT:
+            TARGET(UNARY_INVERT)
                 /* Raise TypeError if it's not an int */
                 if (OBJ_GET_TYPE(TOS) != OBJ_TYPE_INT)
                 {
@@ -171,16 +328,16 @@ interpret(const uint8_t returnOnNoThreads)
                 retval = int_bitInvert(TOS, &pobj2);
                 PM_BREAK_IF_ERROR(retval);
                 TOS = pobj2;
-                continue;
+                DISPATCH();
 
-            case LIST_APPEND:
+            TARGET(LIST_APPEND)
                 /* list_append will raise a TypeError if TOS1 is not a list */
                 retval = list_append(TOS1, TOS);
                 PM_SP -= 2;
-                continue;
+                DISPATCH();
 
-            case BINARY_POWER:
-            case INPLACE_POWER:
+            TARGET(BINARY_POWER)
+            TARGET(INPLACE_POWER)
 
 #ifdef HAVE_FLOAT
                 if ((OBJ_GET_TYPE(TOS) == OBJ_TYPE_FLT)
@@ -191,7 +348,7 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 #endif /* HAVE_FLOAT */
 
@@ -202,9 +359,9 @@ interpret(const uint8_t returnOnNoThreads)
                 /* Set return value */
                 PM_SP--;
                 TOS = pobj3;
-                continue;
+                DISPATCH();
 
-            case GET_ITER:
+            TARGET(GET_ITER)
 #ifdef HAVE_GENERATORS
                 /* Raise TypeError if TOS is an instance, but not iterable */
                 if (OBJ_GET_TYPE(TOS) == OBJ_TYPE_CLI)
@@ -226,10 +383,10 @@ interpret(const uint8_t returnOnNoThreads)
                     /* Put sequence-iterator on top of stack */
                     TOS = pobj1;
                 }
-                continue;
+                DISPATCH();
 
-            case BINARY_MULTIPLY:
-            case INPLACE_MULTIPLY:
+            TARGET(BINARY_MULTIPLY)
+            TARGET(INPLACE_MULTIPLY)
                 /* If both objs are ints, perform the op */
                 if ((OBJ_GET_TYPE(TOS) == OBJ_TYPE_INT)
                     && (OBJ_GET_TYPE(TOS1) == OBJ_TYPE_INT))
@@ -239,7 +396,7 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 
 #ifdef HAVE_FLOAT
@@ -250,7 +407,7 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 #endif /* HAVE_FLOAT */
 
@@ -269,7 +426,7 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 
                 /* If it's a tuple replication operation */
@@ -286,7 +443,7 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 
                 /* If it's a string replication operation */
@@ -306,7 +463,7 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 #endif /* HAVE_REPLICATION */
 
@@ -314,10 +471,10 @@ interpret(const uint8_t returnOnNoThreads)
                 PM_RAISE(retval, PM_RET_EX_TYPE);
                 break;
 
-            case BINARY_DIVIDE:
-            case INPLACE_DIVIDE:
-            case BINARY_FLOOR_DIVIDE:
-            case INPLACE_FLOOR_DIVIDE:
+            TARGET(BINARY_DIVIDE)
+            TARGET(INPLACE_DIVIDE)
+            TARGET(BINARY_FLOOR_DIVIDE)
+            TARGET(INPLACE_FLOOR_DIVIDE)
 
 #ifdef HAVE_FLOAT
                 if ((OBJ_GET_TYPE(TOS) == OBJ_TYPE_FLT)
@@ -327,7 +484,7 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 #endif /* HAVE_FLOAT */
 
@@ -352,10 +509,10 @@ interpret(const uint8_t returnOnNoThreads)
                 PM_BREAK_IF_ERROR(retval);
                 PM_SP--;
                 TOS = pobj3;
-                continue;
+                DISPATCH();
 
-            case BINARY_MODULO:
-            case INPLACE_MODULO:
+            TARGET(BINARY_MODULO)
+            TARGET(INPLACE_MODULO)
 
 #ifdef HAVE_STRING_FORMAT
                 /* If it's a string, perform string format */
@@ -365,7 +522,7 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 #endif /* HAVE_STRING_FORMAT */
 
@@ -377,7 +534,7 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 #endif /* HAVE_FLOAT */
 
@@ -402,18 +559,18 @@ interpret(const uint8_t returnOnNoThreads)
                 PM_BREAK_IF_ERROR(retval);
                 PM_SP--;
                 TOS = pobj3;
-                continue;
+                DISPATCH();
 
-            case STORE_MAP:
+            TARGET(STORE_MAP)
                 /* #213: Add support for Python 2.6 bytecodes */
                 C_ASSERT(OBJ_GET_TYPE(TOS2) == OBJ_TYPE_DIC);
                 retval = dict_setItem(TOS2, TOS, TOS1);
                 PM_BREAK_IF_ERROR(retval);
                 PM_SP -= 2;
-                continue;
+                DISPATCH();
 
-            case BINARY_ADD:
-            case INPLACE_ADD:
+            TARGET(BINARY_ADD)
+            TARGET(INPLACE_ADD)
 
 #ifdef HAVE_FLOAT
                 if ((OBJ_GET_TYPE(TOS) == OBJ_TYPE_FLT)
@@ -423,7 +580,7 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 #endif /* HAVE_FLOAT */
 
@@ -436,7 +593,7 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 
                 /* #242: If both objs are strings, perform concatenation */
@@ -449,15 +606,15 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 
                 /* Otherwise raise a TypeError */
                 PM_RAISE(retval, PM_RET_EX_TYPE);
                 break;
 
-            case BINARY_SUBTRACT:
-            case INPLACE_SUBTRACT:
+            TARGET(BINARY_SUBTRACT)
+            TARGET(INPLACE_SUBTRACT)
 
 #ifdef HAVE_FLOAT
                 if ((OBJ_GET_TYPE(TOS) == OBJ_TYPE_FLT)
@@ -467,7 +624,7 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 #endif /* HAVE_FLOAT */
 
@@ -480,14 +637,14 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 
                 /* Otherwise raise a TypeError */
                 PM_RAISE(retval, PM_RET_EX_TYPE);
                 break;
 
-            case BINARY_SUBSCR:
+            TARGET(BINARY_SUBSCR)
                 /* Implements TOS = TOS1[TOS]. */
 
                 if (OBJ_GET_TYPE(TOS1) == OBJ_TYPE_DIC)
@@ -526,19 +683,19 @@ interpret(const uint8_t returnOnNoThreads)
                 PM_BREAK_IF_ERROR(retval);
                 PM_SP--;
                 TOS = pobj3;
-                continue;
+                DISPATCH();
 
 #ifdef HAVE_FLOAT
             /* #213: Add support for Python 2.6 bytecodes */
-            case BINARY_TRUE_DIVIDE:
-            case INPLACE_TRUE_DIVIDE:
+            TARGET(BINARY_TRUE_DIVIDE)
+            TARGET(INPLACE_TRUE_DIVIDE)
 
                 /* Perform division; float_op() checks for types and zero-div */
                 retval = float_op(TOS1, TOS, &pobj3, '/');
                 PM_BREAK_IF_ERROR(retval);
                 PM_SP--;
                 TOS = pobj3;
-                continue;
+                DISPATCH();
 #endif /* HAVE_FLOAT */
 
             case SLICE_0:
@@ -562,9 +719,9 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_RAISE(retval, PM_RET_EX_TYPE);
                     break;
                 }
-                continue;
+                DISPATCH();
 
-            case STORE_SUBSCR:
+            TARGET(STORE_SUBSCR)
                 /* Implements TOS1[TOS] = TOS2 */
 
                 /* If it's a list */
@@ -584,7 +741,7 @@ interpret(const uint8_t returnOnNoThreads)
                                           TOS2);
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP -= 3;
-                    continue;
+                    DISPATCH();
                 }
 
                 /* If it's a dict */
@@ -594,7 +751,7 @@ interpret(const uint8_t returnOnNoThreads)
                     retval = dict_setItem(TOS1, TOS, TOS2);
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP -= 3;
-                    continue;
+                    DISPATCH();
                 }
 
 #ifdef HAVE_BYTEARRAY
@@ -627,7 +784,7 @@ interpret(const uint8_t returnOnNoThreads)
                                                TOS2);
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP -= 3;
-                    continue;
+                    DISPATCH();
                 }
 #endif /* HAVE_BYTEARRAY */
 
@@ -636,7 +793,7 @@ interpret(const uint8_t returnOnNoThreads)
                 break;
 
 #ifdef HAVE_DEL
-            case DELETE_SUBSCR:
+            TARGET(DELETE_SUBSCR)
 
                 if ((OBJ_GET_TYPE(TOS1) == OBJ_TYPE_LST)
                     && (OBJ_GET_TYPE(TOS) == OBJ_TYPE_INT))
@@ -659,11 +816,11 @@ interpret(const uint8_t returnOnNoThreads)
 
                 PM_BREAK_IF_ERROR(retval);
                 PM_SP -= 2;
-                continue;
+                DISPATCH();
 #endif /* HAVE_DEL */
 
-            case BINARY_LSHIFT:
-            case INPLACE_LSHIFT:
+            TARGET(BINARY_LSHIFT)
+            TARGET(INPLACE_LSHIFT)
                 /* If both objs are ints, perform the op */
                 if ((OBJ_GET_TYPE(TOS) == OBJ_TYPE_INT)
                     && (OBJ_GET_TYPE(TOS1) == OBJ_TYPE_INT))
@@ -673,15 +830,15 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 
                 /* Otherwise raise a TypeError */
                 PM_RAISE(retval, PM_RET_EX_TYPE);
                 break;
 
-            case BINARY_RSHIFT:
-            case INPLACE_RSHIFT:
+            TARGET(BINARY_RSHIFT)
+            TARGET(INPLACE_RSHIFT)
                 /* If both objs are ints, perform the op */
                 if ((OBJ_GET_TYPE(TOS) == OBJ_TYPE_INT)
                     && (OBJ_GET_TYPE(TOS1) == OBJ_TYPE_INT))
@@ -691,15 +848,15 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 
                 /* Otherwise raise a TypeError */
                 PM_RAISE(retval, PM_RET_EX_TYPE);
                 break;
 
-            case BINARY_AND:
-            case INPLACE_AND:
+            TARGET(BINARY_AND)
+            TARGET(INPLACE_AND)
                 /* If both objs are ints, perform the op */
                 if ((OBJ_GET_TYPE(TOS) == OBJ_TYPE_INT)
                     && (OBJ_GET_TYPE(TOS1) == OBJ_TYPE_INT))
@@ -709,15 +866,15 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 
                 /* Otherwise raise a TypeError */
                 PM_RAISE(retval, PM_RET_EX_TYPE);
                 break;
 
-            case BINARY_XOR:
-            case INPLACE_XOR:
+            TARGET(BINARY_XOR)
+            TARGET(INPLACE_XOR)
                 /* If both objs are ints, perform the op */
                 if ((OBJ_GET_TYPE(TOS) == OBJ_TYPE_INT)
                     && (OBJ_GET_TYPE(TOS1) == OBJ_TYPE_INT))
@@ -727,15 +884,15 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 
                 /* Otherwise raise a TypeError */
                 PM_RAISE(retval, PM_RET_EX_TYPE);
                 break;
 
-            case BINARY_OR:
-            case INPLACE_OR:
+            TARGET(BINARY_OR)
+            TARGET(INPLACE_OR)
                 /* If both objs are ints, perform the op */
                 if ((OBJ_GET_TYPE(TOS) == OBJ_TYPE_INT)
                     && (OBJ_GET_TYPE(TOS1) == OBJ_TYPE_INT))
@@ -745,7 +902,7 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_BREAK_IF_ERROR(retval);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 
                 /* Otherwise raise a TypeError */
@@ -753,11 +910,11 @@ interpret(const uint8_t returnOnNoThreads)
                 break;
 
 #ifdef HAVE_PRINT
-            case PRINT_EXPR:
+            TARGET(PRINT_EXPR)
                 /* Print interactive expression */
                 /* Fallthrough */
 
-            case PRINT_ITEM:
+            TARGET(PRINT_ITEM)
                 if (gVmGlobal.needSoftSpace && (bc == PRINT_ITEM))
                 {
                     retval = plat_putByte(' ');
@@ -771,11 +928,11 @@ interpret(const uint8_t returnOnNoThreads)
                 PM_SP--;
                 if (bc != PRINT_EXPR)
                 {
-                    continue;
+                    DISPATCH();
                 }
                 /* If PRINT_EXPR, Fallthrough to print a newline */
 
-            case PRINT_NEWLINE:
+            TARGET(PRINT_NEWLINE)
                 gVmGlobal.needSoftSpace = C_FALSE;
                 if (gVmGlobal.somethingPrinted)
                 {
@@ -783,10 +940,10 @@ interpret(const uint8_t returnOnNoThreads)
                     gVmGlobal.somethingPrinted = C_FALSE;
                 }
                 PM_BREAK_IF_ERROR(retval);
-                continue;
+                DISPATCH();
 #endif /* HAVE_PRINT */
 
-            case BREAK_LOOP:
+            TARGET(BREAK_LOOP)
             {
                 pPmBlock_t pb1 = PM_FP->fo_blockstack;
 
@@ -816,15 +973,15 @@ interpret(const uint8_t returnOnNoThreads)
                 retval = heap_freeChunk((pPmObj_t)pb1);
                 PM_BREAK_IF_ERROR(retval);
             }
-                continue;
+                DISPATCH();
 
-            case LOAD_LOCALS:
+            TARGET(LOAD_LOCALS)
                 /* Pushes local attrs dict of current frame */
                 /* WARNING: does not copy fo_locals to attrs */
                 PM_PUSH((pPmObj_t)PM_FP->fo_attrs);
-                continue;
+                DISPATCH();
 
-            case RETURN_VALUE:
+            TARGET(RETURN_VALUE)
                 /* Get expiring frame's TOS */
                 pobj2 = PM_POP();
 
@@ -854,6 +1011,7 @@ interpret(const uint8_t returnOnNoThreads)
                 }
 
                 /* Otherwise return to previous frame */
+                heap_gcFrameBarrier(pobj1);
                 PM_FP = PM_FP->fo_back;
 
 #ifdef HAVE_GENERATORS
@@ -894,10 +1052,10 @@ interpret(const uint8_t returnOnNoThreads)
 
                 /* Deallocate expired frame */
                 PM_BREAK_IF_ERROR(heap_freeChunk(pobj1));
-                continue;
+                DISPATCH();
 
 #ifdef HAVE_IMPORTS
-            case IMPORT_STAR:
+            TARGET(IMPORT_STAR)
                 /* #102: Implement the remaining IMPORT_ bytecodes */
                 /* Expect a module on the top of the stack */
                 C_ASSERT(OBJ_GET_TYPE(TOS) == OBJ_TYPE_MOD);
@@ -907,11 +1065,11 @@ interpret(const uint8_t returnOnNoThreads)
                                      (pPmObj_t)((pPmFunc_t)TOS)->f_attrs);
                 PM_BREAK_IF_ERROR(retval);
                 PM_SP--;
-                continue;
+                DISPATCH();
 #endif /* HAVE_IMPORTS */
 
 #ifdef HAVE_GENERATORS
-            case YIELD_VALUE:
+            TARGET(YIELD_VALUE)
                 /* #207: Add support for the yield keyword */
                 /* Get expiring frame's TOS */
                 pobj1 = PM_POP();
@@ -925,14 +1083,15 @@ interpret(const uint8_t returnOnNoThreads)
                 }
 
                 /* Return to previous frame */
+                heap_gcFrameBarrier((pPmObj_t)PM_FP);
                 PM_FP = PM_FP->fo_back;
 
                 /* Push yield value onto caller's TOS */
                 PM_PUSH(pobj1);
-                continue;
+                DISPATCH();
 #endif /* HAVE_GENERATORS */
 
-            case POP_BLOCK:
+            TARGET(POP_BLOCK)
                 /* Get ptr to top block */
                 pobj1 = (pPmObj_t)PM_FP->fo_blockstack;
 
@@ -947,16 +1106,16 @@ interpret(const uint8_t returnOnNoThreads)
                 PM_IP = ((pPmBlock_t)pobj1)->b_handler;
 
                 PM_BREAK_IF_ERROR(heap_freeChunk(pobj1));
-                continue;
+                DISPATCH();
 
 #ifdef HAVE_CLASSES
-            case BUILD_CLASS:
+            TARGET(BUILD_CLASS)
                 /* Create and push new class */
                 retval = class_new(TOS, TOS1, TOS2, &pobj2);
                 PM_BREAK_IF_ERROR(retval);
                 PM_SP -= 2;
                 TOS = pobj2;
-                continue;
+                DISPATCH();
 #endif /* HAVE_CLASSES */
 
 
@@ -965,7 +1124,7 @@ interpret(const uint8_t returnOnNoThreads)
              * that needs to be swallowed using GET_ARG().
              **************************************************/
 
-            case STORE_NAME:
+            TARGET(STORE_NAME)
                 /* Get name index */
                 t16 = GET_ARG();
 
@@ -976,10 +1135,10 @@ interpret(const uint8_t returnOnNoThreads)
                 retval = dict_setItem((pPmObj_t)PM_FP->fo_attrs, pobj2, TOS);
                 PM_BREAK_IF_ERROR(retval);
                 PM_SP--;
-                continue;
+                DISPATCH();
 
 #ifdef HAVE_DEL
-            case DELETE_NAME:
+            TARGET(DELETE_NAME)
                 /* Get name index */
                 t16 = GET_ARG();
 
@@ -989,10 +1148,10 @@ interpret(const uint8_t returnOnNoThreads)
                 /* Remove key,val pair from current frame's attrs dict */
                 retval = dict_delItem((pPmObj_t)PM_FP->fo_attrs, pobj2);
                 PM_BREAK_IF_ERROR(retval);
-                continue;
+                DISPATCH();
 #endif /* HAVE_DEL */
 
-            case UNPACK_SEQUENCE:
+            TARGET(UNPACK_SEQUENCE)
                 /* Get ptr to sequence */
                 pobj1 = PM_POP();
 
@@ -1038,9 +1197,9 @@ interpret(const uint8_t returnOnNoThreads)
 
                 /* Test again outside the for loop */
                 PM_BREAK_IF_ERROR(retval);
-                continue;
+                DISPATCH();
 
-            case FOR_ITER:
+            TARGET(FOR_ITER)
                 t16 = GET_ARG();
 
 #ifdef HAVE_GENERATORS
@@ -1073,15 +1232,15 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_SP--;
                     retval = PM_RET_OK;
                     PM_IP += t16;
-                    continue;
+                    DISPATCH();
                 }
                 PM_BREAK_IF_ERROR(retval);
 
                 /* Push the next item onto the stack */
                 PM_PUSH(pobj2);
-                continue;
+                DISPATCH();
 
-            case STORE_ATTR:
+            TARGET(STORE_ATTR)
                 /* TOS.name = TOS1 */
                 /* Get names index */
                 t16 = GET_ARG();
@@ -1129,10 +1288,10 @@ interpret(const uint8_t returnOnNoThreads)
                 retval = dict_setItem(pobj2, pobj3, TOS1);
                 PM_BREAK_IF_ERROR(retval);
                 PM_SP -= 2;
-                continue;
+                DISPATCH();
 
 #ifdef HAVE_DEL
-            case DELETE_ATTR:
+            TARGET(DELETE_ATTR)
                 /* del TOS.name */
                 /* Get names index */
                 t16 = GET_ARG();
@@ -1187,10 +1346,10 @@ interpret(const uint8_t returnOnNoThreads)
 
                 PM_BREAK_IF_ERROR(retval);
                 PM_SP--;
-                continue;
+                DISPATCH();
 #endif /* HAVE_DEL */
 
-            case STORE_GLOBAL:
+            TARGET(STORE_GLOBAL)
                 /* Get name index */
                 t16 = GET_ARG();
 
@@ -1201,10 +1360,10 @@ interpret(const uint8_t returnOnNoThreads)
                 retval = dict_setItem((pPmObj_t)PM_FP->fo_globals, pobj2, TOS);
                 PM_BREAK_IF_ERROR(retval);
                 PM_SP--;
-                continue;
+                DISPATCH();
 
 #ifdef HAVE_DEL
-            case DELETE_GLOBAL:
+            TARGET(DELETE_GLOBAL)
                 /* Get name index */
                 t16 = GET_ARG();
 
@@ -1214,10 +1373,10 @@ interpret(const uint8_t returnOnNoThreads)
                 /* Remove key,val from globals */
                 retval = dict_delItem((pPmObj_t)PM_FP->fo_globals, pobj2);
                 PM_BREAK_IF_ERROR(retval);
-                continue;
+                DISPATCH();
 #endif /* HAVE_DEL */
 
-            case DUP_TOPX:
+            TARGET(DUP_TOPX)
                 t16 = GET_ARG();
                 C_ASSERT(t16 <= 3);
 
@@ -1230,17 +1389,17 @@ interpret(const uint8_t returnOnNoThreads)
                     PM_PUSH(pobj2);
                 if (t16 >= 1)
                     PM_PUSH(pobj1);
-                continue;
+                DISPATCH();
 
-            case LOAD_CONST:
+            TARGET(LOAD_CONST)
                 /* Get const's index in CO */
                 t16 = GET_ARG();
 
                 /* Push const on stack */
                 PM_PUSH(PM_FP->fo_func->f_co->co_consts->val[t16]);
-                continue;
+                DISPATCH();
 
-            case LOAD_NAME:
+            TARGET(LOAD_NAME)
                 /* Get name index */
                 t16 = GET_ARG();
 
@@ -1270,9 +1429,9 @@ interpret(const uint8_t returnOnNoThreads)
                 }
                 PM_BREAK_IF_ERROR(retval);
                 PM_PUSH(pobj2);
-                continue;
+                DISPATCH();
 
-            case BUILD_TUPLE:
+            TARGET(BUILD_TUPLE)
                 /* Get num items */
                 t16 = GET_ARG();
                 retval = tuple_new(t16, &pobj1);
@@ -1284,9 +1443,9 @@ interpret(const uint8_t returnOnNoThreads)
                     ((pPmTuple_t)pobj1)->val[t16] = PM_POP();
                 }
                 PM_PUSH(pobj1);
-                continue;
+                DISPATCH();
 
-            case BUILD_LIST:
+            TARGET(BUILD_LIST)
                 t16 = GET_ARG();
                 retval = list_new(&pobj1);
                 PM_BREAK_IF_ERROR(retval);
@@ -1304,17 +1463,17 @@ interpret(const uint8_t returnOnNoThreads)
 
                 /* push list onto stack */
                 PM_PUSH(pobj1);
-                continue;
+                DISPATCH();
 
-            case BUILD_MAP:
+            TARGET(BUILD_MAP)
                 /* Argument is ignored */
                 t16 = GET_ARG();
                 retval = dict_new(&pobj1);
                 PM_BREAK_IF_ERROR(retval);
                 PM_PUSH(pobj1);
-                continue;
+                DISPATCH();
 
-            case LOAD_ATTR:
+            TARGET(LOAD_ATTR)
                 /* Implements TOS.attr */
                 t16 = GET_ARG();
 
@@ -1357,28 +1516,35 @@ interpret(const uint8_t returnOnNoThreads)
                 /* Get name */
                 pobj2 = PM_FP->fo_func->f_co->co_names->val[t16];
 
-                /* Get attr with given name */
-                retval = dict_getItem(pobj1, pobj2, &pobj3);
+                /* Find the attr where this bytecode last found it */
+                pslot = dict_cacheGet(PM_IP, pobj1, pobj2);
+                if (pslot == C_NULL)
+                {
+                    /* Get attr with given name */
+                    retval = dict_getSlot(pobj1, pobj2, &pslot);
 
 #ifdef HAVE_CLASSES
-                /*
-                 * If attr is not found and object is a class or instance,
-                 * try to get the attribute from the class attrs or parent(s)
-                 */
-                if ((retval == PM_RET_EX_KEY) &&
-                    ((OBJ_GET_TYPE(TOS) == OBJ_TYPE_CLO)
-                        || (OBJ_GET_TYPE(TOS) == OBJ_TYPE_CLI)))
-                {
-                    retval = class_getAttr(TOS, pobj2, &pobj3);
-                }
+                    /*
+                     * If attr is not found and object is a class or instance,
+                     * try to get the attribute from the class attrs or parent(s)
+                     */
+                    if ((retval == PM_RET_EX_KEY) &&
+                        ((OBJ_GET_TYPE(TOS) == OBJ_TYPE_CLO)
+                            || (OBJ_GET_TYPE(TOS) == OBJ_TYPE_CLI)))
+                    {
+                        retval = class_getAttrSlot(TOS, pobj2, &pslot);
+                    }
 #endif /* HAVE_CLASSES */
 
-                /* Raise an AttributeError if key is not found */
-                if (retval == PM_RET_EX_KEY)
-                {
-                    PM_RAISE(retval, PM_RET_EX_ATTR);
+                    /* Raise an AttributeError if key is not found */
+                    if (retval == PM_RET_EX_KEY)
+                    {
+                        PM_RAISE(retval, PM_RET_EX_ATTR);
+                    }
+                    PM_BREAK_IF_ERROR(retval);
+                    dict_cachePut(PM_IP, pobj1, pobj2, pslot);
                 }
-                PM_BREAK_IF_ERROR(retval);
+                pobj3 = *pslot;
 
 #ifdef HAVE_CLASSES
                 /* If obj is an instance and attr is a func, create method */
@@ -1393,9 +1559,9 @@ interpret(const uint8_t returnOnNoThreads)
 
                 /* Put attr on the stack */
                 TOS = pobj3;
-                continue;
+                DISPATCH();
 
-            case COMPARE_OP:
+            TARGET(COMPARE_OP)
                 retval = PM_RET_OK;
                 t16 = GET_ARG();
 
@@ -1406,7 +1572,7 @@ interpret(const uint8_t returnOnNoThreads)
                     retval = float_compare(TOS1, TOS, &pobj3, (PmCompare_t)t16);
                     PM_SP--;
                     TOS = pobj3;
-                    continue;
+                    DISPATCH();
                 }
 #endif /* HAVE_FLOAT */
 
@@ -1494,9 +1660,9 @@ interpret(const uint8_t returnOnNoThreads)
                 }
                 PM_SP--;
                 TOS = pobj3;
-                continue;
+                DISPATCH();
 
-            case IMPORT_NAME:
+            TARGET(IMPORT_NAME)
                 /* Get name index */
                 t16 = GET_ARG();
 
@@ -1517,7 +1683,7 @@ interpret(const uint8_t returnOnNoThreads)
                     && (OBJ_GET_TYPE(pobj2) == OBJ_TYPE_MOD))
                 {
                     TOS = pobj2;
-                    continue;
+                    DISPATCH();
                 }
 
                 /* Load module from image */
@@ -1543,11 +1709,12 @@ interpret(const uint8_t returnOnNoThreads)
                 ((pPmFrame_t)pobj3)->fo_isImport = (uint8_t)1;
 
                 /* Set new frame */
+                heap_gcFrameBarrier((pPmObj_t)PM_FP);
                 PM_FP = (pPmFrame_t)pobj3;
-                continue;
+                DISPATCH();
 
 #ifdef HAVE_IMPORTS
-            case IMPORT_FROM:
+            TARGET(IMPORT_FROM)
                 /* #102: Implement the remaining IMPORT_ bytecodes */
                 /* Expect the module on the top of the stack */
                 C_ASSERT(OBJ_GET_TYPE(TOS) == OBJ_TYPE_MOD);
@@ -1564,65 +1731,73 @@ interpret(const uint8_t returnOnNoThreads)
 
                 /* Push the object onto the top of the stack */
                 PM_PUSH(pobj3);
-                continue;
+                DISPATCH();
 #endif /* HAVE_IMPORTS */
 
-            case JUMP_FORWARD:
+            TARGET(JUMP_FORWARD)
                 t16 = GET_ARG();
                 PM_IP += t16;
-                continue;
+                DISPATCH();
 
-            case JUMP_IF_FALSE:
+            TARGET(JUMP_IF_FALSE)
                 t16 = GET_ARG();
                 if (obj_isFalse(TOS))
                 {
                     PM_IP += t16;
                 }
-                continue;
+                DISPATCH();
 
-            case JUMP_IF_TRUE:
+            TARGET(JUMP_IF_TRUE)
                 t16 = GET_ARG();
                 if (!obj_isFalse(TOS))
                 {
                     PM_IP += t16;
                 }
-                continue;
+                DISPATCH();
 
-            case JUMP_ABSOLUTE:
-            case CONTINUE_LOOP:
+            TARGET(JUMP_ABSOLUTE)
+            TARGET(CONTINUE_LOOP)
                 /* Get target offset (bytes) */
                 t16 = GET_ARG();
 
                 /* Jump to base_ip + arg */
                 PM_IP = PM_FP->fo_func->f_co->co_codeaddr + t16;
-                continue;
+                DISPATCH();
 
-            case LOAD_GLOBAL:
+            TARGET(LOAD_GLOBAL)
                 /* Get name */
                 t16 = GET_ARG();
                 pobj1 = PM_FP->fo_func->f_co->co_names->val[t16];
 
-                /* Try globals first */
-                retval = dict_getItem((pPmObj_t)PM_FP->fo_globals,
-                                      pobj1, &pobj2);
-
-                /* If that didn't work, try builtins */
-                if (retval == PM_RET_EX_KEY)
+                /* Find the global where this bytecode last found it */
+                pslot = dict_cacheGet(PM_IP, (pPmObj_t)PM_FP->fo_globals,
+                                      pobj1);
+                if (pslot == C_NULL)
                 {
-                    retval = dict_getItem(PM_PBUILTINS, pobj1, &pobj2);
+                    /* Try globals first */
+                    retval = dict_getSlot((pPmObj_t)PM_FP->fo_globals,
+                                          pobj1, &pslot);
 
-                    /* No such global, raise NameError */
+                    /* If that didn't work, try builtins */
                     if (retval == PM_RET_EX_KEY)
                     {
-                        PM_RAISE(retval, PM_RET_EX_NAME);
-                        break;
+                        retval = dict_getSlot(PM_PBUILTINS, pobj1, &pslot);
+
+                        /* No such global, raise NameError */
+                        if (retval == PM_RET_EX_KEY)
+                        {
+                            PM_RAISE(retval, PM_RET_EX_NAME);
+                            break;
+                        }
                     }
+                    PM_BREAK_IF_ERROR(retval);
+                    dict_cachePut(PM_IP, (pPmObj_t)PM_FP->fo_globals, pobj1,
+                                  pslot);
                 }
-                PM_BREAK_IF_ERROR(retval);
-                PM_PUSH(pobj2);
-                continue;
+                PM_PUSH(*pslot);
+                DISPATCH();
 
-            case SETUP_LOOP:
+            TARGET(SETUP_LOOP)
             {
                 uint8_t *pchunk;
 
@@ -1645,28 +1820,28 @@ interpret(const uint8_t returnOnNoThreads)
                 /* Insert block into blockstack */
                 ((pPmBlock_t)pobj1)->next = PM_FP->fo_blockstack;
                 PM_FP->fo_blockstack = (pPmBlock_t)pobj1;
-                continue;
+                DISPATCH();
             }
 
-            case LOAD_FAST:
+            TARGET(LOAD_FAST)
                 t16 = GET_ARG();
                 PM_PUSH(PM_FP->fo_locals[t16]);
-                continue;
+                DISPATCH();
 
-            case STORE_FAST:
+            TARGET(STORE_FAST)
                 t16 = GET_ARG();
                 PM_FP->fo_locals[t16] = PM_POP();
-                continue;
+                DISPATCH();
 
 #ifdef HAVE_DEL
-            case DELETE_FAST:
+            TARGET(DELETE_FAST)
                 t16 = GET_ARG();
                 PM_FP->fo_locals[t16] = PM_NONE;
-                continue;
+                DISPATCH();
 #endif /* HAVE_DEL */
 
 #ifdef HAVE_ASSERT
-            case RAISE_VARARGS:
+            TARGET(RAISE_VARARGS)
                 t16 = GET_ARG();
 
                 /* Only supports taking 1 arg for now */
@@ -1708,7 +1883,7 @@ interpret(const uint8_t returnOnNoThreads)
                 break;
 #endif /* HAVE_ASSERT */
 
-            case CALL_FUNCTION:
+            TARGET(CALL_FUNCTION)
                 /* Get num args */
                 t16 = GET_ARG();
 
@@ -1807,7 +1982,7 @@ interpret(const uint8_t returnOnNoThreads)
 
                         /* Otherwise, continue with instance */
                         heap_gcPopTempRoot(objid);
-                        continue;
+                        DISPATCH();
                     }
                     else if (retval != PM_RET_OK)
                     {
@@ -1978,6 +2153,7 @@ CALL_FUNC_FOR_ITER:
                     ((pPmFrame_t)pobj2)->fo_back = PM_FP;
 
                     /* Set new frame */
+                    heap_gcFrameBarrier((pPmObj_t)PM_FP);
                     PM_FP = (pPmFrame_t)pobj2;
                 }
 
@@ -1985,6 +2161,16 @@ CALL_FUNC_FOR_ITER:
                 else if (OBJ_GET_TYPE(((pPmFunc_t)pobj1)->f_co) ==
                          OBJ_TYPE_NOB)
                 {
+#ifdef HAVE_GC
+                    /*
+                     * If the heap is low on memory, run the GC.
+                     * Do it while the args are still on the stack;
+                     * the native frame isn't marked until it is active.
+                     */
+                    retval = heap_gcReserve();
+                    PM_GOTO_IF_ERROR(retval, CALL_FUNC_CLEANUP);
+#endif /* HAVE_GC */
+
                     /* Set number of locals (arguments) */
                     gVmGlobal.nativeframe.nf_numlocals = (uint8_t)t16;
 
@@ -1994,15 +2180,6 @@ CALL_FUNC_FOR_ITER:
                         gVmGlobal.nativeframe.nf_locals[t16] = PM_POP();
                     }
 
-#ifdef HAVE_GC
-                    /* If the heap is low on memory, run the GC */
-                    if (heap_getAvail() < HEAP_GC_NF_THRESHOLD)
-                    {
-                        retval = heap_gcRun();
-                        PM_GOTO_IF_ERROR(retval, CALL_FUNC_CLEANUP);
-                    }
-#endif /* HAVE_GC */
-
                     /* Pop the function object */
                     PM_SP--;
 
@@ -2053,6 +2230,8 @@ CALL_FUNC_FOR_ITER:
                     /* If the frame pointer was switched, do nothing to TOS */
                     if (retval == PM_RET_FRAME_SWITCH)
                     {
+                        /* The new frame returns to the one that was left */
+                        heap_gcFrameBarrier((pPmObj_t)PM_FP->fo_back);
                         retval = PM_RET_OK;
                     }
 
@@ -2065,9 +2244,9 @@ CALL_FUNC_FOR_ITER:
 CALL_FUNC_CLEANUP:
                 heap_gcPopTempRoot(objid);
                 PM_BREAK_IF_ERROR(retval);
-                continue;
+                DISPATCH();
 
-            case MAKE_FUNCTION:
+            TARGET(MAKE_FUNCTION)
                 /* Get num default args to fxn */
                 t16 = GET_ARG();
 
@@ -2110,10 +2289,10 @@ CALL_FUNC_CLEANUP:
 
                 /* Push func obj */
                 PM_PUSH(pobj2);
-                continue;
+                DISPATCH();
 
 #ifdef HAVE_CLOSURES
-            case MAKE_CLOSURE:
+            TARGET(MAKE_CLOSURE)
                 /* Get number of default args */
                 t16 = GET_ARG();
                 retval = func_new(TOS, (pPmObj_t)PM_FP->fo_globals, &pobj2);
@@ -2140,10 +2319,10 @@ CALL_FUNC_CLEANUP:
 
                 /* Push new func with closure */
                 PM_PUSH(pobj2);
-                continue;
+                DISPATCH();
 
-            case LOAD_CLOSURE:
-            case LOAD_DEREF:
+            TARGET(LOAD_CLOSURE)
+            TARGET(LOAD_DEREF)
                 /* Loads the i'th cell of free variable storage onto TOS */
                 t16 = GET_ARG();
                 pobj1 = PM_FP->fo_locals[PM_FP->fo_func->f_co->co_nlocals + t16];
@@ -2153,17 +2332,20 @@ CALL_FUNC_CLEANUP:
                     break;
                 }
                 PM_PUSH(pobj1);
-                continue;
+                DISPATCH();
 
-            case STORE_DEREF:
+            TARGET(STORE_DEREF)
                 /* Stores TOS into the i'th cell of free variable storage */
                 t16 = GET_ARG();
                 PM_FP->fo_locals[PM_FP->fo_func->f_co->co_nlocals + t16] = PM_POP();
-                continue;
+                DISPATCH();
 #endif /* HAVE_CLOSURES */
 
 
             default:
+#ifdef INTERP_THREADED_DISPATCH
+            TARGET_default:
+#endif /* INTERP_THREADED_DISPATCH */
                 /* SystemError, unknown or unimplemented opcode */
                 PM_RAISE(retval, PM_RET_EX_SYS);
                 break;
@@ -2183,6 +2365,7 @@ CALL_FUNC_CLEANUP:
                     {
                         /* Resume execution where the block handler says */
                         /* Set PM_FP first, so PM_SP and PM_IP are set in the frame */
+                        heap_gcFrameBarrier((pPmObj_t)PM_FP);
                         PM_FP = (pPmFrame_t)pobj1;
                         PM_SP = ((pPmBlock_t)pobj2)->b_sp;
                         PM_IP = ((pPmBlock_t)pobj2)->b_handler;
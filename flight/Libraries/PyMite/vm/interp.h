@@ -53,8 +53,26 @@
 #define PM_POP()        (*(--PM_SP))
 /** pushes an obj on the stack */
 #define PM_PUSH(pobj)   (*(PM_SP++) = (pobj))
+/** gets the next bytecode from the instruction stream */
+#define GET_BYTECODE()  (MEM_IS_DIRECT(PM_FP->fo_memspace) \
+                         ? *(PM_IP++) \
+                         : mem_getByte(PM_FP->fo_memspace, &PM_IP))
 /** gets the argument (S16) from the instruction stream */
-#define GET_ARG()       mem_getWord(PM_FP->fo_memspace, &PM_IP)
+#define GET_ARG()       (MEM_IS_DIRECT(PM_FP->fo_memspace) \
+                         ? (PM_IP += 2, \
+                            (uint16_t)(PM_IP[-2] | (PM_IP[-1] << 8))) \
+                         : mem_getWord(PM_FP->fo_memspace, &PM_IP))
+
+/**
+ * Threaded dispatch: each bytecode's handler jumps straight to the
+ * handler of the next bytecode through a table of label addresses,
+ * instead of going back around the interpreter loop to the switch.
+ * Needs GCC's labels as values; define PM_SWITCH_DISPATCH to keep
+ * the plain switch.
+ */
+#if defined(__GNUC__) && !defined(PM_SWITCH_DISPATCH)
+#define INTERP_THREADED_DISPATCH
+#endif
 
 /** pushes an obj in the only stack slot of the native frame */
 #define NATIVE_SET_TOS(pobj) (gVmGlobal.nativeframe.nf_stack = \
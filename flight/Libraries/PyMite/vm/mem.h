@@ -43,6 +43,21 @@ typedef enum PmMemSpace_e
 } PmMemSpace_t, *pPmMemSpace_t;
 
 
+/**
+ * True if the memspace can be read through a plain pointer.
+ *
+ * RAM always can.  A platform whose program memory is mapped into
+ * the address space (flash on a Cortex-M, the desktop) defines
+ * PM_PLAT_PROG_DIRECT in plat.h so images in MEMSPACE_PROG
+ * are read directly too, bypassing plat_memGetByte().
+ */
+#ifdef PM_PLAT_PROG_DIRECT
+#define MEM_IS_DIRECT(memspace) ((memspace) <= MEMSPACE_PROG)
+#else
+#define MEM_IS_DIRECT(memspace) ((memspace) == MEMSPACE_RAM)
+#endif /* PM_PLAT_PROG_DIRECT */
+
+
 /**
  * Returns the byte at the given address in memspace.
  *
@@ -221,6 +221,9 @@ typedef enum PmType_e
 
     /** Native frame (there is only one) */
     OBJ_TYPE_NFM = 0x1E,
+
+    /** Hash index of a dict */
+    OBJ_TYPE_DIX = 0x1F,
 } PmType_t, *pPmType_t;
 
 
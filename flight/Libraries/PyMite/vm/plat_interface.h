@@ -68,6 +68,13 @@ PmReturn_t plat_putByte(uint8_t b);
 PmReturn_t plat_getMsTicks(uint32_t *r_ticks);
 
 
+/**
+ * Gets a free running microsecond count, used to time the garbage collector.
+ * It may wrap; only differences between two readings are used.
+ */
+PmReturn_t plat_getUsTicks(uint32_t *r_ticks);
+
+
 /**
  * Reports an exception or other error that caused the thread to quit
  */
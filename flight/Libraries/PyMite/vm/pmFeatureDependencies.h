@@ -46,6 +46,14 @@
  * will occur.
  *
  *
+ * HAVE_INCREMENTAL_GC
+ * -------------------
+ *
+ * When defined, the garbage collector runs incrementally: each allocation
+ * does a small step of marking or sweeping once the heap is getting full,
+ * instead of one collection that stops the interpreter when it is full.
+ *
+ *
  * HAVE_FLOAT
  * ----------
  *
@@ -154,6 +162,11 @@
 
 /* Check for dependencies */
 
+#if defined(HAVE_INCREMENTAL_GC) && !defined(HAVE_GC)
+#error HAVE_INCREMENTAL_GC requires HAVE_GC
+#endif
+
+
 #if defined(HAVE_ASSERT) && !defined(HAVE_CLASSES)
 #error HAVE_ASSERT requires HAVE_CLASSES
 #endif
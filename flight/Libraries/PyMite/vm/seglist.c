@@ -207,6 +207,7 @@ seglist_insertItem(pSeglist_t pseglist, pPmObj_t pobj, int16_t index)
 
         /* Either way, this is now the last segment */
         pseglist->sl_lastseg = pseg;
+        heap_gcWriteBarrier((pPmObj_t)pseg);
     }
 
     /* Walk out to the segment for insertion */
@@ -237,6 +238,7 @@ seglist_insertItem(pSeglist_t pseglist, pPmObj_t pobj, int16_t index)
         }
     }
     pseglist->sl_length++;
+    heap_gcWriteBarrier(pobj);
     return retval;
 }
 
@@ -253,6 +255,9 @@ seglist_new(pSeglist_t *r_pseglist)
     (*r_pseglist)->sl_rootseg = C_NULL;
     (*r_pseglist)->sl_lastseg = C_NULL;
     (*r_pseglist)->sl_length = 0;
+
+    /* It is about to be stored in a list or dict that may be marked */
+    heap_gcWriteBarrier((pPmObj_t)*r_pseglist);
     return retval;
 }
 
@@ -276,6 +281,7 @@ seglist_setItem(pSeglist_t pseglist, pPmObj_t pobj, int16_t index)
 
     /* Set item in this seg at the index */
     pseg->s_val[index % SEGLIST_OBJS_PER_SEG] = pobj;
+    heap_gcWriteBarrier(pobj);
     return PM_RET_OK;
 }
 
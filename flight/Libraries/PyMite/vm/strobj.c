@@ -33,6 +33,26 @@ static pPmString_t pstrcache = C_NULL;
 #endif /* USE_STRING_CACHE */
 
 
+/*
+ * Hashes the chars of a string (32-bit FNV-1a folded to 16 bits).
+ * The hash is kept in the string obj so string_compare() can reject
+ * most unequal strings at once and dicts can index string keys.
+ */
+static uint16_t
+string_hashChars(pPmString_t pstr)
+{
+    uint32_t hash = (uint32_t)2166136261UL;
+    uint16_t i;
+
+    for (i = 0; i < pstr->length; i++)
+    {
+        hash ^= pstr->val[i];
+        hash *= (uint32_t)16777619UL;
+    }
+    return (uint16_t)(hash ^ (hash >> 16));
+}
+
+
 /*
  * If USE_STRING_CACHE is defined nonzero, the string cache
  * will be searched for an existing String object.
@@ -90,6 +110,7 @@ string_create(PmMemSpace_t memspace, uint8_t const **paddr, int16_t len,
     {
         *pdst = 0;
     }
+    pstr->hash = string_hashChars(pstr);
 
 #if USE_STRING_CACHE
     /* Check for twin string in cache */
@@ -136,6 +157,8 @@ string_newFromChar(uint8_t const c, pPmObj_t *r_pstring)
     if (c == '\0')
     {
         ((pPmString_t)*r_pstring)->length = 1;
+        ((pPmString_t)*r_pstring)->hash =
+            string_hashChars((pPmString_t)*r_pstring);
     }
 
     return retval;
@@ -145,8 +168,8 @@ string_newFromChar(uint8_t const c, pPmObj_t *r_pstring)
 int8_t
 string_compare(pPmString_t pstr1, pPmString_t pstr2)
 {
-    /* Return false if lengths are not equal */
-    if (pstr1->length != pstr2->length)
+    /* Return false if lengths or hashes are not equal */
+    if ((pstr1->length != pstr2->length) || (pstr1->hash != pstr2->hash))
     {
         return C_DIFFER;
     }
@@ -289,6 +312,7 @@ string_concat(pPmString_t pstr1, pPmString_t pstr2, pPmObj_t *r_pstring)
     psrc = (uint8_t const *)&(pstr2->val);
     mem_copy(MEMSPACE_RAM, &pdst, &psrc, pstr2->length);
     *pdst = '\0';
+    pstr->hash = string_hashChars(pstr);
 
 #if USE_STRING_CACHE
     /* Check for twin string in cache */
@@ -515,6 +539,7 @@ string_format(pPmString_t pstr, pPmObj_t parg, pPmObj_t *r_pstring)
         }
     }
     pnewstr->val[strindex] = '\0';
+    pnewstr->hash = string_hashChars(pnewstr);
 
 #if USE_STRING_CACHE
     /* Check for twin string in cache */
@@ -93,6 +93,9 @@ typedef struct PmString_s
     struct PmString_s *next;
 #endif                          /* USE_STRING_CACHE */
 
+    /** Hash of the chars, computed once when the string is made */
+    uint16_t hash;
+
     /**
      * Null-term char array
      *
@@ -163,6 +163,46 @@ uint16_t fifoBuf_getDataPeek(t_fifo_buffer *buf, void *data, uint16_t len)
     return i;                   // return number of bytes copied
 }
 
+uint16_t fifoBuf_getDataPeekOffset(t_fifo_buffer *buf, uint16_t offset, void *data, uint16_t len)
+{       // get data from the buffer without removing it, skipping the first 'offset' bytes
+
+    uint16_t rd = buf->rd;
+    uint16_t buf_size = buf->buf_size;
+    uint8_t *buff = buf->buf_ptr;
+
+    // get number of bytes available
+    uint16_t num_bytes = fifoBuf_getUsed(buf);
+
+    if (offset >= num_bytes)
+        return 0;		// return number of bytes copied
+
+    num_bytes -= offset;
+    if (num_bytes > len)
+        num_bytes = len;
+
+    rd += offset;
+    if (rd >= buf_size)
+        rd -= buf_size;
+
+    uint8_t *p = (uint8_t *)data;
+    uint16_t i = 0;
+
+    while (num_bytes > 0)
+    {
+        uint16_t j = buf_size - rd;
+        if (j > num_bytes)
+            j = num_bytes;
+        memcpy(p + i, buff + rd, j);
+        i += j;
+        num_bytes -= j;
+        rd += j;
+        if (rd >= buf_size)
+            rd = 0;
+    }
+
+    return i;                   // return number of bytes copied
+}
+
 uint16_t fifoBuf_getData(t_fifo_buffer *buf, void *data, uint16_t len)
 {       // get data from our rx buffer
 
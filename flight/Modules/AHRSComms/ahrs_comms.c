@@ -101,6 +101,7 @@ static void ahrscommsTask(void *parameters)
 
 	// Main task loop
 	while (1) {
+		LoopMonitorStart(LOOPTIMING_PERIODMEAN_AHRSCOMMS);
 		PIOS_WDG_UpdateFlag(PIOS_WDG_AHRS);
 		
 		AHRSSettingsData settings;
@@ -126,6 +127,8 @@ static void ahrscommsTask(void *parameters)
 		sData.OpInvalidPackets = stat.local.invalidPacket;
 
 		AhrsStatusSet(&sData);
+		LoopMonitorEnd(LOOPTIMING_PERIODMEAN_AHRSCOMMS);
+
 		/* Wait for the next update interval */
 		vTaskDelayUntil(&lastSysTime, settings.UpdatePeriod / portTICK_RATE_MS);
 
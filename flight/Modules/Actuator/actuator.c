@@ -107,6 +107,7 @@ int32_t ActuatorInitialize()
 {
 	// Create object queue
 	queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
+	LoopMonitorAddQueue(EVENTQUEUESTATS_DROPPED_ACTUATOR, queue);
 
 	// Listen for ExampleObject1 updates
 	ActuatorDesiredConnectQueue(queue);
@@ -134,8 +135,7 @@ MODULE_INITCALL(ActuatorInitialize, ActuatorStart)
 static void actuatorTask(void* parameters)
 {
 	UAVObjEvent ev;
-	portTickType lastSysTime;
-	portTickType thisSysTime;
+	uint32_t lastTimestamp;
 	float dT = 0.0f;
 
 	ActuatorCommandData command;
@@ -158,7 +158,7 @@ static void actuatorTask(void* parameters)
 	setFailsafe();
 
 	// Main task loop
-	lastSysTime = xTaskGetTickCount();
+	lastTimestamp = PIOS_DELAY_GetTimeuS();
 	while (1)
 	{		
 		PIOS_WDG_UpdateFlag(PIOS_WDG_ACTUATOR);
@@ -169,12 +169,13 @@ static void actuatorTask(void* parameters)
 			setFailsafe();
 			continue;
 		}
+		LoopMonitorQueueReceived(EVENTQUEUESTATS_DROPPED_ACTUATOR, &ev);
+		LoopMonitorStart(LOOPTIMING_PERIODMEAN_ACTUATOR);
 
-		// Check how long since last update
-		thisSysTime = xTaskGetTickCount();
-		if(thisSysTime > lastSysTime) // reuse dt in case of wraparound
-			dT = (thisSysTime - lastSysTime) / portTICK_RATE_MS / 1000.0f;
-		lastSysTime = thisSysTime;
+		// Check how long since the last ActuatorDesired update, reuse dT if they came together
+		if(ev.timestamp != lastTimestamp)
+			dT = (ev.timestamp - lastTimestamp) * 1e-6f;
+		lastTimestamp = ev.timestamp;
 
 		FlightStatusGet(&flightStatus);
 		MixerStatusGet(&mixerStatus);
@@ -312,6 +313,7 @@ static void actuatorTask(void* parameters)
 			AlarmsSet(SYSTEMALARMS_ALARM_ACTUATOR, SYSTEMALARMS_ALARM_CRITICAL); 
 		}
 
+		LoopMonitorEnd(LOOPTIMING_PERIODMEAN_ACTUATOR);
 	}
 }
 
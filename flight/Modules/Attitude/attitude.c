@@ -64,6 +64,11 @@
 #define UPDATE_RATE  2.0f
 #define GYRO_NEUTRAL 1665
 
+// Gyro samples are produced GYRO_BATCH times per update and decimated by
+// the FIR below.  Set GYRO_FIR_TAPS to 1 to use only the newest sample.
+#define GYRO_BATCH    2
+#define GYRO_FIR_TAPS 4
+
 #define PI_MOD(x) (fmod(x + M_PI, M_PI * 2) - M_PI)
 // Private types
 
@@ -74,9 +79,19 @@ static xTaskHandle taskHandle;
 static void AttitudeTask(void *parameters);
 
 static float gyro_correct_int[3] = {0,0,0};
-static xQueueHandle gyro_queue;
-
-static void updateSensors(AttitudeRawData *);
+static struct pios_adc_fifo gyro_fifo;
+static uint32_t gyro_timestamp;
+
+// Low pass for decimation by GYRO_BATCH, coefficients sum to one
+#if GYRO_FIR_TAPS == 4
+static const float gyro_fir[GYRO_FIR_TAPS] = {0.125f, 0.375f, 0.375f, 0.125f};
+#else
+static const float gyro_fir[GYRO_FIR_TAPS] = {1.0f};
+#endif
+static float gyro_history[GYRO_FIR_TAPS][3];
+static uint8_t gyro_history_pos;
+
+static int32_t updateSensors(AttitudeRawData *);
 static void updateAttitude(AttitudeRawData *);
 static void settingsUpdatedCb(UAVObjEvent * objEv);
 
@@ -134,14 +149,10 @@ int32_t AttitudeInitialize(void)
 		for(uint8_t j = 0; j < 3; j++)
 			R[i][j] = 0;
 
-	// Create queue for passing gyro data, allow 2 back samples in case
-	gyro_queue = xQueueCreate(1, sizeof(float) * 4);
-	if(gyro_queue == NULL)
+	// Gyro samples are collected by the ADC interrupt, the task is woken once per batch
+	if(PIOS_ADC_SetFifo(&gyro_fifo, GYRO_BATCH) < 0)
 		return -1;
 
-
-	PIOS_ADC_SetQueue(gyro_queue);
-
 	AttitudeSettingsConnectCallback(&settingsUpdatedCb);
 
 	return 0;
@@ -157,7 +168,7 @@ static void AttitudeTask(void *parameters)
 	uint8_t init = 0;
 	AlarmsClear(SYSTEMALARMS_ALARM_ATTITUDE);
 
-	PIOS_ADC_Config((PIOS_ADC_RATE / 1000.0f) * UPDATE_RATE);
+	PIOS_ADC_Config((PIOS_ADC_RATE / 1000.0f) * UPDATE_RATE / GYRO_BATCH);
 
 	// Keep flash CS pin high while talking accel
 	PIOS_FLASH_DISABLE;
@@ -197,29 +208,57 @@ static void AttitudeTask(void *parameters)
 
 		AttitudeRawData attitudeRaw;
 		AttitudeRawGet(&attitudeRaw);
-		updateSensors(&attitudeRaw);
+		// Only integrate when new gyro samples arrived
+		if(updateSensors(&attitudeRaw) != 0)
+			continue;
 		updateAttitude(&attitudeRaw);
 		AttitudeRawSet(&attitudeRaw);
+		LoopMonitorEnd(LOOPTIMING_PERIODMEAN_ATTITUDE);
 
 	}
 }
 
-static void updateSensors(AttitudeRawData * attitudeRaw)
+/**
+ * Drain the gyro FIFO and read the accels
+ * \returns 0 on success or -1 if no new gyro sample arrived
+ */
+static int32_t updateSensors(AttitudeRawData * attitudeRaw)
 {
 	struct pios_adxl345_data accel_data;
-	float gyro[4];
+	struct pios_adc_sample samples[GYRO_BATCH];
+	uint16_t n_samples;
+	uint16_t total = 0;
 
 	// Only wait the time for two nominal updates before setting an alarm
-	if(xQueueReceive(gyro_queue, (void * const) gyro, UPDATE_RATE * 2) == errQUEUE_EMPTY) {
+	if(xSemaphoreTake(gyro_fifo.ready, UPDATE_RATE * 2) != pdTRUE) {
 		AlarmsSet(SYSTEMALARMS_ALARM_ATTITUDE, SYSTEMALARMS_ALARM_ERROR);
-		return;
+		return -1;
 	}
+	LoopMonitorStart(LOOPTIMING_PERIODMEAN_ATTITUDE);
+
+	// Drain the FIFO a batch at a time to keep the stack small.  Every sample
+	// goes through the FIR, but only the output after the newest one is used.
+	while((n_samples = PIOS_ADC_FifoRead(&gyro_fifo, samples, GYRO_BATCH)) > 0) {
+		for(uint16_t s = 0; s < n_samples; s++) {
+			// First sample is temperature
+			float * gyro = samples[s].data;
+			gyro_history_pos = (gyro_history_pos + 1) % GYRO_FIR_TAPS;
+			gyro_history[gyro_history_pos][0] = -(gyro[1] - GYRO_NEUTRAL) * gyroGain;
+			gyro_history[gyro_history_pos][1] = (gyro[2] - GYRO_NEUTRAL) * gyroGain;
+			gyro_history[gyro_history_pos][2] = -(gyro[3] - GYRO_NEUTRAL) * gyroGain;
+		}
+		gyro_timestamp = samples[n_samples - 1].timestamp;
+		total += n_samples;
+	}
+	if(total == 0)
+		return -1;
 
-
-	// First sample is temperature
-	attitudeRaw->gyros[ATTITUDERAW_GYROS_X] = -(gyro[1] - GYRO_NEUTRAL) * gyroGain;
-	attitudeRaw->gyros[ATTITUDERAW_GYROS_Y] = (gyro[2] - GYRO_NEUTRAL) * gyroGain;
-	attitudeRaw->gyros[ATTITUDERAW_GYROS_Z] = -(gyro[3] - GYRO_NEUTRAL) * gyroGain;
+	for(uint8_t axis = 0; axis < 3; axis++) {
+		float sum = 0;
+		for(uint8_t tap = 0; tap < GYRO_FIR_TAPS; tap++)
+			sum += gyro_fir[tap] * gyro_history[(gyro_history_pos + GYRO_FIR_TAPS - tap) % GYRO_FIR_TAPS][axis];
+		attitudeRaw->gyros[axis] = sum;
+	}
 
 	int32_t x = 0;
 	int32_t y = 0;
@@ -270,16 +309,22 @@ static void updateSensors(AttitudeRawData * attitudeRaw)
 	// Because most crafts wont get enough information from gravity to zero yaw gyro, we try
 	// and make it average zero (weakly)
 	gyro_correct_int[2] += - attitudeRaw->gyros[ATTITUDERAW_GYROS_Z] * yawBiasRate;
+
+	return 0;
 }
 
 static void updateAttitude(AttitudeRawData * attitudeRaw)
 {
 	float dT;
-	portTickType thisSysTime = xTaskGetTickCount();
-	static portTickType lastSysTime = 0;
-
-	dT = (thisSysTime == lastSysTime) ? 0.001 : (portMAX_DELAY & (thisSysTime - lastSysTime)) / portTICK_RATE_MS / 1000.0f;
-	lastSysTime = thisSysTime;
+	static uint32_t lastTimestamp = 0;
+
+	// Integrate over the time between the gyro samples themselves, fall back to the
+	// nominal rate for the first sample
+	if (lastTimestamp == 0 || gyro_timestamp == lastTimestamp)
+		dT = UPDATE_RATE / 1000.0f;
+	else
+		dT = (gyro_timestamp - lastTimestamp) * 1e-6f;
+	lastTimestamp = gyro_timestamp;
 
 	// Bad practice to assume structure order, but saves memory
 	float gyro[3];
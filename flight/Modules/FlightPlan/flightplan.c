@@ -40,6 +40,9 @@
 #define STACK_SIZE_BYTES 1500
 #define TASK_PRIORITY (tskIDLE_PRIORITY+1)
 #define MAX_QUEUE_SIZE 2
+#ifndef FLIGHTPLAN_MODULE
+#define FLIGHTPLAN_MODULE "test"
+#endif
 
 // Private types
 
@@ -104,6 +107,9 @@ static void flightPlanTask(void *parameters)
 	status.ErrorType = FLIGHTPLANSTATUS_ERRORTYPE_NONE;
 	status.Debug[0] = 0.0;
 	status.Debug[1] = 0.0;
+	status.GCCycles = 0;
+	status.GCFullCollections = 0;
+	status.GCMaxPause = 0;
 	FlightPlanStatusSet(&status);
 
 	// Main thread loop
@@ -124,8 +130,8 @@ static void flightPlanTask(void *parameters)
 				FlightPlanStatusGet(&status);
 				status.Status = FLIGHTPLANSTATUS_STATUS_RUNNING;
 				FlightPlanStatusSet(&status);
-				// Run the test script (TODO: load from SD card)
-				retval = pm_run((uint8_t *)"test");
+				// Run the flight plan script (TODO: load from SD card)
+				retval = pm_run((uint8_t *)FLIGHTPLAN_MODULE);
 				// Check if an error or exception was thrown
 				if (retval == PM_RET_OK || retval == PM_RET_EX_EXIT)
 				{
@@ -220,6 +226,16 @@ static void flightPlanTask(void *parameters)
 				// Get file ID and line number of error (if one)
 				status.ErrorFileID = gVmGlobal.errFileId;
 				status.ErrorLineNum = gVmGlobal.errLineNum;
+#ifdef HAVE_GC
+				// Get the garbage collector statistics of the run
+				{
+					PmGcStats_t stats;
+					heap_gcGetStats(&stats);
+					status.GCCycles = stats.cycles;
+					status.GCFullCollections = stats.fullCollections;
+					status.GCMaxPause = stats.maxPause;
+				}
+#endif
 			}
 			else
 			{
@@ -0,0 +1,93 @@
+#
+# Times the dict lookups behind attribute, global and subscript access
+# in the PyMite VM. Build it in place of the flight plan with
+# "make FLIGHTPLAN=dictbench" for the SITL, or add it to the desktop
+# platform's PM_USR_SOURCES and import it from ipm.
+#
+import sys
+from list import append
+
+LOOPS = 2000
+
+# A class instance with as many attributes as a typical UAVObject
+class Sample:
+	def __init__(self):
+		self.a0 = 0
+		self.a1 = 1
+		self.a2 = 2
+		self.a3 = 3
+		self.a4 = 4
+		self.a5 = 5
+		self.a6 = 6
+		self.a7 = 7
+		self.a8 = 8
+		self.a9 = 9
+		self.a10 = 10
+		self.a11 = 11
+		self.a12 = 12
+		self.a13 = 13
+		self.a14 = 14
+		self.a15 = 15
+		self.a16 = 16
+		self.a17 = 17
+		self.a18 = 18
+		self.a19 = 19
+		self.a20 = 20
+		self.a21 = 21
+		self.a22 = 22
+		self.a23 = 23
+
+def attributes(s):
+	n = 0
+	while n < LOOPS:
+		s.a0 = s.a23 + s.a12
+		s.a23 = s.a0 + s.a5
+		n = n + 1
+
+# Global and builtin names are looked up in the module and builtins dicts
+def globalnames(l):
+	n = 0
+	while n < LOOPS:
+		len(l)
+		abs(LOOPS)
+		n = n + 1
+
+def subscripts(d, keys):
+	n = 0
+	while n < LOOPS:
+		for k in keys:
+			d[k] = d[k] + 1
+		n = n + 8
+
+def report(name, start):
+	print name, sys.time() - start, "ms"
+
+# String keys named like the attributes and small int keys
+strkeys = []
+intkeys = []
+strdict = {}
+intdict = {}
+i = 0
+while i < 64:
+	k = "k" + chr(65 + i / 8) + chr(65 + i % 8)
+	append(strkeys, k)
+	strdict[k] = 0
+	append(intkeys, i * 7)
+	intdict[i * 7] = 0
+	i = i + 1
+
+t = sys.time()
+attributes(Sample())
+report("attribute get/set:", t)
+
+t = sys.time()
+globalnames(strkeys)
+report("global/builtin lookup:", t)
+
+t = sys.time()
+subscripts(strdict, strkeys)
+report("str key get/set:", t)
+
+t = sys.time()
+subscripts(intdict, intkeys)
+report("int key get/set:", t)
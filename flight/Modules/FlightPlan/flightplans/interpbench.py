@@ -0,0 +1,74 @@
+#
+# Times the bytecode dispatch and name lookups of the PyMite interpreter
+# loop. Build it in place of the flight plan with
+# "make FLIGHTPLAN=interpbench" for the SITL, or add it to the desktop
+# platform's PM_USR_SOURCES and import it from ipm.
+#
+import sys
+
+LOOPS = 2000
+NAMES = ["x", "y", "z"]
+
+class Sample:
+	def __init__(self):
+		self.x = 1
+		self.y = 2
+		self.z = 3
+
+	def sum(self):
+		return self.x + self.y + self.z
+
+def add(a, b):
+	return a + b
+
+# Local loads and stores, integer arithmetic and jumps
+def arithmetic():
+	n = 0
+	a = 0
+	while n < LOOPS:
+		a = (a + n * 3) & 0xFFFF
+		a = a ^ (n << 2)
+		n = n + 1
+
+# Function calls and returns
+def calls():
+	n = 0
+	while n < LOOPS:
+		add(n, 1)
+		add(n, 2)
+		n = n + 1
+
+# Attribute loads through an instance to its class
+def attributes(s):
+	n = 0
+	while n < LOOPS:
+		s.x = s.y + s.z
+		s.sum()
+		n = n + 1
+
+# Module globals and builtins
+def globalnames():
+	n = 0
+	while n < LOOPS:
+		abs(LOOPS)
+		len(NAMES)
+		n = n + 1
+
+def report(name, start):
+	print name, sys.time() - start, "ms"
+
+t = sys.time()
+arithmetic()
+report("arithmetic:", t)
+
+t = sys.time()
+calls()
+report("calls:", t)
+
+t = sys.time()
+attributes(Sample())
+report("attributes:", t)
+
+t = sys.time()
+globalnames()
+report("globals:", t)
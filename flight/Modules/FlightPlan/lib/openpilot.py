@@ -29,6 +29,22 @@
 #include "openpilot.h"
 #include "flightplanstatus.h"
 #include "flightplancontrol.h"
+
+// Publish the garbage collector statistics while the script runs
+static void updateGCStats(void)
+{
+#ifdef HAVE_GC
+	FlightPlanStatusData status;
+	PmGcStats_t stats;
+
+	heap_gcGetStats(&stats);
+	FlightPlanStatusGet(&status);
+	status.GCCycles = stats.cycles;
+	status.GCFullCollections = stats.fullCollections;
+	status.GCMaxPause = stats.maxPause;
+	FlightPlanStatusSet(&status);
+#endif
+}
 """
 
 # Delay (suspend VM thread) for timeToDelayMs ms
@@ -58,6 +74,7 @@ def delay(timeToDelayMs):
 	}
 	 
 	// Delay
+	updateGCStats();
 	vTaskDelay(timeToDelayTicks);
  
 	return PM_RET_OK;
@@ -111,6 +128,7 @@ def delayUntil(lastWakeTimeMs, timeToDelayMs):
 	}
 	 
 	// Delay
+	updateGCStats();
 	vTaskDelayUntil(&lastWakeTimeTicks, timeToDelayTicks);
 
   // Return an int object with the time value */
@@ -36,6 +36,84 @@
 #define TYPE_FLOAT32 6
 #define TYPE_ENUM 7
 
+// Gets the n'th argument of a native as an int
+static PmReturn_t getIntArg(uint8_t n, int32_t *val)
+{
+	pPmObj_t pobj;
+	PmReturn_t retval = PM_RET_OK;
+
+	pobj = NATIVE_GET_LOCAL(n);
+	if ( OBJ_GET_TYPE(pobj) != OBJ_TYPE_INT )
+	{
+		PM_RAISE(retval, PM_RET_EX_TYPE);
+		return retval;
+	}
+	*val = ((pPmInt_t) pobj)->val;
+	return retval;
+}
+
+// Gets the arguments getFieldValue() and setFieldValue() share,
+// (objId, instId, offset, ftype, numElements, index), and works out
+// where the element is in the object data
+static PmReturn_t getFieldArgs(UAVObjHandle *objHandle, uint16_t *instId, uint32_t *offset, uint32_t *type, uint32_t *size)
+{
+	PmReturn_t retval;
+	int32_t objId;
+	int32_t inst;
+	int32_t fieldOffset;
+	int32_t fieldType;
+	int32_t numElements;
+	int32_t index;
+
+	retval = getIntArg(0, &objId); PM_RETURN_IF_ERROR(retval);
+	retval = getIntArg(1, &inst); PM_RETURN_IF_ERROR(retval);
+	retval = getIntArg(2, &fieldOffset); PM_RETURN_IF_ERROR(retval);
+	retval = getIntArg(3, &fieldType); PM_RETURN_IF_ERROR(retval);
+	retval = getIntArg(4, &numElements); PM_RETURN_IF_ERROR(retval);
+	retval = getIntArg(5, &index); PM_RETURN_IF_ERROR(retval);
+
+	// Get handle
+	*objHandle = UAVObjGetByID((uint32_t)objId);
+	if (*objHandle == NULL)
+	{
+		PM_RAISE(retval, PM_RET_EX_VAL);
+		return retval;
+	}
+	*instId = (uint16_t)inst;
+
+	// Get element size
+	switch (fieldType)
+	{
+		case TYPE_INT8:
+		case TYPE_UINT8:
+		case TYPE_ENUM:
+			*size = 1;
+			break;
+		case TYPE_INT16:
+		case TYPE_UINT16:
+			*size = 2;
+			break;
+		case TYPE_INT32:
+		case TYPE_UINT32:
+		case TYPE_FLOAT32:
+			*size = 4;
+			break;
+		default:
+			PM_RAISE(retval, PM_RET_EX_VAL);
+			return retval;
+	}
+	*type = (uint32_t)fieldType;
+
+	// Keep to the elements of the field
+	if (index < 0 || index >= numElements)
+	{
+		PM_RAISE(retval, PM_RET_EX_INDX);
+		return retval;
+	}
+	*offset = (uint32_t)fieldOffset + (uint32_t)index * *size;
+	return retval;
+}
+
 """
 
 from list import append
@@ -100,6 +178,141 @@ class UAVObjectField:
 				for n in range(0, numElements):
 					append(self.value, 0)
 		  
+# Returns one element of a field, read straight from the object data.
+# Called by the generated field getters, which pass the field's offset in
+# the object data, its type and number of elements.
+def getFieldValue(objId, instId, offset, ftype, numElements, index):
+	"""__NATIVE__
+	UAVObjHandle objHandle;
+	uint16_t instId;
+	uint32_t offset;
+	uint32_t type;
+	uint32_t size;
+	pPmObj_t value;
+	PmReturn_t retval;
+	union {
+		int8_t i8;
+		uint8_t u8;
+		int16_t i16;
+		uint16_t u16;
+		int32_t i32;
+		uint32_t u32;
+		float f;
+	} data;
+
+	// Check number of arguments
+	if (NATIVE_GET_NUM_ARGS() != 6)
+	{
+		PM_RAISE(retval, PM_RET_EX_TYPE);
+		return retval;
+	}
+	retval = getFieldArgs(&objHandle, &instId, &offset, &type, &size); PM_RETURN_IF_ERROR(retval);
+
+	// Read the element only
+	if (UAVObjGetInstanceDataField(objHandle, instId, &data, offset, size) < 0)
+	{
+		PM_RAISE(retval, PM_RET_EX_INDX);
+		return retval;
+	}
+
+	// Create return object
+	switch (type)
+	{
+		case TYPE_INT8:
+			retval = int_new(data.i8, &value);
+			break;
+		case TYPE_UINT8:
+		case TYPE_ENUM:
+			retval = int_new(data.u8, &value);
+			break;
+		case TYPE_INT16:
+			retval = int_new(data.i16, &value);
+			break;
+		case TYPE_UINT16:
+			retval = int_new(data.u16, &value);
+			break;
+		case TYPE_INT32:
+		case TYPE_UINT32:
+			retval = int_new(data.i32, &value);
+			break;
+		default:
+			retval = float_new(data.f, &value);
+			break;
+	}
+	PM_RETURN_IF_ERROR(retval);
+	NATIVE_SET_TOS(value);
+	return retval;
+	"""
+	pass
+
+# Writes one element of a field straight into the object data,
+# the counterpart of getFieldValue()
+def setFieldValue(objId, instId, offset, ftype, numElements, index, value):
+	"""__NATIVE__
+	UAVObjHandle objHandle;
+	uint16_t instId;
+	uint32_t offset;
+	uint32_t type;
+	uint32_t size;
+	pPmObj_t value;
+	PmReturn_t retval;
+	int32_t intValue;
+	union {
+		int8_t i8;
+		int16_t i16;
+		int32_t i32;
+		float f;
+	} data;
+
+	// Check number of arguments
+	if (NATIVE_GET_NUM_ARGS() != 7)
+	{
+		PM_RAISE(retval, PM_RET_EX_TYPE);
+		return retval;
+	}
+	retval = getFieldArgs(&objHandle, &instId, &offset, &type, &size); PM_RETURN_IF_ERROR(retval);
+
+	// Convert the value to the field type
+	value = NATIVE_GET_LOCAL(6);
+	if ( OBJ_GET_TYPE(value) == OBJ_TYPE_INT )
+	{
+		intValue = ((pPmInt_t)value)->val;
+		data.f = (float)((pPmInt_t)value)->val;
+	}
+	else if ( OBJ_GET_TYPE(value) == OBJ_TYPE_FLT )
+	{
+		intValue = (int32_t)((pPmFloat_t)value)->val;
+		data.f = ((pPmFloat_t)value)->val;
+	}
+	else
+	{
+		PM_RAISE(retval, PM_RET_EX_TYPE);
+		return retval;
+	}
+	switch (size)
+	{
+		case 1:
+			data.i8 = (int8_t)intValue;
+			break;
+		case 2:
+			data.i16 = (int16_t)intValue;
+			break;
+		default:
+			if (type != TYPE_FLOAT32)
+				data.i32 = intValue;
+			break;
+	}
+
+	// Write the element only
+	if (UAVObjSetInstanceDataField(objHandle, instId, &data, offset, size) < 0)
+	{
+		PM_RAISE(retval, PM_RET_EX_INDX);
+		return retval;
+	}
+	return PM_RET_OK;
+	"""
+	pass
+
 class UAVObject:
 	def __init__(self, objId):
 		self.metadata = UAVObjectMetadata(objId)
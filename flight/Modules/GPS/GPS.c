@@ -39,6 +39,10 @@
 	#include "GTOP_BIN.h"
 #endif
 
+#ifdef ENABLE_GPS_BINARY_UBX
+	#include "UBX.h"
+#endif
+
 #if defined(ENABLE_GPS_ONESENTENCE_GTOP) || defined(ENABLE_GPS_NMEA)
 	#include "NMEA.h"
 #endif
@@ -66,6 +70,11 @@ static float GravityAccel(float latitude, float longitude, float altitude);
 //#define DISABLE_GPS_THRESHOLD          //
 
 #define GPS_TIMEOUT_MS                  500
+#ifdef ENABLE_GPS_BINARY_UBX
+	#define GPS_POLL_MS                 10      // UBX frames have no delimiter to wake us up, poll at the frame rate
+#else
+	#define GPS_POLL_MS                 100     // how often to check the gps when it's not sending anything
+#endif
 #define GPS_COMMAND_RESEND_TIMEOUT_MS   2000
 
 #ifdef PIOS_GPS_SETS_HOMELOCATION
@@ -92,9 +101,8 @@ static uint32_t gpsPort;
 
 static xTaskHandle gpsTaskHandle;
 
-#ifndef ENABLE_GPS_BINARY_GTOP
-	static char gps_rx_buffer[128];
-#endif
+static xSemaphoreHandle gpsRxReady;
+static uint8_t gps_rx_span[32];
 
 static uint32_t timeOfLastCommandMs;
 static uint32_t timeOfLastUpdateMs;
@@ -127,6 +135,14 @@ int32_t GPSInitialize(void)
 	// TODO: Get gps settings object
 	gpsPort = PIOS_COM_GPS;
 
+	// Given by the COM driver at the end of each sentence, so they are
+	// parsed as soon as they arrive. Drivers that can't do it leave us polling.
+	vSemaphoreCreateBinary(gpsRxReady);
+	if (gpsRxReady == NULL)
+		return -1;
+	xSemaphoreTake(gpsRxReady, 0);
+	PIOS_COM_ReceiveNotify(gpsPort, '\n', gpsRxReady);
+
 	return 0;
 }
 MODULE_INITCALL(GPSInitialize, GPSStart)
@@ -138,17 +154,15 @@ MODULE_INITCALL(GPSInitialize, GPSStart)
 
 static void gpsTask(void *parameters)
 {
-	portTickType xDelay = 100 / portTICK_RATE_MS;
+	portTickType xDelay = GPS_POLL_MS / portTICK_RATE_MS;
 	uint32_t timeNowMs = xTaskGetTickCount() * portTICK_RATE_MS;;
 	GPSPositionData GpsData;
+	int32_t len;
 	
-#ifdef ENABLE_GPS_BINARY_GTOP
+#if defined(ENABLE_GPS_BINARY_GTOP)
 	GTOP_BIN_init();
-#else
-	uint8_t rx_count = 0;
-	bool start_flag = false;
-	bool found_cr = false;
-	int32_t gpsRxOverflow = 0;
+#elif defined(ENABLE_GPS_BINARY_UBX)
+	UBX_init(gpsPort);
 #endif
 	
 #ifdef FULL_COLD_RESTART
@@ -194,94 +208,57 @@ static void gpsTask(void *parameters)
 		#ifdef ENABLE_GPS_BINARY_GTOP
 			// GTOP BINARY GPS mode
 
-			while (PIOS_COM_ReceiveBufferUsed(gpsPort) > 0)
+			while ((len = PIOS_COM_ReceiveBufferMore(gpsPort, gps_rx_span, sizeof(gps_rx_span))) > 0)
 			{
-				int res = GTOP_BIN_update_position(PIOS_COM_ReceiveBuffer(gpsPort), &numChecksumErrors, &numParsingErrors);
-				if (res >= 0)
+				for (int32_t i = 0; i < len; i++)
 				{
-					numUpdates++;
+					int res = GTOP_BIN_update_position(gps_rx_span[i], &numChecksumErrors, &numParsingErrors);
+					if (res >= 0)
+					{
+						numUpdates++;
 
-					timeNowMs = xTaskGetTickCount() * portTICK_RATE_MS;
-					timeOfLastUpdateMs = timeNowMs;
-					timeOfLastCommandMs = timeNowMs;
+						timeNowMs = xTaskGetTickCount() * portTICK_RATE_MS;
+						timeOfLastUpdateMs = timeNowMs;
+						timeOfLastCommandMs = timeNowMs;
+					}
 				}
 			}
 
-		#else
-			// NMEA or SINGLE-SENTENCE GPS mode
+		#elif defined(ENABLE_GPS_BINARY_UBX)
+			// u-blox UBX BINARY GPS mode
 
-			// This blocks the task until there is something on the buffer
-			while (PIOS_COM_ReceiveBufferUsed(gpsPort) > 0)
+			while ((len = PIOS_COM_ReceiveBufferMore(gpsPort, gps_rx_span, sizeof(gps_rx_span))) > 0)
 			{
-				char c = PIOS_COM_ReceiveBuffer(gpsPort);
-			
-				// detect start while acquiring stream
-				if (!start_flag && (c == '$'))
-				{
-					start_flag = true;
-					found_cr = false;
-					rx_count = 0;
-				}
-				else
-				if (!start_flag)
-					continue;
-			
-				if (rx_count >= sizeof(gps_rx_buffer))
+				for (int32_t i = 0; i < len; i++)
 				{
-					// The buffer is already full and we haven't found a valid NMEA sentence.
-					// Flush the buffer and note the overflow event.
-					gpsRxOverflow++;
-					start_flag = false;
-					found_cr = false;
-					rx_count = 0;
-				}
-				else
-				{
-					gps_rx_buffer[rx_count] = c;
-					rx_count++;
+					int res = UBX_update_position(gps_rx_span[i], &numChecksumErrors, &numParsingErrors);
+					if (res >= 0)
+					{	// any valid frame tells us the GPS is talking UBX
+						if (res == 0)
+							numUpdates++;
+
+						timeNowMs = xTaskGetTickCount() * portTICK_RATE_MS;
+						timeOfLastUpdateMs = timeNowMs;
+						timeOfLastCommandMs = timeNowMs;
+					}
 				}
-			
-				// look for ending '\r\n' sequence
-				if (!found_cr && (c == '\r') )
-					found_cr = true;
-				else
-				if (found_cr && (c != '\n') )
-					found_cr = false;  // false end flag
-				else
-				if (found_cr && (c == '\n') )
+			}
+
+			// send the next configuration message, or resend one that was not acked
+			UBX_config_update(xTaskGetTickCount() * portTICK_RATE_MS);
+
+		#else
+			// NMEA or SINGLE-SENTENCE GPS mode
+
+			while ((len = PIOS_COM_ReceiveBufferMore(gpsPort, gps_rx_span, sizeof(gps_rx_span))) > 0)
+			{
+				for (int32_t i = 0; i < len; i++)
 				{
-					// The NMEA functions require a zero-terminated string
-					// As we detected \r\n, the string as for sure 2 bytes long, we will also strip the \r\n
-					gps_rx_buffer[rx_count-2] = 0;
-
-					// prepare to parse next sentence
-					start_flag = false;
-					found_cr = false;
-					rx_count = 0;
-					// Our rxBuffer must look like this now:
-					//   [0]           = '$'
-					//   ...           = zero or more bytes of sentence payload
-					//   [end_pos - 1] = '\r'
-					//   [end_pos]     = '\n'
-					//
-					// Prepare to consume the sentence from the buffer
-				
-					// Validate the checksum over the sentence
-					if (!NMEA_checksum(&gps_rx_buffer[1]))
-					{	// Invalid checksum.  May indicate dropped characters on Rx.
-						//PIOS_DEBUG_PinHigh(2);
-						++numChecksumErrors;
-						//PIOS_DEBUG_PinLow(2);
-					}
-					else
-					{	// Valid checksum, use this packet to update the GPS position
-						if (!NMEA_update_position(&gps_rx_buffer[1])) {
-							//PIOS_DEBUG_PinHigh(2);
-							++numParsingErrors;
-							//PIOS_DEBUG_PinLow(2);
-						}
-						else
-							++numUpdates;
+					int res = NMEA_update_position(gps_rx_span[i], &numChecksumErrors, &numParsingErrors);
+					if (res >= 0)
+					{	// any sentence with a valid checksum tells us the GPS is talking
+						if (res == 0)
+							numUpdates++;
 
 						timeNowMs = xTaskGetTickCount() * portTICK_RATE_MS;
 						timeOfLastUpdateMs = timeNowMs;
@@ -312,6 +289,11 @@ static void gpsTask(void *parameters)
 					PIOS_COM_SendStringNonBlocking(gpsPort,"$PGCMD,21,1*6F\r\n");
 				#endif
 
+				#ifdef ENABLE_GPS_BINARY_UBX
+					// start the configuration over, the receiver may have been power cycled
+					UBX_init(gpsPort);
+				#endif
+
 				#ifdef ENABLE_GPS_ONESENTENCE_GTOP
 					// switch to single sentence mode
 					PIOS_COM_SendStringNonBlocking(gpsPort,"$PGCMD,21,2*6C\r\n");
@@ -351,8 +333,9 @@ static void gpsTask(void *parameters)
 				AlarmsSet(SYSTEMALARMS_ALARM_GPS, SYSTEMALARMS_ALARM_CRITICAL);
 		}
 
-		// Block task until next update
-		vTaskDelay(xDelay);
+		// Block task until the next sentence arrives, or poll if the COM
+		// driver can't tell us
+		xSemaphoreTake(gpsRxReady, xDelay);
 	}
 }
 
@@ -61,6 +61,8 @@
 #endif
 
 #define MAX_NB_PARAMS 20
+#define NMEA_MAX_SENTENCE_LEN 128	///< longer sentences are taken as a framing error
+
 /* NMEA sentence parsers */
 
 struct nmea_parser {
@@ -80,210 +82,348 @@ struct nmea_parser {
 
 	static bool nmeaProcessPGTOP(GPSPositionData * GpsData, bool* gpsDataUpdated, char* param[], uint8_t nbParam);
 
-	static struct nmea_parser nmea_parsers[] = {
+	enum {
+	#ifdef ENABLE_GPS_NMEA
+		NMEA_PARSER_GGA,
+		NMEA_PARSER_VTG,
+		NMEA_PARSER_GSA,
+		NMEA_PARSER_RMC,
+		NMEA_PARSER_ZDA,
+		NMEA_PARSER_GSV,
+	#endif
+		NMEA_PARSER_PGTOP,
+		NMEA_NB_PARSERS
+	};
+
+	static struct nmea_parser nmea_parsers[NMEA_NB_PARSERS] = {
 
 	#ifdef ENABLE_GPS_NMEA
-		{
+		[NMEA_PARSER_GGA] = {
 			.prefix = "GPGGA",
 			.handler = nmeaProcessGPGGA,
 			.cnt = 0,
 		},
-		{
+		[NMEA_PARSER_VTG] = {
 			.prefix = "GPVTG",
 			.handler = nmeaProcessGPVTG,
 			.cnt = 0,
 		},
-		{
+		[NMEA_PARSER_GSA] = {
 			.prefix = "GPGSA",
 			.handler = nmeaProcessGPGSA,
 			.cnt = 0,
 		},
-		{
+		[NMEA_PARSER_RMC] = {
 			.prefix = "GPRMC",
 			.handler = nmeaProcessGPRMC,
 			.cnt = 0,
 		},
-		{
+		[NMEA_PARSER_ZDA] = {
 			.prefix = "GPZDA",
 			.handler = nmeaProcessGPZDA,
 			.cnt = 0,
 		},
-		{
+		[NMEA_PARSER_GSV] = {
 			.prefix = "GPGSV",
 			.handler = nmeaProcessGPGSV,
 			.cnt = 0,
 		},
 	#endif
-        {
+        [NMEA_PARSER_PGTOP] = {
          .prefix = "PGTOP",
          .handler = nmeaProcessPGTOP,
          .cnt = 0,
          },
 };
 
-static struct nmea_parser *NMEA_find_parser_by_prefix(const char *prefix)
+/* The 2 char talker and 3 char sentence identifiers, packed to switch on */
+#define NMEA_TALKER(a, b)			(((uint16_t)(a) << 8) | (uint8_t)(b))
+#define NMEA_SENTENCE(a, b, c)		(((uint32_t)(uint8_t)(a) << 16) | ((uint16_t)(uint8_t)(b) << 8) | (uint8_t)(c))
+
+/**
+ * Finds the parser for a sentence from its 5 char address field, such as
+ * "GPGGA". The position and time are taken from the GPS (GP) or combined
+ * multi-constellation (GN) talkers; satellites from GPS only, as each
+ * constellation sends its own set of GSV sentences.
+ * \param[in] The zero-terminated address field
+ * \return the parser or NULL if the sentence isn't decoded
+ */
+static struct nmea_parser *NMEA_find_parser(const char *address)
 {
-	if (!prefix) {
+	if (address[0] == 0 || address[1] == 0 || address[2] == 0 ||
+		address[3] == 0 || address[4] == 0 || address[5] != 0) {
 		return (NULL);
 	}
 
-	for (uint8_t i = 0; i < NELEMENTS(nmea_parsers); i++) {
-		struct nmea_parser *parser = &nmea_parsers[i];
+	uint16_t talker = NMEA_TALKER(address[0], address[1]);
+	uint32_t sentence = NMEA_SENTENCE(address[2], address[3], address[4]);
 
-		/* Use strcmp to check for exact equality over the entire prefix */
-		if (!strcmp(prefix, parser->prefix)) {
-			/* Found an appropriate parser */
-			return (parser);
+	switch (talker) {
+#ifdef ENABLE_GPS_NMEA
+	case NMEA_TALKER('G', 'P'):
+		if (sentence == NMEA_SENTENCE('G', 'S', 'V'))
+			return (&nmea_parsers[NMEA_PARSER_GSV]);
+		/* fall through */
+	case NMEA_TALKER('G', 'N'):
+		switch (sentence) {
+		case NMEA_SENTENCE('G', 'G', 'A'):
+			return (&nmea_parsers[NMEA_PARSER_GGA]);
+		case NMEA_SENTENCE('V', 'T', 'G'):
+			return (&nmea_parsers[NMEA_PARSER_VTG]);
+		case NMEA_SENTENCE('G', 'S', 'A'):
+			return (&nmea_parsers[NMEA_PARSER_GSA]);
+		case NMEA_SENTENCE('R', 'M', 'C'):
+			return (&nmea_parsers[NMEA_PARSER_RMC]);
+		case NMEA_SENTENCE('Z', 'D', 'A'):
+			return (&nmea_parsers[NMEA_PARSER_ZDA]);
 		}
+		break;
+#endif
+	case NMEA_TALKER('P', 'G'):
+		if (sentence == NMEA_SENTENCE('T', 'O', 'P'))
+			return (&nmea_parsers[NMEA_PARSER_PGTOP]);
+		break;
 	}
 
-	/* No matching parser for this prefix */
+	/* No parser for this sentence */
 	return (NULL);
 }
 
+/* Sentence tokenizer, fed one byte at a time */
+
+enum {
+	NMEA_STATE_START = 0,	///< waiting for the '$'
+	NMEA_STATE_SENTENCE,	///< the sentence up to the '*'
+	NMEA_STATE_CHECKSUM1,
+	NMEA_STATE_CHECKSUM2,
+	NMEA_STATE_END,			///< the closing "\r\n"
+};
+
+struct nmea_tokenizer {
+	uint8_t state;
+	uint8_t count;
+	uint8_t checksum;
+	uint8_t checksum_received;
+	uint8_t nbParam;
+	char *param[MAX_NB_PARAMS];
+	char buffer[NMEA_MAX_SENTENCE_LEN];
+};
+
+static struct nmea_tokenizer nmea_tokenizer;
+
+static int8_t NMEA_hex_digit(uint8_t b)
+{
+	if (b >= '0' && b <= '9')
+		return b - '0';
+	if (b >= 'A' && b <= 'F')
+		return b - 'A' + 10;
+	if (b >= 'a' && b <= 'f')
+		return b - 'a' + 10;
+	return -1;
+}
+
 /**
- * Computes NMEA sentence checksum
- * \param[in] Buffer for parsed nmea sentence
- * \return false checksum not valid
- * \return true checksum valid
+ * Feeds a received byte to the tokenizer. The checksum is computed and the
+ * sentence split into its zero-terminated parameters as the bytes arrive,
+ * so a complete sentence is ready to be handed to its parser.
+ * \return 1 when a complete sentence with a valid checksum is in the tokenizer
+ * \return 0 while the sentence is not complete
+ * \return -1 on a framing error
+ * \return -2 on a checksum error
  */
-bool NMEA_checksum(char *nmea_sentence)
+static int NMEA_tokenize_byte(struct nmea_tokenizer *t, uint8_t b)
 {
-	uint8_t checksum_computed = 0;
-	uint8_t checksum_received;
-
-	while (*nmea_sentence != '\0' && *nmea_sentence != '*') {
-		checksum_computed ^= *nmea_sentence;
-		nmea_sentence++;
+	if (b == '$') {
+		/* Start of a sentence, even if the last one was cut short */
+		int res = (t->state == NMEA_STATE_START) ? 0 : -1;
+		t->state = NMEA_STATE_SENTENCE;
+		t->count = 0;
+		t->checksum = 0;
+		t->nbParam = 1;
+		t->param[0] = t->buffer;
+		return res;
 	}
 
-	/* Make sure we're now pointing at the checksum */
-	if (*nmea_sentence == '\0') {
-		/* Buffer ran out before we found a checksum marker */
-		return false;
-	}
+	switch (t->state) {
+	case NMEA_STATE_START:
+		return 0;
 
-	/* Load the checksum from the buffer */
-	checksum_received = strtol(nmea_sentence + 1, NULL, 16);
+	case NMEA_STATE_SENTENCE:
+		if (b == '\r' || b == '\n') {
+			/* Line ended before we found a checksum marker */
+			t->state = NMEA_STATE_START;
+			return -2;
+		}
 
-	//PIOS_COM_SendFormattedStringNonBlocking(COM_DEBUG_USART,"$%d=%d\r\n",checksum_received,checksum_computed);
+		if (t->count >= NMEA_MAX_SENTENCE_LEN - 1) {
+			/* Too long to be a sentence, look for the next one */
+			t->state = NMEA_STATE_START;
+			return -1;
+		}
 
-	return (checksum_computed == checksum_received);
+		if (b == '*') {
+			/* After the * comes the checksum, zero-terminate the last parameter */
+			t->buffer[t->count++] = 0;
+			t->state = NMEA_STATE_CHECKSUM1;
+			return 0;
+		}
+
+		t->checksum ^= b;
+		if (b == ',' && t->nbParam < MAX_NB_PARAMS) {
+			/* Zero-terminate this parameter and start a new one */
+			t->buffer[t->count++] = 0;
+			t->param[t->nbParam++] = &t->buffer[t->count];
+		} else {
+			t->buffer[t->count++] = b;
+		}
+		return 0;
+
+	case NMEA_STATE_CHECKSUM1:
+	case NMEA_STATE_CHECKSUM2:
+	{
+		int8_t digit = NMEA_hex_digit(b);
+		if (digit < 0) {
+			t->state = NMEA_STATE_START;
+			return -2;
+		}
+		if (t->state == NMEA_STATE_CHECKSUM1) {
+			t->checksum_received = digit << 4;
+			t->state = NMEA_STATE_CHECKSUM2;
+		}
+		else {
+			t->checksum_received |= digit;
+			t->state = NMEA_STATE_END;
+		}
+		return 0;
+	}
+
+	case NMEA_STATE_END:
+		if (b == '\r')
+			return 0;
+		t->state = NMEA_STATE_START;
+		if (b != '\n')
+			return -2;
+		return (t->checksum == t->checksum_received) ? 1 : -2;
+
+	default:
+		t->state = NMEA_STATE_START;
+		return 0;
+	}
 }
 
 /*
- * This function only exists to deal with a linking
+ * These functions only exist to deal with a linking
  * failure in the stdlib function strtof().  This
  * implementation does not rely on the _sbrk() syscall
- * like strtof() does.
+ * like strtof() does, and works in fixed-point.
  */
 
+static const uint32_t nmea_pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000 };
+
 /* Parse a number encoded in a string of the format:
- *   [-]NN.nnnnn
- * into a signed whole part and an unsigned fractional part.
- * The fract_units field indicates the units of the fractional part as
+ *   [-]NN[.nnnnn]
+ * into an unsigned whole part and an unsigned fractional part.
+ * fract_units gives the most fractional digits to keep, the rest are
+ * truncated, and returns the number kept
  *   1 whole = 10^fract_units fract
+ * \return true if the number is negative
  */
-static bool NMEA_parse_real(int32_t * whole, uint32_t * fract, uint8_t * fract_units, char *field)
+static bool NMEA_parse_real(uint32_t * whole, uint32_t * fract, uint8_t * fract_units, const char *field)
 {
-	char *s = field;
-	char *field_w;
-	char *field_f;
+	bool negative = false;
+	uint8_t max_units = *fract_units;
 
 	PIOS_DEBUG_Assert(whole);
 	PIOS_DEBUG_Assert(fract);
 	PIOS_DEBUG_Assert(fract_units);
 
-	field_w = strsep(&s, ".");
-	field_f = s;
+	if (*field == '-') {
+		negative = true;
+		field++;
+	}
 
-	*whole = strtol(field_w, NULL, 10);
+	for (*whole = 0; *field >= '0' && *field <= '9'; field++)
+		*whole = *whole * 10 + (*field - '0');
 
-	if (field_w) {
+	*fract = 0;
+	*fract_units = 0;
+	if (*field == '.') {
 		/* decimal was found so we may have a fractional part */
-		*fract = strtoul(field_f, NULL, 10);
-		*fract_units = strlen(field_f);
-	} else {
-		/* no decimal was found, fractional part is zero */
-		*fract = 0;
-		*fract_units = 0;
+		for (field++; *field >= '0' && *field <= '9' && *fract_units < max_units; field++) {
+			*fract = *fract * 10 + (*field - '0');
+			(*fract_units)++;
+		}
 	}
 
-	return true;
+	return negative;
 }
 
-static float NMEA_real_to_float(char *nmea_real)
+/* Converts a real into a fixed-point integer in units of 10^-fract_units */
+static int32_t NMEA_real_to_fixed(const char *nmea_real, uint8_t fract_units)
 {
-	int32_t whole;
+	uint32_t whole;
 	uint32_t fract;
-	uint8_t fract_units;
+	uint8_t units = fract_units;
+	uint32_t value;
 
 	/* Sanity checks */
 	PIOS_DEBUG_Assert(nmea_real);
+	PIOS_DEBUG_Assert(fract_units < NELEMENTS(nmea_pow10));
 
-	if (!NMEA_parse_real(&whole, &fract, &fract_units, nmea_real)) {
-		return false;
-	}
+	bool negative = NMEA_parse_real(&whole, &fract, &units, nmea_real);
+	value = whole * nmea_pow10[fract_units] + fract * nmea_pow10[fract_units - units];
+
+	return (int32_t)(negative ? 0 - value : value);
+}
+
+static int32_t NMEA_parse_int(const char *nmea_int)
+{
+	return NMEA_real_to_fixed(nmea_int, 0);
+}
+
+static float NMEA_real_to_float(const char *nmea_real)
+{
+	uint32_t whole;
+	uint32_t fract;
+	uint8_t fract_units = 6;	/* as many digits as a float holds */
+	float value;
+
+	/* Sanity checks */
+	PIOS_DEBUG_Assert(nmea_real);
+
+	bool negative = NMEA_parse_real(&whole, &fract, &fract_units, nmea_real);
 
 	/* Convert to float */
-	return (((float)whole) + fract * pow(10, -fract_units));
+	value = (float)whole + (float)fract / nmea_pow10[fract_units];
+	return negative ? -value : value;
 }
 
 #ifdef ENABLE_GPS_NMEA
 /*
  * Parse a field in the format:
- *    DD[D]MM.mmmm[mm]
+ *    DD[D]MM.mmmm[mmm]
  * into a fixed-point representation in units of (degrees * 1e-7)
  */
 static bool NMEA_latlon_to_fixed_point(int32_t * latlon, char *nmea_latlon, bool negative)
 {
-	int32_t num_DDDMM;
+	uint32_t num_DDDMM;
 	uint32_t num_m;
-	uint8_t units;
+	uint8_t units = 7;
+	uint32_t value;
 
 	/* Sanity checks */
 	PIOS_DEBUG_Assert(nmea_latlon);
 	PIOS_DEBUG_Assert(latlon);
 
-	if (!NMEA_parse_real(&num_DDDMM, &num_m, &units, nmea_latlon)) {
-		return false;
-	}
+	NMEA_parse_real(&num_DDDMM, &num_m, &units, nmea_latlon);
 
-	/* scale up the mmmm[mm] field apropriately depending on # of digits */
-	switch (units) {
-	case 0:
-		/* no digits, value is zero so no scaling */
-		break;
-	case 1:		/* m       */
-		num_m *= 1e6;	/* m000000 */
-		break;
-	case 2:		/* mm      */
-		num_m *= 1e5;	/* mm00000 */
-		break;
-	case 3:		/* mmm     */
-		num_m *= 1e4;	/* mmm0000 */
-		break;
-	case 4:		/* mmmm    */
-		num_m *= 1e3;	/* mmmm000 */
-		break;
-	case 5:		/* mmmmm   */
-		num_m *= 1e2;	/* mmmmm00 */
-		break;
-	case 6:		/* mmmmmm  */
-		num_m *= 1e1;	/* mmmmmm0 */
-		break;
-	default:
-		/* unhandled format */
-		num_m = 0;
-		break;
-	}
+	/* scale up the mmmm[mmm] field to units of 1e-7 minutes depending on # of digits */
+	num_m *= nmea_pow10[7 - units];
 
-	*latlon = (num_DDDMM / 100) * 1e7;	/* scale the whole degrees */
-	*latlon += (num_DDDMM % 100) * 1e7 / 60;	/* add in the scaled decimal whole minutes */
-	*latlon += num_m / 60;	/* add in the scaled decimal fractional minutes */
+	value = (num_DDDMM / 100) * 10000000;	/* scale the whole degrees */
+	value += ((num_DDDMM % 100) * 10000000 + num_m) / 60;	/* add in the scaled minutes */
 
-	if (negative)
-		*latlon *= -1;
+	*latlon = (int32_t)(negative ? 0 - value : value);
 
 	return true;
 }
@@ -291,74 +431,59 @@ static bool NMEA_latlon_to_fixed_point(int32_t * latlon, char *nmea_latlon, bool
 
 
 /**
- * Parses a complete NMEA sentence and updates the GPSPosition UAVObject
- * \param[in] An NMEA sentence with a valid checksum
- * \return true if the sentence was successfully parsed
- * \return false if any errors were encountered with the parsing
+ * Parses the NMEA stream and updates the GPSPosition UAVObject
+ * \param[in] b = a new received byte from the GPS
+ * \return 0 if a sentence was successfully parsed
+ * \return 1 if we have found a valid sentence we don't decode
+ * \return <0 if any errors were encountered with the sentence or no complete sentence found
  */
-bool NMEA_update_position(char *nmea_sentence)
+int NMEA_update_position(uint8_t b, volatile uint32_t *chksum_errors, volatile uint32_t *parsing_errors)
 {
-	char* p = nmea_sentence;
-	char* params[MAX_NB_PARAMS];
-	uint8_t nbParams;
+	struct nmea_tokenizer *t = &nmea_tokenizer;
 
-#ifdef DEBUG_MSG_IN
-	DEBUG_MSG("\"%s\"\n", nmea_sentence);
-#endif
+	int res = NMEA_tokenize_byte(t, b);
+	if (res == 0)
+		return -1;	// sentence not yet complete
 
-	// Split the nmea sentence it its parameters, separated by ","
-	// Sample NMEA message: "GPRMC,000131.736,V,,,,,0.00,0.00,060180,,,N*43"
-
-	// The first parameter starts at the beginning of the message
-	params[0] = p;
-	nbParams = 1;
-	while (*p != 0) {
-		if (*p == '*') {
-			// After the * comes the "CRC", we are done,
-			*p = 0;		// Zero-terminate this parameter
-			break;
-		} else if (*p == ',') {
-			// This is the end of this parameter
-			*p = 0;		// Zero-terminate this parameter
-			// Start new parameter
-			if (nbParams==MAX_NB_PARAMS)
-				break;
-			params[nbParams] = p+1;	// For sure there is something at p+1 because at p there is ","
-			nbParams++;
+	if (res < 0) {
+		if (res == -2) {
+			if (chksum_errors) (*chksum_errors)++;
+		} else {
+			if (parsing_errors) (*parsing_errors)++;
 		}
-		p++;
+		return res;
 	}
 
-
 #ifdef DEBUG_PARAMS
 	int i;
-	for (i=0;i<nbParams; i++) {
-		DEBUG_MSG(" %d \"%s\"\n", i, params[i]);
+	for (i=0;i<t->nbParam; i++) {
+		DEBUG_MSG(" %d \"%s\"\n", i, t->param[i]);
 	}
 #endif
 
 	// The first parameter is the message name, lets see if we find a parser for it
 	struct nmea_parser *parser;
-	parser = NMEA_find_parser_by_prefix(params[0]);
+	parser = NMEA_find_parser(t->param[0]);
 	if (!parser) {
 		// No parser found
-		DEBUG_MSG(" NO PARSER (\"%s\")\n", params[0]);
-		return false;
+		DEBUG_MSG(" NO PARSER (\"%s\")\n", t->param[0]);
+		return 1;
 	}
 
 	parser->cnt++;
 	#ifdef DEBUG_MGSID_IN
-		DEBUG_MSG("%s %d ", params[0], parser->cnt);
+		DEBUG_MSG("%s %d ", t->param[0], parser->cnt);
 	#endif
 	// Send the message to then parser and get it update the GpsData
 	GPSPositionData GpsData;
 	GPSPositionGet(&GpsData);
 	bool gpsDataUpdated;
 
-	if (!parser->handler(&GpsData, &gpsDataUpdated, params, nbParams)) {
+	if (!parser->handler(&GpsData, &gpsDataUpdated, t->param, t->nbParam)) {
 		// Parse failed
-		DEBUG_MSG("PARSE FAILED (\"%s\")\n", params[0]);
-		return false;
+		DEBUG_MSG("PARSE FAILED (\"%s\")\n", t->param[0]);
+		if (parsing_errors) (*parsing_errors)++;
+		return -3;
 	}
 
 
@@ -373,7 +498,7 @@ bool NMEA_update_position(char *nmea_sentence)
 	#ifdef DEBUG_MGSID_IN
 		DEBUG_MSG("\n");
 	#endif
-	return true;
+	return 0;
 }
 
 #ifdef ENABLE_GPS_NMEA
@@ -413,7 +538,7 @@ static bool nmeaProcessGPGGA(GPSPositionData * GpsData, bool* gpsDataUpdated, ch
 	}
 
 	// get number of satellites used in GPS solution
-	GpsData->Satellites = atoi(param[7]);
+	GpsData->Satellites = NMEA_parse_int(param[7]);
 
 	// get altitude (in meters mm.m)
 	GpsData->Altitude = NMEA_real_to_float(param[9]);
@@ -449,10 +574,10 @@ static bool nmeaProcessGPRMC(GPSPositionData * GpsData, bool* gpsDataUpdated, ch
 	GPSTimeGet(&gpst);
 
 	// get UTC time [hhmmss.sss]
-	float hms = NMEA_real_to_float(param[1]);
-	gpst.Second = (int)hms % 100;
-	gpst.Minute = (((int)hms - gpst.Second) / 100) % 100;
-	gpst.Hour = (int)hms / 10000;
+	int32_t hms = NMEA_parse_int(param[1]);
+	gpst.Second = hms % 100;
+	gpst.Minute = ((hms - gpst.Second) / 100) % 100;
+	gpst.Hour = hms / 10000;
 
 	// get latitude [DDMM.mmmmm] [N|S]
 	if (!NMEA_latlon_to_fixed_point(&GpsData->Latitude, param[3], param[4][0] == 'S')) {
@@ -471,11 +596,10 @@ static bool nmeaProcessGPRMC(GPSPositionData * GpsData, bool* gpsDataUpdated, ch
 	GpsData->Heading = NMEA_real_to_float(param[8]);
 
 	// get Date of fix
-	// TODO: Should really not use a float here to be safe
-	float date = NMEA_real_to_float(param[9]);
-	gpst.Year = (int)date % 100;
-	gpst.Month = (((int)date - gpst.Year) / 100) % 100;
-	gpst.Day = (int)(date / 10000);
+	int32_t date = NMEA_parse_int(param[9]);
+	gpst.Year = date % 100;
+	gpst.Month = ((date - gpst.Year) / 100) % 100;
+	gpst.Day = date / 10000;
 	gpst.Year += 2000;
 	GPSTimeSet(&gpst);
 
@@ -527,15 +651,15 @@ static bool nmeaProcessGPZDA(GPSPositionData * GpsData, bool* gpsDataUpdated, ch
 	GPSTimeGet(&gpst);
 
 	// get UTC time [hhmmss.sss]
-	float hms = NMEA_real_to_float(param[1]);
-	gpst.Second = (int)hms % 100;
-	gpst.Minute = (((int)hms - gpst.Second) / 100) % 100;
-	gpst.Hour = (int)hms / 10000;
+	int32_t hms = NMEA_parse_int(param[1]);
+	gpst.Second = hms % 100;
+	gpst.Minute = ((hms - gpst.Second) / 100) % 100;
+	gpst.Hour = hms / 10000;
 
 	// Get Date
-	gpst.Day = atoi(param[2]);
-	gpst.Month = atoi(param[3]);
-	gpst.Year = atoi(param[4]);
+	gpst.Day = NMEA_parse_int(param[2]);
+	gpst.Month = NMEA_parse_int(param[3]);
+	gpst.Year = NMEA_parse_int(param[4]);
 
 	GPSTimeSet(&gpst);
 	return true;
@@ -559,15 +683,15 @@ static bool nmeaProcessGPGSV(GPSPositionData * GpsData, bool* gpsDataUpdated, ch
 	DEBUG_MSG(" Sats=%s\n", param[3]);
 #endif
 
-	uint8_t nbSentences = atoi(param[1]);
-	uint8_t currSentence = atoi(param[2]);
+	uint8_t nbSentences = NMEA_parse_int(param[1]);
+	uint8_t currSentence = NMEA_parse_int(param[2]);
 
 	*gpsDataUpdated = true;
 
 	if (nbSentences < 1 || nbSentences > 8 || currSentence < 1 || currSentence > nbSentences)
 		return false;
 
-	gsv_partial.SatsInView = atoi(param[3]);
+	gsv_partial.SatsInView = NMEA_parse_int(param[3]);
 
 	// Find out if this is the first sentence in the GSV set
 	if (currSentence == 1) {
@@ -602,10 +726,10 @@ static bool nmeaProcessGPGSV(GPSPositionData * GpsData, bool* gpsDataUpdated, ch
 			uint8_t sat_index = ((currSentence - 1) * 4) + i;
 
 			// Get sat info
-			gsv_partial.PRN[sat_index] = atoi(param[parIdx++]);
+			gsv_partial.PRN[sat_index] = NMEA_parse_int(param[parIdx++]);
 			gsv_partial.Elevation[sat_index] = NMEA_real_to_float(param[parIdx++]);
 			gsv_partial.Azimuth[sat_index] = NMEA_real_to_float(param[parIdx++]);
-			gsv_partial.SNR[sat_index] = atoi(param[parIdx++]);
+			gsv_partial.SNR[sat_index] = NMEA_parse_int(param[parIdx++]);
 #ifdef NMEA_DEBUG_GSV
 			DEBUG_MSG(" %d", gsv_partial.PRN[sat_index]);
 #endif
@@ -647,7 +771,7 @@ static bool nmeaProcessGPGSA(GPSPositionData * GpsData, bool* gpsDataUpdated, ch
 
 	*gpsDataUpdated = true;
 
-	switch (atoi(param[2])) {
+	switch (NMEA_parse_int(param[2])) {
 	case 1:
 		GpsData->Status = GPSPOSITION_STATUS_NOFIX;
 		break;
@@ -693,24 +817,24 @@ static bool nmeaProcessPGTOP(GPSPositionData * GpsData, bool* gpsDataUpdated, ch
 	*gpsDataUpdated = true;
 
 	// get UTC time [hhmmss.sss]
-	float hms = NMEA_real_to_float(param[1]);
-	gpst.Second = (int)hms % 100;
-	gpst.Minute = (((int)hms - gpst.Second) / 100) % 100;
-	gpst.Hour = (int)hms / 10000;
+	int32_t hms = NMEA_parse_int(param[1]);
+	gpst.Second = hms % 100;
+	gpst.Minute = ((hms - gpst.Second) / 100) % 100;
+	gpst.Hour = hms / 10000;
 
 	// get latitude decimal degrees
-	GpsData->Latitude = NMEA_real_to_float(param[2])*1e7;
+	GpsData->Latitude = NMEA_real_to_fixed(param[2], 7);
 	if (param[3][0] == 'S')
 		GpsData->Latitude = -GpsData->Latitude;
 
 
 	// get longitude decimal degrees
-	GpsData->Longitude = NMEA_real_to_float(param[4])*1e7;
+	GpsData->Longitude = NMEA_real_to_fixed(param[4], 7);
 	if (param[5][0] == 'W')
 		GpsData->Longitude = -GpsData->Longitude;
 
 	// get number of satellites used in GPS solution
-	GpsData->Satellites = atoi(param[7]);
+	GpsData->Satellites = NMEA_parse_int(param[7]);
 
 	// next field: HDOP
 	GpsData->HDOP = NMEA_real_to_float(param[8]);
@@ -722,7 +846,7 @@ static bool nmeaProcessPGTOP(GPSPositionData * GpsData, bool* gpsDataUpdated, ch
 	GpsData->GeoidSeparation = NMEA_real_to_float(param[10]);
 
 	// Mode: 1=Fix not available, 2=2D, 3=3D
-	switch (atoi(param[11])) {
+	switch (NMEA_parse_int(param[11])) {
 	case 1:
 			GpsData->Status = GPSPOSITION_STATUS_NOFIX;
 			break;
@@ -746,9 +870,9 @@ static bool nmeaProcessPGTOP(GPSPositionData * GpsData, bool* gpsDataUpdated, ch
 	// to m/s
 	GpsData->Groundspeed /= 3.6;
 
-	gpst.Day = atoi(param[14]);
-	gpst.Month = atoi(param[15]);
-	gpst.Year = atoi(param[16]);
+	gpst.Day = NMEA_parse_int(param[14]);
+	gpst.Month = NMEA_parse_int(param[15]);
+	gpst.Year = NMEA_parse_int(param[16]);
 	GPSTimeSet(&gpst);
 
 	return true;
@@ -0,0 +1,653 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotModules OpenPilot Modules
+ * @{
+ * @addtogroup GSPModule GPS Module
+ * @brief Process GPS information
+ * @{
+ *
+ * @file       UBX.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      GPS module, handles the u-blox UBX binary protocol
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "openpilot.h"
+#include "pios.h"
+#include "UBX.h"
+#include "gpsposition.h"
+#include "gpstime.h"
+
+#include <string.h>
+
+#ifdef ENABLE_GPS_BINARY_UBX
+
+// ************
+// frame and message identifiers
+
+#define UBX_SYNC1                   0xB5
+#define UBX_SYNC2                   0x62
+
+#define UBX_CLASS_NAV               0x01
+#define UBX_CLASS_ACK               0x05
+#define UBX_CLASS_CFG               0x06
+#define UBX_CLASS_NMEA              0xF0
+
+#define UBX_ID_NAV_POSLLH           0x02
+#define UBX_ID_NAV_SOL              0x06
+#define UBX_ID_NAV_PVT              0x07
+#define UBX_ID_NAV_VELNED           0x12
+#define UBX_ID_NAV_TIMEUTC          0x21
+#define UBX_ID_ACK_NAK              0x00
+#define UBX_ID_ACK_ACK              0x01
+#define UBX_ID_CFG_MSG              0x01
+#define UBX_ID_CFG_RATE             0x08
+
+#define UBX_MAX_FRAME_LEN           1024    // longer frames are taken as a framing error
+#define UBX_MEAS_RATE_MS            100     // 10Hz navigation solutions
+#define UBX_CONFIG_TIMEOUT_MS       500     // resend a configuration message if it has not been acked by then
+
+// ************
+// the message payloads we decode, UBX is little endian just like us
+
+typedef struct
+{
+	uint32_t  iTOW;         // ms
+	uint16_t  year;
+	uint8_t   month;
+	uint8_t   day;
+	uint8_t   hour;
+	uint8_t   min;
+	uint8_t   sec;
+	uint8_t   valid;        // bit 0 = valid date, bit 1 = valid time
+	uint32_t  tAcc;         // ns
+	int32_t   nano;         // ns
+	uint8_t   fixType;      // 0 = none, 1 = dead reckoning, 2 = 2D, 3 = 3D, 4 = GNSS + dead reckoning, 5 = time only
+	uint8_t   flags;        // bit 0 = gnssFixOK
+	uint8_t   flags2;
+	uint8_t   numSV;
+	int32_t   lon;          // degrees x 10^-7
+	int32_t   lat;          // degrees x 10^-7
+	int32_t   height;       // mm above the ellipsoid
+	int32_t   hMSL;         // mm above mean sea level
+	uint32_t  hAcc;         // mm
+	uint32_t  vAcc;         // mm
+	int32_t   velN;         // mm/s
+	int32_t   velE;         // mm/s
+	int32_t   velD;         // mm/s
+	int32_t   gSpeed;       // mm/s
+	int32_t   headMot;      // degrees x 10^-5
+	uint32_t  sAcc;         // mm/s
+	uint32_t  headAcc;      // degrees x 10^-5
+	uint16_t  pDOP;         // x 0.01
+	uint8_t   reserved1[6];
+}  __attribute__((__packed__)) t_ubx_nav_pvt;    // the first 84 bytes, newer firmware appends more
+
+typedef struct
+{
+	uint32_t  iTOW;         // ms
+	int32_t   fTOW;         // ns
+	int16_t   week;
+	uint8_t   gpsFix;       // 0 = none, 1 = dead reckoning, 2 = 2D, 3 = 3D, 4 = GPS + dead reckoning, 5 = time only
+	uint8_t   flags;        // bit 0 = gpsFixOK
+	int32_t   ecefX;        // cm
+	int32_t   ecefY;        // cm
+	int32_t   ecefZ;        // cm
+	uint32_t  pAcc;         // cm
+	int32_t   ecefVX;       // cm/s
+	int32_t   ecefVY;       // cm/s
+	int32_t   ecefVZ;       // cm/s
+	uint32_t  sAcc;         // cm/s
+	uint16_t  pDOP;         // x 0.01
+	uint8_t   reserved1;
+	uint8_t   numSV;
+	uint32_t  reserved2;
+}  __attribute__((__packed__)) t_ubx_nav_sol;
+
+typedef struct
+{
+	uint32_t  iTOW;         // ms
+	int32_t   lon;          // degrees x 10^-7
+	int32_t   lat;          // degrees x 10^-7
+	int32_t   height;       // mm above the ellipsoid
+	int32_t   hMSL;         // mm above mean sea level
+	uint32_t  hAcc;         // mm
+	uint32_t  vAcc;         // mm
+}  __attribute__((__packed__)) t_ubx_nav_posllh;
+
+typedef struct
+{
+	uint32_t  iTOW;         // ms
+	int32_t   velN;         // cm/s
+	int32_t   velE;         // cm/s
+	int32_t   velD;         // cm/s
+	uint32_t  speed;        // cm/s
+	uint32_t  gSpeed;       // cm/s
+	int32_t   heading;      // degrees x 10^-5
+	uint32_t  sAcc;         // cm/s
+	uint32_t  cAcc;         // degrees x 10^-5
+}  __attribute__((__packed__)) t_ubx_nav_velned;
+
+typedef struct
+{
+	uint32_t  iTOW;         // ms
+	uint32_t  tAcc;         // ns
+	int32_t   nano;         // ns
+	uint16_t  year;
+	uint8_t   month;
+	uint8_t   day;
+	uint8_t   hour;
+	uint8_t   min;
+	uint8_t   sec;
+	uint8_t   valid;        // bit 0 = valid time of week, bit 1 = valid week number, bit 2 = valid UTC
+}  __attribute__((__packed__)) t_ubx_nav_timeutc;
+
+typedef struct
+{
+	uint8_t   clsID;        // class of the acked message
+	uint8_t   msgID;        // id of the acked message
+}  __attribute__((__packed__)) t_ubx_ack;
+
+typedef union
+{
+	uint8_t           bytes[96];
+	t_ubx_nav_pvt     nav_pvt;
+	t_ubx_nav_sol     nav_sol;
+	t_ubx_nav_posllh  nav_posllh;
+	t_ubx_nav_velned  nav_velned;
+	t_ubx_nav_timeutc nav_timeutc;
+	t_ubx_ack         ack;
+} t_ubx_payload;
+
+// ************
+// frame parser, fed one byte at a time
+
+enum
+{
+	UBX_STATE_SYNC1 = 0,
+	UBX_STATE_SYNC2,
+	UBX_STATE_CLASS,
+	UBX_STATE_ID,
+	UBX_STATE_LEN1,
+	UBX_STATE_LEN2,
+	UBX_STATE_PAYLOAD,
+	UBX_STATE_CK_A,
+	UBX_STATE_CK_B
+};
+
+typedef struct
+{
+	uint8_t       state;
+	uint8_t       msg_class;
+	uint8_t       msg_id;
+	uint16_t      len;
+	uint16_t      count;
+	uint8_t       ck_a;
+	uint8_t       ck_b;
+	t_ubx_payload payload  __attribute__ ((aligned(4)));
+} t_ubx_parser;
+
+static t_ubx_parser ubx_parser;
+
+// ************
+// receivers without NAV-PVT (u-blox 6 and older) send the solution in
+// several messages, they are merged until all of the same epoch are in
+
+#define UBX_HAVE_SOL                0x01
+#define UBX_HAVE_POSLLH             0x02
+#define UBX_HAVE_VELNED             0x04
+#define UBX_HAVE_ALL                (UBX_HAVE_SOL | UBX_HAVE_POSLLH | UBX_HAVE_VELNED)
+
+static GPSPositionData ubx_position;
+static uint32_t ubx_position_iTOW;
+static uint8_t ubx_position_have;
+
+// ************
+// configuration handshake, each message is sent in turn and has to be acked
+// before the next one goes out
+//
+// an ACK only names the class and id of the acked message, so all the CFG-MSG
+// steps get the same one. Answers are only taken between sending a step and
+// its answer, a late or duplicate one arriving after the step moved on but
+// before the next message went out must not ack that message unsent.
+
+enum
+{
+	UBX_CFG_ALWAYS = 0,
+	UBX_CFG_PVT,                // only when the receiver supports NAV-PVT
+	UBX_CFG_LEGACY              // only when it does not
+};
+
+typedef struct
+{
+	uint8_t   msg_class;
+	uint8_t   msg_id;
+	uint8_t   len;
+	uint8_t   payload[6];
+	uint8_t   when;
+} t_ubx_cfg;
+
+static const t_ubx_cfg ubx_cfg[] =
+{
+	// measurement rate, one navigation solution per measurement, aligned to GPS time
+	{UBX_CLASS_CFG, UBX_ID_CFG_RATE, 6, {UBX_MEAS_RATE_MS & 0xff, UBX_MEAS_RATE_MS >> 8, 1, 0, 1, 0}, UBX_CFG_ALWAYS},
+
+	// the solution every epoch, a NAK on NAV-PVT switches to the older messages
+	{UBX_CLASS_CFG, UBX_ID_CFG_MSG, 3, {UBX_CLASS_NAV, UBX_ID_NAV_PVT, 1}, UBX_CFG_PVT},
+	{UBX_CLASS_CFG, UBX_ID_CFG_MSG, 3, {UBX_CLASS_NAV, UBX_ID_NAV_SOL, 1}, UBX_CFG_LEGACY},
+	{UBX_CLASS_CFG, UBX_ID_CFG_MSG, 3, {UBX_CLASS_NAV, UBX_ID_NAV_POSLLH, 1}, UBX_CFG_LEGACY},
+	{UBX_CLASS_CFG, UBX_ID_CFG_MSG, 3, {UBX_CLASS_NAV, UBX_ID_NAV_VELNED, 1}, UBX_CFG_LEGACY},
+	{UBX_CLASS_CFG, UBX_ID_CFG_MSG, 3, {UBX_CLASS_NAV, UBX_ID_NAV_TIMEUTC, 10}, UBX_CFG_LEGACY},
+
+	// NMEA output would not fit next to it at 10Hz
+	{UBX_CLASS_CFG, UBX_ID_CFG_MSG, 3, {UBX_CLASS_NMEA, 0x00, 0}, UBX_CFG_ALWAYS},    // GGA
+	{UBX_CLASS_CFG, UBX_ID_CFG_MSG, 3, {UBX_CLASS_NMEA, 0x01, 0}, UBX_CFG_ALWAYS},    // GLL
+	{UBX_CLASS_CFG, UBX_ID_CFG_MSG, 3, {UBX_CLASS_NMEA, 0x02, 0}, UBX_CFG_ALWAYS},    // GSA
+	{UBX_CLASS_CFG, UBX_ID_CFG_MSG, 3, {UBX_CLASS_NMEA, 0x03, 0}, UBX_CFG_ALWAYS},    // GSV
+	{UBX_CLASS_CFG, UBX_ID_CFG_MSG, 3, {UBX_CLASS_NMEA, 0x04, 0}, UBX_CFG_ALWAYS},    // RMC
+	{UBX_CLASS_CFG, UBX_ID_CFG_MSG, 3, {UBX_CLASS_NMEA, 0x05, 0}, UBX_CFG_ALWAYS},    // VTG
+};
+
+#define UBX_CFG_COUNT               (sizeof(ubx_cfg) / sizeof(ubx_cfg[0]))
+
+static uint32_t ubx_port;
+static uint8_t ubx_cfg_step;        // the configuration message waiting for its ack
+static bool ubx_cfg_legacy;         // TRUE if the receiver has no NAV-PVT
+static bool ubx_cfg_send;           // TRUE if the current step has to be sent
+static uint32_t ubx_cfg_sent_ms;
+
+// ************
+
+static void ubx_checksum(uint8_t *ck_a, uint8_t *ck_b, uint8_t b)
+{
+	*ck_a += b;
+	*ck_b += *ck_a;
+}
+
+/**
+ * Feed a received byte to the frame parser
+ *
+ * return 1 when a complete frame with a valid checksum is in the parser
+ * return 0 while the frame is not complete
+ * return <0 on a checksum or framing error
+ */
+static int ubx_parse_byte(t_ubx_parser *p, uint8_t b)
+{
+	switch (p->state)
+	{
+		case UBX_STATE_SYNC1:
+			if (b == UBX_SYNC1)
+				p->state = UBX_STATE_SYNC2;
+			return 0;
+
+		case UBX_STATE_SYNC2:
+			if (b == UBX_SYNC2)
+				p->state = UBX_STATE_CLASS;
+			else
+			if (b != UBX_SYNC1)
+				p->state = UBX_STATE_SYNC1;
+			return 0;
+
+		case UBX_STATE_CLASS:
+			p->msg_class = b;
+			p->ck_a = 0;
+			p->ck_b = 0;
+			ubx_checksum(&p->ck_a, &p->ck_b, b);
+			p->state = UBX_STATE_ID;
+			return 0;
+
+		case UBX_STATE_ID:
+			p->msg_id = b;
+			ubx_checksum(&p->ck_a, &p->ck_b, b);
+			p->state = UBX_STATE_LEN1;
+			return 0;
+
+		case UBX_STATE_LEN1:
+			p->len = b;
+			ubx_checksum(&p->ck_a, &p->ck_b, b);
+			p->state = UBX_STATE_LEN2;
+			return 0;
+
+		case UBX_STATE_LEN2:
+			p->len |= (uint16_t)b << 8;
+			ubx_checksum(&p->ck_a, &p->ck_b, b);
+			if (p->len > UBX_MAX_FRAME_LEN)
+			{	// can't be a real frame, look for the next one
+				p->state = UBX_STATE_SYNC1;
+				return -1;
+			}
+			p->count = 0;
+			p->state = (p->len > 0) ? UBX_STATE_PAYLOAD : UBX_STATE_CK_A;
+			return 0;
+
+		case UBX_STATE_PAYLOAD:
+			// messages we don't decode may be longer than the buffer, they are checksummed but not kept
+			if (p->count < sizeof(p->payload))
+				p->payload.bytes[p->count] = b;
+			ubx_checksum(&p->ck_a, &p->ck_b, b);
+			if (++p->count >= p->len)
+				p->state = UBX_STATE_CK_A;
+			return 0;
+
+		case UBX_STATE_CK_A:
+			if (b != p->ck_a)
+			{
+				p->state = UBX_STATE_SYNC1;
+				return -2;
+			}
+			p->state = UBX_STATE_CK_B;
+			return 0;
+
+		case UBX_STATE_CK_B:
+			p->state = UBX_STATE_SYNC1;
+			return (b == p->ck_b) ? 1 : -2;
+
+		default:
+			p->state = UBX_STATE_SYNC1;
+			return 0;
+	}
+}
+
+// ************
+// send a frame to the receiver
+
+static void ubx_send(uint8_t msg_class, uint8_t msg_id, const uint8_t *payload, uint8_t len)
+{
+	uint8_t frame[6 + sizeof(ubx_cfg[0].payload) + 2];
+	uint8_t ck_a = 0;
+	uint8_t ck_b = 0;
+
+	frame[0] = UBX_SYNC1;
+	frame[1] = UBX_SYNC2;
+	frame[2] = msg_class;
+	frame[3] = msg_id;
+	frame[4] = len;
+	frame[5] = 0;
+	memcpy(&frame[6], payload, len);
+
+	for (int i = 2; i < 6 + len; i++)
+		ubx_checksum(&ck_a, &ck_b, frame[i]);
+
+	frame[6 + len] = ck_a;
+	frame[7 + len] = ck_b;
+
+	PIOS_COM_SendBufferNonBlocking(ubx_port, frame, 8 + len);
+}
+
+// ************
+// move on to the next configuration message that applies to this receiver
+
+static void ubx_cfg_next(void)
+{
+	while (++ubx_cfg_step < UBX_CFG_COUNT)
+	{
+		uint8_t when = ubx_cfg[ubx_cfg_step].when;
+		if (when == UBX_CFG_ALWAYS ||
+			(when == UBX_CFG_PVT && !ubx_cfg_legacy) ||
+			(when == UBX_CFG_LEGACY && ubx_cfg_legacy))
+			break;
+	}
+	ubx_cfg_send = true;
+}
+
+static void ubx_ack(bool acked, const t_ubx_ack *ack)
+{
+	if (ubx_cfg_step >= UBX_CFG_COUNT)
+		return;     // configuration is complete
+
+	if (ubx_cfg_send)
+		return;     // the current step has not been sent yet, this answers an earlier one
+
+	const t_ubx_cfg *cfg = &ubx_cfg[ubx_cfg_step];
+	if (ack->clsID != cfg->msg_class || ack->msgID != cfg->msg_id)
+		return;     // not for the message we are waiting on
+
+	if (!acked && cfg->when == UBX_CFG_PVT)
+		ubx_cfg_legacy = true;	// this receiver does not know NAV-PVT
+
+	// a NAK on anything else can't be helped, carry on with the rest
+	ubx_cfg_next();
+}
+
+// ************
+// decode the navigation messages
+
+static uint8_t ubx_status(uint8_t fix_type, uint8_t flags)
+{
+	if (!(flags & 0x01))
+		return GPSPOSITION_STATUS_NOFIX;	// fix not valid
+
+	switch (fix_type)
+	{
+		case 2:  return GPSPOSITION_STATUS_FIX2D;
+		case 3:
+		case 4:  return GPSPOSITION_STATUS_FIX3D;
+		default: return GPSPOSITION_STATUS_NOFIX;
+	}
+}
+
+static void ubx_nav_pvt(const t_ubx_nav_pvt *pvt)
+{
+	GPSPositionData GpsData;
+	GPSPositionGet(&GpsData);	// keeps HDOP and VDOP, they are not in NAV-PVT
+		GpsData.Status          = ubx_status(pvt->fixType, pvt->flags);
+		GpsData.Latitude        = pvt->lat;                             // degrees * 10e6
+		GpsData.Longitude       = pvt->lon;                             // degrees * 10e6
+		GpsData.Altitude        = (float)pvt->hMSL * 0.001f;            // meters
+		GpsData.GeoidSeparation = (float)(pvt->height - pvt->hMSL) * 0.001f;   // meters
+		GpsData.Heading         = (float)pvt->headMot * 1e-5f;          // degrees
+		GpsData.Groundspeed     = (float)pvt->gSpeed * 0.001f;          // m/s
+		GpsData.Satellites      = pvt->numSV;
+		GpsData.PDOP            = (float)pvt->pDOP * 0.01f;
+	GPSPositionSet(&GpsData);
+
+	if ((pvt->valid & 0x03) == 0x03)
+	{	// date and time are valid
+		GPSTimeData GpsTime;
+			GpsTime.Second = pvt->sec;
+			GpsTime.Minute = pvt->min;
+			GpsTime.Hour = pvt->hour;
+			GpsTime.Day = pvt->day;
+			GpsTime.Month = pvt->month;
+			GpsTime.Year = pvt->year;
+		GPSTimeSet(&GpsTime);
+	}
+}
+
+static void ubx_nav_timeutc(const t_ubx_nav_timeutc *timeutc)
+{
+	if (!(timeutc->valid & 0x04))
+		return;     // UTC not yet known
+
+	GPSTimeData GpsTime;
+		GpsTime.Second = timeutc->sec;
+		GpsTime.Minute = timeutc->min;
+		GpsTime.Hour = timeutc->hour;
+		GpsTime.Day = timeutc->day;
+		GpsTime.Month = timeutc->month;
+		GpsTime.Year = timeutc->year;
+	GPSTimeSet(&GpsTime);
+}
+
+// returns TRUE once all the messages of the epoch are in and GPSPosition has been updated
+static bool ubx_nav_legacy(uint8_t msg_id, const t_ubx_payload *payload)
+{
+	uint32_t iTOW = payload->nav_sol.iTOW;	// all of them start with the time of week
+
+	if (iTOW != ubx_position_iTOW || ubx_position_have == 0)
+	{	// a new epoch
+		GPSPositionGet(&ubx_position);
+		ubx_position_iTOW = iTOW;
+		ubx_position_have = 0;
+	}
+
+	switch (msg_id)
+	{
+		case UBX_ID_NAV_SOL:
+			ubx_position.Status     = ubx_status(payload->nav_sol.gpsFix, payload->nav_sol.flags);
+			ubx_position.Satellites = payload->nav_sol.numSV;
+			ubx_position.PDOP       = (float)payload->nav_sol.pDOP * 0.01f;
+			ubx_position_have |= UBX_HAVE_SOL;
+			break;
+
+		case UBX_ID_NAV_POSLLH:
+			ubx_position.Latitude        = payload->nav_posllh.lat;                 // degrees * 10e6
+			ubx_position.Longitude       = payload->nav_posllh.lon;                 // degrees * 10e6
+			ubx_position.Altitude        = (float)payload->nav_posllh.hMSL * 0.001f;   // meters
+			ubx_position.GeoidSeparation = (float)(payload->nav_posllh.height - payload->nav_posllh.hMSL) * 0.001f;   // meters
+			ubx_position_have |= UBX_HAVE_POSLLH;
+			break;
+
+		case UBX_ID_NAV_VELNED:
+			ubx_position.Heading     = (float)payload->nav_velned.heading * 1e-5f;  // degrees
+			ubx_position.Groundspeed = (float)payload->nav_velned.gSpeed * 0.01f;   // m/s
+			ubx_position_have |= UBX_HAVE_VELNED;
+			break;
+	}
+
+	if (ubx_position_have != UBX_HAVE_ALL)
+		return false;
+
+	GPSPositionSet(&ubx_position);
+	ubx_position_have = 0;
+
+	return true;
+}
+
+// ************
+/**
+ * Parses the UBX stream and updates the GPSPosition and GPSTime UAVObjects
+ *
+ * param[in] .. b = a new received byte from the GPS
+ *
+ * return '0' if GPSPosition has been updated
+ * return '1' if we have found some other valid message
+ * return <0 if any errors were encountered with the frame or no complete frame found
+ */
+
+int UBX_update_position(uint8_t b, volatile uint32_t *chksum_errors, volatile uint32_t *parsing_errors)
+{
+	t_ubx_parser *p = &ubx_parser;
+
+	int res = ubx_parse_byte(p, b);
+	if (res == 0)
+		return -1;  // frame not yet complete
+
+	if (res < 0)
+	{
+		if (res == -2)
+		{
+			if (chksum_errors) (*chksum_errors)++;
+		}
+		else
+		{
+			if (parsing_errors) (*parsing_errors)++;
+		}
+		return res;
+	}
+
+	if (p->msg_class == UBX_CLASS_ACK)
+	{
+		if (p->len == sizeof(t_ubx_ack) && (p->msg_id == UBX_ID_ACK_ACK || p->msg_id == UBX_ID_ACK_NAK))
+			ubx_ack(p->msg_id == UBX_ID_ACK_ACK, &p->payload.ack);
+		return 1;
+	}
+
+	if (p->msg_class != UBX_CLASS_NAV)
+		return 1;   // not interested
+
+	switch (p->msg_id)
+	{
+		case UBX_ID_NAV_PVT:
+			if (p->len < sizeof(t_ubx_nav_pvt))
+				break;
+			ubx_nav_pvt(&p->payload.nav_pvt);
+			return 0;
+
+		case UBX_ID_NAV_SOL:
+			if (p->len != sizeof(t_ubx_nav_sol))
+				break;
+			return ubx_nav_legacy(p->msg_id, &p->payload) ? 0 : 1;
+
+		case UBX_ID_NAV_POSLLH:
+			if (p->len != sizeof(t_ubx_nav_posllh))
+				break;
+			return ubx_nav_legacy(p->msg_id, &p->payload) ? 0 : 1;
+
+		case UBX_ID_NAV_VELNED:
+			if (p->len != sizeof(t_ubx_nav_velned))
+				break;
+			return ubx_nav_legacy(p->msg_id, &p->payload) ? 0 : 1;
+
+		case UBX_ID_NAV_TIMEUTC:
+			if (p->len != sizeof(t_ubx_nav_timeutc))
+				break;
+			ubx_nav_timeutc(&p->payload.nav_timeutc);
+			return 1;
+
+		default:
+			return 1;   // not interested
+	}
+
+	// a message we know with the wrong length
+	if (parsing_errors) (*parsing_errors)++;
+	return -1;
+}
+
+// ************
+/**
+ * Sends the next configuration message, or sends it again if the
+ * receiver has not acked it in time. Call it regularly.
+ */
+
+void UBX_config_update(uint32_t timeNowMs)
+{
+	if (ubx_cfg_step >= UBX_CFG_COUNT)
+		return;     // configuration is complete
+
+	if (!ubx_cfg_send && (timeNowMs - ubx_cfg_sent_ms) < UBX_CONFIG_TIMEOUT_MS)
+		return;     // still waiting for the ack
+
+	const t_ubx_cfg *cfg = &ubx_cfg[ubx_cfg_step];
+	ubx_send(cfg->msg_class, cfg->msg_id, cfg->payload, cfg->len);
+
+	ubx_cfg_send = false;
+	ubx_cfg_sent_ms = timeNowMs;
+}
+
+// ************
+/**
+ * Resets the parser and starts the configuration handshake over
+ */
+
+void UBX_init(uint32_t port)
+{
+	ubx_port = port;
+
+	memset(&ubx_parser, 0, sizeof(ubx_parser));
+	ubx_position_have = 0;
+
+	ubx_cfg_step = 0;
+	ubx_cfg_legacy = false;
+	ubx_cfg_send = true;
+}
+
+// ************
+
+#endif // ENABLE_GPS_BINARY_UBX
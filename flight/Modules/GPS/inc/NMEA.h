@@ -36,8 +36,7 @@
 #include "gps_mode.h"
 
 #if defined(ENABLE_GPS_NMEA) || defined(ENABLE_GPS_ONESENTENCE_GTOP)
-	extern bool NMEA_update_position(char *nmea_sentence);
-	extern bool NMEA_checksum(char *nmea_sentence);
+	extern int NMEA_update_position(uint8_t b, volatile uint32_t *chksum_errors, volatile uint32_t *parsing_errors);
 #endif
 
 #endif /* NMEA_H */
@@ -39,12 +39,13 @@
 
 //#define ENABLE_GPS_BINARY_GTOP      // uncomment this if we are using GTOP BINARY mode
 //#define ENABLE_GPS_ONESENTENCE_GTOP // uncomment this if we are using GTOP SINGLE SENTENCE mode
+//#define ENABLE_GPS_BINARY_UBX       // uncomment this if we are using a u-blox receiver in UBX BINARY mode
 #define ENABLE_GPS_NMEA               // uncomment this if we are using NMEA mode
 
 // ****************
 // make sure they have defined a protocol to use
 
-#if !defined(ENABLE_GPS_BINARY_GTOP) && !defined(ENABLE_GPS_ONESENTENCE_GTOP) && !defined(ENABLE_GPS_NMEA)
+#if !defined(ENABLE_GPS_BINARY_GTOP) && !defined(ENABLE_GPS_BINARY_UBX) && !defined(ENABLE_GPS_ONESENTENCE_GTOP) && !defined(ENABLE_GPS_NMEA)
 	#error YOU MUST SELECT THE DESIRED GPS PROTOCOL IN gps_mode.h!
 #endif
 
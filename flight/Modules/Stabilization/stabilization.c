@@ -117,6 +117,7 @@ int32_t StabilizationInitialize()
 
 	// Create object queue
 	queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
+	LoopMonitorAddQueue(EVENTQUEUESTATS_DROPPED_STABILIZATION, queue);
 
 	// Listen for updates.
 	//	AttitudeActualConnectQueue(queue);
@@ -136,8 +137,7 @@ MODULE_INITCALL(StabilizationInitialize, StabilizationStart)
  */
 static void stabilizationTask(void* parameters)
 {
-	portTickType lastSysTime;
-	portTickType thisSysTime;
+	uint32_t lastTimestamp;
 	UAVObjEvent ev;
 
 
@@ -152,7 +152,7 @@ static void stabilizationTask(void* parameters)
 	SettingsUpdatedCb((UAVObjEvent *) NULL);
 
 	// Main task loop
-	lastSysTime = xTaskGetTickCount();
+	lastTimestamp = PIOS_DELAY_GetTimeuS();
 	ZeroPids();
 	while(1) {
 		PIOS_WDG_UpdateFlag(PIOS_WDG_STABILIZATION);
@@ -163,12 +163,13 @@ static void stabilizationTask(void* parameters)
 			AlarmsSet(SYSTEMALARMS_ALARM_STABILIZATION,SYSTEMALARMS_ALARM_WARNING);
 			continue;
 		}
+		LoopMonitorQueueReceived(EVENTQUEUESTATS_DROPPED_STABILIZATION, &ev);
+		LoopMonitorStart(LOOPTIMING_PERIODMEAN_STABILIZATION);
 
-		// Check how long since last update
-		thisSysTime = xTaskGetTickCount();
-		if(thisSysTime > lastSysTime) // reuse dt in case of wraparound
-			dT = (thisSysTime - lastSysTime) / portTICK_RATE_MS / 1000.0f;
-		lastSysTime = thisSysTime;
+		// Check how long since the last AttitudeRaw update, reuse dT if they came together
+		if(ev.timestamp != lastTimestamp)
+			dT = (ev.timestamp - lastTimestamp) * 1e-6f;
+		lastTimestamp = ev.timestamp;
 
 		FlightStatusGet(&flightStatus);
 		StabilizationDesiredGet(&stabDesired);
@@ -337,6 +338,8 @@ static void stabilizationTask(void* parameters)
 
 		// Clear alarms
 		AlarmsClear(SYSTEMALARMS_ALARM_STABILIZATION);
+
+		LoopMonitorEnd(LOOPTIMING_PERIODMEAN_STABILIZATION);
 	}
 }
 
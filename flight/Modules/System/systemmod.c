@@ -46,6 +46,7 @@
 #include "i2cstats.h"
 #include "watchdogstatus.h"
 #include "taskmonitor.h"
+#include "loopmonitor.h"
 #include "pios_config.h"
 
 
@@ -143,6 +144,9 @@ static void systemTask(void *parameters)
 		// Update the task status object
 		TaskMonitorUpdateAll();
 
+		// Update the loop timing object
+		LoopMonitorUpdateAll();
+
 		// Flash the heartbeat LED
 		PIOS_LED_Toggle(LED1);
 
@@ -213,6 +217,20 @@ static void objectUpdatedCb(UAVObjEvent * ev)
 			} else if (objper.Selection == OBJECTPERSISTENCE_SELECTION_ALLMETAOBJECTS
 				   || objper.Selection == OBJECTPERSISTENCE_SELECTION_ALLOBJECTS) {
 				retval = UAVObjSaveMetaobjects();
+			} else if (objper.Selection == OBJECTPERSISTENCE_SELECTION_OBJECTLIST) {
+				// Save the instances listed by the GCS, lets it persist
+				// a batch of objects in one transaction
+				if (objper.ListLength > OBJECTPERSISTENCE_LISTOBJECTID_NUMELEM) {
+					return;
+				}
+				retval = 0;
+				for (uint8_t n = 0; n < objper.ListLength && retval == 0; ++n) {
+					obj = UAVObjGetByID(objper.ListObjectID[n]);
+					if (obj == 0) {
+						return;
+					}
+					retval = UAVObjSave(obj, objper.ListInstanceID[n]);
+				}
 			}
 		} else if (objper.Operation == OBJECTPERSISTENCE_OPERATION_DELETE) {
 			if (objper.Selection == OBJECTPERSISTENCE_SELECTION_SINGLEOBJECT) {
@@ -417,6 +435,7 @@ static void updateSystemAlarms()
 	// Check for event errors
 	UAVObjGetStats(&objStats);
 	EventGetStats(&evStats);
+	LoopMonitorEventStats(&evStats);
 	UAVObjClearStats();
 	EventClearStats();
 	if (objStats.eventErrors > 0 || evStats.eventErrors > 0) {
@@ -46,9 +46,31 @@
 #define MAX_RETRIES 2
 #define STATS_UPDATE_PERIOD_MS 4000
 #define CONNECTION_TIMEOUT_MS 8000
+#define PACKET_OVERHEAD 11 // sync, type, size, object ID, instance ID and checksum
+#define MAX_PENDING MAX_QUEUE_SIZE
+#define BURST_MS 100 // link time the token bucket can save up
+#define SCHED_QUANTUM 16 // bytes credited per weight unit on each scheduler round
+#define MAX_WEIGHT 8
+#define ONCHANGE_WEIGHT 2
+#define MAX_PERIOD_SCALE 1600 // slowest the periodic objects get, in % of their configured period
+#define RECOVER_WINDOWS 2 // clean statistics windows before speeding up again
+#define CONGESTED_RETRIES 2 // retries per window, on either side, that mean congestion
+#define CONGESTED_LOAD 80 // % of the link bandwidth
+#define RESCHEDULE_BATCH 8
 
 // Private types
 
+/**
+ * Object update waiting for its share of the link
+ */
+typedef struct {
+	UAVObjHandle obj;
+	uint16_t instId;
+	uint8_t event;
+	uint8_t weight;
+	int32_t deficit;
+} PendingObject;
+
 // Private variables
 static uint32_t telemetryPort;
 static xQueueHandle queue;
@@ -68,6 +90,22 @@ static uint32_t txRetries;
 static TelemetrySettingsData settings;
 static uint32_t timeOfLastObjectUpdate;
 
+// Transmit scheduler, see telemetryTxTask()
+static PendingObject pending[MAX_PENDING];
+static uint8_t numPending;
+static uint8_t nextPending;
+static uint32_t linkRate; // bytes per second of the radio link
+static int32_t txTokens; // bytes that can be sent right now, negative if in debt
+static uint32_t lastRefill;
+
+// Adaptive update rates, see adaptUpdateRates()
+static uint16_t periodScale; // % of the configured update period
+static uint8_t cleanWindows;
+static uint32_t lastGcsRetries;
+static UAVObjHandle rescheduleBatch[RESCHEDULE_BATCH];
+static uint8_t rescheduleCount;
+static uint16_t rescheduleSkip;
+
 // Private functions
 static void telemetryTxTask(void *parameters);
 static void telemetryRxTask(void *parameters);
@@ -80,6 +118,15 @@ static void processObjEvent(UAVObjEvent * ev);
 static void updateTelemetryStats();
 static void gcsTelemetryStatsUpdated();
 static void updateSettings();
+static uint8_t isPriorityObject(UAVObjHandle obj);
+static uint8_t isPriorityEvent(UAVObjEvent * ev);
+static void scheduleObjEvent(UAVObjEvent * ev);
+static int32_t sendPendingObject(void);
+static uint32_t packetSize(UAVObjHandle obj, uint16_t instId);
+static int32_t tokensWaitMs(uint32_t size);
+static void adaptUpdateRates(FlightTelemetryStatsData * flightStats, GCSTelemetryStatsData * gcsStats, uint32_t errors, uint32_t retries);
+static void setPeriodScale(uint16_t scale);
+static void collectPeriodicObject(UAVObjHandle obj);
 
 /**
  * Initialise the telemetry module
@@ -114,11 +161,16 @@ int32_t TelemetryInitialize(void)
 
 	// Initialize vars
 	timeOfLastObjectUpdate = 0;
+	periodScale = 100;
+	cleanWindows = 0;
+	lastGcsRetries = 0;
 
 	// Create object queues
 	queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
+	LoopMonitorAddQueue(EVENTQUEUESTATS_DROPPED_TELEMETRYTX, queue);
 #if defined(PIOS_TELEM_PRIORITY_QUEUE)
 	priorityQueue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
+	LoopMonitorAddQueue(EVENTQUEUESTATS_DROPPED_TELEMETRYTXPRI, priorityQueue);
 #endif
 	
 	// Get telemetry settings object
@@ -167,10 +219,22 @@ static void updateObject(UAVObjHandle obj)
 {
 	UAVObjMetadata metadata;
 	int32_t eventMask;
+	xQueueHandle objQueue;
 
 	// Get metadata
 	UAVObjGetMetadata(obj, &metadata);
 
+	// Objects that need an answer go to the priority queue, the rest share
+	// the link through the scheduler
+	if (isPriorityObject(obj)) {
+		objQueue = priorityQueue;
+	} else {
+		objQueue = queue;
+	}
+#if defined(PIOS_TELEM_PRIORITY_QUEUE)
+	UAVObjDisconnectQueue(obj, objQueue == queue ? priorityQueue : queue);
+#endif
+
 	// Setup object depending on update mode
 	if (metadata.telemetryUpdateMode == UPDATEMODE_PERIODIC) {
 		// Set update period
@@ -180,7 +244,7 @@ static void updateObject(UAVObjHandle obj)
 		if (UAVObjIsMetaobject(obj)) {
 			eventMask |= EV_UNPACKED;	// we also need to act on remote updates (unpack events)
 		}
-		UAVObjConnectQueue(obj, priorityQueue, eventMask);
+		UAVObjConnectQueue(obj, objQueue, eventMask);
 	} else if (metadata.telemetryUpdateMode == UPDATEMODE_ONCHANGE) {
 		// Set update period
 		setUpdatePeriod(obj, 0);
@@ -189,7 +253,7 @@ static void updateObject(UAVObjHandle obj)
 		if (UAVObjIsMetaobject(obj)) {
 			eventMask |= EV_UNPACKED;	// we also need to act on remote updates (unpack events)
 		}
-		UAVObjConnectQueue(obj, priorityQueue, eventMask);
+		UAVObjConnectQueue(obj, objQueue, eventMask);
 	} else if (metadata.telemetryUpdateMode == UPDATEMODE_MANUAL) {
 		// Set update period
 		setUpdatePeriod(obj, 0);
@@ -198,12 +262,12 @@ static void updateObject(UAVObjHandle obj)
 		if (UAVObjIsMetaobject(obj)) {
 			eventMask |= EV_UNPACKED;	// we also need to act on remote updates (unpack events)
 		}
-		UAVObjConnectQueue(obj, priorityQueue, eventMask);
+		UAVObjConnectQueue(obj, objQueue, eventMask);
 	} else if (metadata.telemetryUpdateMode == UPDATEMODE_NEVER) {
 		// Set update period
 		setUpdatePeriod(obj, 0);
 		// Disconnect queue
-		UAVObjDisconnectQueue(obj, priorityQueue);
+		UAVObjDisconnectQueue(obj, objQueue);
 	}
 }
 
@@ -265,18 +329,34 @@ static void processObjEvent(UAVObjEvent * ev)
 
 /**
  * Telemetry transmit task, regular priority
+ *
+ * Events that need an answer are sent right away. Other object updates are
+ * merged per object and sent in deficit round robin order, weighted by the
+ * object update rate, whenever the token bucket of the link allows it.
  */
 static void telemetryTxTask(void *parameters)
 {
 	UAVObjEvent ev;
+	int32_t waitMs = -1;
 
 	// Loop forever
 	while (1) {
-		// Wait for queue message
-		if (xQueueReceive(queue, &ev, portMAX_DELAY) == pdTRUE) {
+		// Wait for queue message, or until the next pending object may be sent
+		if (xQueueReceive(queue, &ev, waitMs < 0 ? portMAX_DELAY : waitMs / portTICK_RATE_MS) == pdTRUE) {
+			LoopMonitorQueueReceived(EVENTQUEUESTATS_DROPPED_TELEMETRYTX, &ev);
 			// Process event
-			processObjEvent(&ev);
+			if (isPriorityEvent(&ev)) {
+				processObjEvent(&ev);
+			} else {
+				scheduleObjEvent(&ev);
+			}
+			// Merge everything already queued before picking what to send
+			if (uxQueueMessagesWaiting(queue) > 0) {
+				waitMs = 0;
+				continue;
+			}
 		}
+		waitMs = sendPendingObject();
 	}
 }
 
@@ -292,6 +372,7 @@ static void telemetryTxPriTask(void *parameters)
 	while (1) {
 		// Wait for queue message
 		if (xQueueReceive(priorityQueue, &ev, portMAX_DELAY) == pdTRUE) {
+			LoopMonitorQueueReceived(EVENTQUEUESTATS_DROPPED_TELEMETRYTXPRI, &ev);
 			// Process event
 			processObjEvent(&ev);
 		}
@@ -330,6 +411,192 @@ static void telemetryRxTask(void *parameters)
 	}
 }
 
+/**
+ * Acks, requests, settings, metadata and the telemetry objects themselves
+ * are never held back by the scheduler.
+ */
+static uint8_t isPriorityObject(UAVObjHandle obj)
+{
+	UAVObjMetadata metadata;
+
+	if (obj == GCSTelemetryStatsHandle() || obj == FlightTelemetryStatsHandle() || obj == TelemetrySettingsHandle() ||
+	    UAVObjIsSettings(obj) || UAVObjIsMetaobject(obj)) {
+		return 1;
+	}
+	UAVObjGetMetadata(obj, &metadata);
+	return metadata.telemetryAcked;
+}
+
+static uint8_t isPriorityEvent(UAVObjEvent * ev)
+{
+	if (ev->obj == 0 || ev->event == EV_UPDATE_REQ || ev->event == EV_UNPACKED) {
+		return 1;
+	}
+	return isPriorityObject(ev->obj);
+}
+
+/**
+ * Add an object update to the scheduler. An update of an object that is still
+ * pending is merged with it, the latest data are read when it is sent anyway.
+ */
+static void scheduleObjEvent(UAVObjEvent * ev)
+{
+	UAVObjMetadata metadata;
+	PendingObject *p;
+	int32_t weight;
+
+	for (int n = 0; n < numPending; ++n) {
+		p = &pending[n];
+		if (p->obj == ev->obj && p->instId == ev->instId && p->event == ev->event) {
+			return;
+		}
+	}
+	if (numPending >= MAX_PENDING) {
+		++txErrors;
+		return;
+	}
+
+	// Faster objects get a larger share of the link
+	UAVObjGetMetadata(ev->obj, &metadata);
+	if (metadata.telemetryUpdateMode == UPDATEMODE_PERIODIC && metadata.telemetryUpdatePeriod > 0) {
+		weight = 1000 / metadata.telemetryUpdatePeriod;
+		if (weight < 1) {
+			weight = 1;
+		} else if (weight > MAX_WEIGHT) {
+			weight = MAX_WEIGHT;
+		}
+	} else {
+		weight = ONCHANGE_WEIGHT;
+	}
+
+	p = &pending[numPending++];
+	p->obj = ev->obj;
+	p->instId = ev->instId;
+	p->event = ev->event;
+	p->weight = weight;
+	p->deficit = 0;
+}
+
+/**
+ * Send the next pending object if the link has room for it
+ * \return Time to wait in ms before trying again, 0 if an object was sent or -1 if nothing is pending
+ */
+static int32_t sendPendingObject(void)
+{
+	PendingObject *p;
+	UAVObjEvent ev;
+	uint32_t size;
+	int32_t waitMs;
+	uint8_t status;
+
+	if (numPending == 0) {
+		return -1;
+	}
+
+	// Nothing but the priority objects goes out until the GCS is connected,
+	// the rest stays pending (merged per object) so that acked updates made
+	// while the link was down still reach the GCS once it is back
+	FlightTelemetryStatsStatusGet(&status);
+	if (status != FLIGHTTELEMETRYSTATS_STATUS_CONNECTED) {
+		return REQ_TIMEOUT_MS;
+	}
+
+	// Deficit round robin, each visit credits the object with its weight
+	// until it can pay for its packet
+	while (1) {
+		if (nextPending >= numPending) {
+			nextPending = 0;
+		}
+		p = &pending[nextPending];
+		size = packetSize(p->obj, p->instId);
+		if (p->deficit < (int32_t)size) {
+			p->deficit += SCHED_QUANTUM * p->weight;
+		}
+		if (p->deficit >= (int32_t)size) {
+			break;
+		}
+		++nextPending;
+	}
+
+	waitMs = tokensWaitMs(size);
+	if (waitMs > 0) {
+		return waitMs;
+	}
+
+	// Remove it, keeping the round robin order of the others
+	ev.obj = p->obj;
+	ev.instId = p->instId;
+	ev.event = p->event;
+	ev.timestamp = 0;
+	--numPending;
+	memmove(p, p + 1, (numPending - nextPending) * sizeof(PendingObject));
+
+	processObjEvent(&ev);
+	return 0;
+}
+
+/**
+ * Size on the link of an object update
+ */
+static uint32_t packetSize(UAVObjHandle obj, uint16_t instId)
+{
+	uint32_t size = UAVObjGetNumBytes(obj) + PACKET_OVERHEAD;
+
+	if (instId == UAVOBJ_ALL_INSTANCES) {
+		size *= UAVObjGetNumInstances(obj);
+	}
+	return size;
+}
+
+/**
+ * Refill the token bucket and check whether a packet can be sent
+ * \return Time in ms until there are enough tokens, 0 if it can be sent now
+ */
+static int32_t tokensWaitMs(uint32_t size)
+{
+	uint32_t now;
+	uint32_t elapsed;
+	int32_t tokens;
+	int32_t burst;
+
+	// USB is not shaped
+#if defined(PIOS_INCLUDE_USB_HID)
+	if (PIOS_USB_HID_CheckAvailable(0)) {
+		return 0;
+	}
+#endif
+	if (linkRate == 0) {
+		return 0;
+	}
+
+	burst = linkRate * BURST_MS / 1000;
+	if (burst < (int32_t)size) {
+		burst = size;
+	}
+
+	portENTER_CRITICAL();
+	now = PIOS_DELAY_GetTimeuS();
+	elapsed = now - lastRefill;
+	// Only move the refill time by what was credited, so no fraction of a byte is lost
+	if (elapsed >= 1000000 / linkRate) {
+		uint32_t credit = (uint64_t)elapsed * linkRate / 1000000;
+		lastRefill += (uint64_t)credit * 1000000 / linkRate;
+		if (txTokens + (int32_t)credit > burst) {
+			txTokens = burst;
+			lastRefill = now;
+		} else {
+			txTokens += credit;
+		}
+	}
+	tokens = txTokens;
+	portEXIT_CRITICAL();
+
+	if (tokens >= (int32_t)size) {
+		return 0;
+	}
+	return ((size - tokens) * 1000) / linkRate + 1;
+}
+
 /**
  * Transmit data buffer to the modem or USB port.
  * \param[in] data Data buffer to send
@@ -350,6 +617,13 @@ static int32_t transmitData(uint8_t * data, int32_t length)
 		outputPort = telemetryPort;
 	}
 
+	// Everything sent on the radio, acks included, is taken from the token bucket
+	if (outputPort == telemetryPort) {
+		portENTER_CRITICAL();
+		txTokens -= length;
+		portEXIT_CRITICAL();
+	}
+
 	return PIOS_COM_SendBufferNonBlocking(outputPort, data, length);
 }
 
@@ -381,6 +655,11 @@ static int32_t setUpdatePeriod(UAVObjHandle obj, int32_t updatePeriodMs)
 {
 	UAVObjEvent ev;
 
+	// Slow down everything but the priority objects while the link is congested
+	if (updatePeriodMs > 0 && periodScale != 100 && !isPriorityObject(obj)) {
+		updatePeriodMs = updatePeriodMs * periodScale / 100;
+	}
+
 	// Add object for periodic updates
 	ev.obj = obj;
 	ev.instId = UAVOBJ_ALL_INSTANCES;
@@ -428,6 +707,7 @@ static void updateTelemetryStats()
 	if (flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_CONNECTED) {
 		flightStats.RxDataRate = (float)utalkStats.rxBytes / ((float)STATS_UPDATE_PERIOD_MS / 1000.0);
 		flightStats.TxDataRate = (float)utalkStats.txBytes / ((float)STATS_UPDATE_PERIOD_MS / 1000.0);
+		adaptUpdateRates(&flightStats, &gcsStats, txErrors, txRetries);
 		flightStats.RxFailures += utalkStats.rxErrors;
 		flightStats.TxFailures += txErrors;
 		flightStats.TxRetries += txRetries;
@@ -441,7 +721,11 @@ static void updateTelemetryStats()
 		flightStats.TxRetries = 0;
 		txErrors = 0;
 		txRetries = 0;
+		// Start the next connection at the configured rates
+		setPeriodScale(100);
+		lastGcsRetries = 0;
 	}
+	flightStats.UpdatePeriodScale = periodScale;
 
 	// Check for connection timeout
 	timeNow = xTaskGetTickCount() * portTICK_RATE_MS;
@@ -494,6 +778,89 @@ static void updateTelemetryStats()
 	}
 }
 
+/**
+ * Adapt the update period of the non critical objects to the link quality.
+ * The periods double while either side retries or the link is close to
+ * full, and halve back towards the configured values once the link has
+ * been clean for a while.
+ */
+static void adaptUpdateRates(FlightTelemetryStatsData * flightStats, GCSTelemetryStatsData * gcsStats, uint32_t errors, uint32_t retries)
+{
+	uint32_t gcsRetries;
+	uint8_t congested;
+
+	if (settings.AdaptiveRates != TELEMETRYSETTINGS_ADAPTIVERATES_ENABLED) {
+		setPeriodScale(100);
+		return;
+	}
+
+	// The GCS counter is cumulative, and restarts with each connection
+	gcsRetries = gcsStats->TxRetries >= lastGcsRetries ? gcsStats->TxRetries - lastGcsRetries : gcsStats->TxRetries;
+	lastGcsRetries = gcsStats->TxRetries;
+
+	congested = errors > 0 || retries >= CONGESTED_RETRIES || gcsRetries >= CONGESTED_RETRIES;
+#if defined(PIOS_INCLUDE_USB_HID)
+	if (!PIOS_USB_HID_CheckAvailable(0))
+#endif
+	{
+		if (linkRate > 0 && flightStats->TxDataRate > linkRate * CONGESTED_LOAD / 100) {
+			congested = 1;
+		}
+	}
+
+	if (congested) {
+		cleanWindows = 0;
+		setPeriodScale(periodScale * 2 > MAX_PERIOD_SCALE ? MAX_PERIOD_SCALE : periodScale * 2);
+	} else if (periodScale > 100 && ++cleanWindows >= RECOVER_WINDOWS) {
+		cleanWindows = 0;
+		setPeriodScale(periodScale / 2 < 100 ? 100 : periodScale / 2);
+	}
+}
+
+/**
+ * Change the period scale and reschedule the periodic objects
+ */
+static void setPeriodScale(uint16_t scale)
+{
+	UAVObjMetadata metadata;
+	uint16_t done;
+
+	if (scale == periodScale) {
+		return;
+	}
+	periodScale = scale;
+
+	// The periods are updated outside of the object manager lock, a batch at
+	// a time, since the event dispatcher takes the two locks in the opposite
+	// order while it runs periodic callbacks
+	done = 0;
+	do {
+		rescheduleCount = 0;
+		rescheduleSkip = done;
+		UAVObjIterate(&collectPeriodicObject);
+		for (int n = 0; n < rescheduleCount; ++n) {
+			UAVObjGetMetadata(rescheduleBatch[n], &metadata);
+			setUpdatePeriod(rescheduleBatch[n], metadata.telemetryUpdatePeriod);
+		}
+		done += rescheduleCount;
+	} while (rescheduleCount == RESCHEDULE_BATCH);
+}
+
+static void collectPeriodicObject(UAVObjHandle obj)
+{
+	UAVObjMetadata metadata;
+
+	UAVObjGetMetadata(obj, &metadata);
+	if (metadata.telemetryUpdateMode != UPDATEMODE_PERIODIC) {
+		return;
+	}
+	if (rescheduleSkip > 0) {
+		--rescheduleSkip;
+	} else if (rescheduleCount < RESCHEDULE_BATCH) {
+		rescheduleBatch[rescheduleCount++] = obj;
+	}
+}
+
 /**
  * Update the telemetry settings, called on startup and
  * each time the settings object is updated
@@ -507,19 +874,28 @@ static void updateSettings()
     TelemetrySettingsGet(&settings);
 
     // Set port speed
-    if (settings.Speed == TELEMETRYSETTINGS_SPEED_2400) PIOS_COM_ChangeBaud(telemetryPort, 2400);
+    uint32_t baud = 57600;
+    if (settings.Speed == TELEMETRYSETTINGS_SPEED_2400) baud = 2400;
     else
-    if (settings.Speed == TELEMETRYSETTINGS_SPEED_4800) PIOS_COM_ChangeBaud(telemetryPort, 4800);
+    if (settings.Speed == TELEMETRYSETTINGS_SPEED_4800) baud = 4800;
     else
-    if (settings.Speed == TELEMETRYSETTINGS_SPEED_9600) PIOS_COM_ChangeBaud(telemetryPort, 9600);
+    if (settings.Speed == TELEMETRYSETTINGS_SPEED_9600) baud = 9600;
     else
-    if (settings.Speed == TELEMETRYSETTINGS_SPEED_19200) PIOS_COM_ChangeBaud(telemetryPort, 19200);
+    if (settings.Speed == TELEMETRYSETTINGS_SPEED_19200) baud = 19200;
     else
-    if (settings.Speed == TELEMETRYSETTINGS_SPEED_38400) PIOS_COM_ChangeBaud(telemetryPort, 38400);
+    if (settings.Speed == TELEMETRYSETTINGS_SPEED_38400) baud = 38400;
     else
-    if (settings.Speed == TELEMETRYSETTINGS_SPEED_57600) PIOS_COM_ChangeBaud(telemetryPort, 57600);
+    if (settings.Speed == TELEMETRYSETTINGS_SPEED_57600) baud = 57600;
     else
-    if (settings.Speed == TELEMETRYSETTINGS_SPEED_115200) PIOS_COM_ChangeBaud(telemetryPort, 115200);
+    if (settings.Speed == TELEMETRYSETTINGS_SPEED_115200) baud = 115200;
+    PIOS_COM_ChangeBaud(telemetryPort, baud);
+
+    // Restart the token bucket at the new rate, 10 bits per byte on the wire
+    linkRate = baud / 10;
+    portENTER_CRITICAL();
+    txTokens = 0;
+    lastRefill = PIOS_DELAY_GetTimeuS();
+    portEXIT_CRITICAL();
 }
 
 /**
@@ -0,0 +1,337 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotSystem OpenPilot System
+ * @{
+ * @addtogroup OpenPilotLibraries OpenPilot System Libraries
+ * @{
+ * @file       loopmonitor.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Loop timing library, measures the period and execution time of
+ *             the time critical loops and the latency of the object event
+ *             queues, reports them in the LoopTiming and EventQueueStats objects
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "openpilot.h"
+#include "loopmonitor.h"
+
+// Private constants
+#define NUM_LOOPS LOOPTIMING_PERIODMEAN_NUMELEM
+#define NUM_QUEUES EVENTQUEUESTATS_DROPPED_NUMELEM
+#define NUM_BINS (LOOPTIMING_PERIODHISTOGRAM_NUMELEM / NUM_LOOPS)
+#define PERIOD_BIN_BASE_US 250
+#define EXECUTION_BIN_BASE_US 32
+
+// Private types
+
+/**
+ * Statistics of one loop since the last report. Each loop is only written
+ * by its own task, the system task copies and clears them with the
+ * scheduler locked.
+ */
+typedef struct {
+	uint32_t start;
+	uint8_t running;
+	uint8_t hasPeriod;
+	uint32_t periodMin;
+	uint32_t periodMax;
+	uint32_t periodSum;
+	uint32_t periodCount;
+	uint32_t executionMax;
+	uint32_t executionSum;
+	uint32_t executionCount;
+	uint16_t periodHistogram[NUM_BINS];
+	uint16_t executionHistogram[NUM_BINS];
+} LoopStats;
+
+/**
+ * Statistics of one event queue since the last report, only written by the
+ * task reading the queue.
+ */
+typedef struct {
+	xQueueHandle handle;
+	uint32_t highWater;
+	uint32_t latencyMax;
+	uint32_t latencySum;
+	uint32_t latencyCount;
+} QueueStats;
+
+// Private variables
+static LoopStats loops[NUM_LOOPS];
+static QueueStats queues[NUM_QUEUES];
+static EventStats eventStats;
+
+// Private functions
+static uint8_t histogramBin(uint32_t value, uint32_t base);
+static uint16_t saturate16(uint32_t value);
+static void updateLoopTiming(void);
+static void updateQueueStats(void);
+
+/**
+ * Initialize library
+ */
+int32_t LoopMonitorInitialize(void)
+{
+	memset(loops, 0, sizeof(loops));
+	memset(queues, 0, sizeof(queues));
+	memset(&eventStats, 0, sizeof(eventStats));
+	return 0;
+}
+
+/**
+ * Mark the start of a loop iteration, the period is measured between starts.
+ * Must be called right after the loop wakes up, from the loop task only.
+ */
+void LoopMonitorStart(LoopTimingPeriodMeanElem loop)
+{
+	LoopStats * stats;
+	uint32_t now;
+	uint32_t period;
+	uint8_t bin;
+
+	if (loop >= NUM_LOOPS)
+		return;
+
+	stats = &loops[loop];
+	now = PIOS_DELAY_GetTimeuS();
+	if (stats->hasPeriod) {
+		period = now - stats->start;
+		if (stats->periodCount == 0 || period < stats->periodMin)
+			stats->periodMin = period;
+		if (period > stats->periodMax)
+			stats->periodMax = period;
+		stats->periodSum += period;
+		++stats->periodCount;
+		bin = histogramBin(period, PERIOD_BIN_BASE_US);
+		if (stats->periodHistogram[bin] < 0xFFFF)
+			++stats->periodHistogram[bin];
+	}
+	stats->start = now;
+	stats->hasPeriod = 1;
+	stats->running = 1;
+}
+
+/**
+ * Mark the end of the loop iteration started by LoopMonitorStart()
+ */
+void LoopMonitorEnd(LoopTimingPeriodMeanElem loop)
+{
+	LoopStats * stats;
+	uint32_t execution;
+	uint8_t bin;
+
+	if (loop >= NUM_LOOPS || !loops[loop].running)
+		return;
+
+	stats = &loops[loop];
+	execution = PIOS_DELAY_GetuSSince(stats->start);
+	if (execution > stats->executionMax)
+		stats->executionMax = execution;
+	stats->executionSum += execution;
+	++stats->executionCount;
+	bin = histogramBin(execution, EXECUTION_BIN_BASE_US);
+	if (stats->executionHistogram[bin] < 0xFFFF)
+		++stats->executionHistogram[bin];
+	stats->running = 0;
+}
+
+/**
+ * Register an object event queue, its statistics are then reported
+ * under the given name
+ */
+int32_t LoopMonitorAddQueue(EventQueueStatsDroppedElem index, xQueueHandle queue)
+{
+	if (index >= NUM_QUEUES || index == EVENTQUEUESTATS_DROPPED_EVENTDISPATCHER)
+		return -1;
+
+	queues[index].handle = queue;
+	return 0;
+}
+
+/**
+ * Record the depth of a registered queue and how long the event waited in
+ * it, call it right after the event was received.
+ */
+void LoopMonitorQueueReceived(EventQueueStatsDroppedElem index, const UAVObjEvent * ev)
+{
+	QueueStats * stats;
+	uint32_t depth;
+	uint32_t latency;
+
+	if (index >= NUM_QUEUES || queues[index].handle == 0)
+		return;
+
+	stats = &queues[index];
+	// The received event counts too
+	depth = uxQueueMessagesWaiting(stats->handle) + 1;
+	if (depth > stats->highWater)
+		stats->highWater = depth;
+	latency = PIOS_DELAY_GetuSSince(ev->timestamp);
+	if (latency > stats->latencyMax)
+		stats->latencyMax = latency;
+	stats->latencySum += latency;
+	++stats->latencyCount;
+}
+
+/**
+ * Hand over the event dispatcher statistics, called by the system task
+ * before they get cleared.
+ */
+void LoopMonitorEventStats(const EventStats * stats)
+{
+	memcpy(&eventStats, stats, sizeof(EventStats));
+}
+
+/**
+ * Publish the statistics collected since the last call and start over
+ */
+void LoopMonitorUpdateAll(void)
+{
+	updateLoopTiming();
+	updateQueueStats();
+}
+
+static void updateLoopTiming(void)
+{
+	static LoopStats snapshot[NUM_LOOPS];
+	LoopTimingData data;
+	uint32_t mean;
+	int n;
+	int m;
+
+	// Copy and clear while the loop tasks can not preempt us, the iterations
+	// in progress keep their start time so their period is not lost
+	portENTER_CRITICAL();
+	memcpy(snapshot, loops, sizeof(loops));
+	for (n = 0; n < NUM_LOOPS; ++n) {
+		LoopStats * stats = &loops[n];
+		stats->periodMin = 0;
+		stats->periodMax = 0;
+		stats->periodSum = 0;
+		stats->periodCount = 0;
+		stats->executionMax = 0;
+		stats->executionSum = 0;
+		stats->executionCount = 0;
+		memset(stats->periodHistogram, 0, sizeof(stats->periodHistogram));
+		memset(stats->executionHistogram, 0, sizeof(stats->executionHistogram));
+	}
+	portEXIT_CRITICAL();
+
+	for (n = 0; n < NUM_LOOPS; ++n) {
+		LoopStats * stats = &snapshot[n];
+		if (stats->periodCount > 0) {
+			mean = stats->periodSum / stats->periodCount;
+			data.PeriodMean[n] = saturate16(mean);
+			data.PeriodMax[n] = saturate16(stats->periodMax);
+			// Worst deviation from the mean period on either side
+			if (stats->periodMax - mean > mean - stats->periodMin)
+				data.Jitter[n] = saturate16(stats->periodMax - mean);
+			else
+				data.Jitter[n] = saturate16(mean - stats->periodMin);
+		} else {
+			data.PeriodMean[n] = 0;
+			data.PeriodMax[n] = 0;
+			data.Jitter[n] = 0;
+		}
+		if (stats->executionCount > 0) {
+			data.ExecutionMean[n] = saturate16(stats->executionSum / stats->executionCount);
+			data.ExecutionMax[n] = saturate16(stats->executionMax);
+		} else {
+			data.ExecutionMean[n] = 0;
+			data.ExecutionMax[n] = 0;
+		}
+		for (m = 0; m < NUM_BINS; ++m) {
+			data.PeriodHistogram[n * NUM_BINS + m] = stats->periodHistogram[m];
+			data.ExecutionHistogram[n * NUM_BINS + m] = stats->executionHistogram[m];
+		}
+	}
+
+	LoopTimingSet(&data);
+}
+
+static void updateQueueStats(void)
+{
+	EventQueueStatsData data;
+	UAVObjQueueStats dropped;
+	QueueStats snapshot;
+	int n;
+
+	for (n = 0; n < NUM_QUEUES; ++n) {
+		if (n == EVENTQUEUESTATS_DROPPED_EVENTDISPATCHER) {
+			// The event dispatcher keeps the statistics of its callback queue,
+			// whose dropped events are booked under queue 0
+			snapshot.handle = 0;
+			snapshot.highWater = eventStats.queueHighWater;
+			snapshot.latencyMax = eventStats.latencyMax;
+			snapshot.latencySum = eventStats.latencySum;
+			snapshot.latencyCount = eventStats.latencyCount;
+		} else if (queues[n].handle != 0) {
+			portENTER_CRITICAL();
+			memcpy(&snapshot, &queues[n], sizeof(QueueStats));
+			queues[n].highWater = 0;
+			queues[n].latencyMax = 0;
+			queues[n].latencySum = 0;
+			queues[n].latencyCount = 0;
+			portEXIT_CRITICAL();
+		} else {
+			// Not running on this board
+			memset(&snapshot, 0, sizeof(QueueStats));
+			data.Dropped[n] = 0;
+			data.WorstObject[n] = 0;
+			data.WorstObjectDropped[n] = 0;
+		}
+
+		if (n == EVENTQUEUESTATS_DROPPED_EVENTDISPATCHER || snapshot.handle != 0) {
+			UAVObjGetQueueStats(snapshot.handle, &dropped);
+			UAVObjClearQueueStats(snapshot.handle);
+			data.Dropped[n] = saturate16(dropped.dropped);
+			data.WorstObject[n] = dropped.worstObjId;
+			data.WorstObjectDropped[n] = saturate16(dropped.worstObjDropped);
+		}
+		data.HighWater[n] = snapshot.highWater > 0xFF ? 0xFF : snapshot.highWater;
+		data.LatencyMean[n] = snapshot.latencyCount > 0 ? saturate16(snapshot.latencySum / snapshot.latencyCount) : 0;
+		data.LatencyMax[n] = saturate16(snapshot.latencyMax);
+	}
+
+	EventQueueStatsSet(&data);
+}
+
+/**
+ * Log2 histogram bin: bin 0 is below base, bin n covers [base*2^(n-1), base*2^n)
+ * and the last bin collects everything above.
+ */
+static uint8_t histogramBin(uint32_t value, uint32_t base)
+{
+	uint8_t bin = 0;
+
+	while (bin < NUM_BINS - 1 && value >= base) {
+		++bin;
+		base <<= 1;
+	}
+	return bin;
+}
+
+static uint16_t saturate16(uint32_t value)
+{
+	return value > 0xFFFF ? 0xFFFF : value;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -1032,6 +1032,9 @@ void PIOS_Board_Init(void) {
 	/* Initialize the task monitor library */
 	TaskMonitorInitialize();
 
+	/* Initialize the loop timing library */
+	LoopMonitorInitialize();
+
 	/* Prepare the AHRS Comms upper layer protocol */
 	AhrsInitComms();
 
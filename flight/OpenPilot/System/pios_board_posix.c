@@ -50,6 +50,9 @@ void PIOS_Board_Init(void) {
 	/* Initialize the task monitor library */
 	TaskMonitorInitialize();
 
+	/* Initialize the loop timing library */
+	LoopMonitorInitialize();
+
 	/* Initialize the PiOS library */
 	PIOS_COM_Init();
 
@@ -40,6 +40,8 @@ extern int32_t PIOS_COM_SendFormattedStringNonBlocking(uint8_t port, char *forma
 extern int32_t PIOS_COM_SendFormattedString(uint8_t port, char *format, ...);
 extern uint8_t PIOS_COM_ReceiveBuffer(uint8_t port);
 extern int32_t PIOS_COM_ReceiveBufferUsed(uint8_t port);
+extern int32_t PIOS_COM_ReceiveBufferMore(uint8_t port, uint8_t *buffer, uint16_t len);
+extern int32_t PIOS_COM_ReceiveNotify(uint8_t port, uint8_t delimiter, xSemaphoreHandle sem);
 
 extern int32_t PIOS_COM_ReceiveHandler(void);
 
@@ -282,4 +282,31 @@ int32_t PIOS_COM_ReceiveBufferUsed(uint8_t port)
   return com_dev->driver->rx_avail(com_dev->id);
 }
 
+/**
+* Get as many received bytes as are available, up to len
+* \param[in] port COM port
+* \param[out] buffer where to put the received bytes
+* \param[in] len size of the buffer
+* \return number of bytes copied
+*/
+int32_t PIOS_COM_ReceiveBufferMore(uint8_t port, uint8_t *buffer, uint16_t len)
+{
+  int32_t count = 0;
+
+  while (count < len && PIOS_COM_ReceiveBufferUsed(port) > 0) {
+    buffer[count++] = PIOS_COM_ReceiveBuffer(port);
+  }
+
+  return count;
+}
+
+/**
+* Receive notifications are not supported here, the caller has to poll
+* \return -1
+*/
+int32_t PIOS_COM_ReceiveNotify(uint8_t port, uint8_t delimiter, xSemaphoreHandle sem)
+{
+  return -1;
+}
+
 #endif
@@ -40,6 +40,7 @@
 * \return < 0 if initialisation failed
 */
 #include <time.h>
+#include <sys/time.h>
 
 int32_t PIOS_DELAY_Init(void)
 {
@@ -103,4 +104,42 @@ int32_t PIOS_DELAY_WaitmS(uint16_t mS)
 	return 0;
 }
 
+/**
+ * @brief Monotonic microsecond timebase
+ * @return Microseconds since the first call, wraps after about 71 minutes
+ */
+uint32_t PIOS_DELAY_GetTimeuS(void)
+{
+#if defined(CLOCK_MONOTONIC)
+	static struct timespec start;
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if (start.tv_sec == 0 && start.tv_nsec == 0) {
+		start = now;
+	}
+	return (uint32_t) ((now.tv_sec - start.tv_sec) * 1000000ULL + (now.tv_nsec - start.tv_nsec) / 1000);
+#else
+	/* No monotonic clock on this host, fall back to the wall clock */
+	static struct timeval start;
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+	if (start.tv_sec == 0 && start.tv_usec == 0) {
+		start = now;
+	}
+	return (uint32_t) ((now.tv_sec - start.tv_sec) * 1000000ULL + (now.tv_usec - start.tv_usec));
+#endif
+}
+
+/**
+ * @brief Microseconds elapsed since a PIOS_DELAY_GetTimeuS reference
+ * @param[in] ref the reference time
+ * @return The number of uS since ref, valid across the timebase wrap
+ */
+uint32_t PIOS_DELAY_GetuSSince(uint32_t ref)
+{
+	return PIOS_DELAY_GetTimeuS() - ref;
+}
+
 #endif
@@ -89,4 +89,32 @@ int32_t PIOS_DELAY_WaitmS(uint16_t mS)
 	return 0;
 }
 
+/**
+ * @brief Monotonic microsecond timebase
+ * @return Microseconds since the first call, wraps after about 71 minutes
+ */
+uint32_t PIOS_DELAY_GetTimeuS(void)
+{
+	static LARGE_INTEGER start;
+	static LARGE_INTEGER frequency;
+	LARGE_INTEGER now;
+
+	QueryPerformanceCounter(&now);
+	if (frequency.QuadPart == 0) {
+		QueryPerformanceFrequency(&frequency);
+		start = now;
+	}
+	return (uint32_t) ((now.QuadPart - start.QuadPart) * 1000000 / frequency.QuadPart);
+}
+
+/**
+ * @brief Microseconds elapsed since a PIOS_DELAY_GetTimeuS reference
+ * @param[in] ref the reference time
+ * @return The number of uS since ref, valid across the timebase wrap
+ */
+uint32_t PIOS_DELAY_GetuSSince(uint32_t ref)
+{
+	return PIOS_DELAY_GetTimeuS() - ref;
+}
+
 #endif
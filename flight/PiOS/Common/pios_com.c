@@ -310,6 +310,66 @@ int32_t PIOS_COM_ReceiveBufferUsed(uint32_t com_id)
 	return com_dev->driver->rx_avail(com_dev->id);
 }
 
+/**
+* Get as many received bytes as are available, up to len
+* \param[in] port COM port
+* \param[out] buffer where to put the received bytes
+* \param[in] len size of the buffer
+* \return number of bytes copied
+*/
+int32_t PIOS_COM_ReceiveBufferMore(uint32_t com_id, uint8_t *buffer, uint16_t len)
+{
+	struct pios_com_dev * com_dev = (struct pios_com_dev *)com_id;
+
+	if (!PIOS_COM_validate(com_dev)) {
+		/* Undefined COM port for this board (see pios_board.c) */
+		return 0;
+	}
+
+	/* Invoke the driver function if it exists */
+	if (com_dev->driver->rx_more) {
+		return com_dev->driver->rx_more(com_dev->id, buffer, len);
+	}
+
+	/* Otherwise get one byte at a time */
+	int32_t count = 0;
+	while (count < len && PIOS_COM_ReceiveBufferUsed(com_id) > 0) {
+		buffer[count++] = com_dev->driver->rx(com_dev->id);
+	}
+
+	return count;
+}
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+/**
+* Have the driver give a semaphore when the delimiter byte is received, or when
+* the receive buffer is getting full, so a task can block until there is
+* something worth parsing instead of polling
+* \param[in] port COM port
+* \param[in] delimiter byte that ends a message
+* \param[in] sem binary semaphore to give, NULL to stop
+* \return -1 if the driver does not support it
+* \return 0 on success
+*/
+int32_t PIOS_COM_ReceiveNotify(uint32_t com_id, uint8_t delimiter, xSemaphoreHandle sem)
+{
+	struct pios_com_dev * com_dev = (struct pios_com_dev *)com_id;
+
+	if (!PIOS_COM_validate(com_dev)) {
+		/* Undefined COM port for this board (see pios_board.c) */
+		return -1;
+	}
+
+	if (!com_dev->driver->rx_notify) {
+		return -1;
+	}
+
+	com_dev->driver->rx_notify(com_dev->id, delimiter, sem);
+
+	return 0;
+}
+#endif
+
 #endif
 
 /**
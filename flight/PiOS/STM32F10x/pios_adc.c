@@ -50,7 +50,7 @@ void PIOS_ADC_Init()
 	pios_adc_devs[0].callback_function = NULL;
 	
 #if defined(PIOS_INCLUDE_FREERTOS)
-	pios_adc_devs[0].data_queue = NULL;
+	pios_adc_devs[0].fifo = NULL;
 #endif
 	
 	/* Setup analog pins */
@@ -197,11 +197,49 @@ void PIOS_ADC_SetCallback(ADCCallback new_function)
 
 #if defined(PIOS_INCLUDE_FREERTOS)
 /**
- * @brief Register a queue to add data to when downsampled 
+ * @brief Register a FIFO the downsampled blocks are added to
+ * @param[in] fifo the FIFO, creates its ready semaphore
+ * @param[in] batch number of samples to collect before the consumer is woken
+ * @return < 0 on errors
  */
-void PIOS_ADC_SetQueue(xQueueHandle data_queue) 
+int32_t PIOS_ADC_SetFifo(struct pios_adc_fifo * fifo, uint16_t batch)
 {
-	pios_adc_devs[0].data_queue = data_queue;
+	if (batch == 0 || batch > PIOS_ADC_FIFO_DEPTH)
+		return -1;
+
+	fifo->head = 0;
+	fifo->tail = 0;
+	fifo->overruns = 0;
+	fifo->batch = batch;
+	vSemaphoreCreateBinary(fifo->ready);
+	if (fifo->ready == NULL)
+		return -2;
+	xSemaphoreTake(fifo->ready, 0);
+
+	pios_adc_devs[0].fifo = fifo;
+	return 0;
+}
+
+/**
+ * @brief Take all the samples available in the FIFO, oldest first
+ * @param[in] fifo the FIFO to read
+ * @param[out] samples buffer for the samples
+ * @param[in] max_samples size of the buffer
+ * @return the number of samples read
+ */
+uint16_t PIOS_ADC_FifoRead(struct pios_adc_fifo * fifo, struct pios_adc_sample * samples, uint16_t max_samples)
+{
+	uint16_t tail = fifo->tail;
+	uint16_t available = fifo->head - tail;
+	if (available > max_samples)
+		available = max_samples;
+
+	for (uint16_t i = 0; i < available; i++)
+		samples[i] = fifo->samples[(tail + i) & (PIOS_ADC_FIFO_DEPTH - 1)];
+
+	/* Only release the slots once they are copied */
+	fifo->tail = tail + available;
+	return available;
 }
 #endif
 
@@ -262,10 +300,26 @@ void PIOS_ADC_downsample_data()
 	}
 	
 #if defined(PIOS_INCLUDE_FREERTOS)
-	if(pios_adc_devs[0].data_queue) {
-		static portBASE_TYPE xHigherPriorityTaskWoken;
-		xQueueSendFromISR(pios_adc_devs[0].data_queue, pios_adc_devs[0].downsampled_buffer, &xHigherPriorityTaskWoken);
-		portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);		
+	struct pios_adc_fifo * fifo = pios_adc_devs[0].fifo;
+	if(fifo) {
+		uint16_t head = fifo->head;
+		uint16_t used = head - fifo->tail;
+		if (used >= PIOS_ADC_FIFO_DEPTH) {
+			/* Consumer fell behind, keep the older samples */
+			fifo->overruns++;
+		} else {
+			struct pios_adc_sample * sample = &fifo->samples[head & (PIOS_ADC_FIFO_DEPTH - 1)];
+			sample->timestamp = PIOS_DELAY_GetTimeuS();
+			memcpy(sample->data, downsampled_buffer, sizeof(sample->data));
+			fifo->head = head + 1;
+
+			/* Wake the consumer once per batch instead of per sample */
+			if (used + 1 >= fifo->batch) {
+				static portBASE_TYPE xHigherPriorityTaskWoken;
+				xSemaphoreGiveFromISR(fifo->ready, &xHigherPriorityTaskWoken);
+				portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+			}
+		}
 	}
 #endif
 	if(pios_adc_devs[0].callback_function)
@@ -35,6 +35,17 @@
 
 #if defined(PIOS_INCLUDE_DELAY)
 
+/* Cortex-M3 DWT cycle counter, used for the 32 bit timebase */
+#define DWT_CTRL		(*(volatile uint32_t *)0xE0001000)
+#define DWT_CYCCNT		(*(volatile uint32_t *)0xE0001004)
+#define DWT_CTRL_CYCCNTENA	(1 << 0)
+
+/* Timebase state, extended from the cycle counter on every read */
+static uint32_t cycles_per_us;
+static uint32_t timebase_last_cycles;
+static uint32_t timebase_remainder;
+static uint32_t timebase_us;
+
 /**
 * Initialises the Timer used by PIOS_DELAY functions<BR>
 * This is called from pios.c as part of the main() function
@@ -59,6 +70,14 @@ int32_t PIOS_DELAY_Init(void)
 	/* Enable counter */
 	TIM_Cmd(PIOS_DELAY_TIMER, ENABLE);
 
+	/* Enable the cycle counter for PIOS_DELAY_GetTimeuS, it is also used by the run time stats */
+	cycles_per_us = SystemCoreClock / 1000000;
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+	timebase_last_cycles = DWT_CYCCNT;
+	timebase_remainder = 0;
+	timebase_us = 0;
+
 	/* No error */
 	return 0;
 }
@@ -126,6 +145,50 @@ int32_t PIOS_DELAY_DiffuS(uint16_t ref)
 	return (int16_t) (PIOS_DELAY_GetuS() - ret_t);
 }
 
+/**
+ * @brief Monotonic microsecond timebase
+ * @return Microseconds since PIOS_DELAY_Init, wraps after about 71 minutes
+ *
+ * @note The cycle counter underneath wraps every 2^32 cycles (59s at 72MHz), so
+ * this must be called at least that often.  Any UAVObject update does.  Safe to
+ * call from interrupts.
+ */
+uint32_t PIOS_DELAY_GetTimeuS(void)
+{
+	/* Not initialised yet */
+	if (cycles_per_us == 0)
+		return 0;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	uint32_t cycles = DWT_CYCCNT;
+	uint32_t elapsed = cycles - timebase_last_cycles;
+	timebase_last_cycles = cycles;
+
+	/* Keep the remainder so no time is lost to the division */
+	timebase_us += elapsed / cycles_per_us;
+	timebase_remainder += elapsed % cycles_per_us;
+	if (timebase_remainder >= cycles_per_us) {
+		timebase_remainder -= cycles_per_us;
+		timebase_us++;
+	}
+	uint32_t now = timebase_us;
+
+	__set_PRIMASK(primask);
+	return now;
+}
+
+/**
+ * @brief Microseconds elapsed since a PIOS_DELAY_GetTimeuS reference
+ * @param[in] ref the reference time
+ * @return The number of uS since ref, valid across the timebase wrap
+ */
+uint32_t PIOS_DELAY_GetuSSince(uint32_t ref)
+{
+	return PIOS_DELAY_GetTimeuS() - ref;
+}
+
 #endif
 
 /**
@@ -42,6 +42,17 @@ static int32_t PIOS_USART_TxBufferPutMoreNonBlocking(uint32_t usart_id, const ui
 static int32_t PIOS_USART_TxBufferPutMore(uint32_t usart_id, const uint8_t *buffer, uint16_t len);
 static int32_t PIOS_USART_RxBufferGet(uint32_t usart_id);
 static int32_t PIOS_USART_RxBufferUsed(uint32_t usart_id);
+static int32_t PIOS_USART_RxBufferGetMore(uint32_t usart_id, uint8_t *buffer, uint16_t len);
+#if defined(PIOS_INCLUDE_FREERTOS)
+/**
+* Sets the semaphore the receive interrupt gives when the delimiter
+* byte arrives or the receive buffer is half full
+* \param[in] USART USART name
+* \param[in] delimiter byte which ends a message
+* \param[in] sem semaphore to give, NULL to stop notifications
+*/
+static void PIOS_USART_RxNotify(uint32_t usart_id, uint8_t delimiter, xSemaphoreHandle sem);
+#endif
 
 const struct pios_com_driver pios_usart_com_driver = {
 	.set_baud = PIOS_USART_ChangeBaud,
@@ -49,6 +60,10 @@ const struct pios_com_driver pios_usart_com_driver = {
 	.tx       = PIOS_USART_TxBufferPutMore,
 	.rx       = PIOS_USART_RxBufferGet,
 	.rx_avail = PIOS_USART_RxBufferUsed,
+	.rx_more  = PIOS_USART_RxBufferGetMore,
+#if defined(PIOS_INCLUDE_FREERTOS)
+	.rx_notify = PIOS_USART_RxNotify,
+#endif
 };
 
 enum pios_usart_dev_magic {
@@ -66,6 +81,12 @@ struct pios_usart_dev {
 	// align to 32-bit to try and provide speed improvement;
         uint8_t tx_buffer[PIOS_USART_TX_BUFFER_SIZE] __attribute__ ((aligned(4)));
 	t_fifo_buffer tx;
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+	// given from the interrupt when the delimiter is received
+	xSemaphoreHandle rx_sem;
+	uint8_t rx_delimiter;
+#endif
 };
 
 static bool PIOS_USART_validate(struct pios_usart_dev * usart_dev)
@@ -151,6 +172,10 @@ int32_t PIOS_USART_Init(uint32_t * usart_id, const struct pios_usart_cfg * cfg)
 	fifoBuf_init(&usart_dev->rx, usart_dev->rx_buffer, sizeof(usart_dev->rx_buffer));
 	fifoBuf_init(&usart_dev->tx, usart_dev->tx_buffer, sizeof(usart_dev->tx_buffer));
 
+#if defined(PIOS_INCLUDE_FREERTOS)
+	usart_dev->rx_sem = NULL;
+#endif
+
 	/* Enable the USART Pins Software Remapping */
 	if (usart_dev->cfg->remap) {
 		GPIO_PinRemapConfig(usart_dev->cfg->remap, ENABLE);
@@ -281,6 +306,46 @@ static int32_t PIOS_USART_RxBufferGet(uint32_t usart_id)
 	return b;
 }
 
+/**
+* Gets up to len bytes from the receive buffer
+* \param[in] USART USART name
+* \param[out] buffer where the received bytes are copied to
+* \param[in] len size of buffer
+* \return number of bytes copied, 0 if nothing new
+*/
+static int32_t PIOS_USART_RxBufferGetMore(uint32_t usart_id, uint8_t *buffer, uint16_t len)
+{
+	struct pios_usart_dev * usart_dev = (struct pios_usart_dev *)usart_id;
+
+	bool valid = PIOS_USART_validate(usart_dev);
+	PIOS_Assert(valid)
+
+	/* get bytes - only the interrupt writes to the buffer, it never moves the read pointer */
+	return fifoBuf_getData(&usart_dev->rx, buffer, len);
+}
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+/**
+* Sets the semaphore the receive interrupt gives when the delimiter
+* byte arrives or the receive buffer is half full
+* \param[in] USART USART name
+* \param[in] delimiter byte which ends a message
+* \param[in] sem semaphore to give, NULL to stop notifications
+*/
+static void PIOS_USART_RxNotify(uint32_t usart_id, uint8_t delimiter, xSemaphoreHandle sem)
+{
+	struct pios_usart_dev * usart_dev = (struct pios_usart_dev *)usart_id;
+
+	bool valid = PIOS_USART_validate(usart_dev);
+	PIOS_Assert(valid)
+
+	PIOS_IRQ_Disable();
+	usart_dev->rx_delimiter = delimiter;
+	usart_dev->rx_sem = sem;
+	PIOS_IRQ_Enable();
+}
+#endif
+
 /**
 * puts a byte onto the receive buffer
 * \param[in] USART USART name
@@ -430,6 +495,16 @@ static void PIOS_USART_generic_irq_handler(uint32_t usart_id)
 		if (PIOS_USART_RxBufferPut(usart_id, dr) < 0) {
 			/* Here we could add some error handling */
 		}
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+		/* Wake the reader at the end of a message, or before the buffer overflows */
+		if (usart_dev->rx_sem &&
+		    (dr == usart_dev->rx_delimiter || fifoBuf_getUsed(&usart_dev->rx) >= sizeof(usart_dev->rx_buffer) / 2)) {
+			portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+			xSemaphoreGiveFromISR(usart_dev->rx_sem, &xHigherPriorityTaskWoken);
+			portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+		}
+#endif
 	}
 
 	/* Check if TXE flag is set */
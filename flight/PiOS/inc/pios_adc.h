@@ -37,6 +37,31 @@
 
 typedef void (*ADCCallback) (float * data);
 
+#if defined(PIOS_INCLUDE_FREERTOS)
+/* Depth of the sample FIFO, must be a power of two */
+#define PIOS_ADC_FIFO_DEPTH 16
+
+/* One downsampled block */
+struct pios_adc_sample {
+	uint32_t timestamp;	/* PIOS_DELAY_GetTimeuS() when the oversampled block completed */
+	float data[PIOS_ADC_NUM_CHANNELS];
+};
+
+/*
+ * Single producer / single consumer ring of samples.  The ADC interrupt only
+ * writes head and the consumer only writes tail, so no locking is needed.
+ * The ready semaphore is given once per batch of samples rather than per sample.
+ */
+struct pios_adc_fifo {
+	volatile uint16_t head;
+	volatile uint16_t tail;
+	volatile uint16_t overruns;	/* Samples dropped because the consumer fell behind */
+	uint16_t batch;
+	xSemaphoreHandle ready;
+	struct pios_adc_sample samples[PIOS_ADC_FIFO_DEPTH];
+};
+#endif
+
 /* Public Functions */
 void PIOS_ADC_Init();
 void PIOS_ADC_Config(uint32_t oversampling);
@@ -45,7 +70,8 @@ int16_t * PIOS_ADC_GetRawBuffer(void);
 uint8_t PIOS_ADC_GetOverSampling(void);
 void PIOS_ADC_SetCallback(ADCCallback new_function);
 #if defined(PIOS_INCLUDE_FREERTOS)
-void PIOS_ADC_SetQueue(xQueueHandle data_queue);
+int32_t PIOS_ADC_SetFifo(struct pios_adc_fifo * fifo, uint16_t batch);
+uint16_t PIOS_ADC_FifoRead(struct pios_adc_fifo * fifo, struct pios_adc_sample * samples, uint16_t max_samples);
 #endif
 extern void PIOS_ADC_DMA_Handler(void);
 
@@ -46,7 +46,7 @@ struct pios_adc_dev {
 	const struct pios_adc_cfg *const cfg;	
 	ADCCallback callback_function;
 #if defined(PIOS_INCLUDE_FREERTOS)
-	xQueueHandle data_queue;
+	struct pios_adc_fifo * fifo;
 #endif
 	volatile int16_t *valid_data_buffer;
 	volatile uint8_t adc_oversample;
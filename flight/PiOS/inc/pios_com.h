@@ -39,6 +39,10 @@ struct pios_com_driver {
 	int32_t (*tx)(uint32_t id, const uint8_t *buffer, uint16_t len);
 	int32_t (*rx)(uint32_t id);
 	int32_t (*rx_avail)(uint32_t id);
+	int32_t (*rx_more)(uint32_t id, uint8_t *buffer, uint16_t len);
+#if defined(PIOS_INCLUDE_FREERTOS)
+	void    (*rx_notify)(uint32_t id, uint8_t delimiter, xSemaphoreHandle sem);
+#endif
 };
 
 /* Public Functions */
@@ -54,6 +58,10 @@ extern int32_t PIOS_COM_SendFormattedStringNonBlocking(uint32_t com_id, const ch
 extern int32_t PIOS_COM_SendFormattedString(uint32_t com_id, const char *format, ...);
 extern uint8_t PIOS_COM_ReceiveBuffer(uint32_t com_id);
 extern int32_t PIOS_COM_ReceiveBufferUsed(uint32_t com_id);
+extern int32_t PIOS_COM_ReceiveBufferMore(uint32_t com_id, uint8_t *buffer, uint16_t len);
+#if defined(PIOS_INCLUDE_FREERTOS)
+extern int32_t PIOS_COM_ReceiveNotify(uint32_t com_id, uint8_t delimiter, xSemaphoreHandle sem);
+#endif
 
 #endif /* PIOS_COM_H */
 
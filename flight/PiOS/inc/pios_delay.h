@@ -38,6 +38,8 @@ extern int32_t PIOS_DELAY_WaituS(uint16_t uS);
 extern int32_t PIOS_DELAY_WaitmS(uint16_t mS);
 extern uint16_t PIOS_DELAY_GetuS();
 extern int32_t PIOS_DELAY_DiffuS(uint16_t ref);
+extern uint32_t PIOS_DELAY_GetTimeuS(void);
+extern uint32_t PIOS_DELAY_GetuSSince(uint32_t ref);
 
 #endif /* PIOS_DELAY_H */
 
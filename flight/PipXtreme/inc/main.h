@@ -60,6 +60,8 @@ enum {
 
 // *****************************************************************************
 
+extern volatile uint32_t    uptime_ms;
+
 extern volatile uint32_t    random32;
 
 extern bool                 booting;
@@ -35,6 +35,7 @@
 //  1-byte  packet type
 //  1-byte  tx sequence value
 //  1-byte  rx sequence value
+//  1-byte  selective ack bits
 //  1-byte  data size
 //  4-byte  crc of entire packet not including CBC bytes
 
@@ -46,9 +47,16 @@
 //  1-byte  packet type
 //  1-byte  tx sequence value
 //  1-byte  rx sequence value
+//  1-byte  selective ack bits
 //  1-byte  data size
 //  4-byte  crc of entire packet not including the null byte
 
+
+// data is sent with a selective repeat sliding window .. up to PH_WINDOW_SIZE data packets can be in flight.
+// 'tx seq' is the sequence number of a data packet, 'rx seq' is the sequence number of the next data packet
+// the sender expects (a cumulative ack of everything before it), and bit n of the selective ack bits is set if
+// the sender also holds data packet 'rx seq + 1 + n'. only the packets that got lost are ever sent again.
+
 // ********
 
 #include <string.h>	// memmove
@@ -80,6 +88,8 @@ const uint8_t default_aes_key[AES_BLOCK_SIZE] = {0x65, 0x3b, 0x71, 0x89, 0x4a, 0
 
 #define RETRY_RECONNECT_COUNT           60      // if transmission retries this many times then reset the link to the remote modem
 
+#define PH_WINDOW_SIZE                  4       // max number of un-acked data packets in flight .. must be a power of 2 and no more than 8
+
 #define PACKET_TYPE_DATA_COMP_BIT       0x80    // data compressed bit. if set then the data in the packet is compressed
 #define PACKET_TYPE_MASK                0x7f    // packet type mask
 
@@ -122,6 +132,7 @@ typedef struct
     uint8_t             type;
     uint8_t             tx_seq;
     uint8_t             rx_seq;
+    uint8_t             sack;
     uint8_t             data_size;
     uint32_t            crc;
 } __attribute__((__packed__)) t_packet_header;
@@ -144,6 +155,8 @@ typedef struct
 
 //#pragma pack(pop)
 
+#define PH_MAX_DATA_SIZE                sizeof(((t_unencrypted_packet *)0)->data)
+
 // *****************************************************************************
 // link state for each remote connection
 
@@ -153,6 +166,27 @@ enum {
 	LINK_CONNECTED
 };
 
+// a data packet we have sent and not yet had acked .. the data stays in the tx fifo buffer until it's acked
+typedef struct
+{
+    uint8_t             seq;                            // the packets sequence number
+    uint8_t             data_size;                      // the number of user data bytes in the packet
+    bool                sent;                           // TRUE once it has been transmitted
+    bool                acked;                          // TRUE once they have selectively acked it
+    bool                resend;                         // TRUE if it needs sending again as soon as possible
+    uint32_t            sent_ms;                        // uptime_ms when it was last transmitted .. a timestamp so that the tick interrupt never writes to the slots
+    uint16_t            timeout;                        // ms .. resend it if it's not been acked by this time
+} t_tx_slot;
+
+// a data packet received out of order, held until the packets before it arrive
+typedef struct
+{
+    bool                used;
+    uint8_t             seq;                            // the packets sequence number
+    uint8_t             data_size;                      // the number of user data bytes in the packet
+    uint8_t             data[PH_MAX_DATA_SIZE];
+} t_rx_slot;
+
 typedef struct
 {
     uint32_t            serial_number;                  // their serial number
@@ -165,10 +199,12 @@ typedef struct
 
     uint8_t             link_state;                     // holds our current RF link state
 
-    uint8_t             tx_sequence;                    // incremented with each data packet transmitted, sent in every packet transmitted
-    uint8_t             tx_sequence_data_size;          // the size of data we sent in our last packet
+    uint8_t             tx_sequence;                    // sequence number of our oldest un-acked data packet (the start of our transmit window)
+    t_tx_slot           tx_slot[PH_WINDOW_SIZE];        // our data packets in flight, tx_slot[n] holds packet 'tx_sequence + n'
+    uint8_t             tx_slots_used;                  // the number of data packets in flight
 
-    uint8_t             rx_sequence;                    // incremented with each data packet received contain data, sent in every packet transmitted
+    uint8_t             rx_sequence;                    // sequence number of the next data packet we expect, sent in every packet transmitted
+    t_rx_slot           rx_slot[PH_WINDOW_SIZE];        // data packets received out of order, rx_slot[seq % PH_WINDOW_SIZE] holds packet 'seq'
 
     volatile uint16_t   tx_packet_timer;                // ms .. used for packet timing
 
@@ -271,6 +307,189 @@ uint16_t ph_getData(const int connection_index, void *data, uint16_t len)
     return fifoBuf_getData(&connection[connection_index].rx_fifo_buffer, data, len);
 }
 
+// *****************************************************************************
+// sliding window functions
+
+void ph_resetWindows(t_connection *conn)
+{	// forget any packets in flight .. the un-acked data is still in the tx fifo buffer and gets sent again
+    conn->tx_sequence = 0;
+    conn->tx_slots_used = 0;
+
+    conn->rx_sequence = 0;
+    for (int i = 0; i < PH_WINDOW_SIZE; i++)
+      conn->rx_slot[i].used = false;
+}
+
+uint16_t ph_txDataInFlight(t_connection *conn, int slots)
+{	// return the number of user data bytes held by the first 'slots' tx slots
+    uint16_t size = 0;
+
+    for (int i = 0; i < slots; i++)
+      size += conn->tx_slot[i].data_size;
+
+    return size;
+}
+
+uint16_t ph_txDataUnsent(t_connection *conn)
+{	// return the number of user data bytes waiting to be sent that are not yet in a data packet
+    return fifoBuf_getUsed(&conn->tx_fifo_buffer) - ph_txDataInFlight(conn, conn->tx_slots_used);
+}
+
+int ph_nextTxSlot(t_connection *conn)
+{	// return the tx slot of the data packet to send next, or -1 if there is nothing to send
+
+    // resend lost packets first .. oldest first
+    for (int i = 0; i < conn->tx_slots_used; i++)
+    {
+        t_tx_slot *slot = &conn->tx_slot[i];
+        if (!slot->acked && (slot->resend || uptime_ms - slot->sent_ms >= slot->timeout))
+          return i;
+    }
+
+    if (conn->tx_slots_used >= PH_WINDOW_SIZE)
+      return -1;	// window is full
+
+    // give the remote modem a chance to ack the packet we just sent before we send another
+    if (conn->tx_slots_used > 0 && conn->tx_packet_timer < conn->tx_retry_time_slot_len / 4)
+      return -1;
+
+    uint16_t size = ph_txDataUnsent(conn);
+    if (size == 0)
+      return -1;	// no data to send
+
+    if (size < 200 && conn->ready_to_send_timer < saved_settings.rts_time)
+      return -1;	// wait a bit for more data to mount up
+
+    // put the data into a new packet
+    uint16_t max_data_size = conn->send_encrypted ? sizeof(((t_encrypted_packet *)0)->data) : PH_MAX_DATA_SIZE;
+    if (size > max_data_size)
+      size = max_data_size;
+
+    int i = conn->tx_slots_used++;
+    t_tx_slot *slot = &conn->tx_slot[i];
+    slot->seq = conn->tx_sequence + i;
+    slot->data_size = size;
+    slot->sent = false;
+    slot->acked = false;
+    slot->resend = false;
+    slot->sent_ms = 0;
+    slot->timeout = 0;
+
+    return i;
+}
+
+void ph_processAck(t_connection *conn, uint8_t rx_seq, uint8_t sack)
+{	// they have told us which of our data packets they have received
+
+    uint8_t acked = rx_seq - conn->tx_sequence;
+    if (acked > conn->tx_slots_used)
+      return;	// not one of ours .. ignore it
+
+    if (acked > 0)
+    {	// remove the data they have received in order
+        fifoBuf_removeData(&conn->tx_fifo_buffer, ph_txDataInFlight(conn, acked));
+
+        conn->tx_slots_used -= acked;
+        memmove(&conn->tx_slot[0], &conn->tx_slot[acked], conn->tx_slots_used * sizeof(t_tx_slot));
+
+        conn->tx_sequence = rx_seq;
+        conn->tx_retry_counter = 0;
+        conn->not_ready_timer = -1;	// stop timer
+    }
+
+    // tx_slot[0] is now packet 'rx_seq', so bit n of the selective acks is tx_slot[n + 1]
+    uint32_t now = uptime_ms;
+    uint32_t newest = 0xffffffff;	// time since we sent the most recent packet they have received
+    for (int i = 1; i < conn->tx_slots_used; i++)
+    {
+        t_tx_slot *slot = &conn->tx_slot[i];
+        if (sack & (1u << (i - 1)))
+        {
+            slot->acked = true;
+            if (now - slot->sent_ms < newest)
+              newest = now - slot->sent_ms;
+        }
+    }
+
+    // any packet sent before one they have received has been lost .. resend it now rather than waiting for it to time out
+    for (int i = 0; i < conn->tx_slots_used; i++)
+    {
+        t_tx_slot *slot = &conn->tx_slot[i];
+        if (slot->sent && !slot->acked && now - slot->sent_ms > newest)
+          slot->resend = true;
+    }
+}
+
+uint8_t ph_rxSack(t_connection *conn)
+{	// return the selective ack bits of the data packets we are holding out of order
+    uint8_t sack = 0;
+
+    for (int i = 0; i < PH_WINDOW_SIZE - 1; i++)
+    {
+        uint8_t seq = conn->rx_sequence + 1 + i;
+        t_rx_slot *slot = &conn->rx_slot[seq % PH_WINDOW_SIZE];
+        if (slot->used && slot->seq == seq)
+          sack |= 1u << i;
+    }
+
+    return sack;
+}
+
+void ph_deliverRxData(t_connection *conn)
+{	// move the held data packets that are now in order into our rx fifo buffer
+    while (TRUE)
+    {
+        t_rx_slot *slot = &conn->rx_slot[conn->rx_sequence % PH_WINDOW_SIZE];
+        if (!slot->used || slot->seq != conn->rx_sequence)
+          break;
+
+        if (fifoBuf_getFree(&conn->rx_fifo_buffer) < slot->data_size)
+          break;	// no room yet
+
+        fifoBuf_putData(&conn->rx_fifo_buffer, slot->data, slot->data_size);
+        slot->used = false;
+        conn->rx_sequence++;
+    }
+}
+
+void ph_receiveData(t_connection *conn, uint8_t seq, const uint8_t *data, uint16_t data_size)
+{	// save the data from a received data packet
+
+    uint8_t offset = seq - conn->rx_sequence;
+    if (offset >= PH_WINDOW_SIZE)
+      return;	// we already have it (our ack got lost) or it's outside our window
+
+    if (offset > 0)
+    {	// received out of order .. hold it until the packets before it arrive
+        t_rx_slot *slot = &conn->rx_slot[seq % PH_WINDOW_SIZE];
+        if (!slot->used)
+        {
+            conn->rx_data_speed_count += data_size * 8;	// + the number of data bits we just received
+
+            slot->used = true;
+            slot->seq = seq;
+            slot->data_size = data_size;
+            memmove(slot->data, data, data_size);
+        }
+        return;
+    }
+
+    if (fifoBuf_getFree(&conn->rx_fifo_buffer) < data_size)
+    {	// error .. we don't have enough space left in our fifo buffer to save the data .. discard it, they will send it again
+//      conn->rx_not_ready_mode = true;
+        return;
+    }
+
+    conn->rx_data_speed_count += data_size * 8;	// + the number of data bits we just received
+
+    // save the received data into our fifo buffer
+    fifoBuf_putData(&conn->rx_fifo_buffer, data, data_size);
+    conn->rx_sequence++;
+    conn->rx_not_ready_mode = false;
+
+    ph_deliverRxData(conn);
+}
+
 // *****************************************************************************
 // start a connection to another modem
 
@@ -289,9 +508,7 @@ int ph_startConnect(int connection_index, uint32_t sn)
 
 	conn->serial_number = sn;
 
-    conn->tx_sequence = 0;
-    conn->tx_sequence_data_size = 0;
-    conn->rx_sequence = 0;
+    ph_resetWindows(conn);
 
 //    fifoBuf_init(&conn->tx_fifo_buffer, conn->tx_buffer, PH_FIFO_BUFFER_SIZE);
 //    fifoBuf_init(&conn->rx_fifo_buffer, conn->rx_buffer, PH_FIFO_BUFFER_SIZE);
@@ -369,12 +586,15 @@ bool ph_RxDataCallback(void *data, uint8_t len)
 
 // *****************************************************************************
 // transmit a packet
+//
+// data packets send the data held by tx slot 'slot_index', other packet types pass -1
 
-bool ph_sendPacket(int connection_index, bool encrypt, uint8_t packet_type, bool send_immediately)
+bool ph_sendPacket(int connection_index, bool encrypt, uint8_t packet_type, int slot_index, bool send_immediately)
 {
   uint8_t key[AES_BLOCK_SIZE];
 
   t_connection *conn = NULL;
+  t_tx_slot *slot = NULL;
 
   // ***********
 
@@ -426,18 +646,16 @@ bool ph_sendPacket(int connection_index, bool encrypt, uint8_t packet_type, bool
 
   uint16_t data_size = 0;
 
-  if (data_packet && conn)
+  if (data_packet)
   {	// we're adding user data to the packet
-      data_size = fifoBuf_getUsed(&connection[connection_index].tx_fifo_buffer);	// the number of data bytes waiting to be sent
+      if (slot_index < 0 || slot_index >= conn->tx_slots_used)
+        return false;
 
-      if (data_size > max_data_size)
-        data_size = max_data_size;
+      slot = &conn->tx_slot[slot_index];
 
-      if (conn->tx_sequence_data_size > 0)
-      {	// we are re-sending data the same data
-          if (data_size > conn->tx_sequence_data_size)
-            data_size = conn->tx_sequence_data_size;
-      }
+      data_size = slot->data_size;
+      if (data_size > max_data_size)
+        return false;	// the packet was made for unencrypted packets
   }
 
   // ******************
@@ -481,8 +699,9 @@ bool ph_sendPacket(int connection_index, bool encrypt, uint8_t packet_type, bool
 //      header->destination_id = BROADCAST_ADDR;					// broadcast packet
   header->destination_id = conn->serial_number;				// the other modems serial number
   header->type = packet_type;									// packet type
-  header->tx_seq = conn->tx_sequence;							// our TX sequence number
+  header->tx_seq = slot ? slot->seq : conn->tx_sequence;		// our TX sequence number
   header->rx_seq = conn->rx_sequence;							// our RX sequence number
+  header->sack = ph_rxSack(conn);								// the data packets we have received out of order
   header->data_size = data_size;								// the number of user data bytes in the packet
   header->crc = 0;											// the CRC of the header and user data bytes
 
@@ -490,16 +709,14 @@ bool ph_sendPacket(int connection_index, bool encrypt, uint8_t packet_type, bool
   // add the user data to the packet
 
   if (data_packet)
-  {	// we're adding user data to the packet
-      fifoBuf_getDataPeek(&connection[connection_index].tx_fifo_buffer, data, data_size);
+  {	// we're adding user data to the packet .. it's behind the data held by the slots before this one
+      fifoBuf_getDataPeekOffset(&conn->tx_fifo_buffer, ph_txDataInFlight(conn, slot_index), data, data_size);
 
       if (encrypt)
       {	// zero unused bytes
           if (data_size < max_data_size)
             memset(data + data_size, 0, max_data_size - data_size);
       }
-
-      conn->tx_sequence_data_size = data_size;	// remember how much data we are sending in this packet
   }
 
   // ******************
@@ -538,8 +755,21 @@ bool ph_sendPacket(int connection_index, bool encrypt, uint8_t packet_type, bool
 
   // ******************
 
-  if (data_size > 0 && conn->tx_retry_counter == 0)
-    conn->tx_data_speed_count += data_size * 8;	// + the number of data bits we just sent .. used for calculating the transmit data rate
+  if (slot && res >= packet_size)
+  {
+      if (!slot->sent)
+        conn->tx_data_speed_count += data_size * 8;	// + the number of data bits we just sent .. used for calculating the transmit data rate
+      else
+      if (conn->tx_retry_counter < 0xffff)
+        conn->tx_retry_counter++;					// we are re-sending it
+
+      slot->sent = true;
+      slot->resend = false;
+      slot->sent_ms = uptime_ms;
+
+      // allow for the packets that may be sent after this one and their acks
+      slot->timeout = conn->tx_retry_time_slot_len * (2 + PH_WINDOW_SIZE) + (random32 % conn->tx_retry_time_slots) * conn->tx_retry_time_slot_len;
+  }
 
   // ******************
   // debug stuff
@@ -567,7 +797,7 @@ bool ph_sendPacket(int connection_index, bool encrypt, uint8_t packet_type, bool
     case PACKET_TYPE_ADJUST_TX_PWR_ACK: DEBUG_PRINTF("PACKET_TYPE_ADJUST_TX_PWR_ACK"); break;
     default:                            DEBUG_PRINTF("UNKNOWN [%d]", pack_type); break;
   }
-  DEBUG_PRINTF(" tseq:%d rseq:%d", conn->tx_sequence, conn->rx_sequence);
+  DEBUG_PRINTF(" tseq:%d rseq:%d sack:%02X", header->tx_seq, header->rx_seq, header->sack);
   DEBUG_PRINTF(" drate:%dbps", conn->tx_data_speed);
   if (data_size > 0) DEBUG_PRINTF(" data_size:%d", data_size);
   if (conn->tx_retry_counter > 0) DEBUG_PRINTF(" retry:%d", conn->tx_retry_counter);
@@ -580,9 +810,7 @@ bool ph_sendPacket(int connection_index, bool encrypt, uint8_t packet_type, bool
   {
     case PACKET_TYPE_CONNECT:
     case PACKET_TYPE_DISCONNECT:
-    case PACKET_TYPE_DATA:
     case PACKET_TYPE_READY:
-    case PACKET_TYPE_NOTREADY:
     case PACKET_TYPE_DATARATE:
     case PACKET_TYPE_PING:
     case PACKET_TYPE_ADJUST_TX_PWR:
@@ -590,6 +818,10 @@ bool ph_sendPacket(int connection_index, bool encrypt, uint8_t packet_type, bool
         conn->tx_retry_counter++;
       break;
 
+    case PACKET_TYPE_DATA:
+    case PACKET_TYPE_NOTREADY:
+      break;	// counted above, only when re-sent
+
     case PACKET_TYPE_CONNECT_ACK:
     case PACKET_TYPE_DATA_ACK:
     case PACKET_TYPE_READY_ACK:
@@ -665,7 +897,7 @@ void ph_processPacket2(bool was_encrypted, t_packet_header *header, uint8_t *dat
     case PACKET_TYPE_ADJUST_TX_PWR_ACK: DEBUG_PRINTF("PACKET_TYPE_ADJUST_TX_PWR_ACK"); break;
     default:                            DEBUG_PRINTF("UNKNOWN [%d]", packet_type); break;
   }
-  DEBUG_PRINTF(" tseq-%d rseq-%d", header->tx_seq, header->rx_seq);
+  DEBUG_PRINTF(" tseq-%d rseq-%d sack-%02X", header->tx_seq, header->rx_seq, header->sack);
 //      DEBUG_PRINTF(" drate:%dbps", conn->rx_data_speed);
   if (data_size > 0) DEBUG_PRINTF(" data_size:%d", data_size);
   DEBUG_PRINTF(" %ddBm", rx_rssi_dBm);
@@ -714,7 +946,7 @@ void ph_processPacket2(bool was_encrypted, t_packet_header *header, uint8_t *dat
 
       if (packet_type != PACKET_TYPE_NONE)
       {	// send a disconnect packet back to them
-//              ph_sendPacket(-1, was_encrypted, PACKET_TYPE_DISCONNECT, true);
+//              ph_sendPacket(-1, was_encrypted, PACKET_TYPE_DISCONNECT, -1, true);
       }
 
       return;
@@ -763,9 +995,8 @@ void ph_processPacket2(bool was_encrypted, t_packet_header *header, uint8_t *dat
       conn->tx_retry_counter = 0;
       conn->tx_retry_time = conn->tx_retry_time_slot_len + (random32 % conn->tx_retry_time_slots) * conn->tx_retry_time_slot_len;
 
+      ph_resetWindows(conn);
       conn->rx_sequence = header->tx_seq;
-      conn->tx_sequence = 0;
-      conn->tx_sequence_data_size = 0;
 
       conn->data_speed_timer = 0;
       conn->tx_data_speed_count = 0;
@@ -786,7 +1017,7 @@ void ph_processPacket2(bool was_encrypted, t_packet_header *header, uint8_t *dat
       conn->link_state = LINK_CONNECTED;
 
       // send an ack back
-      if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_CONNECT_ACK, true))
+      if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_CONNECT_ACK, -1, true))
       {
           conn->tx_packet_timer = 0;
       }
@@ -809,9 +1040,8 @@ void ph_processPacket2(bool was_encrypted, t_packet_header *header, uint8_t *dat
       conn->tx_retry_counter = 0;
       conn->tx_retry_time = conn->tx_retry_time_slot_len + (random32 % conn->tx_retry_time_slots) * conn->tx_retry_time_slot_len;
 
+      ph_resetWindows(conn);
       conn->rx_sequence = header->tx_seq;
-      conn->tx_sequence = 0;
-      conn->tx_sequence_data_size = 0;
 
       conn->data_speed_timer = 0;
       conn->tx_data_speed_count = 0;
@@ -839,7 +1069,7 @@ void ph_processPacket2(bool was_encrypted, t_packet_header *header, uint8_t *dat
 
   if (conn->link_state == LINK_CONNECTING)
   {	// we are trying to connect to them .. reply with a connect request packet
-      if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_CONNECT, true))
+      if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_CONNECT, -1, true))
       {
           conn->tx_packet_timer = 0;
           conn->tx_retry_time = conn->tx_retry_time_slot_len * 4 + (random32 % conn->tx_retry_time_slots) * conn->tx_retry_time_slot_len * 4;
@@ -880,84 +1110,54 @@ void ph_processPacket2(bool was_encrypted, t_packet_header *header, uint8_t *dat
 
 
 
-  if ((conn->tx_sequence_data_size > 0) && (header->rx_seq == (uint8_t)(conn->tx_sequence + 1)))
-  {	// they received our last data packet
-
-      // remove the data we have sent and they have acked
-      fifoBuf_removeData(&conn->tx_fifo_buffer, conn->tx_sequence_data_size);
-
-      conn->tx_sequence++;
-      conn->tx_retry_counter = 0;
-      conn->tx_sequence_data_size = 0;
-      conn->not_ready_timer = -1;	// stop timer
-  }
-
-  uint16_t size = fifoBuf_getUsed(&conn->tx_fifo_buffer);	// the size of data waiting to be sent
-
-
-
+  // every packet carries their acks of our data packets
+  ph_processAck(conn, header->rx_seq, header->sack);
 
-  if (packet_type == PACKET_TYPE_DATA || packet_type == PACKET_TYPE_DATA_ACK)
+  if (packet_type == PACKET_TYPE_DATA || packet_type == PACKET_TYPE_NOTREADY)
   {
-      if (packet_type == PACKET_TYPE_DATA && header->tx_seq == conn->rx_sequence)
-      {	// the packet number is what we expected
-
-          if (data_size > 0)
-          {	// save the data
-
-              conn->rx_data_speed_count += data_size * 8;	// + the number of data bits we just received
-
-              uint16_t num = fifoBuf_getFree(&conn->rx_fifo_buffer);
-              if (num < data_size)
-              {	// error .. we don't have enough space left in our fifo buffer to save the data .. discard it and tell them to hold off a sec
-//                      conn->rx_not_ready_mode = true;
-              }
-              else
-              {	// save the received data into our fifo buffer
-                  fifoBuf_putData(&conn->rx_fifo_buffer, data, data_size);
-                  conn->rx_sequence++;
-                  conn->rx_not_ready_mode = false;
-              }
-          }
-      }
+      if (data_size > 0)
+        ph_receiveData(conn, header->tx_seq, data, data_size);
 
-      if (size >= 200 || (conn->ready_to_send_timer >= 10 && size > 0) || (conn->tx_sequence_data_size > 0 && size > 0))
-      {	// send data
+      // send data back if we have some .. the ack goes with it
+      int slot = ph_nextTxSlot(conn);
+      if (slot >= 0)
+      {
           uint8_t pack_type = PACKET_TYPE_DATA;
           if (conn->rx_not_ready_mode)
             pack_type = PACKET_TYPE_NOTREADY;
 
-          if (ph_sendPacket(connection_index, conn->send_encrypted, pack_type, true))
+          if (ph_sendPacket(connection_index, conn->send_encrypted, pack_type, slot, true))
           {
               conn->tx_packet_timer = 0;
-              conn->tx_retry_time = conn->tx_retry_time_slot_len + (random32 % conn->tx_retry_time_slots) * conn->tx_retry_time_slot_len;
               return;
           }
       }
 
-      if (packet_type == PACKET_TYPE_DATA)
-      {	// send an ack back
-          uint8_t pack_type = PACKET_TYPE_DATA_ACK;
-          if (conn->rx_not_ready_mode)
-            pack_type = PACKET_TYPE_NOTREADY_ACK;
+      // send an ack back
+      uint8_t pack_type = PACKET_TYPE_DATA_ACK;
+      if (packet_type == PACKET_TYPE_NOTREADY || conn->rx_not_ready_mode)
+        pack_type = PACKET_TYPE_NOTREADY_ACK;
 
-          if (ph_sendPacket(connection_index, conn->send_encrypted, pack_type, true))
-          {
-              conn->tx_packet_timer = 0;
-              conn->tx_retry_time = conn->tx_retry_time_slot_len + (random32 % conn->tx_retry_time_slots) * conn->tx_retry_time_slot_len;
-              return;
-          }
+      if (ph_sendPacket(connection_index, conn->send_encrypted, pack_type, -1, true))
+      {
+          conn->tx_packet_timer = 0;
+          conn->tx_retry_time = conn->tx_retry_time_slot_len + (random32 % conn->tx_retry_time_slots) * conn->tx_retry_time_slot_len;
       }
 
       return;
   }
 
+  if (packet_type == PACKET_TYPE_DATA_ACK)
+  {
+      return;
+  }
+
   if (packet_type == PACKET_TYPE_READY)
   {
       conn->not_ready_timer = -1;	// stop timer
 
       // send an ack back
-      if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_READY_ACK, true))
+      if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_READY_ACK, -1, true))
       {
           conn->tx_packet_timer = 0;
           conn->tx_retry_time = conn->tx_retry_time_slot_len * 4 + (random32 % conn->tx_retry_time_slots) * conn->tx_retry_time_slot_len * 4;
@@ -973,43 +1173,6 @@ void ph_processPacket2(bool was_encrypted, t_packet_header *header, uint8_t *dat
       return;
   }
 
-  if (packet_type == PACKET_TYPE_NOTREADY)
-  {
-//      conn->not_ready_timer = 0;	// start timer
-
-      if (header->tx_seq == conn->rx_sequence)
-      {	// the packet number is what we expected
-
-          if (data_size > 0)
-          {	// save the data
-
-              conn->rx_data_speed_count += data_size * 8;	// + the number of data bits we just received
-
-              uint16_t num = fifoBuf_getFree(&conn->rx_fifo_buffer);
-              if (num < data_size)
-              {	// error .. we don't have enough space left in our fifo buffer to save the data .. discard it and tell them to hold off a sec
-//              conn->rx_not_ready_mode = true;
-              }
-              else
-              {	// save the received data into our fifo buffer
-                  fifoBuf_putData(&conn->rx_fifo_buffer, data, data_size);
-                  conn->rx_sequence++;
-                  conn->rx_not_ready_mode = false;
-              }
-          }
-      }
-
-      // send an ack back
-      if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_NOTREADY_ACK, true))
-      {
-          conn->tx_packet_timer = 0;
-          conn->tx_retry_time = conn->tx_retry_time_slot_len * 4 + (random32 % conn->tx_retry_time_slots) * conn->tx_retry_time_slot_len * 4;
-          return;
-      }
-
-      return;
-  }
-
   if (packet_type == PACKET_TYPE_NOTREADY_ACK)
   {
       return;
@@ -1017,7 +1180,7 @@ void ph_processPacket2(bool was_encrypted, t_packet_header *header, uint8_t *dat
 
   if (packet_type == PACKET_TYPE_PING)
   {	// send a pong back
-      if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_PONG, true))
+      if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_PONG, -1, true))
       {
           conn->tx_packet_timer = 0;
           conn->tx_retry_time = conn->tx_retry_time_slot_len + (random32 % conn->tx_retry_time_slots) * conn->tx_retry_time_slot_len;
@@ -1038,7 +1201,7 @@ void ph_processPacket2(bool was_encrypted, t_packet_header *header, uint8_t *dat
   if (packet_type == PACKET_TYPE_DATARATE)
   {
       // send an ack back
-      if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_DATARATE_ACK, true))
+      if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_DATARATE_ACK, -1, true))
       {
           conn->tx_packet_timer = 0;
           conn->tx_retry_time = conn->tx_retry_time_slot_len + (random32 % conn->tx_retry_time_slots) * conn->tx_retry_time_slot_len;
@@ -1054,7 +1217,7 @@ void ph_processPacket2(bool was_encrypted, t_packet_header *header, uint8_t *dat
   if (packet_type == PACKET_TYPE_ADJUST_TX_PWR)
   {
       // send an ack back
-      if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_ADJUST_TX_PWR_ACK, true))
+      if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_ADJUST_TX_PWR_ACK, -1, true))
       {
           conn->tx_packet_timer = 0;
           conn->tx_retry_time = conn->tx_retry_time_slot_len + (random32 % conn->tx_retry_time_slots) * conn->tx_retry_time_slot_len;
@@ -1184,12 +1347,13 @@ void ph_processRxPacket(void)
       for (int i = 0; i < AES_BLOCK_SIZE; i++)
         DEBUG_PRINTF("%02X", encrypted_packet->cbc[i]);
   }
-  DEBUG_PRINTF(" %08X %08X %u %u %u %u %08X\r\n",
+  DEBUG_PRINTF(" %08X %08X %u %u %u %02X %u %08X\r\n",
       header->source_id,
       header->destination_id,
       header->type,
       header->tx_seq,
       header->rx_seq,
+      header->sack,
       header->data_size,
       header->crc);
 
@@ -1292,7 +1456,7 @@ void ph_processLinks(int connection_index)
       if (!timeToRetry)
         break;
 
-      if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_CONNECT, false))
+      if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_CONNECT, -1, false))
       {
           conn->tx_packet_timer = 0;
           conn->tx_retry_time = conn->tx_retry_time_slot_len * 4 + (random32 % conn->tx_retry_time_slots) * conn->tx_retry_time_slot_len * 4;
@@ -1302,24 +1466,56 @@ void ph_processLinks(int connection_index)
       break;
 
     case LINK_CONNECTED:
+      // move any held data packets into the rx fifo buffer once there's room
+      ph_deliverRxData(conn);
+
       if (!canTx)
       {
           conn->tx_packet_timer = 0;
           break;
       }
 
-      if (!timeToRetry)
-        break;
-
       if (tomanyRetries)
       {	// reset the link if we have sent tomany retries
           ph_startConnect(connection_index, conn->serial_number);
           break;
       }
 
+      // ***********
+      // send data packets .. lost ones are sent again first, new ones go out as soon as the radio is free until the window is full
+
+//      if (conn->not_ready_timer < 0)
+      if (rfm22_txReady())
+      {
+        if (ph_txDataUnsent(conn) == 0)
+          conn->ready_to_send_timer = -1;	// no data to send
+        else
+        if (conn->ready_to_send_timer < 0)
+          conn->ready_to_send_timer = 0;	// start timer
+
+        int slot = ph_nextTxSlot(conn);
+        if (slot >= 0)
+        {       // send data
+
+            uint8_t pack_type = PACKET_TYPE_DATA;
+            if (conn->rx_not_ready_mode)
+              pack_type = PACKET_TYPE_NOTREADY;
+
+            if (ph_sendPacket(connection_index, conn->send_encrypted, pack_type, slot, false))
+            {
+                conn->tx_packet_timer = 0;
+                conn->tx_retry_time = conn->tx_retry_time_slot_len + (random32 % conn->tx_retry_time_slots) * conn->tx_retry_time_slot_len;
+            }
+            break;
+        }
+      }
+
+      if (!timeToRetry)
+        break;
+
       if (conn->pinging)
       {	// we are trying to ping them
-          if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_PING, false))
+          if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_PING, -1, false))
           {
               conn->tx_packet_timer = 0;
               conn->tx_retry_time = conn->tx_retry_time_slot_len * 4 + (random32 % conn->tx_retry_time_slots) * conn->tx_retry_time_slot_len * 4;
@@ -1331,7 +1527,7 @@ void ph_processLinks(int connection_index)
       if (fast_ping) ping_time = conn->fast_ping_time;
       if (conn->tx_packet_timer >= ping_time)
       {	// start pinging
-          if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_PING, false))
+          if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_PING, -1, false))
           {
               conn->ping_time = 8000 + (random32 % 100) * 10;
               conn->fast_ping_time = 600 + (random32 % 50) * 10;
@@ -1350,7 +1546,7 @@ void ph_processLinks(int connection_index)
 				uint16_t size = fifoBuf_getFree(&conn->rx_fifo_buffer);
 				if (size >= conn->rx_fifo_buffer.buf_size / 6)
 				{	// leave 'rx not ready' mode
-					if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_READY, false))
+					if (ph_sendPacket(connection_index, conn->send_encrypted, PACKET_TYPE_READY, -1, false))
 					{
 						conn->tx_packet_timer = 0;
 						conn->tx_retry_time = conn->tx_retry_time_slot_len + (random32 % conn->tx_retry_time_slots) * conn->tx_retry_time_slot_len;
@@ -1359,37 +1555,6 @@ void ph_processLinks(int connection_index)
 				}
 			}
 */
-			// ***********
-			// send data packets
-
-//			if (conn->not_ready_timer < 0)
-      {
-        uint16_t size = fifoBuf_getUsed(&conn->tx_fifo_buffer);
-
-        if (size == 0)
-          conn->ready_to_send_timer = -1;	// no data to send
-        else
-        if (conn->ready_to_send_timer < 0)
-          conn->ready_to_send_timer = 0;	// start timer
-
-        if (size >= 200 || (conn->ready_to_send_timer >= saved_settings.rts_time && size > 0) || (conn->tx_sequence_data_size > 0 && size > 0))
-        {       // send data
-
-            uint8_t pack_type = PACKET_TYPE_DATA;
-            if (conn->rx_not_ready_mode)
-              pack_type = PACKET_TYPE_NOTREADY;
-
-            if (ph_sendPacket(connection_index, conn->send_encrypted, pack_type, false))
-            {
-                conn->tx_packet_timer = 0;
-                conn->tx_retry_time = conn->tx_retry_time_slot_len + (random32 % conn->tx_retry_time_slots) * conn->tx_retry_time_slot_len;
-            }
-            break;
-        }
-      }
-
-      // ***********
-
       break;
 
     default:	// we should never end up here - maybe we should do a reboot?
@@ -1544,7 +1709,16 @@ void ph_set_remote_encryption(int connection_index, bool enabled, const void *ke
 
     ph_set_AES128_key(key);
 
-    connection[connection_index].send_encrypted = enabled;
+    t_connection *conn = &connection[connection_index];
+
+    if (conn->send_encrypted != enabled && conn->link_state != LINK_DISCONNECTED)
+    {	// the packets in flight were sized for the other packet format .. restart the link
+        conn->send_encrypted = enabled;
+        ph_startConnect(connection_index, conn->serial_number);
+        return;
+    }
+
+    conn->send_encrypted = enabled;
 }
 
 // *****************************************************************************
@@ -1637,10 +1811,7 @@ void ph_disconnectAll(void)
 
 		conn->serial_number = 0;
 
-		conn->tx_sequence = 0;
-		conn->tx_sequence_data_size = 0;
-
-		conn->rx_sequence = 0;
+		ph_resetWindows(conn);
 
 		fifoBuf_init(&conn->tx_fifo_buffer, conn->tx_buffer, PH_FIFO_BUFFER_SIZE);
 		fifoBuf_init(&conn->rx_fifo_buffer, conn->rx_buffer, PH_FIFO_BUFFER_SIZE);
@@ -48,6 +48,7 @@ typedef struct {
 	UAVObjEvent ev; /** The actual event */
 	UAVObjEventCallback cb; /** The callback function, or zero if none */
 	xQueueHandle queue; /** The queue or zero if none */
+	uint32_t dispatchTime; /** PIOS_DELAY_GetTimeuS() when the callback was queued */
 } EventCallbackInfo;
 
 /**
@@ -136,6 +137,7 @@ int32_t EventCallbackDispatch(UAVObjEvent* ev, UAVObjEventCallback cb)
 	memcpy(&evInfo.ev, ev, sizeof(UAVObjEvent));
 	evInfo.cb = cb;
 	evInfo.queue = 0;
+	evInfo.dispatchTime = PIOS_DELAY_GetTimeuS();
 	// Push to queue
 	return xQueueSend(queue, &evInfo, 0); // will not block if queue is full
 }
@@ -221,8 +223,10 @@ static int32_t eventPeriodicCreate(UAVObjEvent* ev, UAVObjEventCallback cb, xQue
 	objEntry->evInfo.ev.obj = ev->obj;
 	objEntry->evInfo.ev.instId = ev->instId;
 	objEntry->evInfo.ev.event = ev->event;
+	objEntry->evInfo.ev.timestamp = 0;
 	objEntry->evInfo.cb = cb;
 	objEntry->evInfo.queue = queue;
+	objEntry->evInfo.dispatchTime = 0;
     objEntry->updatePeriodMs = periodMs;
     objEntry->timeToNextUpdateMs = randomizePeriod(periodMs); // avoid bunching of updates
     // Add to list
@@ -274,6 +278,8 @@ static void eventTask()
 {
 	int32_t timeToNextUpdateMs;
 	int32_t delayMs;
+	uint32_t waiting;
+	uint32_t latency;
 	EventCallbackInfo evInfo;
 
 	// Initialize time
@@ -292,6 +298,22 @@ static void eventTask()
 		// Wait for queue message
 		if ( xQueueReceive(queue, &evInfo, delayMs/portTICK_RATE_MS) == pdTRUE )
 		{
+			// Update the latency statistics
+			waiting = uxQueueMessagesWaiting(queue) + 1;
+			latency = PIOS_DELAY_GetuSSince(evInfo.dispatchTime);
+			xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+			if (waiting > stats.queueHighWater)
+			{
+				stats.queueHighWater = waiting;
+			}
+			if (latency > stats.latencyMax)
+			{
+				stats.latencyMax = latency;
+			}
+			stats.latencySum += latency;
+			++stats.latencyCount;
+			xSemaphoreGiveRecursive(mutex);
+
 			// Invoke callback, if one
 			if ( evInfo.cb != 0)
 			{
@@ -336,6 +358,7 @@ static int32_t processPeriodicUpdates()
                 // Reset timer
             	offset = ( timeNow - objEntry->timeToNextUpdateMs ) % objEntry->updatePeriodMs;
             	objEntry->timeToNextUpdateMs = timeNow + objEntry->updatePeriodMs - offset;
+            	objEntry->evInfo.ev.timestamp = PIOS_DELAY_GetTimeuS();
     			// Invoke callback, if one
     			if ( objEntry->evInfo.cb != 0)
     			{
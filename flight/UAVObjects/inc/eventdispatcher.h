@@ -32,6 +32,10 @@
  */
 typedef struct {
 	uint32_t eventErrors;
+	uint32_t latencyMax; /** Worst delay between dispatching a callback and invoking it (us) */
+	uint32_t latencySum; /** Sum of the callback delays (us), divide by latencyCount for the mean */
+	uint32_t latencyCount; /** Number of callbacks invoked */
+	uint32_t queueHighWater; /** Most events found waiting in the callback queue */
 } EventStats;
 
 // Public functions
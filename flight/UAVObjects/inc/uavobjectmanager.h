@@ -102,6 +102,7 @@ typedef struct {
 	UAVObjHandle obj;
 	uint16_t instId;
 	UAVObjEventType event;
+	uint32_t timestamp; /** PIOS_DELAY_GetTimeuS() when the event was generated */
 } UAVObjEvent;
 
 /**
@@ -123,9 +124,21 @@ typedef struct {
 	uint32_t eventErrors;
 } UAVObjStats;
 
+/**
+ * Events dropped on one queue since the last clear, the callback queue of
+ * the event dispatcher is queue 0
+ */
+typedef struct {
+	uint32_t dropped; /** Events dropped because the queue was full */
+	uint32_t worstObjId; /** ID of the object that lost the most events, 0 if none */
+	uint32_t worstObjDropped; /** Events that object lost */
+} UAVObjQueueStats;
+
 int32_t UAVObjInitialize();
 void UAVObjGetStats(UAVObjStats* statsOut);
 void UAVObjClearStats();
+void UAVObjGetQueueStats(xQueueHandle queue, UAVObjQueueStats* statsOut);
+void UAVObjClearQueueStats(xQueueHandle queue);
 UAVObjHandle UAVObjRegister(uint32_t id, const char* name, const char* metaName, int32_t isMetaobject,
 		int32_t isSingleInstance, int32_t isSettings, uint32_t numBytes, UAVObjInitializeCallback initCb);
 UAVObjHandle UAVObjGetByID(uint32_t id);
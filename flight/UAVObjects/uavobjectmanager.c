@@ -44,6 +44,8 @@ struct ObjectEventListStruct {
 	  xQueueHandle queue;
 	  UAVObjEventCallback cb;
 	  int32_t eventMask;
+	  /** Events not delivered since the queue was full, see UAVObjGetQueueStats() */
+	  uint16_t dropped;
 	  struct ObjectEventListStruct *next;
 };
 typedef struct ObjectEventListStruct ObjectEventList;
@@ -161,6 +163,53 @@ void UAVObjClearStats()
 	  xSemaphoreGiveRecursive(mutex);
 }
 
+/**
+ * Get the number of events dropped on a queue and the object that lost the most
+ * @param[in] queue The event queue, or 0 for the callbacks run by the event dispatcher
+ * @param[out] statsOut The statistics will be copied there
+ */
+void UAVObjGetQueueStats(xQueueHandle queue, UAVObjQueueStats * statsOut)
+{
+	  ObjectList *objEntry;
+	  ObjectEventList *eventEntry;
+	  uint32_t objDropped;
+
+	  memset(statsOut, 0, sizeof(UAVObjQueueStats));
+	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+	  LL_FOREACH(objList, objEntry) {
+		    objDropped = 0;
+		    LL_FOREACH(objEntry->events, eventEntry) {
+			      if (eventEntry->queue == queue)
+					objDropped += eventEntry->dropped;
+		    }
+		    statsOut->dropped += objDropped;
+		    if (objDropped > statsOut->worstObjDropped) {
+			      statsOut->worstObjDropped = objDropped;
+			      statsOut->worstObjId = objEntry->id;
+		    }
+	  }
+	  xSemaphoreGiveRecursive(mutex);
+}
+
+/**
+ * Clear the dropped event counters of a queue
+ * @param[in] queue The event queue, or 0 for the callbacks run by the event dispatcher
+ */
+void UAVObjClearQueueStats(xQueueHandle queue)
+{
+	  ObjectList *objEntry;
+	  ObjectEventList *eventEntry;
+
+	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+	  LL_FOREACH(objList, objEntry) {
+		    LL_FOREACH(objEntry->events, eventEntry) {
+			      if (eventEntry->queue == queue)
+					eventEntry->dropped = 0;
+		    }
+	  }
+	  xSemaphoreGiveRecursive(mutex);
+}
+
 /**
  * Register and new object in the object manager.
  * \param[in] id Unique object ID
@@ -1432,6 +1481,7 @@ static int32_t sendEvent(ObjectList * obj, uint16_t instId,
 	  msg.obj = (UAVObjHandle) obj;
 	  msg.event = event;
 	  msg.instId = instId;
+	  msg.timestamp = PIOS_DELAY_GetTimeuS();
 
 	  // Go through each object and push the event message in the queue (if event is activated for the queue)
 	  LL_FOREACH(obj->events, eventEntry) {
@@ -1442,6 +1492,8 @@ static int32_t sendEvent(ObjectList * obj, uint16_t instId,
 					if (xQueueSend(eventEntry->queue, &msg, 0) != pdTRUE)	// will not block
 					{
 						  ++stats.eventErrors;
+						  if (eventEntry->dropped < 0xFFFF)
+							    ++eventEntry->dropped;
 					}
 			      }
 			      // Invoke callback (from event task) if a valid one is registered
@@ -1449,6 +1501,8 @@ static int32_t sendEvent(ObjectList * obj, uint16_t instId,
 					if (EventCallbackDispatch(&msg, eventEntry->cb) != pdTRUE)	// invoke callback from the event task, will not block
 					{
 						  ++stats.eventErrors;
+						  if (eventEntry->dropped < 0xFFFF)
+							    ++eventEntry->dropped;
 					}
 			      }
 		    }
@@ -1565,6 +1619,7 @@ static int32_t connectObj(UAVObjHandle obj, xQueueHandle queue,
 	  eventEntry->queue = queue;
 	  eventEntry->cb = cb;
 	  eventEntry->eventMask = eventMask;
+	  eventEntry->dropped = 0;
 	  LL_APPEND(objEntry->events, eventEntry);
 
 	  // Done
@@ -0,0 +1,56 @@
+#-------------------------------------------------
+#
+# Runs the uploader's OP_DFU against a simulated bootloader behind a mock
+# USB HID device, so uploads can be timed and checked on Linux without a board
+#
+#-------------------------------------------------
+
+# op_dfu.cpp calls QApplication::processEvents()
+QT       += core gui
+
+TARGET = DFUMock
+CONFIG   += console
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+UPLOADER = ../../plugins/uploader
+
+# rawhid/ in this directory stands in for the RawHID plugin op_dfu.h includes,
+# so it has to come before ../../plugins
+INCLUDEPATH += . \
+    ../../libs \
+    ../../libs/qextserialport/src \
+    ../../plugins \
+    $$UPLOADER
+
+DEFINES += QEXTSERIALPORT_LIBRARY
+
+HEADERS                 = ../../libs/qextserialport/src/qextserialport.h \
+                          ../../libs/qextserialport/src/qextserialport_global.h
+SOURCES                 = ../../libs/qextserialport/src/qextserialport.cpp
+
+unix:SOURCES           += ../../libs/qextserialport/src/posix_qextserialport.cpp
+
+win32 {
+  SOURCES          += ../../libs/qextserialport/src/win_qextserialport.cpp
+  DEFINES          += WINVER=0x0501
+}
+
+HEADERS += rawhid/pjrc_rawhid.h \
+    rawhid/usbmonitor.h \
+    mockdevice.h \
+    $$UPLOADER/op_dfu.h \
+    $$UPLOADER/delay.h \
+    $$UPLOADER/SSP/port.h \
+    $$UPLOADER/SSP/qssp.h \
+    $$UPLOADER/SSP/qsspt.h \
+    $$UPLOADER/SSP/common.h
+
+SOURCES += main.cpp \
+    mockdevice.cpp \
+    $$UPLOADER/op_dfu.cpp \
+    $$UPLOADER/delay.cpp \
+    $$UPLOADER/SSP/port.cpp \
+    $$UPLOADER/SSP/qssp.cpp \
+    $$UPLOADER/SSP/qsspt.cpp
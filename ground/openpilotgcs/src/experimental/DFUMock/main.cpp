@@ -0,0 +1,160 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Runs OP_DFU uploads against the mock HID device
+ *
+ * The uploader's DFUObject (plugins/uploader/op_dfu.cpp) is built against the
+ * mock rawhid headers in this directory, so it talks to the simulated
+ * bootloader in mockdevice.cpp instead of a board. Each scenario uploads a
+ * firmware with verify on, which runs UploadData() and then VerifyCRC() on
+ * the pipelined path or the read back on the sequential one. The lengths
+ * end in a full, a one word, a thirteen word and a padded last packet. A
+ * scenario passes if DFUObject reports the expected result, no report
+ * reached the device out of order and, after a successful upload, the
+ * device flash holds the image followed by blank flash. Exits with 1 if any
+ * of them does not.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <QtCore/QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QTime>
+#include "op_dfu.h"
+#include "mockdevice.h"
+
+#define SIZE_OF_CODE    0x1E000     // CopterControl code space
+#define PACKET_BYTES    (14 * 4)    // words of firmware per upload report
+
+// catches the status the upload thread finishes with
+class uploadResult : public QObject
+{
+    Q_OBJECT
+public:
+    OP_DFU::Status status;
+public slots:
+    void finished(OP_DFU::Status ret) { status = ret; }
+};
+
+struct scenario
+{
+    const char *name;
+    bool pipeline;
+    int length;             // bytes of firmware
+    int failWriteAt;
+    int corruptWordAt;
+    bool checkCRCAtEnd;
+    bool expectSuccess;
+};
+
+static const scenario scenarios[] = {
+    { "sequential, read back verify",        false,  100000,                    -1,   -1,     true,   true },
+    { "pipelined, CRC verify",               true,   100000,                    -1,   -1,     true,   true },
+    { "pipelined, full last packet",         true,   1500 * PACKET_BYTES,       -1,   -1,     true,   true },
+    { "pipelined, one word last packet",     true,   1500 * PACKET_BYTES + 4,   -1,   -1,     true,   true },
+    { "pipelined, 13 word last packet",      true,   1500 * PACKET_BYTES + 52,  -1,   -1,     true,   true },
+    { "pipelined, padded last word",         true,   1500 * PACKET_BYTES + 1,   -1,   -1,     true,   true },
+    { "sequential, write fails",             false,  100000,                    500,  -1,     true,   false },
+    { "pipelined, write fails",              true,   100000,                    500,  -1,     true,   false },
+    { "sequential, bad flash word",          false,  100000,                    -1,   1000,   true,   false },
+    { "pipelined, bad flash word",           true,   100000,                    -1,   1000,   true,   false },
+    // the bootloader takes the image, so only the host verify can catch it
+    { "pipelined, no CRC check at end",      true,   1500 * PACKET_BYTES + 52,  -1,   -1,     false,  true },
+    { "sequential, bad last word, no check", false,  1500 * PACKET_BYTES + 52,  -1,   21012,  false,  false },
+    { "pipelined, bad last word, no check",  true,   1500 * PACKET_BYTES + 52,  -1,   21012,  false,  false },
+};
+
+static bool runScenario(const scenario &s, const QString &firmware, const QByteArray &image)
+{
+    QFile file(firmware);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "Could not write" << firmware;
+        return false;
+    }
+    file.write(image.left(s.length));
+    file.close();
+
+    mockSettings settings;
+    settings.sizeOfCode = SIZE_OF_CODE;
+    settings.failWriteAt = s.failWriteAt;
+    settings.corruptWordAt = s.corruptWordAt;
+    settings.checkCRCAtEnd = s.checkCRCAtEnd;
+    mockdevice_Init(settings);
+
+    OP_DFU::DFUObject dfu(false, false, QString());
+    dfu.use_pipeline = s.pipeline;
+    uploadResult result;
+    result.status = OP_DFU::abort;
+    QObject::connect(&dfu, SIGNAL(uploadFinished(OP_DFU::Status)),
+                     &result, SLOT(finished(OP_DFU::Status)), Qt::DirectConnection);
+
+    if(!dfu.ready() || !dfu.enterDFU(0) || !dfu.findDevices())
+    {
+        qDebug("%-36s FAILED to find the mock device", s.name);
+        return false;
+    }
+
+    QTime time;
+    time.start();
+    dfu.UploadFirmware(firmware, true, 0);
+    dfu.wait();
+    int elapsed = time.elapsed();
+
+    mockStats stats;
+    mockdevice_GetStats(&stats);
+    bool success = (result.status == OP_DFU::Last_operation_Success);
+    bool ok = (success == s.expectSuccess) && (stats.wrongPackets == 0);
+
+    // the image padded to whole words with 0xFF, then blank flash
+    if(success)
+    {
+        QByteArray expected = image.left(s.length);
+        expected.append(QByteArray(SIZE_OF_CODE - s.length, (char)0xFF));
+        if(mockdevice_Flash() != expected)
+            ok = false;
+    }
+    qDebug("%-36s %s %s in %d ms, %d reports written, %d read",
+           s.name, ok ? "OK    " : "FAILED", dfu.StatusToString(result.status).toLatin1().data(),
+           elapsed, stats.reportsWritten, stats.reportsRead);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    bool ok = true;
+
+    int longest = 0;
+    for(unsigned x = 0; x < sizeof(scenarios) / sizeof(scenarios[0]); x++)
+        longest = qMax(longest, scenarios[x].length);
+    QByteArray image(longest, 0);
+    qsrand(1);
+    for(int x = 0; x < image.length(); x++)
+        image[x] = qrand();
+
+    QString firmware = QDir::temp().filePath("DFUMock.bin");
+    for(unsigned x = 0; x < sizeof(scenarios) / sizeof(scenarios[0]); x++)
+        ok &= runScenario(scenarios[x], firmware, image);
+
+    QFile::remove(firmware);
+    return ok ? 0 : 1;
+}
+
+#include "main.moc"
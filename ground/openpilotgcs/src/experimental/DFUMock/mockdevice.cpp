@@ -0,0 +1,323 @@
+/**
+ ******************************************************************************
+ *
+ * @file       mockdevice.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Simulated OpenPilot bootloader behind the mock HID device
+ *
+ * Follows processComand() in flight/Bootloaders/OpenPilot/op_dfu.c for one
+ * self flashed device: capabilities, upload with the CRC check at Op_END,
+ * download and status. Every report each way takes one 1 ms USB frame, which
+ * is what the full speed interrupt endpoints of the real board allow.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "mockdevice.h"
+#include "rawhid/pjrc_rawhid.h"
+#include "rawhid/usbmonitor.h"
+#include "op_dfu.h"
+#include "delay.h"
+#include <QByteArray>
+#include <QQueue>
+#include <QMutex>
+#include <string.h>
+
+#define REPORT_LEN      64
+#define FRAME_MS        1
+#define WORDS_PER_PACKET 14
+
+using namespace OP_DFU;
+
+static mockSettings settings;
+static mockStats stats;
+static QByteArray flash;
+static QQueue<QByteArray> replies;
+static QMutex replyMutex;
+
+static OP_DFU::Status deviceState;
+static quint8 transferType;
+static quint32 nextPacket;
+static quint32 sizeOfTransfer;
+static quint8 sizeOfLastPacket;
+static quint32 expectedCRC;
+static quint32 downPacketCurrent;
+static quint32 downPacketTotal;
+static quint8 downSizeOfLastPacket;
+static quint32 uploadReports;
+
+// STM32 hardware CRC: polynomial 0x04C11DB7, MSB first, over little endian words
+static quint32 flashCRC()
+{
+    quint32 crc = 0xFFFFFFFF;
+    for(int x = 0; x < flash.length(); x += 4)
+    {
+        quint32 word = (quint8)flash[x] | (quint8)flash[x + 1] << 8 |
+                       (quint8)flash[x + 2] << 16 | (quint32)(quint8)flash[x + 3] << 24;
+        crc ^= word;
+        for(int bit = 0; bit < 32; bit++)
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+    }
+    return crc;
+}
+
+static void reply(const char *buf)
+{
+    QMutexLocker locker(&replyMutex);
+    replies.enqueue(QByteArray(buf, REPORT_LEN));
+}
+
+static void queueDownloads()
+{
+    char buf[REPORT_LEN];
+    while(downPacketCurrent < downPacketTotal)
+    {
+        memset(buf, 0, REPORT_LEN);
+        buf[0] = 0x01;
+        buf[1] = Download;
+        buf[2] = downPacketCurrent >> 24;
+        buf[3] = downPacketCurrent >> 16;
+        buf[4] = downPacketCurrent >> 8;
+        buf[5] = downPacketCurrent;
+        int words = (downPacketCurrent == downPacketTotal - 1) ? downSizeOfLastPacket : WORDS_PER_PACKET;
+        memcpy(buf + 6, flash.constData() + downPacketCurrent * WORDS_PER_PACKET * 4, words * 4);
+        reply(buf);
+        downPacketCurrent++;
+    }
+    deviceState = Last_operation_Success;
+}
+
+static void processCommand(const quint8 *buf)
+{
+    quint8 command = buf[1] & 0x1F;
+    bool start = buf[1] & 0x20;
+    quint32 count = buf[2] << 24 | buf[3] << 16 | buf[4] << 8 | buf[5];
+    char rep[REPORT_LEN];
+    memset(rep, 0, REPORT_LEN);
+
+    switch(command)
+    {
+    case EnterDFU:
+        deviceState = DFUidle;
+        break;
+    case Req_Capabilities:
+        rep[0] = 0x01;
+        rep[1] = Rep_Capabilities;
+        if(buf[6] == 0)
+        {
+            rep[7] = 1;     // one device, readable and writable
+            rep[9] = 0x03;
+        }
+        else
+        {
+            quint32 crc = flashCRC();
+            rep[2] = settings.sizeOfCode >> 24;
+            rep[3] = settings.sizeOfCode >> 16;
+            rep[4] = settings.sizeOfCode >> 8;
+            rep[5] = settings.sizeOfCode;
+            rep[6] = buf[6];
+            rep[7] = 2;     // BL version
+            rep[8] = 100;   // size of description
+            rep[10] = crc >> 24;
+            rep[11] = crc >> 16;
+            rep[12] = crc >> 8;
+            rep[13] = crc;
+            rep[14] = 0x04;
+            rep[15] = 0x01;
+        }
+        reply(rep);
+        break;
+    case Upload:
+        if(deviceState != DFUidle && deviceState != uploading)
+            break;
+        if(start && nextPacket == 0)
+        {
+            transferType = buf[6];
+            sizeOfTransfer = count;
+            sizeOfLastPacket = buf[7];
+            expectedCRC = buf[8] << 24 | buf[9] << 16 | buf[10] << 8 | buf[11];
+            nextPacket = 1;
+            deviceState = uploading;
+            // descriptions are taken but not kept
+            if(transferType != FW)
+                break;
+            if((sizeOfTransfer - 1) * WORDS_PER_PACKET * 4 + sizeOfLastPacket * 4 > settings.sizeOfCode)
+            {
+                nextPacket = 0;
+                deviceState = outsideDevCapabilities;
+                break;
+            }
+            flash.fill((char)0xFF);
+        }
+        else if(!start && nextPacket != 0)
+        {
+            if(count != nextPacket - 1)
+            {
+                stats.wrongPackets++;
+                deviceState = wrong_packet_received;
+                break;
+            }
+            if(transferType == FW)
+            {
+                int words = (count == sizeOfTransfer - 1) ? sizeOfLastPacket : WORDS_PER_PACKET;
+                for(int x = 0; x < words; x++)
+                {
+                    quint32 address = (count * WORDS_PER_PACKET + x) * 4;
+                    quint32 data = buf[6 + x * 4] << 24 | buf[7 + x * 4] << 16 | buf[8 + x * 4] << 8 | buf[9 + x * 4];
+                    if((int)(address / 4) == settings.corruptWordAt)
+                        data ^= 0x00010000;
+                    if(address + 4 <= (quint32)flash.length())
+                    {
+                        flash[address] = data;
+                        flash[address + 1] = data >> 8;
+                        flash[address + 2] = data >> 16;
+                        flash[address + 3] = data >> 24;
+                    }
+                }
+            }
+            nextPacket++;
+        }
+        break;
+    case Op_END:
+        if(deviceState == uploading)
+        {
+            if(nextPacket - 1 == sizeOfTransfer)
+                deviceState = (transferType != FW || !settings.checkCRCAtEnd || expectedCRC == flashCRC()) ? Last_operation_Success : CRC_Fail;
+            else
+                deviceState = too_few_packets;
+            nextPacket = 0;
+        }
+        break;
+    case Download_Req:
+        if(deviceState != DFUidle)
+        {
+            deviceState = Last_operation_failed;
+            break;
+        }
+        downPacketTotal = count;
+        downSizeOfLastPacket = buf[7];
+        downPacketCurrent = 0;
+        deviceState = downloading;
+        queueDownloads();
+        break;
+    case Status_Request:
+        rep[0] = 0x01;
+        rep[1] = Status_Rep;
+        rep[6] = deviceState;
+        reply(rep);
+        if(deviceState == Last_operation_Success)
+            deviceState = DFUidle;
+        break;
+    case Abort_Operation:
+        nextPacket = 0;
+        deviceState = DFUidle;
+        break;
+    default:
+        break;
+    }
+}
+
+void mockdevice_Init(const mockSettings &newSettings)
+{
+    settings = newSettings;
+    memset(&stats, 0, sizeof(stats));
+    flash = QByteArray(settings.sizeOfCode, (char)0xFF);
+    replies.clear();
+    deviceState = DFUidle;
+    nextPacket = 0;
+    uploadReports = 0;
+}
+
+void mockdevice_GetStats(mockStats *out)
+{
+    *out = stats;
+}
+
+QByteArray mockdevice_Flash()
+{
+    return flash;
+}
+
+USBMonitor *USBMonitor::instance()
+{
+    static USBMonitor monitor;
+    return &monitor;
+}
+
+QList<USBPortInfo> USBMonitor::availableDevices(int vid, int pid, int boardModel, int runState)
+{
+    Q_UNUSED(pid);
+    Q_UNUSED(boardModel);
+    Q_UNUSED(runState);
+    USBPortInfo info;
+    info.vendorID = vid;
+    info.productID = 0x415b;
+    info.UsagePage = 0;
+    info.Usage = 0;
+    info.bcdDevice = 0x0401;
+    return QList<USBPortInfo>() << info;
+}
+
+int pjrc_rawhid::open(int max, int vid, int pid, int usage_page, int usage)
+{
+    Q_UNUSED(max);
+    Q_UNUSED(vid);
+    Q_UNUSED(pid);
+    Q_UNUSED(usage_page);
+    Q_UNUSED(usage);
+    return 1;
+}
+
+void pjrc_rawhid::close(int num)
+{
+    Q_UNUSED(num);
+}
+
+int pjrc_rawhid::send(int num, void *buf, int len, int timeout)
+{
+    Q_UNUSED(num);
+    Q_UNUSED(timeout);
+    const quint8 *report = (const quint8 *)buf;
+
+    delay::msleep(FRAME_MS);
+    if((report[1] & 0x3F) == Upload)
+    {
+        // data reports only, the start report does not count
+        if((int)uploadReports == settings.failWriteAt)
+            return -1;
+        uploadReports++;
+    }
+    stats.reportsWritten++;
+    processCommand(report);
+    return len;
+}
+
+int pjrc_rawhid::receive(int num, void *buf, int len, int timeout)
+{
+    Q_UNUSED(num);
+    Q_UNUSED(timeout);
+    QByteArray report;
+
+    delay::msleep(FRAME_MS);
+    {
+        QMutexLocker locker(&replyMutex);
+        if(replies.isEmpty())
+            return 0;
+        report = replies.dequeue();
+    }
+    stats.reportsRead++;
+    memcpy(buf, report.constData(), qMin(len, report.length()));
+    return len;
+}
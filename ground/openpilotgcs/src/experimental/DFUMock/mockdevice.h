@@ -0,0 +1,51 @@
+/**
+ ******************************************************************************
+ *
+ * @file       mockdevice.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Simulated OpenPilot bootloader behind the mock HID device
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MOCKDEVICE_H
+#define MOCKDEVICE_H
+
+#include <QtGlobal>
+#include <QByteArray>
+
+// how the simulated board behaves, set before each run
+struct mockSettings
+{
+    quint32 sizeOfCode;     // bytes of code space
+    int failWriteAt;        // upload report whose USB write fails, -1 for none
+    int corruptWordAt;      // word that programs wrong, -1 for none
+    bool checkCRCAtEnd;     // false for a bootloader that takes any image at Op_END
+};
+
+// what the simulated board saw
+struct mockStats
+{
+    int reportsWritten;     // reports the host sent
+    int reportsRead;        // reports the host read back
+    int wrongPackets;       // upload reports that came out of order
+};
+
+void mockdevice_Init(const mockSettings &settings);
+void mockdevice_GetStats(mockStats *stats);
+QByteArray mockdevice_Flash();
+
+#endif // MOCKDEVICE_H
@@ -0,0 +1,54 @@
+/**
+ ******************************************************************************
+ *
+ * @file       usbmonitor.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Mock of the RawHID plugin's USBMonitor, always finds one
+ *             board in bootloader mode
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef USBMONITOR_H
+#define USBMONITOR_H
+
+#include <QList>
+#include <QString>
+
+struct USBPortInfo {
+    QString serialNumber;
+    QString manufacturer;
+    QString product;
+    int UsagePage;
+    int Usage;
+    int vendorID;
+    int productID;
+    int bcdDevice;
+};
+
+class USBMonitor
+{
+public:
+    enum RunState {
+        Bootloader = 0x01,
+        Running = 0x02
+    };
+
+    static USBMonitor *instance();
+    QList<USBPortInfo> availableDevices(int vid, int pid, int boardModel, int runState);
+};
+
+#endif // USBMONITOR_H
@@ -0,0 +1,35 @@
+#-------------------------------------------------
+#
+# Host test of the GPS module NMEA parser: decoding, captured logs,
+# corrupted streams and throughput
+#
+#-------------------------------------------------
+
+TARGET = NMEATest
+CONFIG   += console
+CONFIG   -= qt app_bundle
+
+TEMPLATE = app
+
+GPS = ../../../../../flight/Modules/GPS
+
+# openpilot.h, pios.h and the UAVObject headers in this directory stand in
+# for the flight ones NMEA.c includes
+INCLUDEPATH += . \
+    $$GPS/inc
+
+HEADERS += openpilot.h \
+    pios.h \
+    uavobjects.h \
+    gpsposition.h \
+    gpstime.h \
+    gpssatellites.h \
+    $$GPS/inc/NMEA.h
+
+SOURCES += main.c \
+    $$GPS/NMEA.c
+
+DEFINES += SAMPLE_LOG=\\\"$$PWD/sample.nmea\\\"
+
+QMAKE_CFLAGS += -std=gnu99
+LIBS += -lm
@@ -0,0 +1,2 @@
+// Stands in for the generated gpssatellites.h, the GPS objects are all in uavobjects.h
+#include "uavobjects.h"
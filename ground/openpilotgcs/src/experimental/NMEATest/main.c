@@ -0,0 +1,380 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Host test of the GPS module NMEA parser
+ *
+ * Feeds flight/Modules/GPS/NMEA.c the way the GPS task does, a byte at a
+ * time, and checks:
+ *   - the decoding of known sentences into the GPS UAVObjects
+ *   - captured logs given on the command line (sample.nmea without any)
+ *     parse without checksum or parsing errors
+ *   - randomly corrupted logs don't upset the parser and it picks the
+ *     stream up again afterwards; build with -fsanitize=address to catch
+ *     any out of bounds access
+ *   - how many sentences a second it gets through
+ * Exits with 1 if any check fails.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "uavobjects.h"
+#include "NMEA.h"
+
+#ifndef SAMPLE_LOG
+#define SAMPLE_LOG          "sample.nmea"
+#endif
+
+#define FUZZ_RUNS           20000
+#define THROUGHPUT_SECONDS  1.0
+
+typedef struct
+{
+	uint32_t parsed;
+	uint32_t unhandled;
+	uint32_t chksumErrors;
+	uint32_t parsingErrors;
+} Counts_t;
+
+static GPSPositionData position;
+static GPSTimeData gpstime;
+static GPSSatellitesData satellites;
+static uint32_t satellitesUpdates;
+static int failures;
+
+#define CHECK(test) \
+	do { if (!(test)) { printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #test); failures++; } } while (0)
+
+void GPSPositionGet(GPSPositionData *data) { *data = position; }
+void GPSPositionSet(GPSPositionData *data) { position = *data; }
+void GPSTimeGet(GPSTimeData *data) { *data = gpstime; }
+void GPSTimeSet(GPSTimeData *data) { gpstime = *data; }
+void GPSSatellitesSet(GPSSatellitesData *data) { satellites = *data; satellitesUpdates++; }
+
+// small xorshift so every run corrupts the same bytes
+static uint32_t random_state = 2463534242u;
+
+static uint32_t fuzzRandom(uint32_t range)
+{
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 17;
+	random_state ^= random_state << 5;
+	return random_state % range;
+}
+
+// returns the result for the last byte
+static int feed(const uint8_t *buf, size_t len, Counts_t *counts)
+{
+	int res = -1;
+
+	for (size_t i = 0; i < len; i++)
+	{
+		res = NMEA_update_position(buf[i], &counts->chksumErrors, &counts->parsingErrors);
+		if (res == 0)
+			counts->parsed++;
+		else if (res == 1)
+			counts->unhandled++;
+	}
+	return res;
+}
+
+static int feedString(const char *s, Counts_t *counts)
+{
+	return feed((const uint8_t *)s, strlen(s), counts);
+}
+
+// frames a sentence body with its checksum and feeds it
+static int feedSentence(const char *body, Counts_t *counts)
+{
+	char sentence[256];
+	uint8_t checksum = 0;
+
+	for (const char *p = body; *p; p++)
+		checksum ^= (uint8_t)*p;
+	snprintf(sentence, sizeof(sentence), "$%s*%02X\r\n", body, checksum);
+	return feedString(sentence, counts);
+}
+
+static bool near(float a, float b)
+{
+	return fabsf(a - b) < 1e-4f * (1.0f + fabsf(b));
+}
+
+static void testDecoding(void)
+{
+	Counts_t c;
+
+	memset(&c, 0, sizeof(c));
+	CHECK(feedString("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n", &c) == 0);
+	CHECK(position.Latitude == 481173000);
+	CHECK(position.Longitude == 115166666);
+	CHECK(position.Satellites == 8);
+	CHECK(near(position.Altitude, 545.4f));
+	CHECK(near(position.GeoidSeparation, 46.9f));
+
+	// the southern and western hemispheres, below sea level, 7 decimals of minutes
+	CHECK(feedSentence("GNGGA,000001.00,3352.1234567,S,15112.5,W,1,11,0.8,-12.3,M,-0.4,M,,", &c) == 0);
+	CHECK(position.Latitude == -(330000000 + (52 * 10000000 + 1234567) / 60));
+	CHECK(position.Longitude == -(1510000000 + (12 * 10000000 + 5000000) / 60));
+	CHECK(near(position.Altitude, -12.3f));
+	CHECK(near(position.GeoidSeparation, -0.4f));
+
+	CHECK(feedString("$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n", &c) == 0);
+	CHECK(position.Status == GPSPOSITION_STATUS_FIX3D);
+	CHECK(near(position.PDOP, 2.5f));
+	CHECK(near(position.HDOP, 1.3f));
+	CHECK(near(position.VDOP, 2.1f));
+
+	CHECK(feedSentence("GPRMC,123519.50,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W,A", &c) == 0);
+	CHECK(gpstime.Hour == 12 && gpstime.Minute == 35 && gpstime.Second == 19);
+	CHECK(gpstime.Day == 23 && gpstime.Month == 3 && gpstime.Year == 2094);
+	CHECK(near(position.Groundspeed, 22.4f * 0.51444f));
+	CHECK(near(position.Heading, 84.4f));
+
+	CHECK(feedSentence("GNVTG,38.50,T,,M,3.200,N,5.926,K,A", &c) == 0);
+	CHECK(near(position.Heading, 38.5f));
+	CHECK(near(position.Groundspeed, 3.2f * 0.51444f));
+
+	CHECK(feedSentence("GNZDA,201530.00,04,07,2026,00,00", &c) == 0);
+	CHECK(gpstime.Hour == 20 && gpstime.Minute == 15 && gpstime.Second == 30);
+	CHECK(gpstime.Day == 4 && gpstime.Month == 7 && gpstime.Year == 2026);
+
+	// a set of GSV sentences updates the satellites once it is complete
+	satellitesUpdates = 0;
+	CHECK(feedSentence("GPGSV,2,1,05,02,45,112,22,05,62,231,19,12,33,287,,13,21,064,29", &c) == 0);
+	CHECK(satellitesUpdates == 0);
+	CHECK(feedSentence("GPGSV,2,2,05,15,74,178,34", &c) == 0);
+	CHECK(satellitesUpdates == 1);
+	CHECK(satellites.SatsInView == 5);
+	CHECK(satellites.PRN[0] == 2 && satellites.PRN[3] == 13 && satellites.PRN[4] == 15);
+	CHECK(near(satellites.Elevation[4], 74.0f) && near(satellites.Azimuth[4], 178.0f));
+	CHECK(satellites.SNR[2] == 0 && satellites.SNR[3] == 29);
+
+	// other constellations' satellites are valid sentences we don't decode
+	CHECK(feedSentence("GLGSV,1,1,01,65,35,080,36", &c) == 1);
+	CHECK(satellitesUpdates == 1);
+	CHECK(c.parsed == 8 && c.unhandled == 1);
+	CHECK(c.chksumErrors == 0 && c.parsingErrors == 0);
+
+	// lower case checksums are fine, bad ones are counted
+	CHECK(feedString("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n", &c) == 0);
+	CHECK(feedString("$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*3a\r\n", &c) < 0);
+	CHECK(feedString("$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1\r\n", &c) < 0);
+	CHECK(c.chksumErrors == 2 && c.parsingErrors == 0);
+
+	// a sentence cut short by the next one is a framing error, the next one is parsed
+	CHECK(feedString("$GPGGA,123519,4807.0$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n", &c) == 0);
+	CHECK(c.parsingErrors == 1);
+
+	// so is one too long to be a sentence
+	for (int i = 0; i < 20; i++)
+		feedString(i ? "0123456789" : "$GPGGA,", &c);
+	CHECK(c.parsingErrors == 2);
+	CHECK(feedString("$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n", &c) == 0);
+
+	// a sentence with the wrong number of parameters is a parsing error
+	CHECK(feedSentence("GPGGA,123519,4807.038,N", &c) < 0);
+	CHECK(c.parsingErrors == 3);
+	CHECK(c.chksumErrors == 2);
+}
+
+static uint8_t *loadLog(const char *name, size_t *len)
+{
+	FILE *f = fopen(name, "rb");
+	uint8_t *buf;
+
+	if (!f)
+		return NULL;
+	fseek(f, 0, SEEK_END);
+	*len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	buf = malloc(*len + 1);
+	if (buf && fread(buf, 1, *len, f) != *len)
+	{
+		free(buf);
+		buf = NULL;
+	}
+	fclose(f);
+	return buf;
+}
+
+static void testLog(const char *name, const uint8_t *log, size_t len, bool clean)
+{
+	Counts_t c;
+
+	memset(&c, 0, sizeof(c));
+	feed(log, len, &c);
+	printf("%-24s %u parsed, %u not decoded, %u checksum errors, %u parsing errors\n",
+	       name, c.parsed, c.unhandled, c.chksumErrors, c.parsingErrors);
+
+	CHECK(c.parsed > 0);
+	if (clean)
+		CHECK(c.chksumErrors == 0 && c.parsingErrors == 0);
+}
+
+// a sentence the parser must take once a corrupted stream has been resynchronised
+static const char resync[] = "\r\n$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n";
+
+static void testFuzz(const uint8_t *log, size_t len)
+{
+	static const char special[] = "$*,.-\r\n";
+	static const char bodyChars[] = "0123456789.-,ABENSWMPGLV";
+	uint8_t buf[1024];
+	Counts_t c;
+
+	memset(&c, 0, sizeof(c));
+	for (uint32_t run = 0; run < FUZZ_RUNS; run++)
+	{
+		// take a few sentences of the log from a random place
+		size_t start = fuzzRandom(len);
+		size_t n = 1 + fuzzRandom(sizeof(buf) / 2);
+		if (start + n > len)
+			n = len - start;
+		memcpy(buf, &log[start], n);
+
+		if (run & 1)
+		{
+			// corrupt, insert and drop any bytes
+			uint32_t edits = 1 + fuzzRandom(8);
+			for (uint32_t e = 0; e < edits; e++)
+			{
+				size_t at = fuzzRandom(n);
+				uint8_t b = fuzzRandom(4) ? fuzzRandom(256) : (uint8_t)special[fuzzRandom(sizeof(special) - 1)];
+				switch (fuzzRandom(3))
+				{
+				case 0:
+					buf[at] = b;
+					break;
+				case 1:
+					if (n < sizeof(buf))
+					{
+						memmove(&buf[at + 1], &buf[at], n - at);
+						buf[at] = b;
+						n++;
+					}
+					break;
+				default:
+					memmove(&buf[at], &buf[at + 1], n - at - 1);
+					n--;
+					break;
+				}
+				if (n == 0)
+					break;
+			}
+			feed(buf, n, &c);
+		}
+		else
+		{
+			// corrupt the parameters of whole sentences and fix their checksums,
+			// so the sentence parsers get the garbage
+			uint32_t before = c.chksumErrors;
+			uint8_t *p = buf;
+			uint8_t *end = buf + n;
+
+			feedString("\r\n", &c);
+			while ((p = memchr(p, '$', end - p)) != NULL)
+			{
+				uint8_t *star = memchr(p, '*', end - p);
+				if (!star || star + 5 > end)
+					break;
+
+				uint8_t checksum = 0;
+				for (uint8_t *q = p + 7; q < star; q++)
+				{
+					if (fuzzRandom(8) == 0)
+						*q = bodyChars[fuzzRandom(sizeof(bodyChars) - 1)];
+				}
+				for (uint8_t *q = p + 1; q < star; q++)
+					checksum ^= *q;
+				star[1] = "0123456789ABCDEF"[checksum >> 4];
+				star[2] = "0123456789ABCDEF"[checksum & 15];
+				feed(p, star + 5 - p, &c);
+				p = star + 5;
+			}
+			CHECK(c.chksumErrors == before);
+		}
+
+		// the parser has to pick the stream up again
+		CHECK(feedString(resync, &c) == 0);
+		if (failures > 10)
+			break;
+	}
+	printf("%-24s %u runs, %u parsed, %u checksum errors, %u parsing errors\n",
+	       "fuzz", FUZZ_RUNS, c.parsed, c.chksumErrors, c.parsingErrors);
+}
+
+static void testThroughput(const uint8_t *log, size_t len)
+{
+	Counts_t c;
+	uint64_t bytes = 0;
+	clock_t start = clock();
+	double elapsed;
+
+	memset(&c, 0, sizeof(c));
+	do
+	{
+		for (int i = 0; i < 10; i++)
+			feed(log, len, &c);
+		bytes += 10 * len;
+		elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+	} while (elapsed < THROUGHPUT_SECONDS);
+
+	printf("%-24s %.0f sentences/s, %.1f MB/s\n", "throughput",
+	       (c.parsed + c.unhandled) / elapsed, bytes / elapsed / 1e6);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *sample = SAMPLE_LOG;
+	uint8_t *log;
+	size_t len;
+
+	testDecoding();
+
+	log = loadLog(sample, &len);
+	if (!log)
+	{
+		printf("FAILED can't read %s\n", sample);
+		return 1;
+	}
+	testLog(sample, log, len, true);
+	for (int i = 1; i < argc; i++)
+	{
+		size_t capturedLen;
+		uint8_t *captured = loadLog(argv[i], &capturedLen);
+		if (!captured)
+		{
+			printf("FAILED can't read %s\n", argv[i]);
+			failures++;
+			continue;
+		}
+		testLog(argv[i], captured, capturedLen, false);
+		testThroughput(captured, capturedLen);
+		free(captured);
+	}
+
+	testFuzz(log, len);
+	testThroughput(log, len);
+	free(log);
+
+	printf(failures ? "FAILED\n" : "OK\n");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,32 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Stands in for the PiOS header when the GPS NMEA parser is
+ *             built on the host. Failed asserts abort the test.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef PIOS_H
+#define PIOS_H
+
+#include <assert.h>
+
+#define NELEMENTS(x) (sizeof(x) / sizeof(*(x)))
+#define PIOS_DEBUG_Assert(test) assert(test)
+
+#endif // PIOS_H
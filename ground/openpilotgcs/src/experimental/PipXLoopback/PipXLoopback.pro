@@ -0,0 +1,40 @@
+#-------------------------------------------------
+#
+# Loopback test of the PipXtreme packet handler, two modems built from
+# packet_handler.c send each other data over a simulated lossy radio link
+#
+#-------------------------------------------------
+
+TARGET = PipXLoopback
+CONFIG   += console
+CONFIG   -= qt app_bundle
+
+TEMPLATE = app
+
+PIPX = ../../../../../flight/PipXtreme
+LIBRARIES = ../../../../../flight/Libraries
+
+# pios.h and the stm32 headers in this directory stand in for the ones the
+# PipXtreme code includes, modem.inc builds packet_handler.c once per modem
+INCLUDEPATH += . \
+    $$PIPX \
+    $$PIPX/inc \
+    $$LIBRARIES/inc
+
+HEADERS += pios.h \
+    stm32f10x.h \
+    stm32f10x_flash.h \
+    radio.h \
+    modem.h \
+    modem.inc \
+    $$PIPX/inc/packet_handler.h
+
+SOURCES += main.c \
+    radio.c \
+    modem_a.c \
+    modem_b.c \
+    $$PIPX/crc.c \
+    $$PIPX/aes.c \
+    $$LIBRARIES/fifo_buffer.c
+
+QMAKE_CFLAGS += -std=gnu99
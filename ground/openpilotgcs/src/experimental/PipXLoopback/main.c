@@ -0,0 +1,198 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Loopback test of the PipXtreme packet handler over a lossy radio link
+ *
+ * Two modems built from flight/PipXtreme/packet_handler.c connect to each
+ * other over a simulated half duplex RF channel that loses packets and
+ * delivers some late, after packets sent behind them. Both send a known
+ * byte stream to the other at the same time, and each end checks that it
+ * gets the stream complete, in order and only once. Runs with the clock
+ * stepped a millisecond at a time, so every run is the same. Exits with 1
+ * if any scenario fails.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <stdio.h>
+#include <string.h>
+#include "radio.h"
+#include "modem.h"
+
+#define DATARATE		57600	// bps
+#define STREAM_BYTES	16384	// sent each way
+#define CONNECT_LIMIT_MS	60000
+#define SETTLE_MS		2000	// both ends connected this long before the test starts
+#define TIME_LIMIT_MS	600000
+#define PROCESS_PER_MS	4		// ph_process() calls per ms, the firmware main loop spins faster than the tick
+
+// what the packet handler expects main.c to provide
+volatile uint32_t uptime_ms;
+volatile uint32_t random32 = 0x35b7f4a1;
+bool booting = false;
+
+struct scenario
+{
+	const char *name;
+	uint32_t loss;		// per million packets
+	uint32_t late;		// per million packets
+	uint32_t late_ms;
+	bool encrypt;
+};
+
+static const struct scenario scenarios[] = {
+	{ "clean",                   0,      0,  0, false },
+	{ "clean, encrypted",        0,      0,  0, true },
+	{ "10% loss",           100000,      0,  0, false },
+	{ "30% loss",           300000,      0,  0, false },
+	{ "10% late",                0, 100000, 40, false },
+	{ "20% loss, 20% late", 200000, 200000, 40, true },
+};
+
+// one direction of the test, the byte stream one modem sends the other
+struct stream
+{
+	const Modem_t *from;
+	const Modem_t *to;
+	uint32_t sent;
+	uint32_t received;
+	uint32_t errors;
+};
+
+static uint8_t stream_Byte(uint32_t n, uint32_t seed)
+{
+	uint32_t x = (n + seed) * 2654435761u;
+	return x >> 13;
+}
+
+static void stream_Step(struct stream *s, uint32_t seed)
+{
+	uint8_t buf[128];
+
+	while (s->sent < STREAM_BYTES && s->from->putDataFree(0) > 0) {
+		uint16_t len = sizeof(buf);
+		if (len > s->from->putDataFree(0)) {
+			len = s->from->putDataFree(0);
+		}
+		if (len > STREAM_BYTES - s->sent) {
+			len = STREAM_BYTES - s->sent;
+		}
+		for (uint16_t i = 0; i < len; i++) {
+			buf[i] = stream_Byte(s->sent + i, seed);
+		}
+		s->sent += s->from->putData(0, buf, len);
+	}
+
+	uint16_t len;
+	while ((len = s->to->getData(0, buf, sizeof(buf))) > 0) {
+		for (uint16_t i = 0; i < len; i++) {
+			if (s->received >= s->sent || buf[i] != stream_Byte(s->received, seed)) {
+				s->errors++;
+			}
+			s->received++;
+		}
+	}
+}
+
+static void step(const Modem_t *a, const Modem_t *b)
+{
+	uptime_ms++;
+	a->tick();
+	b->tick();
+	radio_Tick();
+	for (int i = 0; i < PROCESS_PER_MS; i++) {
+		a->process();
+		b->process();
+	}
+}
+
+static bool run(const struct scenario *sc)
+{
+	const Modem_t *a = &a_modem;
+	const Modem_t *b = &b_modem;
+	struct stream ab = { a, b, 0, 0, 0 };
+	struct stream ba = { b, a, 0, 0, 0 };
+
+	radio_Init(sc->loss, sc->late, sc->late_ms);
+	uptime_ms = 0;
+	a->init(0x1a2b3c4d, 0x5e6f7a8b, DATARATE, sc->encrypt);
+	b->init(0x5e6f7a8b, 0x1a2b3c4d, DATARATE, sc->encrypt);
+
+	// when both ends connect at once they can reset the link again, which
+	// wipes the buffers, so wait for it to settle
+	uint32_t connected_ms = 0;
+	while (uptime_ms < connected_ms + SETTLE_MS || connected_ms == 0) {
+		if (uptime_ms >= CONNECT_LIMIT_MS) {
+			printf("%-22s FAILED, no connection after %u ms\n", sc->name, uptime_ms);
+			return false;
+		}
+		step(a, b);
+		if (!(a->connected(0) && b->connected(0))) {
+			connected_ms = 0;
+		} else if (connected_ms == 0) {
+			connected_ms = uptime_ms;
+		}
+	}
+	connected_ms = uptime_ms;
+
+	uint32_t resets = 0;
+	while (ab.received < STREAM_BYTES || ba.received < STREAM_BYTES) {
+		if (uptime_ms >= TIME_LIMIT_MS || ab.errors || ba.errors) {
+			break;
+		}
+		step(a, b);
+		// a link reset throws away the data in flight, the test can't go on
+		if (!(a->connected(0) && b->connected(0))) {
+			resets++;
+			break;
+		}
+		stream_Step(&ab, 1);
+		stream_Step(&ba, 2);
+	}
+
+	uint32_t ms = uptime_ms - connected_ms;
+	bool ok = ab.received == STREAM_BYTES && ba.received == STREAM_BYTES && ab.errors == 0 && ba.errors == 0 && resets == 0;
+	printf("%-22s %s  connected %5u ms  %6u/%u bytes each way in %6u ms (%4u B/s)  packets %5u+%5u, lost %4u, late %s, collided %3u, overrun %3u",
+		sc->name, ok ? "OK    " : "FAILED", connected_ms,
+		ab.received < ba.received ? ab.received : ba.received, STREAM_BYTES, ms,
+		ms ? (ab.received + ba.received) * 500 / ms : 0,
+		radio[0].sent, radio[1].sent, radio[0].lost + radio[1].lost,
+		sc->late ? "yes" : "no ", radio[0].collided + radio[1].collided,
+		radio[0].overrun + radio[1].overrun);
+	if (ab.errors || ba.errors) {
+		printf("  %u+%u bytes wrong or duplicated", ab.errors, ba.errors);
+	}
+	if (resets) {
+		printf("  link reset");
+	}
+	printf("\n");
+	return ok;
+}
+
+int main(int argc, char *argv[])
+{
+	int failed = 0;
+
+	for (unsigned i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+		if (!run(&scenarios[i])) {
+			failed++;
+		}
+	}
+
+	printf(failed ? "FAILED\n" : "OK\n");
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,44 @@
+/**
+ ******************************************************************************
+ *
+ * @file       modem.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      The two simulated PipXtreme modems
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef MODEM_H
+#define MODEM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// the parts of a modem's packet handler the test drives
+typedef struct {
+	void (*init)(uint32_t serial_number, uint32_t destination_id, uint32_t datarate, bool encrypt);
+	void (*tick)(void);
+	void (*process)(void);
+	bool (*connected)(const int connection_index);
+	uint16_t (*putDataFree)(const int connection_index);
+	uint16_t (*putData)(const int connection_index, const void *data, uint16_t len);
+	uint16_t (*getData)(const int connection_index, void *data, uint16_t len);
+	uint16_t (*getRetries)(const int connection_index);
+} Modem_t;
+
+extern const Modem_t a_modem;
+extern const Modem_t b_modem;
+
+#endif // MODEM_H
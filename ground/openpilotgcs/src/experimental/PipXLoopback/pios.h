@@ -0,0 +1,44 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Stands in for the PiOS header the PipXtreme code includes
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef PIOS_H
+#define PIOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define TRUE	1
+#define FALSE	0
+
+// no LEDs, debug port or interrupts on the host
+#define USB_LED_OFF
+#define USB_LED_TOGGLE
+#define LINK_LED_ON
+#define LINK_LED_OFF
+#define RX_LED_OFF
+#define TX_LED_OFF
+#define DEBUG_PRINTF(...)
+#define PIOS_IRQ_Disable()
+#define PIOS_SYS_Reset()
+
+#endif // PIOS_H
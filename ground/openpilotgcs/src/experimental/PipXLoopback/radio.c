@@ -0,0 +1,124 @@
+/**
+ ******************************************************************************
+ *
+ * @file       radio.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Simulated RF channel between two modems, with packet loss and reordering
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "radio.h"
+#include <string.h>
+
+// a packet on its way to the other modem
+typedef struct {
+	bool used;
+	int to;
+	uint32_t due;					// ms
+	uint16_t length;
+	uint8_t data[RADIO_MAX_PACKET];
+} InFlight_t;
+
+Radio_t radio[RADIO_MODEMS];
+
+static InFlight_t inFlight[RADIO_IN_FLIGHT];
+static uint32_t loss_rate;
+static uint32_t late_rate;
+static uint32_t late_delay;
+static uint32_t random_state;
+
+// small LCG so every run loses the same packets
+static uint32_t radio_Random(void)
+{
+	random_state = random_state * 1103515245 + 12345;
+	return (random_state >> 8) % 1000000;
+}
+
+void radio_Init(uint32_t loss_per_million, uint32_t late_per_million, uint32_t late_ms)
+{
+	memset(radio, 0, sizeof(radio));
+	memset(inFlight, 0, sizeof(inFlight));
+	loss_rate = loss_per_million;
+	late_rate = late_per_million;
+	late_delay = late_ms;
+	random_state = 1;
+}
+
+// hand the packets that have arrived to their radio
+void radio_Tick(void)
+{
+	for (int i = 0; i < RADIO_IN_FLIGHT; i++) {
+		InFlight_t *p = &inFlight[i];
+		if (!p->used || p->due > uptime_ms) {
+			continue;
+		}
+		p->used = false;
+		Radio_t *r = &radio[p->to];
+		if (radio_Busy(p->to)) {
+			r->collided++;
+		} else if (r->rxLength > 0) {
+			r->overrun++;
+		} else {
+			memcpy(r->rx, p->data, p->length);
+			r->rxLength = p->length;
+		}
+	}
+}
+
+bool radio_Busy(int modem)
+{
+	return radio[modem].busyUntil > uptime_ms;
+}
+
+int32_t radio_Send(int modem, const void *data, uint16_t length)
+{
+	Radio_t *r = &radio[modem];
+	if (radio_Busy(modem)) {
+		return -4;
+	}
+	if (length == 0 || length > RADIO_MAX_PACKET) {
+		return -3;
+	}
+
+	uint32_t air_ms = ((length + RADIO_OVERHEAD) * 8 * 1000 + r->datarate - 1) / r->datarate;
+	r->busyUntil = uptime_ms + air_ms;
+	r->sent++;
+
+	if (loss_rate > 0 && radio_Random() < loss_rate) {
+		r->lost++;
+		return length;
+	}
+
+	for (int i = 0; i < RADIO_IN_FLIGHT; i++) {
+		InFlight_t *p = &inFlight[i];
+		if (p->used) {
+			continue;
+		}
+		p->used = true;
+		p->to = 1 - modem;
+		p->due = r->busyUntil;
+		// a late packet is overtaken by the ones sent after it
+		if (late_rate > 0 && radio_Random() < late_rate) {
+			p->due += late_delay;
+		}
+		p->length = length;
+		memcpy(p->data, data, length);
+		return length;
+	}
+
+	r->lost++;
+	return length;
+}
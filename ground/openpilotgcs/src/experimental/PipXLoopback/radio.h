@@ -0,0 +1,56 @@
+/**
+ ******************************************************************************
+ *
+ * @file       radio.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Simulated RF channel between two modems, with packet loss and reordering
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef RADIO_H
+#define RADIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RADIO_MODEMS		2
+#define RADIO_MAX_PACKET	256
+#define RADIO_IN_FLIGHT		16
+#define RADIO_OVERHEAD		12		// preamble, sync word and rfm22 header bytes sent with every packet
+
+// one modem's radio, half duplex like the rfm22
+typedef struct {
+	uint32_t datarate;				// bps
+	uint32_t busyUntil;				// ms, when it is done sending its current packet
+	uint8_t rx[RADIO_MAX_PACKET];	// received packet waiting to be read
+	uint16_t rxLength;
+	uint32_t sent;
+	uint32_t lost;					// dropped by the channel
+	uint32_t collided;				// arrived while this radio was transmitting
+	uint32_t overrun;				// arrived before the previous one was read
+} Radio_t;
+
+extern Radio_t radio[RADIO_MODEMS];
+
+// the modems' millisecond clock, ph_1ms_tick() is called on each increment
+extern volatile uint32_t uptime_ms;
+
+void radio_Init(uint32_t loss_per_million, uint32_t late_per_million, uint32_t late_ms);
+void radio_Tick(void);
+bool radio_Busy(int modem);
+int32_t radio_Send(int modem, const void *data, uint16_t length);
+
+#endif // RADIO_H
@@ -0,0 +1,52 @@
+#-------------------------------------------------
+#
+# Loopback test of the SSP serial upload protocol, the GCS side (qssp)
+# talks to the bootloader side (ssp.c) over a simulated serial pair
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = SSPLoopback
+CONFIG   += console
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+BOOTLOADER = ../../../../../flight/Bootloaders/OpenPilot
+UPLOADER = ../../plugins/uploader
+
+# pios.h in this directory stands in for the PiOS one ssp.c includes
+INCLUDEPATH += . \
+    ../../libs/qextserialport/src \
+    $$UPLOADER \
+    $$UPLOADER/SSP \
+    $$BOOTLOADER/inc
+
+HEADERS                 = ../../libs/qextserialport/src/qextserialport.h \
+                          ../../libs/qextserialport/src/qextserialport_global.h
+SOURCES                 = ../../libs/qextserialport/src/qextserialport.cpp
+
+unix:SOURCES           += ../../libs/qextserialport/src/posix_qextserialport.cpp
+
+win32 {
+  SOURCES          += ../../libs/qextserialport/src/win_qextserialport.cpp
+  DEFINES          += WINVER=0x0501
+}
+
+HEADERS += link.h \
+    device.h \
+    pios.h \
+    $$UPLOADER/SSP/port.h \
+    $$UPLOADER/SSP/qssp.h \
+    $$UPLOADER/SSP/common.h
+
+SOURCES += main.cpp \
+    link.c \
+    device.c \
+    $$BOOTLOADER/ssp.c \
+    $$UPLOADER/SSP/port.cpp \
+    $$UPLOADER/SSP/qssp.cpp
+
+QMAKE_CFLAGS += -std=gnu99
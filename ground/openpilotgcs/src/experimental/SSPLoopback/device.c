@@ -0,0 +1,99 @@
+/**
+ ******************************************************************************
+ *
+ * @file       device.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Bootloader end of the loopback test, runs flight/Bootloaders/OpenPilot/ssp.c
+ *             set up the way the bootloader's main.c does
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "device.h"
+#include "link.h"
+#include "ssp.h"
+#include <string.h>
+
+#define MAX_PACKET_DATA_LEN	255
+#define MAX_PACKET_BUF_SIZE	(1+1+MAX_PACKET_DATA_LEN+2)
+
+static uint8_t SSP_TxBuf[SSP_MAX_WINDOW * MAX_PACKET_BUF_SIZE];
+static uint8_t SSP_RxBuf[MAX_PACKET_BUF_SIZE];
+static Port_t ssp_port;
+static DeviceStats_t stats;
+
+static void SSP_CallBack(uint8_t *buf, uint16_t len)
+{
+	uint32_t number;
+
+	if (len < sizeof(number)) {
+		stats.outOfOrder++;
+		return;
+	}
+	memcpy(&number, buf, sizeof(number));
+	if (number != stats.received) {
+		stats.outOfOrder++;
+	}
+	stats.received++;
+}
+
+static int16_t SSP_SerialRead(void)
+{
+	return link_Read(&link_toDevice);
+}
+
+static void SSP_SerialWrite(uint8_t value)
+{
+	link_Write(&link_toHost, &value, 1);
+}
+
+static void SSP_SerialWriteBuffer(const uint8_t *buf, uint16_t len)
+{
+	link_Write(&link_toHost, buf, len);
+}
+
+static uint32_t SSP_GetTime(void)
+{
+	return link_TimeMs();
+}
+
+void device_Init(uint8_t txWindow)
+{
+	PortConfig_t config = { .rxBuf = SSP_RxBuf,
+		.rxBufSize = MAX_PACKET_DATA_LEN, .txBuf = SSP_TxBuf,
+		.txBufSize = MAX_PACKET_DATA_LEN, .txWindow = txWindow,
+		.max_retry = 10, .timeoutLen = 300,
+		.pfCallBack = SSP_CallBack, .pfSerialRead = SSP_SerialRead,
+		.pfSerialWrite = SSP_SerialWrite,
+		.pfSerialWriteBuffer = SSP_SerialWriteBuffer, .pfGetTime = SSP_GetTime, };
+
+	memset(&ssp_port, 0, sizeof(ssp_port));
+	memset(&stats, 0, sizeof(stats));
+	ssp_Init(&ssp_port, &config);
+}
+
+// one pass of the bootloader main loop
+void device_Step(void)
+{
+	ssp_ReceiveProcess(&ssp_port);
+	ssp_SendProcess(&ssp_port);
+}
+
+void device_GetStats(DeviceStats_t *out)
+{
+	stats.rxErrors = ssp_port.RxError;
+	stats.window = ssp_port.window;
+	memcpy(out, &stats, sizeof(stats));
+}
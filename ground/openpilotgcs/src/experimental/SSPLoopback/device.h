@@ -0,0 +1,48 @@
+/**
+ ******************************************************************************
+ *
+ * @file       device.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Bootloader end of the loopback test, runs flight/Bootloaders/OpenPilot/ssp.c
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef DEVICE_H
+#define DEVICE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// what the device saw of the packets numbered by the host
+typedef struct {
+	uint32_t received;		// packets handed to the application
+	uint32_t outOfOrder;	// packets handed over with the wrong number
+	uint32_t rxErrors;		// packets dropped on a bad CRC
+	uint8_t window;			// window agreed on at synchronisation
+} DeviceStats_t;
+
+void device_Init(uint8_t txWindow);
+void device_Step(void);
+void device_GetStats(DeviceStats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DEVICE_H
@@ -0,0 +1,102 @@
+/**
+ ******************************************************************************
+ *
+ * @file       link.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Simulated serial pair with a baud rate, latency and byte errors
+ *
+ * Time is simulated, it only moves on with link_Tick() so a run gives the
+ * same result on any machine. Each byte takes 10 bit times on the line and
+ * comes out the other end latency_us after it was sent, which stands for the
+ * USB serial adapter and the polling on both ends.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "link.h"
+#include <string.h>
+
+LinkDir_t link_toDevice;
+LinkDir_t link_toHost;
+
+static uint32_t now_us;
+static uint32_t byte_us;
+static uint32_t latency;
+static uint32_t error_rate;
+static uint32_t random_state;
+
+// small LCG so every run corrupts the same bytes
+static uint32_t link_Random(void)
+{
+	random_state = random_state * 1103515245 + 12345;
+	return (random_state >> 8) % 1000000;
+}
+
+void link_Init(uint32_t baud, uint32_t latency_us, uint32_t errors_per_million)
+{
+	memset(&link_toDevice, 0, sizeof(link_toDevice));
+	memset(&link_toHost, 0, sizeof(link_toHost));
+	now_us = 0;
+	byte_us = 10000000 / baud;
+	latency = latency_us;
+	error_rate = errors_per_million;
+	random_state = 1;
+}
+
+void link_Tick(uint32_t us)
+{
+	now_us += us;
+}
+
+uint32_t link_TimeUs(void)
+{
+	return now_us;
+}
+
+uint32_t link_TimeMs(void)
+{
+	return now_us / 1000;
+}
+
+void link_Write(LinkDir_t *dir, const uint8_t *buf, uint16_t length)
+{
+	for (uint16_t x = 0; x < length; x++) {
+		uint16_t next = (dir->head + 1) % LINK_BUFFER_SIZE;
+		if (next == dir->tail) {
+			dir->overruns++;
+			return;
+		}
+		if (dir->busyUntil < now_us) {
+			dir->busyUntil = now_us;
+		}
+		dir->busyUntil += byte_us;
+		dir->data[dir->head] = buf[x];
+		if (error_rate > 0 && link_Random() < error_rate) {
+			dir->data[dir->head] ^= 0x55;
+		}
+		dir->due[dir->head] = dir->busyUntil + latency;
+		dir->head = next;
+	}
+}
+
+int16_t link_Read(LinkDir_t *dir)
+{
+	if (dir->tail == dir->head || dir->due[dir->tail] > now_us) {
+		return -1;
+	}
+	uint8_t c = dir->data[dir->tail];
+	dir->tail = (dir->tail + 1) % LINK_BUFFER_SIZE;
+	return c;
+}
@@ -0,0 +1,58 @@
+/**
+ ******************************************************************************
+ *
+ * @file       link.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Simulated serial pair with a baud rate, latency and byte errors
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef LINK_H
+#define LINK_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LINK_BUFFER_SIZE	8192
+
+// one direction of the serial pair
+typedef struct {
+	uint8_t data[LINK_BUFFER_SIZE];
+	uint32_t due[LINK_BUFFER_SIZE];	// when each byte comes out the other end, in us
+	uint16_t head;
+	uint16_t tail;
+	uint32_t busyUntil;				// when the line is done sending what it has, in us
+	uint32_t overruns;
+} LinkDir_t;
+
+extern LinkDir_t link_toDevice;
+extern LinkDir_t link_toHost;
+
+void link_Init(uint32_t baud, uint32_t latency_us, uint32_t errors_per_million);
+void link_Tick(uint32_t us);
+uint32_t link_TimeUs(void);
+uint32_t link_TimeMs(void);
+void link_Write(LinkDir_t *dir, const uint8_t *buf, uint16_t length);
+int16_t link_Read(LinkDir_t *dir);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LINK_H
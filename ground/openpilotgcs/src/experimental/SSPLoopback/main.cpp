@@ -0,0 +1,172 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Loopback test of the SSP serial upload protocol
+ *
+ * The GCS end (plugins/uploader/SSP/qssp.cpp) sends numbered firmware sized
+ * packets to the bootloader end (flight/Bootloaders/OpenPilot/ssp.c) over a
+ * simulated 57600 baud serial pair. Every combination of windowed and stop
+ * and wait ends is run, with and without byte errors on the line, and the
+ * bootloader end checks each packet arrives once and in order. Exits with 1
+ * if any of them fails.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <QtCore/QCoreApplication>
+#include <QDebug>
+#include <string.h>
+#include "qssp.h"
+#include "port.h"
+#include "link.h"
+#include "device.h"
+
+#define MAX_PACKET_DATA_LEN	255
+#define MAX_PACKET_BUF_SIZE	(1+1+MAX_PACKET_DATA_LEN+2)
+
+#define BAUD            57600
+#define LATENCY_US      4000    // USB serial adapter and polling, each way
+#define PACKETS         400
+#define PACKET_LEN      63      // what op_dfu sends
+#define TICK_US         100
+#define TIME_LIMIT_MS   600000
+
+// GCS end of the serial pair
+class loopbackport : public port
+{
+public:
+    int16_t pfSerialRead(void)
+    {
+        int16_t c = link_Read(&link_toHost);
+        if(c == -1)
+        {
+            // nothing for us yet, let time pass and the bootloader run
+            link_Tick(TICK_US);
+            device_Step();
+        }
+        return c;
+    }
+    void pfSerialWrite(uint8_t c)
+    {
+        link_Write(&link_toDevice, &c, 1);
+    }
+    void pfSerialWriteBuffer(const uint8_t *buf, uint16_t length)
+    {
+        link_Write(&link_toDevice, buf, length);
+    }
+    uint32_t pfGetTime(void)
+    {
+        return link_TimeMs();
+    }
+};
+
+struct scenario
+{
+    const char *name;
+    uint8_t hostWindow;
+    uint8_t deviceWindow;
+    uint32_t errorsPerMillion;
+};
+
+static const scenario scenarios[] = {
+    { "stop and wait",                      1, 1, 0 },
+    { "windowed",                           8, 4, 0 },
+    { "windowed GCS, stop and wait device", 8, 1, 0 },
+    { "old GCS, windowed device",           1, 4, 0 },
+    { "stop and wait, line errors",         1, 1, 300 },
+    { "windowed, line errors",              8, 4, 300 },
+};
+
+static bool runScenario(const scenario &s)
+{
+    uint8_t txBuf[SSP_MAX_WINDOW * MAX_PACKET_BUF_SIZE];
+    uint8_t rxBuf[MAX_PACKET_BUF_SIZE];
+    uint8_t packet[PACKET_LEN];
+    DeviceStats_t stats;
+
+    link_Init(BAUD, LATENCY_US, s.errorsPerMillion);
+    device_Init(s.deviceWindow);
+
+    loopbackport info;
+    info.rxBuf      = rxBuf;
+    info.rxBufSize  = MAX_PACKET_DATA_LEN;
+    info.txBuf      = txBuf;
+    info.txBufSize  = MAX_PACKET_DATA_LEN;
+    info.txWindow   = s.hostWindow;
+    info.max_retry  = 10;
+    info.timeoutLen = 300;
+    info.InputState = state_unescaped_e;
+    info.DecodeState = decode_idle_e;
+    info.flags      = 0;
+    qssp host(&info, false);
+
+    if(!host.ssp_Synchronise())
+    {
+        qDebug("%-36s FAILED to synchronise", s.name);
+        return false;
+    }
+
+    uint32_t start = link_TimeMs();
+    uint32_t sent = 0;
+    int16_t status = SSP_TX_IDLE;
+    while(link_TimeMs() - start < TIME_LIMIT_MS)
+    {
+        if(sent < PACKETS && host.ssp_SendReady())
+        {
+            for(int x = 0; x < PACKET_LEN; x++)
+                packet[x] = (uint8_t)(sent * 7 + x);
+            memcpy(packet, &sent, sizeof(sent));
+            host.ssp_SendData(packet, PACKET_LEN);
+            sent++;
+        }
+        host.ssp_ReceiveProcess();
+        status = host.ssp_SendProcess();
+        if(status == SSP_TX_TIMEOUT)
+            break;
+        if(sent == PACKETS && status == SSP_TX_IDLE)
+            break;
+    }
+    uint32_t elapsed = link_TimeMs() - start;
+
+    // let the bootloader see anything still on the line
+    for(int x = 0; x < 1000; x++)
+        info.pfSerialRead();
+    device_GetStats(&stats);
+
+    bool ok = (status != SSP_TX_TIMEOUT) && (stats.received == PACKETS) && (stats.outOfOrder == 0);
+    qDebug("%-36s %s window %u, %u packets in %u ms, %u bytes/s, %u bad CRCs",
+           s.name, ok ? "OK    " : "FAILED", host.ssp_Window(), stats.received, elapsed,
+           elapsed ? (unsigned)((uint64_t)stats.received * PACKET_LEN * 1000 / elapsed) : 0,
+           stats.rxErrors);
+    if(stats.window != host.ssp_Window())
+    {
+        qDebug("%-36s FAILED the ends agreed on different windows", s.name);
+        ok = false;
+    }
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    bool ok = true;
+
+    for(unsigned x = 0; x < sizeof(scenarios) / sizeof(scenarios[0]); x++)
+        ok &= runScenario(scenarios[x]);
+
+    return ok ? 0 : 1;
+}
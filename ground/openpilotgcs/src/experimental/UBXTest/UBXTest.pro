@@ -0,0 +1,35 @@
+#-------------------------------------------------
+#
+# Host test of the GPS module UBX parser: NAV-PVT and legacy decoding,
+# framing errors and the configuration ACK/NAK handshake
+#
+#-------------------------------------------------
+
+TARGET = UBXTest
+CONFIG   += console
+CONFIG   -= qt app_bundle
+
+TEMPLATE = app
+
+GPS = ../../../../../flight/Modules/GPS
+
+# openpilot.h, pios.h and the UAVObject headers in this directory stand in
+# for the flight ones UBX.c includes
+INCLUDEPATH += . \
+    $$GPS/inc
+
+HEADERS += openpilot.h \
+    pios.h \
+    uavobjects.h \
+    gpsposition.h \
+    gpstime.h \
+    $$GPS/inc/UBX.h
+
+SOURCES += main.c \
+    $$GPS/UBX.c
+
+# flight gps_mode.h selects NMEA, UBX.c is empty without this
+DEFINES += ENABLE_GPS_BINARY_UBX
+
+QMAKE_CFLAGS += -std=gnu99
+LIBS += -lm
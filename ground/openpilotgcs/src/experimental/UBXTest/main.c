@@ -0,0 +1,621 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Host test of the GPS module UBX parser
+ *
+ * Feeds flight/Modules/GPS/UBX.c the way the GPS task does, a byte at a
+ * time, and checks:
+ *   - the decoding of NAV-PVT, and of NAV-SOL, NAV-POSLLH and NAV-VELNED
+ *     merged per epoch plus NAV-TIMEUTC for receivers without NAV-PVT
+ *   - checksum and framing errors are counted and the parser picks the
+ *     stream up again, also after random garbage; build with
+ *     -fsanitize=address to catch any out of bounds access
+ *   - the configuration handshake against a simulated receiver that acks
+ *     or naks NAV-PVT, loses frames, answers late or answers twice: every
+ *     message goes out in order, none is skipped and the NAV-PVT probe
+ *     picks the right messages
+ * Exits with 1 if any check fails.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include "uavobjects.h"
+#include "pios.h"
+#include "UBX.h"
+
+#define FUZZ_RUNS           20000
+#define MAX_FRAME_LEN       1024    // UBX_MAX_FRAME_LEN in UBX.c
+#define CONFIG_TIMEOUT_MS   500     // UBX_CONFIG_TIMEOUT_MS in UBX.c
+#define TICK_MS             10      // how often the GPS task calls UBX_config_update()
+#define MAX_SENT            64
+
+typedef struct
+{
+	uint32_t parsed;
+	uint32_t unhandled;
+	uint32_t chksumErrors;
+	uint32_t parsingErrors;
+} Counts_t;
+
+// a configuration message taken from UBX_config_update()
+typedef struct
+{
+	uint32_t ms;
+	uint8_t  msgClass;
+	uint8_t  msgId;
+	uint8_t  len;
+	uint8_t  payload[8];
+} Sent_t;
+
+static GPSPositionData position;
+static GPSTimeData gpstime;
+static uint32_t positionUpdates;
+static uint32_t timeUpdates;
+static Sent_t sent[MAX_SENT];
+static int sentCount;
+static uint32_t nowMs;
+static int failures;
+
+#define CHECK(test) \
+	do { if (!(test)) { printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #test); failures++; } } while (0)
+
+void GPSPositionGet(GPSPositionData *data) { *data = position; }
+void GPSPositionSet(GPSPositionData *data) { position = *data; positionUpdates++; }
+void GPSTimeGet(GPSTimeData *data) { *data = gpstime; }
+void GPSTimeSet(GPSTimeData *data) { gpstime = *data; timeUpdates++; }
+void GPSSatellitesSet(GPSSatellitesData *data) { }
+
+int32_t PIOS_COM_SendBufferNonBlocking(uint32_t com_id, const uint8_t *buffer, uint16_t len)
+{
+	uint8_t ck_a = 0;
+	uint8_t ck_b = 0;
+
+	CHECK(len >= 8 && buffer[0] == 0xB5 && buffer[1] == 0x62);
+	CHECK(buffer[4] + 8 == len && buffer[5] == 0);
+	for (int i = 2; i < len - 2; i++)
+	{
+		ck_a += buffer[i];
+		ck_b += ck_a;
+	}
+	CHECK(buffer[len - 2] == ck_a && buffer[len - 1] == ck_b);
+
+	if (sentCount < MAX_SENT && len >= 8 && buffer[4] <= sizeof(sent[0].payload))
+	{
+		Sent_t *s = &sent[sentCount++];
+		s->ms = nowMs;
+		s->msgClass = buffer[2];
+		s->msgId = buffer[3];
+		s->len = buffer[4];
+		memcpy(s->payload, &buffer[6], s->len);
+	}
+	return len;
+}
+
+// small xorshift so every run is the same
+static uint32_t random_state = 2463534242u;
+
+static uint32_t fuzzRandom(uint32_t range)
+{
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 17;
+	random_state ^= random_state << 5;
+	return random_state % range;
+}
+
+// returns the result for the last byte
+static int feed(const uint8_t *buf, size_t len, Counts_t *counts)
+{
+	int res = -1;
+
+	for (size_t i = 0; i < len; i++)
+	{
+		res = UBX_update_position(buf[i], &counts->chksumErrors, &counts->parsingErrors);
+		if (res == 0)
+			counts->parsed++;
+		else if (res == 1)
+			counts->unhandled++;
+	}
+	return res;
+}
+
+// frames a payload with its checksum, returns the frame length
+static size_t frame(uint8_t *buf, uint8_t msgClass, uint8_t msgId, const uint8_t *payload, uint16_t len)
+{
+	uint8_t ck_a = 0;
+	uint8_t ck_b = 0;
+
+	buf[0] = 0xB5;
+	buf[1] = 0x62;
+	buf[2] = msgClass;
+	buf[3] = msgId;
+	buf[4] = len & 0xff;
+	buf[5] = len >> 8;
+	memcpy(&buf[6], payload, len);
+	for (size_t i = 2; i < 6 + (size_t)len; i++)
+	{
+		ck_a += buf[i];
+		ck_b += ck_a;
+	}
+	buf[6 + len] = ck_a;
+	buf[7 + len] = ck_b;
+	return 8 + len;
+}
+
+static int feedFrame(uint8_t msgClass, uint8_t msgId, const uint8_t *payload, uint16_t len, Counts_t *counts)
+{
+	uint8_t buf[8 + MAX_FRAME_LEN];
+
+	return feed(buf, frame(buf, msgClass, msgId, payload, len), counts);
+}
+
+// the payloads are built field by field from the u-blox protocol spec
+// offsets rather than with the structs in UBX.c
+static void put16(uint8_t *p, int off, uint16_t v)
+{
+	p[off] = v & 0xff;
+	p[off + 1] = v >> 8;
+}
+
+static void put32(uint8_t *p, int off, uint32_t v)
+{
+	put16(p, off, v & 0xffff);
+	put16(p, off + 2, v >> 16);
+}
+
+static bool near(float a, float b)
+{
+	return fabsf(a - b) < 1e-4f * (1.0f + fabsf(b));
+}
+
+// ************
+// decoding
+
+static void navPvt(uint8_t *p, uint8_t fixType, uint8_t flags, uint8_t valid)
+{
+	memset(p, 0, 92);
+	put32(p, 0, 123456000);             // iTOW
+	put16(p, 4, 2026);                  // year
+	p[6] = 7;                           // month
+	p[7] = 4;                           // day
+	p[8] = 20;                          // hour
+	p[9] = 15;                          // min
+	p[10] = 30;                         // sec
+	p[11] = valid;
+	p[20] = fixType;
+	p[21] = flags;
+	p[23] = 11;                         // numSV
+	put32(p, 24, (uint32_t)-1511250000); // lon
+	put32(p, 28, (uint32_t)-338702123); // lat
+	put32(p, 32, 58123);                // height
+	put32(p, 36, 12300);                // hMSL
+	put32(p, 60, 5926);                 // gSpeed
+	put32(p, 64, 3850000);              // headMot
+	put16(p, 76, 183);                  // pDOP
+}
+
+static void testPvt(void)
+{
+	Counts_t c;
+	uint8_t p[100];
+
+	memset(&c, 0, sizeof(c));
+	memset(&position, 0, sizeof(position));
+	position.HDOP = 1.3f;   // not in NAV-PVT, has to be kept
+
+	// u-blox 8 and later send 92 bytes
+	navPvt(p, 3, 0x01, 0x07);
+	timeUpdates = 0;
+	CHECK(feedFrame(0x01, 0x07, p, 92, &c) == 0);
+	CHECK(position.Status == GPSPOSITION_STATUS_FIX3D);
+	CHECK(position.Latitude == -338702123);
+	CHECK(position.Longitude == -1511250000);
+	CHECK(near(position.Altitude, 12.3f));
+	CHECK(near(position.GeoidSeparation, 45.823f));
+	CHECK(near(position.Heading, 38.5f));
+	CHECK(near(position.Groundspeed, 5.926f));
+	CHECK(position.Satellites == 11);
+	CHECK(near(position.PDOP, 1.83f));
+	CHECK(near(position.HDOP, 1.3f));
+	CHECK(timeUpdates == 1);
+	CHECK(gpstime.Year == 2026 && gpstime.Month == 7 && gpstime.Day == 4);
+	CHECK(gpstime.Hour == 20 && gpstime.Minute == 15 && gpstime.Second == 30);
+
+	// the first 84 bytes are enough, the time is only taken when valid
+	navPvt(p, 2, 0x01, 0x01);
+	CHECK(feedFrame(0x01, 0x07, p, 84, &c) == 0);
+	CHECK(position.Status == GPSPOSITION_STATUS_FIX2D);
+	CHECK(timeUpdates == 1);
+
+	// no fix unless gnssFixOK is set
+	navPvt(p, 3, 0x00, 0x07);
+	CHECK(feedFrame(0x01, 0x07, p, 92, &c) == 0);
+	CHECK(position.Status == GPSPOSITION_STATUS_NOFIX);
+	navPvt(p, 5, 0x01, 0x07);
+	CHECK(feedFrame(0x01, 0x07, p, 92, &c) == 0);
+	CHECK(position.Status == GPSPOSITION_STATUS_NOFIX);
+
+	CHECK(c.parsed == 4 && c.chksumErrors == 0 && c.parsingErrors == 0);
+}
+
+static void navSol(uint8_t *p, uint32_t iTOW)
+{
+	memset(p, 0, 52);
+	put32(p, 0, iTOW);
+	p[10] = 3;                          // gpsFix
+	p[11] = 0x01;                       // flags
+	put16(p, 44, 250);                  // pDOP
+	p[47] = 7;                          // numSV
+}
+
+static void navPosllh(uint8_t *p, uint32_t iTOW)
+{
+	memset(p, 0, 28);
+	put32(p, 0, iTOW);
+	put32(p, 4, 115166666);             // lon
+	put32(p, 8, 481173000);             // lat
+	put32(p, 12, 592300);               // height
+	put32(p, 16, 545400);               // hMSL
+}
+
+static void navVelned(uint8_t *p, uint32_t iTOW)
+{
+	memset(p, 0, 36);
+	put32(p, 0, iTOW);
+	put32(p, 20, 1152);                 // gSpeed
+	put32(p, 24, 8440000);              // heading
+}
+
+static void testLegacy(void)
+{
+	Counts_t c;
+	uint8_t p[64];
+
+	memset(&c, 0, sizeof(c));
+	memset(&position, 0, sizeof(position));
+	positionUpdates = 0;
+
+	// GPSPosition is only set once all three of an epoch are in, in any order
+	navVelned(p, 1000);
+	CHECK(feedFrame(0x01, 0x12, p, 36, &c) == 1);
+	navSol(p, 1000);
+	CHECK(feedFrame(0x01, 0x06, p, 52, &c) == 1);
+	CHECK(positionUpdates == 0);
+	navPosllh(p, 1000);
+	CHECK(feedFrame(0x01, 0x02, p, 28, &c) == 0);
+	CHECK(positionUpdates == 1);
+	CHECK(position.Status == GPSPOSITION_STATUS_FIX3D);
+	CHECK(position.Satellites == 7);
+	CHECK(near(position.PDOP, 2.5f));
+	CHECK(position.Latitude == 481173000);
+	CHECK(position.Longitude == 115166666);
+	CHECK(near(position.Altitude, 545.4f));
+	CHECK(near(position.GeoidSeparation, 46.9f));
+	CHECK(near(position.Heading, 84.4f));
+	CHECK(near(position.Groundspeed, 11.52f));
+
+	// an epoch that is missing a message is dropped when the next one starts
+	navSol(p, 1100);
+	CHECK(feedFrame(0x01, 0x06, p, 52, &c) == 1);
+	navPosllh(p, 1100);
+	CHECK(feedFrame(0x01, 0x02, p, 28, &c) == 1);
+	navSol(p, 1200);
+	CHECK(feedFrame(0x01, 0x06, p, 52, &c) == 1);
+	navVelned(p, 1200);
+	CHECK(feedFrame(0x01, 0x12, p, 36, &c) == 1);
+	CHECK(positionUpdates == 1);
+	navPosllh(p, 1200);
+	CHECK(feedFrame(0x01, 0x02, p, 28, &c) == 0);
+	CHECK(positionUpdates == 2);
+
+	// UTC only once the receiver knows it
+	memset(p, 0, 20);
+	put16(p, 12, 2094);
+	p[14] = 3;
+	p[15] = 23;
+	p[16] = 12;
+	p[17] = 35;
+	p[18] = 19;
+	p[19] = 0x03;
+	timeUpdates = 0;
+	CHECK(feedFrame(0x01, 0x21, p, 20, &c) == 1);
+	CHECK(timeUpdates == 0);
+	p[19] = 0x07;
+	CHECK(feedFrame(0x01, 0x21, p, 20, &c) == 1);
+	CHECK(timeUpdates == 1);
+	CHECK(gpstime.Year == 2094 && gpstime.Month == 3 && gpstime.Day == 23);
+	CHECK(gpstime.Hour == 12 && gpstime.Minute == 35 && gpstime.Second == 19);
+
+	CHECK(c.chksumErrors == 0 && c.parsingErrors == 0);
+}
+
+static void testErrors(void)
+{
+	Counts_t c;
+	uint8_t p[256];
+	uint8_t buf[8 + 256];
+	size_t n;
+
+	memset(&c, 0, sizeof(c));
+	navPvt(p, 3, 0x01, 0x07);
+
+	// a bad checksum is counted, the next frame is parsed
+	n = frame(buf, 0x01, 0x07, p, 92);
+	buf[n - 1] ^= 0x10;
+	CHECK(feed(buf, n, &c) == -2);
+	CHECK(c.chksumErrors == 1);
+	CHECK(feedFrame(0x01, 0x07, p, 92, &c) == 0);
+
+	// a known message with the wrong length is a parsing error
+	CHECK(feedFrame(0x01, 0x07, p, 60, &c) < 0);
+	CHECK(feedFrame(0x01, 0x06, p, 51, &c) < 0);
+	CHECK(c.parsingErrors == 2);
+
+	// a length no frame has, the parser looks for the next sync
+	n = frame(buf, 0x01, 0x07, p, 92);
+	buf[5] = 0x40;
+	CHECK(feed(buf, n, &c) < 0);
+	CHECK(c.parsingErrors == 3);
+	CHECK(feedFrame(0x01, 0x07, p, 92, &c) == 0);
+
+	// messages we don't decode, also ones longer than the parser keeps,
+	// and a sync byte repeated in front of a frame
+	for (int i = 0; i < 256; i++)
+		p[i] = i;
+	CHECK(feedFrame(0x01, 0x35, p, 248, &c) == 1);
+	CHECK(feedFrame(0x0A, 0x04, p, 100, &c) == 1);
+	CHECK(feed((const uint8_t *)"\xB5", 1, &c) == -1);
+	navPvt(p, 3, 0x01, 0x07);
+	CHECK(feedFrame(0x01, 0x07, p, 92, &c) == 0);
+
+	CHECK(c.chksumErrors == 1 && c.parsingErrors == 3);
+}
+
+static void testFuzz(void)
+{
+	static const uint8_t special[] = {0xB5, 0x62, 0x01, 0x05, 0x06, 0x07, 0x00, 0xFF};
+	uint8_t p[92];
+	uint8_t stream[1024];
+	uint8_t zeros[8 + MAX_FRAME_LEN];
+	Counts_t c;
+
+	memset(&c, 0, sizeof(c));
+	memset(zeros, 0, sizeof(zeros));
+	navPvt(p, 3, 0x01, 0x07);
+
+	for (uint32_t run = 0; run < FUZZ_RUNS; run++)
+	{
+		// a few good frames with random bytes changed, inserted and dropped
+		size_t n = 0;
+		while (n + 100 < sizeof(stream))
+			n += frame(&stream[n], 0x01, fuzzRandom(2) ? 0x07 : 0x06, p, fuzzRandom(2) ? 92 : 52);
+
+		uint32_t edits = 1 + fuzzRandom(16);
+		for (uint32_t e = 0; e < edits && n > 1; e++)
+		{
+			size_t at = fuzzRandom(n);
+			uint8_t b = fuzzRandom(2) ? fuzzRandom(256) : special[fuzzRandom(sizeof(special))];
+			switch (fuzzRandom(3))
+			{
+			case 0:
+				stream[at] = b;
+				break;
+			case 1:
+				if (n < sizeof(stream))
+				{
+					memmove(&stream[at + 1], &stream[at], n - at);
+					stream[at] = b;
+					n++;
+				}
+				break;
+			default:
+				memmove(&stream[at], &stream[at + 1], n - at - 1);
+				n--;
+				break;
+			}
+		}
+		feed(stream, n, &c);
+
+		// the longest length the parser takes swallows at most this many
+		// bytes, after that it has to pick the stream up again
+		feed(zeros, sizeof(zeros), &c);
+		CHECK(feedFrame(0x01, 0x07, p, 92, &c) == 0);
+		if (failures > 10)
+			break;
+	}
+	printf("%-24s %u runs, %u parsed, %u checksum errors, %u parsing errors\n",
+	       "fuzz", FUZZ_RUNS, c.parsed, c.chksumErrors, c.parsingErrors);
+}
+
+// ************
+// configuration handshake
+
+// how the simulated receiver treats the configuration messages
+typedef struct
+{
+	const char *name;
+	bool     pvt;           // knows NAV-PVT, naks it otherwise
+	bool     loseFirst;     // the first frame of each message gets lost
+	bool     twice;         // every answer arrives twice
+	uint32_t delayMs;       // answers arrive this late
+	bool     strayNak;      // a stray CFG-MSG NAK arrives after CFG-RATE is acked
+} Receiver_t;
+
+typedef struct
+{
+	uint32_t due;
+	bool     ack;
+	uint8_t  msgClass;
+	uint8_t  msgId;
+} Answer_t;
+
+// the CFG-MSG messages in the order UBX.c has to send them, class and id
+static const uint8_t pvtMessages[][2] = {{0x01, 0x07}};
+static const uint8_t legacyMessages[][2] = {{0x01, 0x07}, {0x01, 0x06}, {0x01, 0x02}, {0x01, 0x12}, {0x01, 0x21}};
+static const uint8_t nmeaMessages[][2] = {{0xF0, 0x00}, {0xF0, 0x01}, {0xF0, 0x02}, {0xF0, 0x03}, {0xF0, 0x04}, {0xF0, 0x05}};
+
+static void answer(const Answer_t *a, Counts_t *c)
+{
+	uint8_t p[2] = {a->msgClass, a->msgId};
+
+	CHECK(feedFrame(0x05, a->ack ? 0x01 : 0x00, p, 2, c) == 1);
+}
+
+static void testConfig(const Receiver_t *rx)
+{
+	Answer_t answers[MAX_SENT * 2];
+	int answerCount = 0;
+	bool lost[256] = {false};   // by CFG-MSG id, CFG-RATE uses 255
+	Counts_t c;
+	int expected[2 + 5 + 6][2];
+	int expectedCount = 0;
+
+	memset(&c, 0, sizeof(c));
+	sentCount = 0;
+	UBX_init(0);
+
+	for (nowMs = 0; nowMs < 20000; nowMs += TICK_MS)
+	{
+		// answers due now arrive before the task gets to send
+		while (answerCount > 0 && answers[0].due <= nowMs)
+		{
+			answer(&answers[0], &c);
+			memmove(&answers[0], &answers[1], --answerCount * sizeof(answers[0]));
+		}
+
+		int before = sentCount;
+		UBX_config_update(nowMs);
+
+		for (int i = before; i < sentCount; i++)
+		{
+			const Sent_t *s = &sent[i];
+			if (s->msgClass != 0x06 || s->len < 2)
+				continue;
+
+			uint8_t key = (s->msgId == 0x08) ? 255 : s->payload[1] + (s->payload[0] == 0xF0 ? 128 : 0);
+			if (rx->loseFirst && !lost[key])
+			{
+				lost[key] = true;
+				continue;
+			}
+
+			Answer_t a;
+			a.due = nowMs + rx->delayMs;
+			a.ack = rx->pvt || s->msgId != 0x01 || s->payload[0] != 0x01 || s->payload[1] != 0x07;
+			a.msgClass = s->msgClass;
+			a.msgId = s->msgId;
+			for (int n = rx->twice ? 2 : 1; n > 0 && answerCount < MAX_SENT * 2; n--)
+				answers[answerCount++] = a;
+
+			if (rx->strayNak && s->msgId == 0x08)
+			{
+				a.ack = false;
+				a.msgId = 0x01;
+				answers[answerCount++] = a;
+			}
+		}
+	}
+
+	// CFG-RATE, then the solution messages, then NMEA off
+	expected[expectedCount][0] = 0x08;
+	expected[expectedCount++][1] = 0;
+	if (rx->pvt)
+	{
+		for (size_t i = 0; i < sizeof(pvtMessages) / sizeof(pvtMessages[0]); i++)
+		{
+			expected[expectedCount][0] = pvtMessages[i][0];
+			expected[expectedCount++][1] = pvtMessages[i][1];
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < sizeof(legacyMessages) / sizeof(legacyMessages[0]); i++)
+		{
+			expected[expectedCount][0] = legacyMessages[i][0];
+			expected[expectedCount++][1] = legacyMessages[i][1];
+		}
+	}
+	for (size_t i = 0; i < sizeof(nmeaMessages) / sizeof(nmeaMessages[0]); i++)
+	{
+		expected[expectedCount][0] = nmeaMessages[i][0];
+		expected[expectedCount++][1] = nmeaMessages[i][1];
+	}
+
+	// every message once, twice if its first frame got lost, in order
+	int e = 0;
+	int resends = 0;
+	bool ok = true;
+	for (int i = 0; i < sentCount && ok; i++)
+	{
+		const Sent_t *s = &sent[i];
+		bool rate = (s->msgClass == 0x06 && s->msgId == 0x08);
+		bool msg = (s->msgClass == 0x06 && s->msgId == 0x01 && s->len == 3);
+
+		if (i > 0 && s->msgId == sent[i - 1].msgId && s->len == sent[i - 1].len &&
+			memcmp(s->payload, sent[i - 1].payload, s->len) == 0)
+		{	// sent again, only after the timeout
+			CHECK(s->ms - sent[i - 1].ms >= CONFIG_TIMEOUT_MS);
+			resends++;
+			continue;
+		}
+		if (e >= expectedCount)
+			ok = false;
+		else if (expected[e][0] == 0x08)
+			ok = rate;
+		else
+			ok = msg && s->payload[0] == expected[e][0] && s->payload[1] == expected[e][1];
+		e++;
+	}
+	CHECK(ok);
+	CHECK(e == expectedCount);
+	CHECK(resends == (rx->loseFirst ? expectedCount : 0));
+	CHECK(c.chksumErrors == 0 && c.parsingErrors == 0);
+
+	printf("%-24s %d messages, %d resends, done after %u ms%s\n", rx->name, e, resends,
+	       sentCount ? sent[sentCount - 1].ms : 0, (ok && e == expectedCount) ? "" : " (wrong sequence)");
+}
+
+int main(int argc, char *argv[])
+{
+	static const Receiver_t receivers[] =
+	{
+		// name                 pvt    loseFirst twice  delayMs strayNak
+		{"config, NAV-PVT",     true,  false,    false, 0,      false},
+		{"config, legacy",      false, false,    false, 0,      false},
+		{"config, lost frames", false, true,     false, 0,      false},
+		{"config, late answers", true, false,    false, 120,    false},
+		{"config, double",      true,  false,    true,  0,      false},
+		{"config, legacy double", false, false,  true,  0,      false},
+		{"config, double late", false, false,    true,  200,    false},
+		{"config, stray NAK",   true,  false,    false, 0,      true},
+	};
+
+	testPvt();
+	testLegacy();
+	testErrors();
+	testFuzz();
+
+	for (size_t i = 0; i < sizeof(receivers) / sizeof(receivers[0]); i++)
+		testConfig(&receivers[i]);
+
+	printf(failures ? "FAILED\n" : "OK\n");
+	return failures ? 1 : 0;
+}
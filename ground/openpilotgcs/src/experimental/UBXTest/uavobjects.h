@@ -0,0 +1,81 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjects.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      The GPS UAVObjects the UBX parser updates. main.c keeps one
+ *             instance of each and counts the updates.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVOBJECTS_H
+#define UAVOBJECTS_H
+
+#include <stdint.h>
+
+typedef struct {
+	uint8_t Status;
+	int32_t Latitude;
+	int32_t Longitude;
+	float Altitude;
+	float GeoidSeparation;
+	float Heading;
+	float Groundspeed;
+	int8_t Satellites;
+	float PDOP;
+	float HDOP;
+	float VDOP;
+} GPSPositionData;
+
+enum {
+	GPSPOSITION_STATUS_NOGPS = 0,
+	GPSPOSITION_STATUS_NOFIX,
+	GPSPOSITION_STATUS_FIX2D,
+	GPSPOSITION_STATUS_FIX3D
+};
+
+typedef struct {
+	int8_t Month;
+	int8_t Day;
+	int16_t Year;
+	int8_t Hour;
+	int8_t Minute;
+	int8_t Second;
+} GPSTimeData;
+
+typedef struct {
+	int8_t SatsInView;
+	int8_t PRN[16];
+	float Elevation[16];
+	float Azimuth[16];
+	int8_t SNR[16];
+} GPSSatellitesData;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void GPSPositionGet(GPSPositionData *data);
+void GPSPositionSet(GPSPositionData *data);
+void GPSTimeGet(GPSTimeData *data);
+void GPSTimeSet(GPSTimeData *data);
+void GPSSatellitesSet(GPSSatellitesData *data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UAVOBJECTS_H
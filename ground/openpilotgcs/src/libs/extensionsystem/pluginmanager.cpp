@@ -37,6 +37,8 @@
 #include <QtCore/QDir>
 #include <QtCore/QTextStream>
 #include <QtCore/QWriteLocker>
+#include <QtCore/QSet>
+#include <QtCore/QtConcurrentMap>
 #include <QtDebug>
 #ifdef WITH_TESTS
 #include <QTest>
@@ -245,6 +247,19 @@ void PluginManager::loadPlugins()
     return d->loadPlugins();
 }
 
+/*!
+    \fn bool PluginManager::loadLazyPlugin(PluginSpec *spec)
+    Loads, initializes and runs a plugin that was left out of loadPlugins()
+    because it is lazy, together with any of its dependencies that are not
+    running yet. Returns true if the plugin is running afterwards.
+
+    \sa PluginSpec::isLazy()
+*/
+bool PluginManager::loadLazyPlugin(PluginSpec *spec)
+{
+    return d->loadLazyPlugin(spec);
+}
+
 /*!
     \fn QStringList PluginManager::pluginPaths() const
     The list of paths were the plugin manager searches for plugins.
@@ -379,6 +394,9 @@ void PluginManager::formatOptions(QTextStream &str, int optionIndentation, int d
     formatOption(str, QLatin1String(OptionsParser::NO_LOAD_OPTION),
                  QLatin1String("plugin"), QLatin1String("Do not load <plugin>"),
                  optionIndentation, descriptionIndentation);
+    formatOption(str, QLatin1String(OptionsParser::PROFILE_OPTION),
+                 QString(), QLatin1String("Print the time each startup phase takes"),
+                 optionIndentation, descriptionIndentation);
 }
 
 /*!
@@ -488,8 +506,10 @@ PluginSpecPrivate *PluginManagerPrivate::privateSpec(PluginSpec *spec)
     \internal
 */
 PluginManagerPrivate::PluginManagerPrivate(PluginManager *pluginManager)
-    : extension("xml"), q(pluginManager)
+    : extension("xml"), q(pluginManager),
+    profiling(false), profileElapsedMS(0), readPluginPathsMS(0)
 {
+    profileTimer.start();
 }
 
 /*!
@@ -509,7 +529,9 @@ void PluginManagerPrivate::stopAll()
 {
     QList<PluginSpec *> queue = loadQueue();
     foreach (PluginSpec *spec, queue) {
-        loadPlugin(spec, PluginSpec::Stopped);
+        // lazy plugins that were never started have nothing to stop
+        if (spec->plugin())
+            loadPlugin(spec, PluginSpec::Stopped);
     }
     QListIterator<PluginSpec *> it(queue);
     it.toBack();
@@ -573,7 +595,8 @@ void PluginManagerPrivate::removeObject(QObject *obj)
 */
 void PluginManagerPrivate::loadPlugins()
 {
-    QList<PluginSpec *> queue = loadQueue();
+    QList<PluginSpec *> queue = startupQueue();
+    openLibraries(queue);
     foreach (PluginSpec *spec, queue) {
         loadPlugin(spec, PluginSpec::Loaded);
     }
@@ -585,9 +608,124 @@ void PluginManagerPrivate::loadPlugins()
     while (it.hasPrevious()) {
         loadPlugin(it.previous(), PluginSpec::Running);
     }
+    profilingReport("<loadPlugins");
     emit q->pluginsChanged();
 }
 
+/*!
+    \fn bool PluginManagerPrivate::loadLazyPlugin(PluginSpec *spec)
+    \internal
+*/
+bool PluginManagerPrivate::loadLazyPlugin(PluginSpec *spec)
+{
+    if (spec->hasError())
+        return false;
+    if (spec->state() == PluginSpec::Running)
+        return true;
+    QList<PluginSpec *> queue;
+    QList<PluginSpec *> circularityCheckQueue;
+    if (!loadQueue(spec, queue, circularityCheckQueue))
+        return false;
+    // only what is not running yet, the dependencies usually are
+    QList<PluginSpec *> pending;
+    foreach (PluginSpec *queued, queue) {
+        if (queued->state() == PluginSpec::Resolved)
+            pending.append(queued);
+    }
+    profilingReport(">loadLazyPlugin", spec);
+    openLibraries(pending);
+    foreach (PluginSpec *pendingSpec, pending) {
+        loadPlugin(pendingSpec, PluginSpec::Loaded);
+    }
+    foreach (PluginSpec *pendingSpec, pending) {
+        loadPlugin(pendingSpec, PluginSpec::Initialized);
+    }
+    QListIterator<PluginSpec *> it(pending);
+    it.toBack();
+    while (it.hasPrevious()) {
+        loadPlugin(it.previous(), PluginSpec::Running);
+    }
+    profilingReport("<loadLazyPlugin", spec);
+    emit q->pluginsChanged();
+    return spec->state() == PluginSpec::Running;
+}
+
+/*!
+    \fn QList<PluginSpec *> PluginManagerPrivate::startupQueue()
+    \internal
+
+    The load queue without the lazy plugins, unless a plugin loaded at
+    startup depends on them.
+*/
+QList<PluginSpec *> PluginManagerPrivate::startupQueue()
+{
+    QList<PluginSpec *> queue = loadQueue();
+    // plugins come after their dependencies in the queue, so going through it
+    // backwards all the plugins that depend on a plugin are seen before it
+    QSet<PluginSpec *> needed;
+    QListIterator<PluginSpec *> it(queue);
+    it.toBack();
+    while (it.hasPrevious()) {
+        PluginSpec *spec = it.previous();
+        if (spec->isLazy() && !needed.contains(spec))
+            continue;
+        needed.insert(spec);
+        foreach (PluginSpec *depSpec, spec->dependencySpecs())
+            needed.insert(depSpec);
+    }
+    QList<PluginSpec *> startup;
+    foreach (PluginSpec *spec, queue) {
+        if (needed.contains(spec))
+            startup.append(spec);
+    }
+    profilingReport("startupQueue");
+    return startup;
+}
+
+/*!
+    \fn void PluginManagerPrivate::openLibraries(const QList<PluginSpec *> &queue)
+    \internal
+
+    Opens the libraries of the plugins in \a queue on the thread pool ahead of
+    loadPlugin(), one level of the dependency graph at a time so a library's
+    plugin dependencies are always open before it is. How much runs at the
+    same time is up to the platform's dynamic loader, which serializes part of
+    the work. Creating the plugin instances stays on the main thread.
+*/
+void PluginManagerPrivate::openLibraries(const QList<PluginSpec *> &queue)
+{
+    QList<PluginSpec *> pending = queue;
+    while (!pending.isEmpty()) {
+        QList<PluginSpec *> level;
+        foreach (PluginSpec *spec, pending) {
+            bool ready = true;
+            foreach (PluginSpec *depSpec, spec->dependencySpecs()) {
+                if (pending.contains(depSpec)) {
+                    ready = false;
+                    break;
+                }
+            }
+            if (ready)
+                level.append(spec);
+        }
+        if (level.isEmpty())
+            break; // a cycle, loadPlugin() reports it
+        QtConcurrent::blockingMap(level, &PluginManagerPrivate::openLibrary);
+        foreach (PluginSpec *spec, level)
+            pending.removeOne(spec);
+    }
+    profilingReport("openLibraries");
+}
+
+/*!
+    \fn void PluginManagerPrivate::openLibrary(PluginSpec *spec)
+    \internal
+*/
+void PluginManagerPrivate::openLibrary(PluginSpec *spec)
+{
+    spec->d->openLibrary();
+}
+
 /*!
     \fn void PluginManagerPrivate::loadQueue()
     \internal
@@ -656,13 +794,14 @@ void PluginManagerPrivate::loadPlugin(PluginSpec *spec, PluginSpec::State destSt
         return;
     if (destState == PluginSpec::Running) {
         spec->d->initializeExtensions();
+        profilingReport(">initializeExtensions", spec);
         return;
     } else if (destState == PluginSpec::Deleted) {
         spec->d->kill();
         return;
     }
     foreach (PluginSpec *depSpec, spec->dependencySpecs()) {
-        if (depSpec->state() != destState) {
+        if (depSpec->state() < destState) {
             spec->d->hasError = true;
             spec->d->errorString =
                 PluginManager::tr("Cannot load plugin because dependency failed to load: %1(%2)\nReason: %3")
@@ -670,11 +809,13 @@ void PluginManagerPrivate::loadPlugin(PluginSpec *spec, PluginSpec::State destSt
             return;
         }
     }
-    if (destState == PluginSpec::Loaded)
+    if (destState == PluginSpec::Loaded) {
         spec->d->loadLibrary();
-    else if (destState == PluginSpec::Initialized)
+        profilingReport(">loadLibrary", spec);
+    } else if (destState == PluginSpec::Initialized) {
         spec->d->initializePlugin();
-    else if (destState == PluginSpec::Stopped)
+        profilingReport(">initializePlugin", spec);
+    } else if (destState == PluginSpec::Stopped)
         spec->d->stop();
 }
 
@@ -708,17 +849,33 @@ void PluginManagerPrivate::readPluginPaths()
         foreach (const QFileInfo &subdir, dirs)
             searchPaths << subdir.absoluteFilePath();
     }
+    QTime readTimer;
+    readTimer.start();
     foreach (const QString &specFile, specFiles) {
         PluginSpec *spec = new PluginSpec;
-        spec->d->read(specFile);
+        spec->d->filePath = specFile;
         pluginSpecs.append(spec);
     }
+    // sets up the shared version regexp before the reading threads copy it
+    PluginSpecPrivate::isValidVersion(QString());
+    QtConcurrent::blockingMap(pluginSpecs, &PluginManagerPrivate::readSpec);
     resolveDependencies();
     // ensure deterministic plugin load order by sorting
     qSort(pluginSpecs.begin(), pluginSpecs.end(), lessThanByPluginName);
+    readPluginPathsMS = readTimer.elapsed();
     emit q->pluginsChanged();
 }
 
+/*!
+    \fn void PluginManagerPrivate::readSpec(PluginSpec *spec)
+    \internal
+*/
+void PluginManagerPrivate::readSpec(PluginSpec *spec)
+{
+    const QString specFile = spec->d->filePath;
+    spec->d->read(specFile);
+}
+
 void PluginManagerPrivate::resolveDependencies()
 {
     foreach (PluginSpec *spec, pluginSpecs) {
@@ -726,6 +883,41 @@ void PluginManagerPrivate::resolveDependencies()
     }
 }
 
+/*!
+    \fn void PluginManagerPrivate::initProfiling()
+    \internal
+*/
+void PluginManagerPrivate::initProfiling()
+{
+    if (profiling)
+        return;
+    profiling = true;
+    profileTimer.restart();
+    profileElapsedMS = 0;
+    qDebug("Profiling started");
+    // the specs are read before the command line is parsed
+    qDebug("%-45s %8dms", "readPluginPaths", readPluginPathsMS);
+}
+
+/*!
+    \fn void PluginManagerPrivate::profilingReport(const char *what, const PluginSpec *spec)
+    \internal
+
+    Prints the time since profiling started and since the last report.
+*/
+void PluginManagerPrivate::profilingReport(const char *what, const PluginSpec *spec)
+{
+    if (!profiling)
+        return;
+    const int absoluteElapsedMS = profileTimer.elapsed();
+    const int elapsedMS = absoluteElapsedMS - profileElapsedMS;
+    profileElapsedMS = absoluteElapsedMS;
+    if (spec)
+        qDebug("%-22s %-22s %8dms (%8dms)", what, qPrintable(spec->name()), absoluteElapsedMS, elapsedMS);
+    else
+        qDebug("%-45s %8dms (%8dms)", what, absoluteElapsedMS, elapsedMS);
+}
+
  // Look in argument descriptions of the specs for the option.
 PluginSpec *PluginManagerPrivate::pluginForOption(const QString &option, bool *requiresArgument) const
 {
@@ -91,6 +91,7 @@ public:
 
     // Plugin operations
     void loadPlugins();
+    bool loadLazyPlugin(PluginSpec *spec);
     QStringList pluginPaths() const;
     void setPluginPaths(const QStringList &paths);
     QList<PluginSpec *> plugins() const;
@@ -35,6 +35,7 @@
 #include <QtCore/QSet>
 #include <QtCore/QStringList>
 #include <QtCore/QObject>
+#include <QtCore/QTime>
 
 namespace ExtensionSystem {
 
@@ -56,10 +57,13 @@ public:
 
     // Plugin operations
     void loadPlugins();
+    bool loadLazyPlugin(PluginSpec *spec);
     void setPluginPaths(const QStringList &paths);
     QList<PluginSpec *> loadQueue();
     void loadPlugin(PluginSpec *spec, PluginSpec::State destState);
     void resolveDependencies();
+    void initProfiling();
+    void profilingReport(const char *what, const PluginSpec *spec = 0);
 
     QList<PluginSpec *> pluginSpecs;
     QList<PluginSpec *> testSpecs;
@@ -80,10 +84,19 @@ private:
     PluginManager *q;
 
     void readPluginPaths();
+    QList<PluginSpec *> startupQueue();
+    void openLibraries(const QList<PluginSpec *> &queue);
+    static void readSpec(PluginSpec *spec);
+    static void openLibrary(PluginSpec *spec);
     bool loadQueue(PluginSpec *spec,
             QList<PluginSpec *> &queue,
             QList<PluginSpec *> &circularityCheckQueue);
     void stopAll();
+
+    bool profiling;
+    QTime profileTimer;
+    int profileElapsedMS;
+    int readPluginPathsMS;
 };
 
 } // namespace Internal
@@ -37,6 +37,7 @@
 #include <QtCore/QFileInfo>
 #include <QtCore/QXmlStreamReader>
 #include <QtCore/QRegExp>
+#include <QtCore/QLibrary>
 #include <QtCore/QCoreApplication>
 #include <QtDebug>
 
@@ -81,6 +82,25 @@
     Version string that a plugin must match to fill this dependency.
 */
 
+/*!
+    \class ExtensionSystem::PluginGadgetDescription
+    \brief Struct that names a gadget that a lazily started plugin provides.
+
+    This reflects the data of a gadget tag in the plugin's xml description file.
+    The gadget can be offered to the user before the plugin is loaded, the
+    plugin is loaded when the gadget is first created.
+*/
+
+/*!
+    \variable ExtensionSystem::PluginGadgetDescription::classId
+    Class id of the gadget's factory.
+*/
+
+/*!
+    \variable ExtensionSystem::PluginGadgetDescription::name
+    Name of the gadget shown to the user.
+*/
+
 /*!
     \class ExtensionSystem::PluginSpec
     \brief Contains the information of the plugins xml description file and
@@ -243,6 +263,28 @@ PluginSpec::PluginArgumentDescriptions PluginSpec::argumentDescriptions() const
     return d->argumentDescriptions;
 }
 
+/*!
+    \fn bool PluginSpec::isLazy() const
+    True if the plugin is not loaded at startup, but when one of its gadgets
+    is first created. Plugins other plugins depend on at startup are loaded
+    at startup anyway.
+
+    \sa gadgetDescriptions()
+*/
+bool PluginSpec::isLazy() const
+{
+    return d->lazy;
+}
+
+/*!
+    \fn PluginSpec::PluginGadgetDescriptions PluginSpec::gadgetDescriptions() const
+    Returns a list of the gadgets a lazy plugin provides.
+*/
+PluginSpec::PluginGadgetDescriptions PluginSpec::gadgetDescriptions() const
+{
+    return d->gadgetDescriptions;
+}
+
 /*!
     \fn QString PluginSpec::location() const
     The absolute path to the directory containing the plugin xml description file
@@ -363,6 +405,7 @@ namespace {
     const char * const PLUGIN_NAME = "name";
     const char * const PLUGIN_VERSION = "version";
     const char * const PLUGIN_COMPATVERSION = "compatVersion";
+    const char * const PLUGIN_LAZY = "lazy";
     const char * const VENDOR = "vendor";
     const char * const COPYRIGHT = "copyright";
     const char * const LICENSE = "license";
@@ -376,13 +419,18 @@ namespace {
     const char * const ARGUMENT = "argument";
     const char * const ARGUMENT_NAME = "name";
     const char * const ARGUMENT_PARAMETER = "parameter";
+    const char * const GADGETLIST = "gadgetList";
+    const char * const GADGET = "gadget";
+    const char * const GADGET_CLASSID = "classId";
+    const char * const GADGET_NAME = "name";
 }
 /*!
     \fn PluginSpecPrivate::PluginSpecPrivate(PluginSpec *spec)
     \internal
 */
 PluginSpecPrivate::PluginSpecPrivate(PluginSpec *spec)
-    : plugin(0),
+    : lazy(false),
+    plugin(0),
     state(PluginSpec::Invalid),
     hasError(false),
     q(spec)
@@ -409,6 +457,8 @@ bool PluginSpecPrivate::read(const QString &fileName)
     hasError = false;
     errorString = "";
     dependencies.clear();
+    lazy = false;
+    gadgetDescriptions.clear();
     QFile file(fileName);
     if (!file.exists())
         return reportError(tr("File does not exist: %1").arg(file.fileName()));
@@ -506,6 +556,7 @@ void PluginSpecPrivate::readPluginSpec(QXmlStreamReader &reader)
     } else if (compatVersion.isEmpty()) {
         compatVersion = version;
     }
+    lazy = (reader.attributes().value(PLUGIN_LAZY).toString() == QLatin1String("true"));
     while (!reader.atEnd()) {
         reader.readNext();
         switch (reader.tokenType()) {
@@ -525,6 +576,8 @@ void PluginSpecPrivate::readPluginSpec(QXmlStreamReader &reader)
                 readDependencies(reader);
             else if (element == ARGUMENTLIST)
                 readArgumentDescriptions(reader);
+            else if (element == GADGETLIST)
+                readGadgetDescriptions(reader);
             else
                 reader.raiseError(msgInvalidElement(name));
             break;
@@ -594,6 +647,61 @@ void PluginSpecPrivate::readArgumentDescription(QXmlStreamReader &reader)
     argumentDescriptions.push_back(arg);
 }
 
+/*!
+    \fn void PluginSpecPrivate::readGadgetDescriptions(QXmlStreamReader &reader)
+    \internal
+*/
+void PluginSpecPrivate::readGadgetDescriptions(QXmlStreamReader &reader)
+{
+    QString element;
+    while (!reader.atEnd()) {
+        reader.readNext();
+        switch (reader.tokenType()) {
+        case QXmlStreamReader::StartElement:
+            element = reader.name().toString();
+            if (element == GADGET) {
+                readGadgetDescription(reader);
+            } else {
+                reader.raiseError(msgInvalidElement(name));
+            }
+            break;
+        case QXmlStreamReader::Comment:
+        case QXmlStreamReader::Characters:
+            break;
+        case QXmlStreamReader::EndElement:
+            element = reader.name().toString();
+            if (element == GADGETLIST)
+                return;
+            reader.raiseError(msgUnexpectedClosing(element));
+            break;
+        default:
+            reader.raiseError(msgUnexpectedToken());
+            break;
+        }
+    }
+}
+
+/*!
+    \fn void PluginSpecPrivate::readGadgetDescription(QXmlStreamReader &reader)
+    \internal
+*/
+void PluginSpecPrivate::readGadgetDescription(QXmlStreamReader &reader)
+{
+    PluginGadgetDescription gadget;
+    gadget.classId = reader.attributes().value(GADGET_CLASSID).toString();
+    if (gadget.classId.isEmpty()) {
+        reader.raiseError(msgAttributeMissing(GADGET, GADGET_CLASSID));
+        return;
+    }
+    gadget.name = reader.attributes().value(GADGET_NAME).toString();
+    if (gadget.name.isEmpty())
+        gadget.name = gadget.classId;
+    gadgetDescriptions.append(gadget);
+    reader.readNext();
+    if (reader.tokenType() != QXmlStreamReader::EndElement)
+        reader.raiseError(msgUnexpectedToken());
+}
+
 /*!
     \fn void PluginSpecPrivate::readDependencies(QXmlStreamReader &reader)
     \internal
@@ -677,7 +785,9 @@ QRegExp &PluginSpecPrivate::versionRegExp()
 */
 bool PluginSpecPrivate::isValidVersion(const QString &version)
 {
-    return versionRegExp().exactMatch(version);
+    // a copy, specs are read from several threads at once
+    QRegExp reg = versionRegExp();
+    return reg.exactMatch(version);
 }
 
 /*!
@@ -747,20 +857,11 @@ bool PluginSpecPrivate::resolveDependencies(const QList<PluginSpec *> &specs)
 }
 
 /*!
-    \fn bool PluginSpecPrivate::loadLibrary()
+    \fn QString PluginSpecPrivate::libraryName() const
     \internal
 */
-bool PluginSpecPrivate::loadLibrary()
+QString PluginSpecPrivate::libraryName() const
 {
-    if (hasError)
-        return false;
-    if (state != PluginSpec::Resolved) {
-        if (state == PluginSpec::Loaded)
-            return true;
-        errorString = QCoreApplication::translate("PluginSpec", "Loading the library failed because state != Resolved");
-        hasError = true;
-        return false;
-    }
 #ifdef QT_NO_DEBUG
 
 #ifdef Q_OS_WIN
@@ -782,7 +883,41 @@ bool PluginSpecPrivate::loadLibrary()
 #endif
 
 #endif
+    return libName;
+}
+
+/*!
+    \fn bool PluginSpecPrivate::openLibrary()
+    \internal
+
+    Maps the plugin's library into the process without creating the plugin
+    instance, so it can be done from a worker thread. loadLibrary() then
+    finds the library already open and reports any error.
+*/
+bool PluginSpecPrivate::openLibrary()
+{
+    if (hasError || state != PluginSpec::Resolved)
+        return false;
+    QLibrary library(libraryName());
+    return library.load();
+}
 
+/*!
+    \fn bool PluginSpecPrivate::loadLibrary()
+    \internal
+*/
+bool PluginSpecPrivate::loadLibrary()
+{
+    if (hasError)
+        return false;
+    if (state != PluginSpec::Resolved) {
+        if (state == PluginSpec::Loaded)
+            return true;
+        errorString = QCoreApplication::translate("PluginSpec", "Loading the library failed because state != Resolved");
+        hasError = true;
+        return false;
+    }
+    QString libName = libraryName();
     PluginLoader loader(libName);
     if (!loader.load()) {
         hasError = true;
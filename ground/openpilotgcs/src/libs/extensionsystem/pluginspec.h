@@ -61,6 +61,12 @@ struct EXTENSIONSYSTEM_EXPORT PluginArgumentDescription
     QString description;
 };
 
+struct EXTENSIONSYSTEM_EXPORT PluginGadgetDescription
+{
+    QString classId;
+    QString name;
+};
+
 class EXTENSIONSYSTEM_EXPORT PluginSpec
 {
 public:
@@ -82,6 +88,10 @@ public:
     typedef QList<PluginArgumentDescription> PluginArgumentDescriptions;
     PluginArgumentDescriptions argumentDescriptions() const;
 
+    bool isLazy() const;
+    typedef QList<PluginGadgetDescription> PluginGadgetDescriptions;
+    PluginGadgetDescriptions gadgetDescriptions() const;
+
     // other information, valid after 'Read' state is reached
     QString location() const;
     QString filePath() const;
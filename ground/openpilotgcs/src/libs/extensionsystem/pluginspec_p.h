@@ -52,6 +52,8 @@ public:
     bool read(const QString &fileName);
     bool provides(const QString &pluginName, const QString &version) const;
     bool resolveDependencies(const QList<PluginSpec *> &specs);
+    QString libraryName() const;
+    bool openLibrary();
     bool loadLibrary();
     bool initializePlugin();
     bool initializeExtensions();
@@ -74,6 +76,8 @@ public:
 
     QList<PluginSpec *> dependencySpecs;
     PluginSpec::PluginArgumentDescriptions argumentDescriptions;
+    bool lazy;
+    PluginSpec::PluginGadgetDescriptions gadgetDescriptions;
     IPlugin *plugin;
 
     PluginSpec::State state;
@@ -92,6 +96,8 @@ private:
     void readDependencyEntry(QXmlStreamReader &reader);
     void readArgumentDescriptions(QXmlStreamReader &reader);
     void readArgumentDescription(QXmlStreamReader &reader);
+    void readGadgetDescriptions(QXmlStreamReader &reader);
+    void readGadgetDescription(QXmlStreamReader &reader);
 
     static QRegExp &versionRegExp();
 };
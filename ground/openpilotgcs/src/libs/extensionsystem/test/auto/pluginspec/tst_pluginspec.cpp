@@ -45,6 +45,7 @@ class tst_PluginSpec : public QObject
 private slots:
     void read();
     void readError();
+    void readLazy();
     void isValidVersion();
     void versionCompare();
     void provides();
@@ -113,6 +114,35 @@ void tst_PluginSpec::readError()
     QCOMPARE(spec.state, PluginSpec::Invalid);
     QVERIFY(spec.hasError);
     QVERIFY(!spec.errorString.isEmpty());
+    QVERIFY(!spec.read("testspecs/spec_wrong6.xml"));
+    QCOMPARE(spec.state, PluginSpec::Invalid);
+    QVERIFY(spec.hasError);
+    QVERIFY(!spec.errorString.isEmpty());
+}
+
+void tst_PluginSpec::readLazy()
+{
+    Internal::PluginSpecPrivate spec(0);
+    QVERIFY(spec.read("testspecs/spec1.xml"));
+    QVERIFY(!spec.lazy);
+    QVERIFY(spec.gadgetDescriptions.isEmpty());
+
+    QVERIFY(spec.read("testspecs/spec_lazy.xml"));
+    QCOMPARE(spec.state, PluginSpec::Read);
+    QVERIFY(!spec.hasError);
+    QVERIFY(spec.lazy);
+    QCOMPARE(spec.dependencies.size(), 1);
+    QCOMPARE(spec.gadgetDescriptions.size(), 2);
+    QCOMPARE(spec.gadgetDescriptions.at(0).classId, QString("TestGadget"));
+    QCOMPARE(spec.gadgetDescriptions.at(0).name, QString("Test Gadget"));
+    // the name defaults to the class id
+    QCOMPARE(spec.gadgetDescriptions.at(1).classId, QString("OtherGadget"));
+    QCOMPARE(spec.gadgetDescriptions.at(1).name, QString("OtherGadget"));
+
+    // reading again starts over
+    QVERIFY(spec.read("testspecs/spec2.xml"));
+    QVERIFY(!spec.lazy);
+    QVERIFY(spec.gadgetDescriptions.isEmpty());
 }
 
 void tst_PluginSpec::isValidVersion()
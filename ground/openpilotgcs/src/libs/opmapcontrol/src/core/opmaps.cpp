@@ -273,6 +273,14 @@ namespace core {
     {
         return Cache::Instance()->ImageCache.ExportMapDataToDB(file,Cache::Instance()->ImageCache.GtileCache()+QDir::separator()+"Data.qmdb");
     }
+    bool OPMaps::ExportToMBTiles(const QString &file,const MapType::Types &type)
+    {
+        return Cache::Instance()->ImageCache.ExportMBTiles(file,type);
+    }
+    bool OPMaps::ImportFromMBTiles(const QString &file,const MapType::Types &type)
+    {
+        return Cache::Instance()->ImageCache.ImportMBTiles(file,type);
+    }
 
     diagnostics OPMaps::GetDiagnostics()
     {
@@ -56,6 +56,8 @@ namespace core {
         static OPMaps* Instance();
         bool ImportFromGMDB(const QString &file);
         bool ExportToGMDB(const QString &file);
+        bool ImportFromMBTiles(const QString &file,const MapType::Types &type);
+        bool ExportToMBTiles(const QString &file,const MapType::Types &type);
         /// <summary>
         /// timeout for map connections
         /// </summary>
@@ -27,11 +27,25 @@
 #include "pureimagecache.h"
 #include <QDateTime>
 #include <QSettings>
+#include <QThread>
+#include <QThreadStorage>
+#include <QMap>
 //#define DEBUG_PUREIMAGECACHE
 namespace core {
     qlonglong PureImageCache::ConnCounter=0;
 
-    PureImageCache::PureImageCache()
+    // Name of a thread's tile pack connection, the connection is removed when
+    // the thread finishes so pooled loader threads don't leak one each
+    class TilePackConnection
+    {
+    public:
+        TilePackConnection():name(QString("TilePack%1").arg((quintptr)QThread::currentThreadId())){}
+        ~TilePackConnection(){QSqlDatabase::removeDatabase(name);}
+        QString name;
+    };
+    static QThreadStorage<TilePackConnection *> tilepackconnection;
+
+    PureImageCache::PureImageCache():tilepacktype(-1)
     {
 
     }
@@ -57,6 +71,21 @@ namespace core {
 #endif //DEBUG_PUREIMAGECACHE
                 CreateEmptyDB(db);
             }
+            else
+            {
+                // Caches created before the tile index existed get it here
+                {
+                    QSqlDatabase cn;
+                    cn = QSqlDatabase::addDatabase("QSQLITE",QLatin1String("IndexConn"));
+                    cn.setDatabaseName(db);
+                    if(cn.open())
+                    {
+                        CreateIndex(cn);
+                        cn.close();
+                    }
+                }
+                QSqlDatabase::removeDatabase(QLatin1String("IndexConn"));
+            }
         }
         lock.unlock();
     }
@@ -161,6 +190,14 @@ namespace core {
         {
 #ifdef DEBUG_PUREIMAGECACHE
             qDebug()<<"CreateEmptyDB: "<<query.lastError().driverText();
+#endif //DEBUG_PUREIMAGECACHE
+            db.close();
+            return false;
+        }
+        if(!CreateIndex(db))
+        {
+#ifdef DEBUG_PUREIMAGECACHE
+            qDebug()<<"CreateEmptyDB: Could not create tile index";
 #endif //DEBUG_PUREIMAGECACHE
             db.close();
             return false;
@@ -169,6 +206,12 @@ namespace core {
         QSqlDatabase::removeDatabase(QLatin1String("CreateConn"));
         return true;
     }
+    bool PureImageCache::CreateIndex(QSqlDatabase &db)
+    {
+        // Every tile lookup is by position, zoom and type
+        QSqlQuery query(db);
+        return query.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (X, Y, Zoom, Type)");
+    }
     bool PureImageCache::PutImageToCache(const QByteArray &tile, const MapType::Types &type,const Point &pos,const int &zoom)
     {
         if(gtilecache.isEmpty()|gtilecache.isNull())
@@ -214,8 +257,10 @@ namespace core {
     }
     QByteArray PureImageCache::GetImageFromCache(MapType::Types type, Point pos, int zoom)
     {
+        QByteArray ar=GetImageFromTilePack(type,pos,zoom);
+        if(!ar.isEmpty())
+            return ar;
         lock.lockForRead();
-        QByteArray ar;
         if(gtilecache.isEmpty()|gtilecache.isNull())
             return ar;
         QString dir=gtilecache;
@@ -295,6 +340,264 @@ namespace core {
             }
         }
     }
+    QByteArray PureImageCache::GetImageFromTilePack(MapType::Types type, Point pos, int zoom)
+    {
+        QByteArray ar;
+        packlock.lockForRead();
+        QString pack=tilepack;
+        int packtype=tilepacktype;
+        packlock.unlock();
+        if(pack.isEmpty()||(packtype>=0&&packtype!=(int)type))
+            return ar;
+
+        // The pack never changes, so each thread keeps its read-only connection
+        // (and SQLite's mapping of the file) open instead of reopening it per tile
+        if(!tilepackconnection.hasLocalData())
+            tilepackconnection.setLocalData(new TilePackConnection);
+        QString name=tilepackconnection.localData()->name;
+        if(QSqlDatabase::contains(name)&&QSqlDatabase::database(name,false).databaseName()!=pack)
+            QSqlDatabase::removeDatabase(name);
+        QSqlDatabase cn;
+        if(QSqlDatabase::contains(name))
+        {
+            cn=QSqlDatabase::database(name);
+        }
+        else
+        {
+            cn=QSqlDatabase::addDatabase("QSQLITE",name);
+            cn.setDatabaseName(pack);
+            cn.setConnectOptions("QSQLITE_OPEN_READONLY");
+            if(cn.open())
+            {
+                QSqlQuery query(cn);
+                query.exec("PRAGMA mmap_size=268435456");
+            }
+        }
+        if(cn.isOpen())
+        {
+            // MBTiles rows are numbered from the south (TMS), ours from the north
+            QSqlQuery query(cn);
+            query.prepare("SELECT tile_data FROM tiles WHERE zoom_level=? AND tile_column=? AND tile_row=?");
+            query.addBindValue(zoom);
+            query.addBindValue(pos.X());
+            query.addBindValue((1<<zoom)-1-pos.Y());
+            if(query.exec()&&query.next())
+                ar=query.value(0).toByteArray();
+        }
+        return ar;
+    }
+    bool PureImageCache::SetTilePack(const QString &packFile)
+    {
+        int type=-1;
+        if(!packFile.isEmpty())
+        {
+            if(!QFileInfo(packFile).exists())
+                return false;
+            bool ret=false;
+            Mcounter.lock();
+            qlonglong id=++ConnCounter;
+            Mcounter.unlock();
+            {
+                QSqlDatabase cn;
+                cn = QSqlDatabase::addDatabase("QSQLITE",QString::number(id));
+                cn.setDatabaseName(packFile);
+                cn.setConnectOptions("QSQLITE_OPEN_READONLY");
+                if(cn.open())
+                {
+                    {
+                        // Packs written by ExportMBTiles name their map type, others serve every type
+                        QSqlQuery query(cn);
+                        ret=query.exec("SELECT value FROM metadata WHERE name='opmap_maptype'");
+                        if(ret&&query.next())
+                            type=(int)MapType::TypeByStr(query.value(0).toString());
+                    }
+                    cn.close();
+                }
+            }
+            QSqlDatabase::removeDatabase(QString::number(id));
+            if(!ret)
+                return false;
+        }
+        packlock.lockForWrite();
+        tilepack=packFile;
+        tilepacktype=type;
+        packlock.unlock();
+        return true;
+    }
+    QString PureImageCache::TilePack()
+    {
+        packlock.lockForRead();
+        QString ret=tilepack;
+        packlock.unlock();
+        return ret;
+    }
+    bool PureImageCache::ImportMBTiles(const QString &packFile, const MapType::Types &type)
+    {
+        if(gtilecache.isEmpty()|gtilecache.isNull())
+            return false;
+        if(!QFileInfo(packFile).exists())
+            return false;
+        bool ret=false;
+        Mcounter.lock();
+        qlonglong id=++ConnCounter;
+        Mcounter.unlock();
+        {
+            QSqlDatabase cn;
+            cn = QSqlDatabase::addDatabase("QSQLITE",QString::number(id));
+            cn.setDatabaseName(gtilecache+"Data.qmdb");
+            if(cn.open())
+            {
+                {
+                    QSqlQuery query(cn);
+                    query.exec("PRAGMA synchronous=OFF");
+                    query.exec("PRAGMA journal_mode=MEMORY");
+                    if(query.exec(QString("ATTACH DATABASE \"%1\" AS Pack").arg(packFile)))
+                    {
+                        // Split the pack into batches of whole columns of one zoom level
+                        QList<int> batchzoom,batchfirst,batchlast;
+                        ret=query.exec("SELECT zoom_level, tile_column, COUNT(*) FROM Pack.tiles GROUP BY zoom_level, tile_column");
+                        int count=0;
+                        while(ret&&query.next())
+                        {
+                            int zoom=query.value(0).toInt();
+                            int column=query.value(1).toInt();
+                            if(batchzoom.isEmpty()||batchzoom.last()!=zoom||count>=ImportBatchTiles)
+                            {
+                                batchzoom.append(zoom);
+                                batchfirst.append(column);
+                                batchlast.append(column);
+                                count=0;
+                            }
+                            batchlast.last()=column;
+                            count+=query.value(2).toInt();
+                        }
+                        QString date=QDateTime::currentDateTime().toString();
+                        for(int i=0;ret&&i<batchzoom.count();++i)
+                        {
+                            // Writers take the read lock, so this keeps them out of a batch;
+                            // tile fetches only wait for one batch, not for the whole pack
+                            lock.lockForWrite();
+                            qlonglong lastid=0;
+                            if(query.exec("SELECT MAX(id) FROM Tiles")&&query.next())
+                                lastid=query.value(0).toLongLong();
+                            // Two set based statements instead of two inserts per tile,
+                            // MBTiles rows are numbered from the south (TMS), ours from the north
+                            cn.transaction();
+                            query.prepare("INSERT INTO Tiles(X, Y, Zoom, Type, Date) "
+                                          "SELECT p.tile_column, (1<<p.zoom_level)-1-p.tile_row, p.zoom_level, ?, ? FROM Pack.tiles p "
+                                          "WHERE p.zoom_level=? AND p.tile_column>=? AND p.tile_column<=? "
+                                          "AND NOT EXISTS (SELECT 1 FROM Tiles t WHERE t.X=p.tile_column AND t.Y=(1<<p.zoom_level)-1-p.tile_row AND t.Zoom=p.zoom_level AND t.Type=?)");
+                            query.addBindValue((int)type);
+                            query.addBindValue(date);
+                            query.addBindValue(batchzoom.at(i));
+                            query.addBindValue(batchfirst.at(i));
+                            query.addBindValue(batchlast.at(i));
+                            query.addBindValue((int)type);
+                            ret=query.exec();
+                            if(ret)
+                            {
+                                query.prepare("INSERT OR IGNORE INTO TilesData(id, Tile) "
+                                              "SELECT t.id, p.tile_data FROM Tiles t JOIN Pack.tiles p "
+                                              "ON p.zoom_level=t.Zoom AND p.tile_column=t.X AND p.tile_row=(1<<t.Zoom)-1-t.Y "
+                                              "WHERE t.id>? AND t.Type=?");
+                                query.addBindValue(lastid);
+                                query.addBindValue((int)type);
+                                ret=query.exec();
+                            }
+#ifdef DEBUG_PUREIMAGECACHE
+                            if(!ret)
+                                qDebug()<<"ImportMBTiles: "<<query.lastError().driverText();
+#endif //DEBUG_PUREIMAGECACHE
+                            if(ret)
+                                ret=cn.commit();
+                            else
+                                cn.rollback();
+                            lock.unlock();
+                        }
+                        query.exec("DETACH DATABASE Pack");
+                    }
+                }
+                cn.close();
+            }
+        }
+        QSqlDatabase::removeDatabase(QString::number(id));
+        return ret;
+    }
+    bool PureImageCache::ExportMBTiles(const QString &packFile, const MapType::Types &type)
+    {
+        if(gtilecache.isEmpty()|gtilecache.isNull())
+            return false;
+        if(QFileInfo(packFile).exists())
+            QFile(packFile).remove();
+        bool ret=false;
+        lock.lockForRead();
+        Mcounter.lock();
+        qlonglong id=++ConnCounter;
+        Mcounter.unlock();
+        {
+            QSqlDatabase cn;
+            cn = QSqlDatabase::addDatabase("QSQLITE",QString::number(id));
+            cn.setDatabaseName(packFile);
+            if(cn.open())
+            {
+                {
+                    QSqlQuery query(cn);
+                    query.exec("PRAGMA synchronous=OFF");
+                    query.exec("PRAGMA journal_mode=MEMORY");
+                    ret=query.exec("CREATE TABLE metadata (name TEXT, value TEXT)")&&
+                        query.exec("CREATE TABLE tiles (zoom_level INTEGER, tile_column INTEGER, tile_row INTEGER, tile_data BLOB)")&&
+                        query.exec("CREATE UNIQUE INDEX tile_index ON tiles (zoom_level, tile_column, tile_row)")&&
+                        query.exec(QString("ATTACH DATABASE \"%1\" AS Source").arg(gtilecache+"Data.qmdb"));
+                    if(ret)
+                    {
+                        cn.transaction();
+                        query.prepare("INSERT OR IGNORE INTO tiles(zoom_level, tile_column, tile_row, tile_data) "
+                                      "SELECT t.Zoom, t.X, (1<<t.Zoom)-1-t.Y, d.Tile FROM Source.Tiles t JOIN Source.TilesData d ON d.id=t.id "
+                                      "WHERE t.Type=?");
+                        query.addBindValue((int)type);
+                        ret=query.exec();
+                        if(ret)
+                        {
+                            QMap<QString,QString> metadata;
+                            metadata["name"]=MapType::StrByType(type);
+                            metadata["type"]="baselayer";
+                            metadata["version"]="1.1";
+                            metadata["description"]="OpenPilot GCS map cache";
+                            metadata["opmap_maptype"]=MapType::StrByType(type);
+                            if(query.exec("SELECT MIN(zoom_level), MAX(zoom_level) FROM tiles")&&query.next())
+                            {
+                                metadata["minzoom"]=query.value(0).toString();
+                                metadata["maxzoom"]=query.value(1).toString();
+                            }
+                            metadata["format"]="jpg";
+                            if(query.exec("SELECT tile_data FROM tiles LIMIT 1")&&query.next()&&query.value(0).toByteArray().startsWith("\x89PNG"))
+                                metadata["format"]="png";
+                            query.prepare("INSERT INTO metadata(name, value) VALUES(?, ?)");
+                            foreach(QString name,metadata.keys())
+                            {
+                                query.addBindValue(name);
+                                query.addBindValue(metadata.value(name));
+                                ret=ret&&query.exec();
+                            }
+                        }
+#ifdef DEBUG_PUREIMAGECACHE
+                        if(!ret)
+                            qDebug()<<"ExportMBTiles: "<<query.lastError().driverText();
+#endif //DEBUG_PUREIMAGECACHE
+                        if(ret)
+                            ret=cn.commit();
+                        else
+                            cn.rollback();
+                        query.exec("DETACH DATABASE Source");
+                    }
+                }
+                cn.close();
+            }
+        }
+        QSqlDatabase::removeDatabase(QString::number(id));
+        lock.unlock();
+        return ret;
+    }
     // PureImageCache::ExportMapDataToDB("C:/Users/Xapo/Documents/mapcontrol/debug/mapscache/data.qmdb","C:/Users/Xapo/Documents/mapcontrol/debug/mapscache/data2.qmdb");
     bool PureImageCache::ExportMapDataToDB(QString sourceFile, QString destFile)
     {
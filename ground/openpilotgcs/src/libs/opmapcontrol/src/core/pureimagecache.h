@@ -55,11 +55,34 @@ namespace core {
         void setGtileCache(const QString &value);
         static bool ExportMapDataToDB(QString sourceFile, QString destFile);
         void deleteOlderTiles(int const& days);
+        /**
+        * @brief Bulk loads the tiles of an MBTiles pack into the cache DB, one transaction per batch
+        *        of about ImportBatchTiles tiles. Only tiles not already in the cache are added,
+        *        and the batches before a failed one are kept.
+        */
+        bool ImportMBTiles(const QString &packFile, const MapType::Types &type);
+        /**
+        * @brief Writes all cached tiles of one map type to a new MBTiles pack
+        */
+        bool ExportMBTiles(const QString &packFile, const MapType::Types &type);
+        /**
+        * @brief Serves tiles straight from a read-only MBTiles pack, looked up before the cache DB.
+        *        An empty file name stops using the pack.
+        */
+        bool SetTilePack(const QString &packFile);
+        QString TilePack();
     private:
+        QByteArray GetImageFromTilePack(MapType::Types type, core::Point pos, int zoom);
+        static bool CreateIndex(QSqlDatabase &db);
         QString gtilecache;
         QMutex Mcounter;
         QReadWriteLock lock;
         static qlonglong ConnCounter;
+        // tiles imported per transaction, the cache is locked for one batch at a time
+        static const int ImportBatchTiles=2000;
+        QString tilepack;
+        int tilepacktype;
+        QReadWriteLock packlock;
 
     };
 
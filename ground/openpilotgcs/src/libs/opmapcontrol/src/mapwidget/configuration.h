@@ -174,6 +174,29 @@ public:
     */
     void ExportMapDataToDB(QString const& sourceDB, QString const& destDB)const{core::PureImageCache::ExportMapDataToDB(sourceDB,destDB);}
     /**
+    * @brief  Imports an MBTiles tile pack into the cache DB in batches, so tile fetches are not held up by the whole pack. Only new tiles are added.
+    *
+    * @param pack the MBTiles file
+    * @param type the map type the pack tiles are stored as
+    * @return true on success
+    */
+    bool ImportMBTiles(QString const& pack, core::MapType::Types const& type){return core::OPMaps::Instance()->ImportFromMBTiles(pack,type);}
+    /**
+    * @brief  Exports the cached tiles of one map type to a new MBTiles tile pack
+    *
+    * @param pack the MBTiles file. If it exists it will be replaced.
+    * @param type the map type to export
+    * @return true on success
+    */
+    bool ExportMBTiles(QString const& pack, core::MapType::Types const& type){return core::OPMaps::Instance()->ExportToMBTiles(pack,type);}
+    /**
+    * @brief  Serves tiles read-only from an MBTiles tile pack before looking in the cache DB
+    *
+    * @param pack the MBTiles file, empty to stop using a pack
+    * @return true if the pack could be opened
+    */
+    bool SetTilePack(QString const& pack){return core::Cache::Instance()->ImageCache.SetTilePack(pack);}
+    /**
     * @brief Returns the location for the SQLite Database used for caching and the geocoding cache files
     *
     * @return
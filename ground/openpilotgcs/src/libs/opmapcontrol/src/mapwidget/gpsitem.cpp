@@ -37,10 +37,7 @@ namespace mapcontrol
         localposition=map->FromLatLngToLocal(mapwidget->CurrentPosition());
         this->setPos(localposition.X(),localposition.Y());
         this->setZValue(4);
-        trail=new QGraphicsItemGroup();
-        trail->setParentItem(map);
-        trailLine=new QGraphicsItemGroup();
-        trailLine->setParentItem(map);
+        trail=new TrailPathItem(map,Qt::green);
         this->setFlag(QGraphicsItem::ItemIgnoresTransformations,true);
         mapfollowtype=UAVMapFollowType::None;
         trailtype=UAVTrailType::ByDistance;
@@ -74,10 +71,7 @@ namespace mapcontrol
             {
                 if(timer.elapsed()>trailtime*1000)
                 {
-                    trail->addToGroup(new TrailItem(position,altitude,Qt::green,this));
-                    if(!lasttrailline.IsEmpty())
-                        trailLine->addToGroup((new TrailLineItem(lasttrailline,position,Qt::green,map)));
-                    lasttrailline=position;
+                    trail->AddPoint(position,altitude);
                     timer.restart();
                 }
 
@@ -86,11 +80,7 @@ namespace mapcontrol
             {
                 if(qAbs(internals::PureProjection::DistanceBetweenLatLng(lastcoord,position)*1000)>traildistance)
                 {
-                    trail->addToGroup(new TrailItem(position,altitude,Qt::green,this));
-                    if(!lasttrailline.IsEmpty())
-
-                        trailLine->addToGroup((new TrailLineItem(lasttrailline,position,Qt::green,this)));
-                    lasttrailline=position;
+                    trail->AddPoint(position,altitude);
                     lastcoord=position;
                 }
             }
@@ -169,19 +159,7 @@ namespace mapcontrol
     {
         localposition=map->FromLatLngToLocal(coord);
         this->setPos(localposition.X(),localposition.Y());
-        foreach(QGraphicsItem* i,trail->childItems())
-        {
-            TrailItem* w=qgraphicsitem_cast<TrailItem*>(i);
-            if(w)
-                w->setPos(map->FromLatLngToLocal(w->coord).X(),map->FromLatLngToLocal(w->coord).Y());
-        }
-        foreach(QGraphicsItem* i,trailLine->childItems())
-        {
-            TrailLineItem* ww=qgraphicsitem_cast<TrailLineItem*>(i);
-            if(ww)
-                ww->setLine(map->FromLatLngToLocal(ww->coord1).X(),map->FromLatLngToLocal(ww->coord1).Y(),map->FromLatLngToLocal(ww->coord2).X(),map->FromLatLngToLocal(ww->coord2).Y());
-        }
-
+        trail->RefreshPos();
     }
     void GPSItem::SetTrailType(const UAVTrailType::Types &value)
     {
@@ -192,20 +170,17 @@ namespace mapcontrol
     void GPSItem::SetShowTrail(const bool &value)
     {
         showtrail=value;
-        trail->setVisible(value);
+        trail->SetShowPoints(value);
 
     }
     void GPSItem::SetShowTrailLine(const bool &value)
     {
         showtrailline=value;
-        trailLine->setVisible(value);
+        trail->SetShowLine(value);
     }
     void GPSItem::DeleteTrail()const
     {
-        foreach(QGraphicsItem* i,trail->childItems())
-            delete i;
-        foreach(QGraphicsItem* i,trailLine->childItems())
-            delete i;
+        trail->Clear();
     }
     double GPSItem::Distance3D(const internals::PointLatLng &coord, const int &altitude)
     {
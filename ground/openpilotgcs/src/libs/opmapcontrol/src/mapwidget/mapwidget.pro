@@ -10,11 +10,10 @@ SOURCES += mapgraphicitem.cpp \
     waypointitem.cpp \
     uavitem.cpp \
     gpsitem.cpp \
-    trailitem.cpp \
+    trailpathitem.cpp \
     homeitem.cpp \
     mapripform.cpp \
-    mapripper.cpp \
-    traillineitem.cpp
+    mapripper.cpp
 
 LIBS += -L../build \
     -lcore \
@@ -35,11 +34,10 @@ HEADERS += mapgraphicitem.h \
     gpsitem.h \
     uavmapfollowtype.h \
     uavtrailtype.h \
-    trailitem.h \
+    trailpathitem.h \
     homeitem.h \
     mapripform.h \
-    mapripper.h \
-    traillineitem.h
+    mapripper.h
 QT += opengl
 QT += network
 QT += sql
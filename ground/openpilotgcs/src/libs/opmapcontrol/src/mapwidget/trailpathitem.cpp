@@ -0,0 +1,302 @@
+/**
+******************************************************************************
+*
+* @file       trailpathitem.cpp
+* @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+* @brief      A graphicsItem representing a whole UAV or GPS trail
+* @see        The GNU Public License (GPL) Version 3
+* @defgroup   OPMapWidget
+* @{
+*
+*****************************************************************************/
+/*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+#include "trailpathitem.h"
+#include <QDateTime>
+#include <QGraphicsSceneHoverEvent>
+#include <QStyleOptionGraphicsItem>
+namespace mapcontrol
+{
+    // Points closer than this (in pixels) to the simplified line are not drawn
+    static const qreal simplifytolerance=1.0;
+    // Radius of a trail point, also used for hit testing
+    static const qreal pointradius=2.0;
+    static const qreal hitradius=4.0;
+
+    TrailPathItem::TrailPathItem(MapGraphicItem* map,QColor const& color,int const& capacity):QGraphicsItem(map),map(map),color(color),
+        points(capacity),projected(capacity),head(0),count(0),projectedzoom(-1),showpoints(true),showline(true)
+    {
+        hitshape.setFillRule(Qt::WindingFill);
+        this->setFlag(QGraphicsItem::ItemUsesExtendedStyleOption,true);
+        this->setAcceptedMouseButtons(Qt::NoButton);
+        this->setAcceptHoverEvents(true);
+    }
+
+    void TrailPathItem::AddPoint(internals::PointLatLng const& coord,int const& altitude)
+    {
+        RefreshPos();
+
+        bool rebuild=false;
+        if(count==points.size())
+        {
+            // Drop the oldest points in chunks so a full trail is simplified
+            // again once per chunk instead of on every new point
+            int drop=qMax(1,points.size()/16);
+            head=Index(drop);
+            count-=drop;
+            rebuild=true;
+        }
+
+        int i=Index(count);
+        points[i].coord=coord;
+        points[i].altitude=altitude;
+        points[i].time=QDateTime::currentDateTime().toTime_t();
+        ++count;
+
+        if(count==1||projectedzoom!=map->ZoomTotal())
+        {
+            Reproject();
+            return;
+        }
+        projected[i]=Project(coord);
+        if(rebuild)
+        {
+            Simplify();
+            return;
+        }
+
+        // Extend the simplified trail, the next zoom change runs the full simplification
+        QPointF const& last=projected[Index(drawn.last())];
+        QPointF const& p=projected[i];
+        if(qAbs(p.x()-last.x())<simplifytolerance&&qAbs(p.y()-last.y())<simplifytolerance)
+            return;
+        prepareGeometryChange();
+        drawn.append(count-1);
+        linepath.lineTo(p);
+        hitshape.addEllipse(p,hitradius,hitradius);
+        bounds|=QRectF(p.x()-hitradius,p.y()-hitradius,2*hitradius,2*hitradius);
+        update();
+    }
+
+    void TrailPathItem::Clear()
+    {
+        prepareGeometryChange();
+        head=0;
+        count=0;
+        projectedzoom=-1;
+        drawn.clear();
+        linepath=QPainterPath();
+        hitshape=QPainterPath();
+        hitshape.setFillRule(Qt::WindingFill);
+        bounds=QRectF();
+        update();
+    }
+
+    void TrailPathItem::SetShowPoints(bool const& value)
+    {
+        showpoints=value;
+        this->setVisible(showpoints||showline);
+        update();
+    }
+
+    void TrailPathItem::SetShowLine(bool const& value)
+    {
+        showline=value;
+        this->setVisible(showpoints||showline);
+        update();
+    }
+
+    void TrailPathItem::RefreshPos()
+    {
+        if(count==0)
+            return;
+        if(projectedzoom!=map->ZoomTotal())
+        {
+            Reproject();
+            return;
+        }
+        // Same zoom: the cached projection is still valid up to a translation
+        core::Point p=map->FromLatLngToLocal(reference);
+        this->setPos(p.X()-referencelocal.x(),p.Y()-referencelocal.y());
+    }
+
+    QPointF TrailPathItem::Project(internals::PointLatLng const& coord)
+    {
+        core::Point p=map->FromLatLngToLocal(coord);
+        return QPointF(p.X(),p.Y())-pos();
+    }
+
+    void TrailPathItem::Reproject()
+    {
+        this->setPos(0,0);
+        projectedzoom=map->ZoomTotal();
+        for(int n=0;n<count;++n)
+        {
+            int i=Index(n);
+            projected[i]=Project(points[i].coord);
+        }
+        reference=points[Index(0)].coord;
+        referencelocal=projected[Index(0)];
+        Simplify();
+    }
+
+    void TrailPathItem::Simplify()
+    {
+        prepareGeometryChange();
+        drawn.clear();
+        linepath=QPainterPath();
+        hitshape=QPainterPath();
+        hitshape.setFillRule(Qt::WindingFill);
+        bounds=QRectF();
+        if(count>0)
+        {
+            QVector<QPointF> line(count);
+            for(int n=0;n<count;++n)
+                line[n]=projected[Index(n)];
+            QVector<bool> keep;
+            DouglasPeucker(line,simplifytolerance,keep);
+            for(int n=0;n<count;++n)
+            {
+                if(!keep[n])
+                    continue;
+                if(drawn.isEmpty())
+                    linepath.moveTo(line[n]);
+                else
+                    linepath.lineTo(line[n]);
+                hitshape.addEllipse(line[n],hitradius,hitradius);
+                drawn.append(n);
+            }
+            bounds=hitshape.boundingRect();
+        }
+        update();
+    }
+
+    void TrailPathItem::DouglasPeucker(QVector<QPointF> const& line,qreal const& epsilon,QVector<bool>& keep)
+    {
+        keep.fill(false,line.size());
+        if(line.isEmpty())
+            return;
+        keep[0]=true;
+        keep[line.size()-1]=true;
+
+        // Explicit stack, a long straight trail would otherwise recurse once per point
+        QVector<QPair<int,int> > stack;
+        stack.append(qMakePair(0,line.size()-1));
+        qreal epsilon2=epsilon*epsilon;
+        while(!stack.isEmpty())
+        {
+            int first=stack.last().first;
+            int last=stack.last().second;
+            stack.remove(stack.size()-1);
+            if(last<=first+1)
+                continue;
+
+            QPointF a=line[first];
+            QPointF ab=line[last]-a;
+            qreal length2=ab.x()*ab.x()+ab.y()*ab.y();
+            qreal maxdistance2=0;
+            int index=first;
+            for(int i=first+1;i<last;++i)
+            {
+                // Distance to the segment rather than the line, trails often double back
+                QPointF ap=line[i]-a;
+                qreal t=0;
+                if(length2>0)
+                    t=qBound(qreal(0),(ap.x()*ab.x()+ap.y()*ab.y())/length2,qreal(1));
+                QPointF d=ap-t*ab;
+                qreal distance2=d.x()*d.x()+d.y()*d.y();
+                if(distance2>maxdistance2)
+                {
+                    maxdistance2=distance2;
+                    index=i;
+                }
+            }
+            if(maxdistance2>epsilon2)
+            {
+                keep[index]=true;
+                stack.append(qMakePair(first,index));
+                stack.append(qMakePair(index,last));
+            }
+        }
+    }
+
+    void TrailPathItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+    {
+        Q_UNUSED(widget);
+        if(count==0)
+            return;
+        if(showline)
+        {
+            QPen pen;
+            pen.setBrush(color);
+            pen.setWidth(1);
+            painter->setPen(pen);
+            painter->setBrush(Qt::NoBrush);
+            painter->drawPath(linepath);
+        }
+        if(showpoints)
+        {
+            painter->setPen(QPen(Qt::black));
+            painter->setBrush(color);
+            QRectF exposed=option->exposedRect.adjusted(-pointradius,-pointradius,pointradius,pointradius);
+            foreach(int n,drawn)
+            {
+                QPointF const& p=projected[Index(n)];
+                if(exposed.contains(p))
+                    painter->drawEllipse(p,pointradius,pointradius);
+            }
+        }
+    }
+    QRectF TrailPathItem::boundingRect()const
+    {
+        return bounds;
+    }
+    QPainterPath TrailPathItem::shape()const
+    {
+        return hitshape;
+    }
+    void TrailPathItem::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
+    {
+        int nearest=-1;
+        qreal best=hitradius*hitradius;
+        if(showpoints)
+        {
+            foreach(int n,drawn)
+            {
+                QPointF d=projected[Index(n)]-event->pos();
+                qreal distance2=d.x()*d.x()+d.y()*d.y();
+                if(distance2<best)
+                {
+                    best=distance2;
+                    nearest=n;
+                }
+            }
+        }
+        if(nearest<0)
+        {
+            setToolTip(QString());
+            return;
+        }
+        TrailPoint const& p=points[Index(nearest)];
+        QString coord_str = " " + QString::number(p.coord.Lat(), 'f', 6) + "   " + QString::number(p.coord.Lng(), 'f', 6);
+        setToolTip(QString(tr("Position:")+"%1\n"+tr("Altitude:")+"%2\n"+tr("Time:")+"%3").arg(coord_str).arg(QString::number(p.altitude)).arg(QDateTime::fromTime_t(p.time).toString()));
+    }
+
+    int TrailPathItem::type()const
+    {
+        return Type;
+    }
+}
@@ -0,0 +1,135 @@
+/**
+******************************************************************************
+*
+* @file       trailpathitem.h
+* @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+* @brief      A graphicsItem representing a whole UAV or GPS trail
+* @see        The GNU Public License (GPL) Version 3
+* @defgroup   OPMapWidget
+* @{
+*
+*****************************************************************************/
+/*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+#ifndef TRAILPATHITEM_H
+#define TRAILPATHITEM_H
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QPainterPath>
+#include <QVector>
+#include <QObject>
+#include "../internals/pointlatlng.h"
+#include "mapgraphicitem.h"
+
+namespace mapcontrol
+{
+    /**
+    * @brief A single QGraphicsItem drawing a complete trail
+    *
+    * Trail points are kept in a fixed size ring buffer. Their map projection is
+    * cached and only recomputed when the zoom changes, a pan just moves the item.
+    * What gets drawn is a Douglas-Peucker simplified copy of the projected trail,
+    * so the drawing cost follows the on-screen detail rather than the flight length.
+    *
+    * @class TrailPathItem trailpathitem.h "mapwidget/trailpathitem.h"
+    */
+    class TrailPathItem:public QObject,public QGraphicsItem
+    {
+        Q_OBJECT
+        Q_INTERFACES(QGraphicsItem)
+    public:
+                enum { Type = UserType + 8 };
+        /**
+        * @brief Constructor
+        *
+        * @param map the map the trail is drawn on, also becomes the item parent
+        * @param color color of the trail points and line
+        * @param capacity maximum number of trail points kept, the oldest are dropped first
+        */
+        TrailPathItem(MapGraphicItem* map,QColor const& color,int const& capacity=10000);
+        /**
+        * @brief Appends a point to the trail
+        *
+        * @param coord LatLng point
+        * @param altitude altitude in meters
+        */
+        void AddPoint(internals::PointLatLng const& coord,int const& altitude);
+        /**
+        * @brief Deletes all the trail points
+        */
+        void Clear();
+        /**
+        * @brief Returns the number of points in the trail
+        *
+        * @return int
+        */
+        int Count()const{return count;}
+        /**
+        * @brief Used to define if the trail points are drawn
+        *
+        * @param value
+        */
+        void SetShowPoints(bool const& value);
+        /**
+        * @brief Used to define if the line joining the trail points is drawn
+        *
+        * @param value
+        */
+        void SetShowLine(bool const& value);
+        /**
+        * @brief Follows the map after a pan or zoom, reprojects only on zoom change
+        */
+        void RefreshPos();
+
+        void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+                    QWidget *widget);
+        QRectF boundingRect() const;
+        QPainterPath shape() const;
+        int type() const;
+    protected:
+        void hoverMoveEvent(QGraphicsSceneHoverEvent *event);
+    private:
+        struct TrailPoint
+        {
+            internals::PointLatLng coord;
+            int altitude;
+            uint time;
+        };
+        int Index(int const& n)const{return (head+n)%points.size();}
+        QPointF Project(internals::PointLatLng const& coord);
+        void Reproject();
+        void Simplify();
+        static void DouglasPeucker(QVector<QPointF> const& line,qreal const& epsilon,QVector<bool>& keep);
+
+        MapGraphicItem* map;
+        QColor color;
+        QVector<TrailPoint> points;
+        QVector<QPointF> projected;
+        int head;
+        int count;
+        double projectedzoom;
+        internals::PointLatLng reference;
+        QPointF referencelocal;
+        QVector<int> drawn;
+        QPainterPath linepath;
+        QPainterPath hitshape;
+        QRectF bounds;
+        bool showpoints;
+        bool showline;
+    };
+}
+#endif // TRAILPATHITEM_H
@@ -0,0 +1,213 @@
+/**
+ ******************************************************************************
+ *
+ * @file       calibrationengine.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ConfigPlugin Config Plugin
+ * @{
+ * @brief Incremental AHRS multi-point calibration
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "calibrationengine.h"
+#include "calibration.h"
+
+#include <Eigen/LU>
+#include <Eigen/align-function.h>
+#include <iostream>
+#include <limits>
+
+using namespace Eigen;
+
+void RunningStats3::reset()
+{
+    n = 0;
+    m_mean.setZero();
+    m_m2.setZero();
+}
+
+void RunningStats3::add(const Vector3d& sample)
+{
+    ++n;
+    Vector3d delta = sample - m_mean;
+    m_mean += delta / n;
+    m_m2 += delta.cwise() * (sample - m_mean);
+}
+
+Vector3d RunningStats3::variance() const
+{
+    if (n < 2)
+        return Vector3d::Zero();
+    return m_m2 / (n - 1);
+}
+
+double RunningStats3::standardError() const
+{
+    if (n < 2)
+        return std::numeric_limits<double>::max();
+    return (variance() / n).cwise().sqrt().maxCoeff();
+}
+
+// Every position gets at least minSamples, and keeps sampling up to maxSamples
+// while the means are still moving by more than a quarter of the sensor noise
+// used by the twostep solver.
+const int CalibrationEngine::minSamples = 8;
+const int CalibrationEngine::maxSamples = 50;
+const double CalibrationEngine::accelNoise = 0.04;
+const double CalibrationEngine::magNoise = 4.0;
+
+CalibrationEngine::CalibrationEngine(QObject *parent) :
+        QObject(parent),
+        expectedPositions(0),
+        currentPosition(0),
+        collecting(false)
+{
+    reset(0);
+}
+
+void CalibrationEngine::reset(int positions)
+{
+    expectedPositions = positions;
+    collecting = false;
+    accelMeans.clear();
+    magMeans.clear();
+    accelMeans.reserve(positions);
+    magMeans.reserve(positions);
+
+    // A large initial covariance means no prior knowledge of the model
+    gyroCovariance = Matrix4d::Identity() * 1e6;
+    gyroModel.setZero();
+    gyroResidual = 0;
+}
+
+void CalibrationEngine::beginPosition(int position)
+{
+    currentPosition = position;
+    accelStats.reset();
+    magStats.reset();
+    collecting = true;
+}
+
+void CalibrationEngine::addSample(const CalibrationSample& sample)
+{
+    // Samples still queued after the position completed are dropped
+    if (!collecting)
+        return;
+
+    Vector3d accel = sample.accel.cast<double>();
+    accelStats.add(accel);
+    magStats.add(sample.mag.cast<double>());
+    updateGyroModel(accel, sample.gyro.cast<double>());
+
+    double accelError = accelStats.standardError();
+    double magError = magStats.standardError();
+    int samples = accelStats.count();
+    emit progress(currentPosition, samples, accelError, magError, gyroResidual);
+
+    bool converged = accelError < accelNoise / 4 && magError < magNoise / 4;
+    if (samples >= minSamples && (converged || samples >= maxSamples)) {
+        collecting = false;
+        accelMeans.push_back(accelStats.mean().cast<float>());
+        magMeans.push_back(magStats.mean().cast<float>());
+        std::cout << "observed accel: " << accelMeans.back().transpose()
+                << "\nobserved mag: " << magMeans.back().transpose()
+                << "\nsamples: " << samples << std::endl;
+        emit positionComplete(currentPosition);
+    }
+}
+
+/**
+ * Recursive least squares update of gyro = A * accel + b.  All three gyro
+ * axes share the same regressor, so they also share one covariance matrix.
+ */
+FORCE_ALIGN_FUNC
+void CalibrationEngine::updateGyroModel(const Vector3d& accel, const Vector3d& gyro)
+{
+    Vector4d h;
+    h << accel, 1.0;
+    Vector4d Ph = gyroCovariance * h;
+    Vector4d gain = Ph / (1.0 + h.dot(Ph));
+    Vector3d innovation = gyro - gyroModel.transpose() * h;
+
+    gyroModel += gain * innovation.transpose();
+    gyroCovariance -= gain * Ph.transpose();
+
+    // Smoothed innovation magnitude, settles once the model explains the data
+    gyroResidual = 0.9 * gyroResidual + 0.1 * innovation.norm();
+}
+
+FORCE_ALIGN_FUNC
+void CalibrationEngine::solve(double localGravity, double magX, double magY, double magZ)
+{
+    CalibrationResult result;
+    const size_t n_positions = accelMeans.size();
+    result.valid = n_positions > 0 && (int)n_positions == expectedPositions;
+    if (!result.valid) {
+        emit solved(result);
+        return;
+    }
+
+    Vector3f localMagField;
+    localMagField << magX, magY, magZ;
+    Vector3f referenceField = Vector3f::UnitZ()*localGravity;
+
+    double noise = accelNoise;
+    twostep_bias_scale(result.accelBias, result.accelScale, &accelMeans[0], n_positions, referenceField, noise*noise);
+    // Twostep computes an offset from the identity scalar, and a negative bias offset
+    result.accelScale += Matrix3f::Identity();
+    result.accelBias = -result.accelBias;
+    std::cout << "computed accel bias: " << result.accelBias.transpose()
+            << "\ncomputed accel scale:\n" << result.accelScale << std::endl;
+
+    std::vector<Vector3f> accelCorrected(n_positions);
+    for (size_t i = 0; i < n_positions; ++i) {
+        accelCorrected[i] = result.accelScale * accelMeans[i] + result.accelBias;
+    }
+
+    // Magnetometer has excellent orthogonality, so only calibrate the scale factors.
+    noise = magNoise;
+    twostep_bias_scale(result.magBias, result.magScale, &magMeans[0], n_positions, localMagField, noise*noise);
+    result.magScale += Vector3f::Ones();
+    result.magBias = -result.magBias;
+    std::cout << "computed mag bias: " << result.magBias.transpose()
+            << "\ncomputed mag scale:\n" << result.magScale << std::endl;
+
+    std::vector<Vector3f> magCorrected(n_positions);
+    for (size_t i = 0; i < n_positions; ++i) {
+        magCorrected[i] = result.magScale.asDiagonal() * magMeans[i] + result.magBias;
+    }
+
+    // The gyro model was fitted against raw accels while sampling.  With
+    // corrected = S * raw + c it becomes gyro = (A * S^-1) * corrected + (b - A * S^-1 * c),
+    // which is exactly the least squares fit against the corrected accels.
+    Matrix3d A = gyroModel.block<3, 3>(0, 0).transpose();
+    Vector3d b = gyroModel.row(3).transpose();
+    Matrix3d correctedA = A * result.accelScale.cast<double>().inverse();
+    result.accelSensitivity = correctedA.cast<float>();
+    result.gyroBias = (b - correctedA * result.accelBias.cast<double>()).cast<float>();
+    std::cout << "gyro bias: " << result.gyroBias.transpose()
+            << "\ngyro's acceleration sensitivity:\n" << result.accelSensitivity << std::endl;
+
+    // Calibrate alignment between the accelerometer and magnetometer, taking the mag as the
+    // reference.
+    calibration_misalignment(result.accelRotation, &accelCorrected[0], -Vector3f::UnitZ()*localGravity,
+            &magCorrected[0], localMagField, n_positions);
+    std::cout << "magnetometer rotation vector: " << result.accelRotation.transpose() << std::endl;
+
+    emit solved(result);
+}
@@ -0,0 +1,136 @@
+/**
+ ******************************************************************************
+ *
+ * @file       calibrationengine.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ConfigPlugin Config Plugin
+ * @{
+ * @brief Incremental AHRS multi-point calibration
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef CALIBRATIONENGINE_H
+#define CALIBRATIONENGINE_H
+
+#include <QObject>
+#include <QMetaType>
+#include <vector>
+
+#include <Eigen/Core>
+
+/**
+ * Running mean and variance of a 3-axis sensor (Welford's method).  Uses
+ * constant memory however many samples are added.
+ */
+class RunningStats3
+{
+public:
+    RunningStats3() { reset(); }
+    void reset();
+    void add(const Eigen::Vector3d& sample);
+    int count() const { return n; }
+    Eigen::Vector3d mean() const { return m_mean; }
+    Eigen::Vector3d variance() const;
+    //! Standard error of the mean on the worst axis, i.e. how much the mean may still move
+    double standardError() const;
+
+private:
+    int n;
+    Eigen::Vector3d m_mean;
+    Eigen::Vector3d m_m2;
+};
+
+//! One AttitudeRaw reading
+struct CalibrationSample
+{
+    Eigen::Vector3f accel;
+    Eigen::Vector3f gyro;
+    Eigen::Vector3f mag;
+};
+
+//! Corrections computed from a complete multi-point calibration run
+struct CalibrationResult
+{
+    bool valid;
+    Eigen::Matrix3f accelScale;
+    Eigen::Vector3f accelBias;
+    Eigen::Vector3f magScale;
+    Eigen::Vector3f magBias;
+    Eigen::Vector3f gyroBias;
+    Eigen::Matrix3f accelSensitivity;
+    Eigen::Vector3f accelRotation;
+};
+
+Q_DECLARE_METATYPE(CalibrationSample)
+Q_DECLARE_METATYPE(CalibrationResult)
+
+/**
+ * Multi-point calibration solver meant to live on a worker thread.
+ *
+ * Each position only keeps running statistics of the samples, and the gyro
+ * bias / acceleration sensitivity model is updated by recursive least squares
+ * as samples arrive, so nothing grows with the number of samples.  Progress
+ * and convergence are reported after every sample.
+ */
+class CalibrationEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    CalibrationEngine(QObject *parent = 0);
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+public slots:
+    void reset(int positions);
+    void beginPosition(int position);
+    void addSample(const CalibrationSample& sample);
+    void solve(double localGravity, double magX, double magY, double magZ);
+
+signals:
+    //! Live convergence of the position being sampled
+    void progress(int position, int samples, double accelError, double magError, double gyroResidual);
+    //! The position has enough samples, its means have been recorded
+    void positionComplete(int position);
+    void solved(const CalibrationResult& result);
+
+private:
+    void updateGyroModel(const Eigen::Vector3d& accel, const Eigen::Vector3d& gyro);
+
+    static const int minSamples;
+    static const int maxSamples;
+    static const double accelNoise;
+    static const double magNoise;
+
+    int expectedPositions;
+    int currentPosition;
+    bool collecting;
+
+    RunningStats3 accelStats;
+    RunningStats3 magStats;
+
+    std::vector<Eigen::Vector3f> accelMeans;
+    std::vector<Eigen::Vector3f> magMeans;
+
+    // Recursive least squares state for gyro = A * accel + b.  Rows 0-2 of
+    // gyroModel hold A transposed, row 3 holds b.
+    Eigen::Matrix4d gyroCovariance;
+    Eigen::Matrix<double, 4, 3> gyroModel;
+    double gyroResidual;
+};
+
+#endif // CALIBRATIONENGINE_H
@@ -34,6 +34,7 @@ HEADERS += configplugin.h \
     configstabilizationwidget.h \
     assertions.h \
     calibration.h \
+    calibrationengine.h \
     defaultattitudewidget.h
 
 SOURCES += configplugin.cpp \
@@ -59,6 +60,7 @@ SOURCES += configplugin.cpp \
     legacy-calibration.cpp \
     gyro-calibration.cpp \
     alignment-calibration.cpp \
+    calibrationengine.cpp \
     defaultattitudewidget.cpp
     
 FORMS +=  \
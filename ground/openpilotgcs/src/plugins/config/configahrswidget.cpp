@@ -48,6 +48,46 @@
 const double ConfigAHRSWidget::maxVarValue = 0.1;
 const int ConfigAHRSWidget::calibrationDelay = 7; // Time to wait for the AHRS to do its calibration
 
+namespace {
+
+// Multi-point calibration positions following the initial horizontal one
+const struct {
+    const char* instructions;
+    const char* display;
+} instructions[] = {
+    { "Pitch up 45 deg and click save position...", "plane-horizontal" },
+    { "Pitch down 45 deg and click save position...", "plane-horizontal" },
+    { "Roll left 45 deg and click save position...", "plane-left" },
+    { "Roll right 45 deg and click save position...", "plane-left" },
+
+    { "Turn left 90 deg to 09:00 position and click save position...", "plane-horizontal" },
+    { "Pitch up 45 deg and click save position...", "plane-horizontal" },
+    { "Pitch down 45 deg and click save position...", "plane-horizontal" },
+    { "Roll left 45 deg and click save position...", "plane-left" },
+    { "Roll right 45 deg and click save position...", "plane-left" },
+
+    { "Turn left 90 deg to 06:00 position and click save position...", "plane-horizontal" },
+    { "Pitch up 45 deg and click save position...", "plane-horizontal" },
+    { "Pitch down 45 deg and click save position...", "plane-horizontal" },
+    { "Roll left 45 deg and click save position...", "plane-left" },
+    { "Roll right 45 deg and click save position...", "plane-left" },
+
+    { "Turn left 90 deg to 03:00 position and click save position...", "plane-horizontal" },
+    { "Pitch up 45 deg and click save position...", "plane-horizontal" },
+    { "Pitch down 45 deg and click save position...", "plane-horizontal" },
+    { "Roll left 45 deg and click save position...", "plane-left" },
+    { "Roll right 45 deg and click save position...", "plane-left" },
+
+    { "Place with nose vertically up and click save position...", "plane-up" },
+    { "Place with nose straight down and click save position...", "plane-down" },
+    { "Place upside down and click save position...", "plane-flip" },
+};
+
+// The initial horizontal position plus one per instruction
+const int n_positions = sizeof(instructions) / sizeof(instructions[0]) + 1;
+
+}
+
 // *****************
 
 class Thread : public QThread
@@ -201,6 +241,21 @@ ConfigAHRSWidget::ConfigAHRSWidget(QWidget *parent) : ConfigTaskWidget(parent)
 
     position = -1;
 
+    // Set up the calibration engine, it receives the samples and reports back
+    // through queued connections
+    qRegisterMetaType<CalibrationSample>("CalibrationSample");
+    qRegisterMetaType<CalibrationResult>("CalibrationResult");
+    calibrationEngine = new CalibrationEngine();
+    calibrationEngine->moveToThread(&calibrationThread);
+    connect(this, SIGNAL(calibrationReset(int)), calibrationEngine, SLOT(reset(int)));
+    connect(this, SIGNAL(calibrationBeginPosition(int)), calibrationEngine, SLOT(beginPosition(int)));
+    connect(this, SIGNAL(calibrationSample(CalibrationSample)), calibrationEngine, SLOT(addSample(CalibrationSample)));
+    connect(this, SIGNAL(calibrationSolve(double,double,double,double)), calibrationEngine, SLOT(solve(double,double,double,double)));
+    connect(calibrationEngine, SIGNAL(progress(int,int,double,double,double)), this, SLOT(calibrationProgress(int,int,double,double,double)));
+    connect(calibrationEngine, SIGNAL(positionComplete(int)), this, SLOT(positionCaptured(int)));
+    connect(calibrationEngine, SIGNAL(solved(CalibrationResult)), this, SLOT(applyCalibration(CalibrationResult)));
+    calibrationThread.start();
+
     // Fill the dropdown menus:
     UAVObject *obj = dynamic_cast<UAVDataObject*>(getObjectManager()->getObject(QString("AHRSSettings")));
     UAVObjectField *field = obj->getField(QString("Algorithm"));
@@ -242,7 +297,9 @@ ConfigAHRSWidget::ConfigAHRSWidget(QWidget *parent) : ConfigTaskWidget(parent)
 
 ConfigAHRSWidget::~ConfigAHRSWidget()
 {
-   // Do nothing
+    calibrationThread.quit();
+    calibrationThread.wait();
+    delete calibrationEngine;
 }
 
 
@@ -284,9 +341,7 @@ void ConfigAHRSWidget::launchAccelBiasCalibration()
     field->setValue("FALSE");
     obj->updated();
 
-    accel_accum_x.clear();
-    accel_accum_y.clear();
-    accel_accum_z.clear();
+    accelBiasStats.reset();
 
 //    UAVDataObject* ahrsCalib = dynamic_cast<UAVDataObject*>(getObjectManager()->getObject(QString("AHRSCalibration")));
 //    ahrsCalib->getField("accel_bias")->setDouble(0,0);
@@ -320,23 +375,24 @@ void ConfigAHRSWidget::accelBiasattitudeRawUpdated(UAVObject *obj)
 
     // This is necessary to prevent a race condition on disconnect signal and another update
     if (collectingData == true) {
-        accel_accum_x.append(accel_field->getValue(0).toDouble());
-        accel_accum_y.append(accel_field->getValue(1).toDouble());
-        accel_accum_z.append(accel_field->getValue(2).toDouble());
+        accelBiasStats.add(Vector3d(accel_field->getDouble(0),
+                accel_field->getDouble(1),
+                accel_field->getDouble(2)));
     }
 
     m_ahrs->accelBiasProgress->setValue(m_ahrs->accelBiasProgress->value()+1);
 
-    if(accel_accum_x.size() >= 100 && collectingData == true) {
+    if(accelBiasStats.count() >= 100 && collectingData == true) {
         collectingData = false;
         disconnect(obj,SIGNAL(objectUpdated(UAVObject*)),this,SLOT(accelBiasattitudeRawUpdated(UAVObject*)));
         m_ahrs->accelBiasStart->setEnabled(true);
 
         UAVDataObject* ahrsCalib = dynamic_cast<UAVDataObject*>(getObjectManager()->getObject(QString("AHRSCalibration")));
         UAVObjectField* field = ahrsCalib->getField("accel_bias");
-        double xBias = field->getDouble(0)- listMean(accel_accum_x);
-        double yBias = field->getDouble(1) - listMean(accel_accum_y);
-        double zBias = -9.81 + field->getDouble(2) - listMean(accel_accum_z);
+        Vector3d accelMean = accelBiasStats.mean();
+        double xBias = field->getDouble(0) - accelMean[0];
+        double yBias = field->getDouble(1) - accelMean[1];
+        double zBias = -9.81 + field->getDouble(2) - accelMean[2];
 
         field->setDouble(xBias,0);
         field->setDouble(yBias,1);
@@ -599,95 +655,60 @@ void ConfigAHRSWidget::attitudeRawUpdated(UAVObject * obj)
 
     // This is necessary to prevent a race condition on disconnect signal and another update
     if (collectingData == true) {
-        accel_accum_x.append(accel_field->getValue(0).toDouble());
-        accel_accum_y.append(accel_field->getValue(1).toDouble());
-        accel_accum_z.append(accel_field->getValue(2).toDouble());
+        CalibrationSample sample;
+        sample.accel << accel_field->getDouble(0),
+			accel_field->getDouble(1),
+			accel_field->getDouble(2);
         // Note gyros actually (-y,-x,-z) but since we consistent here no prob
-        mag_accum_x.append(mag_field->getValue(0).toDouble());
-        mag_accum_y.append(mag_field->getValue(1).toDouble());
-        mag_accum_z.append(mag_field->getValue(2).toDouble());
-
-        gyro_accum_x.append(gyro_field->getValue(0).toDouble());
-        gyro_accum_y.append(gyro_field->getValue(1).toDouble());
-        gyro_accum_z.append(gyro_field->getValue(2).toDouble());
+        sample.gyro << gyro_field->getDouble(0),
+			gyro_field->getDouble(1),
+			gyro_field->getDouble(2);
+        sample.mag << mag_field->getDouble(0),
+			mag_field->getDouble(1),
+			mag_field->getDouble(2);
+        emit calibrationSample(sample);
     }
+}
 
-    if(accel_accum_x.size() >= 8 && collectingData == true) {
-        collectingData = false;
-        disconnect(obj,SIGNAL(objectUpdated(UAVObject*)),this,SLOT(attitudeRawUpdated(UAVObject*)));
-        m_ahrs->sixPointsSave->setEnabled(true);
+/**
+  * Called by the calibration engine once it has enough samples for a position
+  */
+void ConfigAHRSWidget::positionCaptured(int captured)
+{
+    QMutexLocker lock(&attitudeRawUpdateLock);
 
-        accel_data[position] << listMean(accel_accum_x),
-			listMean(accel_accum_y),
-			listMean(accel_accum_z);
-
-        mag_data[position] << listMean(mag_accum_x),
-			listMean(mag_accum_y),
-			listMean(mag_accum_z);
-
-        gyro_data[position] << listMean(gyro_accum_x),
-			listMean(gyro_accum_y),
-			listMean(gyro_accum_z);
-
-
-        std::cout << "observed accel: " << accel_data[position].transpose()
-			<< "\nobserved mag: " << mag_data[position].transpose()
-			<< "\nobserved gyro: " << gyro_data[position].transpose()
-			<< std::endl;
-
-        struct {
-        	const char* instructions;
-        	const char* display;
-        } instructions[] = {
-        		{ "Pitch up 45 deg and click save position...", "plane-horizontal" },
-        		{ "Pitch down 45 deg and click save position...", "plane-horizontal" },
-        		{ "Roll left 45 deg and click save position...", "plane-left" },
-        		{ "Roll right 45 deg and click save position...", "plane-left" },
-
-        		{ "Turn left 90 deg to 09:00 position and click save position...", "plane-horizontal" },
-        		{ "Pitch up 45 deg and click save position...", "plane-horizontal" },
-        		{ "Pitch down 45 deg and click save position...", "plane-horizontal" },
-        		{ "Roll left 45 deg and click save position...", "plane-left" },
-        		{ "Roll right 45 deg and click save position...", "plane-left" },
-
-        		{ "Turn left 90 deg to 06:00 position and click save position...", "plane-horizontal" },
-        		{ "Pitch up 45 deg and click save position...", "plane-horizontal" },
-        		{ "Pitch down 45 deg and click save position...", "plane-horizontal" },
-        		{ "Roll left 45 deg and click save position...", "plane-left" },
-        		{ "Roll right 45 deg and click save position...", "plane-left" },
-
-        		{ "Turn left 90 deg to 03:00 position and click save position...", "plane-horizontal" },
-        		{ "Pitch up 45 deg and click save position...", "plane-horizontal" },
-        		{ "Pitch down 45 deg and click save position...", "plane-horizontal" },
-        		{ "Roll left 45 deg and click save position...", "plane-left" },
-        		{ "Roll right 45 deg and click save position...", "plane-left" },
-
-        		{ "Place with nose vertically up and click save position...", "plane-up" },
-        		{ "Place with nose straight down and click save position...", "plane-down" },
-        		{ "Place upside down and click save position...", "plane-flip" },
-        };
-
-        n_positions = sizeof(instructions) / sizeof(instructions[0]);
-        position = (position + 1) % n_positions;
-
-        if (position != 0 && position < n_positions) {
-
-        	m_ahrs->sixPointCalibInstructions->append(instructions[position-1].instructions);
-        	displayPlane(instructions[position-1].display);
-        }
-        else if(position == 0) {
-        	position = n_positions;
-            computeScaleBias();
-            m_ahrs->sixPointsStart->setEnabled(true);
-            m_ahrs->sixPointsSave->setEnabled(false);
-            saveAHRSCalibration(); // Saves the result to SD.
-
-            /* Cleanup original settings */
-            getObjectManager()->getObject(QString("AttitudeRaw"))->setMetadata(initialMdata);
-        }
+    if (captured != position || collectingData == false)
+        return;
+
+    collectingData = false;
+    UAVObject *obj = getObjectManager()->getObject(QString("AttitudeRaw"));
+    disconnect(obj,SIGNAL(objectUpdated(UAVObject*)),this,SLOT(attitudeRawUpdated(UAVObject*)));
+
+    position++;
+    if (position < n_positions) {
+        m_ahrs->sixPointsSave->setEnabled(true);
+        m_ahrs->sixPointCalibInstructions->append(instructions[position-1].instructions);
+        displayPlane(instructions[position-1].display);
+    } else {
+        // Extract the local magnetic and gravitational field vectors from HomeLocation.
+        UAVObject *home = dynamic_cast<UAVDataObject*>(getObjectManager()->getObject(QString("HomeLocation")));
+        UAVObjectField *be = home->getField("Be");
+        m_ahrs->sixPointCalibInstructions->append("Computing calibration...");
+        emit calibrationSolve(home->getField("g_e")->getDouble(),
+                be->getDouble(0), be->getDouble(1), be->getDouble(2));
     }
 }
 
+/**
+  * Live feedback on how well the current position is converging
+  */
+void ConfigAHRSWidget::calibrationProgress(int pos, int samples, double accelError, double magError, double gyroResidual)
+{
+    m_ahrs->calibInstructions->setText(QString("Position %1: %2 samples, accel error %3, mag error %4, gyro residual %5")
+            .arg(pos + 1).arg(samples)
+            .arg(accelError, 0, 'g', 3).arg(magError, 0, 'g', 3).arg(gyroResidual, 0, 'g', 3));
+}
+
 /**
   * Saves the data from the aircraft in one of six positions
   */
@@ -696,15 +717,7 @@ void ConfigAHRSWidget::savePositionData()
     QMutexLocker lock(&attitudeRawUpdateLock);
     m_ahrs->sixPointsSave->setEnabled(false);
 
-    accel_accum_x.clear();
-    accel_accum_y.clear();
-    accel_accum_z.clear();
-    mag_accum_x.clear();
-    mag_accum_y.clear();
-    mag_accum_z.clear();
-    gyro_accum_x.clear();
-    gyro_accum_y.clear();
-    gyro_accum_z.clear();
+    emit calibrationBeginPosition(position);
 
     collectingData = true;
     UAVObject *obj = dynamic_cast<UAVDataObject*>(getObjectManager()->getObject(QString("AttitudeRaw")));
@@ -876,63 +889,23 @@ ConfigAHRSWidget::updateScaleFactors(UAVObjectField *scale,
     }
 }
 
+/**
+  * Stores the corrections computed by the calibration engine
+  */
 FORCE_ALIGN_FUNC
-void ConfigAHRSWidget::computeScaleBias()
+void ConfigAHRSWidget::applyCalibration(const CalibrationResult& result)
 {
-    // Extract the local magnetic and gravitational field vectors from HomeLocation.
-    UAVObject *home = dynamic_cast<UAVDataObject*>(getObjectManager()->getObject(QString("HomeLocation")));
-    Vector3f localMagField;
-    localMagField << home->getField("Be")->getValue(0).toDouble(),
-		home->getField("Be")->getValue(1).toDouble(),
-		home->getField("Be")->getValue(2).toDouble();
-
-    float localGravity = home->getField("g_e")->getDouble();
-
-    Vector3f referenceField = Vector3f::UnitZ()*localGravity;
-    double noise = 0.04;
-    Vector3f accelBias;
-    Matrix3f accelScale;
-    std::cout << "number of samples: " << n_positions << "\n";
-    twostep_bias_scale(accelBias, accelScale, accel_data, n_positions, referenceField, noise*noise);
-    // Twostep computes an offset from the identity scalar, and a negative bias offset
-    accelScale += Matrix3f::Identity();
-    accelBias = -accelBias;
-    std::cout << "computed accel bias: " << accelBias.transpose()
-		<< "\ncomputed accel scale:\n" << accelScale<< std::endl;
-
-    // Apply the computed scale factor and bias to each sample
-    for (int i = 0; i < n_positions; ++i) {
-    	accel_data[i] = accelScale * accel_data[i] + accelBias;
-    }
-
-    // Magnetometer has excellent orthogonality, so only calibrate the scale factors.
-    Vector3f magBias;
-    Vector3f magScale;
-    noise = 4.0;
-    twostep_bias_scale(magBias, magScale, mag_data, n_positions, localMagField, noise*noise);
-    magScale += Vector3f::Ones();
-    magBias = -magBias;
-    std::cout << "computed mag bias: " << magBias.transpose()
-		<< "\ncomputed mag scale:\n" << magScale << std::endl;
-
-    // Apply the computed scale factor and bias to each sample
-    for (int i = 0; i < n_positions; ++i) {
-    	mag_data[i] = magScale.asDiagonal() * mag_data[i] + magBias;
-    }
+    m_ahrs->sixPointsStart->setEnabled(true);
+    m_ahrs->sixPointsSave->setEnabled(false);
+    position = -1; //set to run again
 
-    // Calibrate gyro bias and acceleration sensitivity
-    Matrix3f accelSensitivity;
-    Vector3f gyroBias;
-    gyroscope_calibration(gyroBias, accelSensitivity, gyro_data, accel_data, n_positions);
-    std::cout << "gyro bias: " << gyroBias.transpose()
-		<< "\ngyro's acceleration sensitivity:\n" << accelSensitivity << std::endl;
+    /* Cleanup original settings */
+    getObjectManager()->getObject(QString("AttitudeRaw"))->setMetadata(initialMdata);
 
-    // Calibrate alignment between the accelerometer and magnetometer, taking the mag as the
-    // reference.
-    Vector3f accelRotation;
-    calibration_misalignment(accelRotation, accel_data, -Vector3f::UnitZ()*localGravity,
-			mag_data, localMagField, n_positions);
-    std::cout << "magnetometer rotation vector: " << accelRotation.transpose() << std::endl;
+    if (!result.valid) {
+        m_ahrs->sixPointCalibInstructions->append("Calibration failed, not all positions were captured.");
+        return;
+    }
 
     // Update the calibration scalars with a clear message box
     m_ahrs->sixPointCalibInstructions->clear();
@@ -942,8 +915,8 @@ void ConfigAHRSWidget::computeScaleBias()
     bool success = updateScaleFactors(obj->getField(QString("accel_scale")),
 			obj->getField(QString("accel_bias")),
 			obj->getField(QString("accel_ortho")),
-			accelScale,
-			accelBias,
+			result.accelScale,
+			result.accelBias,
 			saved_accel_scale,
 			saved_accel_bias,
 			saved_accel_ortho);
@@ -951,26 +924,27 @@ void ConfigAHRSWidget::computeScaleBias()
     success &= updateScaleFactors(obj->getField(QString("mag_scale")),
     		obj->getField(QString("mag_bias")),
     		NULL,
-    		magScale.asDiagonal(),
-    		magBias,
+    		result.magScale.asDiagonal(),
+    		result.magBias,
     		saved_mag_scale,
     		saved_mag_bias);
 
 	updateBias(obj->getField(QString("gyro_scale")),
 		obj->getField(QString("gyro_bias")),
-		gyroBias);
+		result.gyroBias);
 
 #if 0
 	// TODO: Enable after v1.0 feature freeze is lifted.
-	updateRotation(obj->getField(QString("accel_rotation")), accelRotation);
+	updateRotation(obj->getField(QString("accel_rotation")), result.accelRotation);
 #endif
 
     obj->updated();
 
-    position = -1; //set to run again
 	if (success)
 		m_ahrs->sixPointCalibInstructions->append("Computed new accel and mag scale and bias.");
 
+    saveAHRSCalibration(); // Saves the result to SD.
+
 }
 
 /**
@@ -990,9 +964,7 @@ void ConfigAHRSWidget::multiPointCalibrationMode()
 
     Thread::usleep(100000);
 
-    gyro_accum_x.clear();
-    gyro_accum_y.clear();
-    gyro_accum_z.clear();
+    emit calibrationReset(n_positions);
 
     /* Need to get as many AttitudeRaw updates as possible */
     obj = getObjectManager()->getObject(QString("AttitudeRaw"));
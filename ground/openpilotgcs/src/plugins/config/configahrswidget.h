@@ -34,12 +34,14 @@
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
 #include "uavobject.h"
+#include "calibrationengine.h"
 #include <QtGui/QWidget>
 #include <QtSvg/QSvgRenderer>
 #include <QtSvg/QGraphicsSvgItem>
 #include <QList>
 #include <QTimer>
 #include <QMutex>
+#include <QThread>
 
 #include <Eigen/Core>
 
@@ -79,22 +81,12 @@ private:
 
     bool collectingData;
 
-    QList<double> gyro_accum_x;
-    QList<double> gyro_accum_y;
-    QList<double> gyro_accum_z;
-    QList<double> accel_accum_x;
-    QList<double> accel_accum_y;
-    QList<double> accel_accum_z;
-    QList<double> mag_accum_x;
-    QList<double> mag_accum_y;
-    QList<double> mag_accum_z;
-
-    // TODO: Store these in std::vectors
-    Eigen::Vector3f gyro_data[60];
-    Eigen::Vector3f accel_data[60];
-    Eigen::Vector3f mag_data[60];
+    RunningStats3 accelBiasStats;
+
+    // The multi-point calibration is solved incrementally on its own thread
+    QThread calibrationThread;
+    CalibrationEngine *calibrationEngine;
     int position;
-    int n_positions;
 
     UAVObject::Metadata initialMdata;
 
@@ -123,6 +115,12 @@ private:
     		const Eigen::Vector3f& oldBias,
     		const Eigen::Vector3f& oldOrtho = Eigen::Vector3f::Zero());
 
+signals:
+    void calibrationReset(int positions);
+    void calibrationBeginPosition(int position);
+    void calibrationSample(const CalibrationSample& sample);
+    void calibrationSolve(double localGravity, double magX, double magY, double magZ);
+
 private slots:
     void enableHomeLocSave(UAVObject *obj);
     void launchAHRSCalibration();
@@ -137,7 +135,9 @@ private slots:
     void ahrsSettingsSaveRAM();
     void ahrsSettingsSaveSD();
     void savePositionData();
-    void computeScaleBias();
+    void positionCaptured(int captured);
+    void calibrationProgress(int pos, int samples, double accelError, double magError, double gyroResidual);
+    void applyCalibration(const CalibrationResult& result);
     void multiPointCalibrationMode();
 //    void sixPointCalibrationMode();      // this function no longer exists
     void attitudeRawUpdated(UAVObject * obj);
@@ -106,6 +106,8 @@ SettingsDialog::SettingsDialog(QWidget *parent, const QString &categoryId,
     connect(buttonBox->button(QDialogButtonBox::Apply), SIGNAL(clicked()), this, SLOT(apply()));
    
     m_instanceManager = Core::ICore::instance()->uavGadgetInstanceManager();
+    // the options pages of lazy gadgets only exist once their plugin is started
+    m_instanceManager->loadLazyGadgets();
     
     connect(this, SIGNAL(settingsDialogShown(Core::Internal::SettingsDialog*)), m_instanceManager, SLOT(settingsDialogShown(Core::Internal::SettingsDialog*)));
     connect(this, SIGNAL(settingsDialogRemoved()), m_instanceManager, SLOT(settingsDialogRemoved()));
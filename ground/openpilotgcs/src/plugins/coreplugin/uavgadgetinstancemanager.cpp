@@ -36,10 +36,12 @@
 #include "icore.h"
 
 #include <extensionsystem/pluginmanager.h>
+#include <extensionsystem/pluginspec.h>
 #include <QtCore/QStringList>
 #include <QtCore/QSettings>
 #include <QtCore/QDebug>
 #include <QtGui/QMessageBox>
+#include <QtGui/QApplication>
 
 
 using namespace Core;
@@ -47,7 +49,8 @@ using namespace Core;
 static const UAVConfigVersion m_versionUAVGadgetConfigurations = UAVConfigVersion("1.2.0");
 
 UAVGadgetInstanceManager::UAVGadgetInstanceManager(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    m_lazySettingsFormat(QSettings::NativeFormat)
 {
     m_pm = ExtensionSystem::PluginManager::instance();
     QList<IUAVGadgetFactory*> factories = m_pm->getObjects<IUAVGadgetFactory>();
@@ -61,6 +64,19 @@ UAVGadgetInstanceManager::UAVGadgetInstanceManager(QObject *parent) :
             m_classIdIconMap.insert(classId, icon);
         }
     }
+    // The gadgets of lazy plugins that were not started, the plugin is
+    // started when one of them is first created
+    foreach (ExtensionSystem::PluginSpec *spec, m_pm->plugins()) {
+        if (!spec->isLazy() || spec->hasError() || spec->state() != ExtensionSystem::PluginSpec::Resolved)
+            continue;
+        foreach (const ExtensionSystem::PluginGadgetDescription &gadget, spec->gadgetDescriptions()) {
+            if (m_classIdNameMap.contains(gadget.classId))
+                continue;
+            m_lazyPlugins.insert(gadget.classId, spec);
+            m_classIdNameMap.insert(gadget.classId, gadget.name);
+            m_classIdIconMap.insert(gadget.classId, QIcon());
+        }
+    }
 }
 
 UAVGadgetInstanceManager::~UAVGadgetInstanceManager()
@@ -77,6 +93,10 @@ void UAVGadgetInstanceManager::readSettings(QSettings *qs)
     while ( !m_configurations.isEmpty() ){
        emit configurationToBeDeleted(m_configurations.takeLast());
     }
+    // The configurations of lazy gadgets are read from here when their plugin starts
+    m_lazySettingsFile = qs->fileName();
+    m_lazySettingsFormat = qs->format();
+
     qs->beginGroup("UAVGadgetConfigurations");
     UAVConfigInfo configInfo(qs);
     configInfo.setNameOfConfigurable("UAVGadgetConfigurations");
@@ -89,6 +109,9 @@ void UAVGadgetInstanceManager::readSettings(QSettings *qs)
     if ( configInfo.version() == UAVConfigVersion("1.1.0") ){
         configInfo.notify(tr("Migrating UAVGadgetConfigurations from version 1.1.0 to ")
                           + m_versionUAVGadgetConfigurations.toString());
+        // Only 1.2.0 configurations are read when a lazy gadget is first created
+        while (!m_lazyPlugins.isEmpty())
+            startLazyPlugin(m_lazyPlugins.begin().value());
         readConfigs_1_1_0(qs); // this is fully compatible with 1.2.0
     }
     else if ( !configInfo.standardVersionHandlingOK(m_versionUAVGadgetConfigurations) ){
@@ -108,53 +131,60 @@ void UAVGadgetInstanceManager::readSettings(QSettings *qs)
 
 void UAVGadgetInstanceManager::readConfigs_1_2_0(QSettings *qs)
 {
-    UAVConfigInfo configInfo;
-
     foreach (QString classId, m_classIdNameMap.keys())
     {
-        IUAVGadgetFactory *f = factory(classId);
-        qs->beginGroup(classId);
+        if (m_lazyPlugins.contains(classId))
+            continue;
+        readConfigs_1_2_0(qs, classId);
+    }
+}
 
-        QStringList configs = QStringList();
+void UAVGadgetInstanceManager::readConfigs_1_2_0(QSettings *qs, QString classId)
+{
+    UAVConfigInfo configInfo;
 
-        configs = qs->childGroups();
-        foreach (QString configName, configs) {
-            qDebug() << "Loading config: " << classId << "," <<  configName;
-            qs->beginGroup(configName);
-            configInfo.read(qs);
-            configInfo.setNameOfConfigurable(classId+"-"+configName);
-            qs->beginGroup("data");
-            IUAVGadgetConfiguration *config = f->createConfiguration(qs, &configInfo);
-            if (config){
-                config->setName(configName);
-                config->setProvisionalName(configName);
-                config->setLocked(configInfo.locked());
-                int idx = indexForConfig(m_configurations, classId, configName);
-                if ( idx >= 0 ){
-                    // We should replace the config, but it might be used, so just
-                    // throw it out of the list. The GCS should be reinitialised soon.
-                    m_configurations[idx] = config;
-                }
-                else{
-                    m_configurations.append(config);
-                }
-            }
-            qs->endGroup();
-            qs->endGroup();
-        }
+    IUAVGadgetFactory *f = factory(classId);
+    qs->beginGroup(classId);
 
-        if (configs.count() == 0) {
-            IUAVGadgetConfiguration *config = f->createConfiguration(0, 0);
-            // it is not mandatory for uavgadgets to have any configurations (settings)
-            // and therefore we have to check for that
-            if (config) {
-                config->setName(tr("default"));
-                config->setProvisionalName(tr("default"));
+    QStringList configs = QStringList();
+
+    configs = qs->childGroups();
+    foreach (QString configName, configs) {
+        qDebug() << "Loading config: " << classId << "," <<  configName;
+        qs->beginGroup(configName);
+        configInfo.read(qs);
+        configInfo.setNameOfConfigurable(classId+"-"+configName);
+        qs->beginGroup("data");
+        IUAVGadgetConfiguration *config = f->createConfiguration(qs, &configInfo);
+        if (config){
+            config->setName(configName);
+            config->setProvisionalName(configName);
+            config->setLocked(configInfo.locked());
+            int idx = indexForConfig(m_configurations, classId, configName);
+            if ( idx >= 0 ){
+                // We should replace the config, but it might be used, so just
+                // throw it out of the list. The GCS should be reinitialised soon.
+                m_configurations[idx] = config;
+            }
+            else{
                 m_configurations.append(config);
             }
         }
         qs->endGroup();
+        qs->endGroup();
+    }
+
+    if (configs.count() == 0) {
+        IUAVGadgetConfiguration *config = f->createConfiguration(0, 0);
+        // it is not mandatory for uavgadgets to have any configurations (settings)
+        // and therefore we have to check for that
+        if (config) {
+            config->setName(tr("default"));
+            config->setProvisionalName(tr("default"));
+            m_configurations.append(config);
+        }
     }
+    qs->endGroup();
 }
 
 void UAVGadgetInstanceManager::readConfigs_1_1_0(QSettings *qs)
@@ -208,6 +238,21 @@ void UAVGadgetInstanceManager::readConfigs_1_1_0(QSettings *qs)
 
 void UAVGadgetInstanceManager::saveSettings(QSettings *qs)
 {
+    // Lazy gadgets that were not created have their configurations only in
+    // the settings they were read from, keep them as they are
+    QMap<QString, QVariant> lazyConfigs;
+    if (!m_lazyPlugins.isEmpty() && !m_lazySettingsFile.isEmpty()) {
+        QSettings source(m_lazySettingsFile, m_lazySettingsFormat);
+        source.beginGroup("UAVGadgetConfigurations");
+        foreach (QString classId, m_lazyPlugins.keys()) {
+            source.beginGroup(classId);
+            foreach (QString key, source.allKeys())
+                lazyConfigs.insert(classId + "/" + key, source.value(key));
+            source.endGroup();
+        }
+        source.endGroup();
+    }
+
     UAVConfigInfo *configInfo;
     qs->beginGroup("UAVGadgetConfigurations");
     qs->remove(""); // Remove existing configurations
@@ -227,6 +272,8 @@ void UAVGadgetInstanceManager::saveSettings(QSettings *qs)
         qs->endGroup();
         delete configInfo;
     }
+    foreach (QString key, lazyConfigs.keys())
+        qs->setValue(key, lazyConfigs.value(key));
     qs->endGroup();
 }
 
@@ -240,21 +287,96 @@ void UAVGadgetInstanceManager::createOptionsPages()
     }
 
     foreach (IUAVGadgetConfiguration *config, m_configurations)
-    {
-        IUAVGadgetFactory *f = factory(config->classId());
-        IOptionsPage *p = f->createOptionsPage(config);
-        if (p) {
-            IOptionsPage *page = new UAVGadgetOptionsPageDecorator(p, config, f->isSingleConfigurationGadget());
-            page->setIcon(f->icon());
-            m_optionsPages.append(page);
-            m_pm->addObject(page);
+        createOptionsPage(config);
+}
+
+void UAVGadgetInstanceManager::createOptionsPage(IUAVGadgetConfiguration *config)
+{
+    IUAVGadgetFactory *f = factory(config->classId());
+    IOptionsPage *p = f->createOptionsPage(config);
+    if (p) {
+        IOptionsPage *page = new UAVGadgetOptionsPageDecorator(p, config, f->isSingleConfigurationGadget());
+        page->setIcon(f->icon());
+        m_optionsPages.append(page);
+        m_pm->addObject(page);
+    }
+}
+
+/**
+  * Starts a lazy plugin and anything it needs that is not running yet, and
+  * takes in the gadget factories they add. Returns the class ids of the new
+  * factories.
+  */
+QStringList UAVGadgetInstanceManager::startLazyPlugin(ExtensionSystem::PluginSpec *spec)
+{
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    if (!m_pm->loadLazyPlugin(spec))
+        qWarning() << "Could not start plugin" << spec->name() << ":" << spec->errorString();
+    QApplication::restoreOverrideCursor();
+
+    // A started or failed plugin is not lazy anymore, neither are its dependencies
+    foreach (QString classId, m_lazyPlugins.keys()) {
+        ExtensionSystem::PluginSpec *lazySpec = m_lazyPlugins.value(classId);
+        if (lazySpec == spec || lazySpec->state() != ExtensionSystem::PluginSpec::Resolved
+            || lazySpec->hasError()) {
+            m_lazyPlugins.remove(classId);
+            m_classIdNameMap.remove(classId);
+            m_classIdIconMap.remove(classId);
         }
     }
+
+    QStringList classIds;
+    QList<IUAVGadgetFactory*> factories = m_pm->getObjects<IUAVGadgetFactory>();
+    foreach (IUAVGadgetFactory *f, factories) {
+        if (!m_factories.contains(f)) {
+            m_factories.append(f);
+            QString classId = f->classId();
+            m_classIdNameMap.insert(classId, f->name());
+            m_classIdIconMap.insert(classId, f->icon());
+            classIds.append(classId);
+        }
+    }
+    return classIds;
+}
+
+/**
+  * Starts the plugin of a lazy gadget, then reads the configurations of the
+  * gadgets it adds and creates their options pages.
+  */
+bool UAVGadgetInstanceManager::loadLazyGadget(QString classId)
+{
+    ExtensionSystem::PluginSpec *spec = m_lazyPlugins.value(classId);
+    if (!spec)
+        return factory(classId) != 0;
+    QStringList classIds = startLazyPlugin(spec);
+
+    int firstNew = m_configurations.count();
+    if (!m_lazySettingsFile.isEmpty()) {
+        QSettings qs(m_lazySettingsFile, m_lazySettingsFormat);
+        qs.beginGroup("UAVGadgetConfigurations");
+        foreach (QString newClassId, classIds)
+            readConfigs_1_2_0(&qs, newClassId);
+        qs.endGroup();
+    }
+    for (int i = firstNew; i < m_configurations.count(); ++i)
+        createOptionsPage(m_configurations.at(i));
+    return factory(classId) != 0;
+}
+
+/**
+  * Starts the plugins of all lazy gadgets, so their options pages can be shown.
+  */
+void UAVGadgetInstanceManager::loadLazyGadgets()
+{
+    while (!m_lazyPlugins.isEmpty())
+        loadLazyGadget(m_lazyPlugins.begin().key());
 }
 
 
 IUAVGadget *UAVGadgetInstanceManager::createGadget(QString classId, QWidget *parent)
 {
+    if (m_lazyPlugins.contains(classId))
+        loadLazyGadget(classId);
     IUAVGadgetFactory *f = factory(classId);
     if (f) {
         QList<IUAVGadgetConfiguration*> *configs = configurations(classId);
@@ -38,6 +38,7 @@
 
 namespace ExtensionSystem {
     class PluginManager;
+    class PluginSpec;
 }
 
 namespace Core
@@ -73,6 +74,7 @@ public:
     QStringList configurationNames(QString classId) const;
     QString gadgetName(QString classId) const;
     QIcon gadgetIcon(QString classId) const;
+    void loadLazyGadgets();
 
 signals:
     void configurationChanged(IUAVGadgetConfiguration* config);
@@ -87,6 +89,9 @@ public slots:
 private:
     IUAVGadgetFactory *factory(QString classId) const;
     void createOptionsPages();
+    void createOptionsPage(IUAVGadgetConfiguration *config);
+    QStringList startLazyPlugin(ExtensionSystem::PluginSpec *spec);
+    bool loadLazyGadget(QString classId);
     QList<IUAVGadgetConfiguration*> *configurations(QString classId) const;
     QString suggestName(QString classId, QString name);
     QList<IUAVGadget*> m_gadgetInstances;
@@ -101,10 +106,14 @@ private:
     QList<IOptionsPage*> m_provisionalOptionsPages;
     Core::Internal::SettingsDialog *m_settingsDialog;
     ExtensionSystem::PluginManager *m_pm;
+    QMap<QString, ExtensionSystem::PluginSpec*> m_lazyPlugins;
+    QString m_lazySettingsFile;
+    QSettings::Format m_lazySettingsFormat;
     int indexForConfig(QList<IUAVGadgetConfiguration*> configurations,
                        QString classId, QString configName);
     void readConfigs_1_1_0(QSettings *qs);
     void readConfigs_1_2_0(QSettings *qs);
+    void readConfigs_1_2_0(QSettings *qs, QString classId);
 };
 
 } // namespace Core
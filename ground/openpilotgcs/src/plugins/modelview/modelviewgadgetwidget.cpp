@@ -26,6 +26,12 @@
  */
 #include "modelviewgadgetwidget.h"
 #include "extensionsystem/pluginmanager.h"
+#include "utils/pathutils.h"
+#include "io/glc_bsreptoworld.h"
+#include "geometry/glc_bsrep.h"
+#include "geometry/glc_mesh.h"
+#include <QtCore/QtConcurrentRun>
+#include <QtCore/QCryptographicHash>
 #include <iostream>
 
 ModelViewGadgetWidget::ModelViewGadgetWidget(QWidget *parent) 
@@ -39,6 +45,8 @@ ModelViewGadgetWidget::ModelViewGadgetWidget(QWidget *parent)
 , m_ModelBoundingBox()
 , m_MotionTimer()
 , vboEnable(false)
+, loadError(true)
+, modelLoading(false)
 {
     // Prevent crash on non-VBO enabled systems during GLC geometry creation
     GLC_State::setVboUsage(vboEnable);
@@ -66,10 +74,13 @@ ModelViewGadgetWidget::ModelViewGadgetWidget(QWidget *parent)
 
     // Create objects to display
     connect(&m_MotionTimer, SIGNAL(timeout()), this, SLOT(updateAttitude()));
+    connect(&m_LoadWatcher, SIGNAL(finished()), this, SLOT(sceneLoaded()));
 }
 
 ModelViewGadgetWidget::~ModelViewGadgetWidget()
 {
+    // The loader shares the GLC factory with us, let it finish first
+    m_LoadWatcher.waitForFinished();
     //delete m_pFactory;
 }
 
@@ -82,7 +93,7 @@ void ModelViewGadgetWidget::reloadScene()
 //// Private functions ////
 void ModelViewGadgetWidget::initializeGL()
 {
-    if (loadError)
+    if (loadError || modelLoading)
         return;
     // OpenGL initialization
     m_GlView.initGl();
@@ -107,6 +118,13 @@ void ModelViewGadgetWidget::initializeGL()
 
 void ModelViewGadgetWidget::paintGL()
 {
+    if (modelLoading)
+    {
+        // Placeholder until the background load has delivered the world
+        glClearColor(0.0, 0.0, 0.0, 1.0);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        return;
+    }
     if (loadError)
         return;
     // Clear screen
@@ -155,27 +173,129 @@ void ModelViewGadgetWidget::CreateScene()
         qDebug("ModelView: background image file loading failed.");
     }
 
-    try
+    if (!QFile::exists(acFilename))
     {
-        if(QFile::exists(acFilename))
-	{
-            QFile aircraft(acFilename);
-            m_World= GLC_Factory::instance()->createWorldFromFile(aircraft);
-            m_ModelBoundingBox= m_World.boundingBox();
-            m_GlView.reframe(m_ModelBoundingBox); // center 3D model in the scene
-            m_GlView.setDistMinAndMax(m_World.boundingBox());
-            loadError = false;
-            if (!mvInitGLSuccess)
-                initializeGL();
-        } else {
-            loadError = true;
+        loadError = true;
+        return;
+    }
+
+    // Parsing 3DS/Collada/OBJ files can take seconds, so the world is
+    // built on a worker thread and picked up again in sceneLoaded()
+    const QString cacheDir = Utils::PathUtils().GetStoragePath() + "modelcache" + QDir::separator();
+    modelLoading = true;
+    m_MotionTimer.stop();
+    m_LoadWatcher.setFuture(QtConcurrent::run(&ModelViewGadgetWidget::loadWorld, acFilename, cacheDir));
+    updateGL();
+}
+
+// Runs on a worker thread: must not touch the widget or the GL context
+ModelLoadResult ModelViewGadgetWidget::loadWorld(const QString &fileName, const QString &cacheDir)
+{
+    ModelLoadResult result;
+
+    QFile aircraft(fileName);
+    if (!aircraft.open(QIODevice::ReadOnly))
+        return result;
+    // Key the cache on the file contents so edited models are picked up
+    const QString hash = QCryptographicHash::hash(aircraft.readAll(), QCryptographicHash::Md5).toHex();
+    aircraft.close();
+    const QString cacheFileName = cacheDir + hash + '.' + GLC_BSRep::suffix();
+
+    if (QFile::exists(cacheFileName))
+    {
+        try
+        {
+            QFile cacheFile(cacheFileName);
+            GLC_BSRepToWorld bsRepToWorld;
+            GLC_World* pWorld = bsRepToWorld.CreateWorldFromBSRep(cacheFile);
+            result.world = *pWorld;
+            delete pWorld;
+            result.ok = true;
+            return result;
         }
+        catch(GLC_Exception e)
+        {
+            qDebug("ModelView: model cache is unreadable, reloading aircraft file.");
+            QFile::remove(cacheFileName);
+        }
+    }
+
+    try
+    {
+        result.world = GLC_Factory::instance()->createWorldFromFile(aircraft);
+        result.ok = true;
     }
     catch(GLC_Exception e)
     {
         qDebug("ModelView: aircraft file loading failed.");
+        return result;
+    }
+
+    if (QDir().mkpath(cacheDir))
+        saveWorldCache(result.world, cacheFileName);
+
+    return result;
+}
+
+// Flatten the world into a single 3D representation and store it as BSRep
+void ModelViewGadgetWidget::saveWorldCache(const GLC_World &world, const QString &cacheFileName)
+{
+    GLC_3DRep flatRep;
+    QList<GLC_StructOccurence*> occurences = world.listOfOccurence();
+    foreach (GLC_StructOccurence* pOcc, occurences)
+    {
+        if (!pOcc->hasRepresentation())
+            continue;
+        GLC_3DRep* pRep = dynamic_cast<GLC_3DRep*>(pOcc->structReference()->representationHandle());
+        if (NULL == pRep)
+            continue;
+        for (int i = 0; i < pRep->numberOfBody(); ++i)
+        {
+            // Only meshes can have the occurence matrix applied to them,
+            // anything else would end up misplaced so skip caching
+            GLC_Mesh* pMesh = dynamic_cast<GLC_Mesh*>(pRep->geomAt(i)->clone());
+            if (NULL == pMesh)
+                return;
+            pMesh->transformVertice(pOcc->absoluteMatrix());
+            flatRep.addGeom(pMesh);
+        }
+    }
+    if (flatRep.isEmpty())
+        return;
+
+    // Write next to the final name and rename, so another gadget never reads half a file
+    const QString tmpFileName = cacheFileName + ".part";
+    GLC_BSRep bsRep(tmpFileName);
+    if (bsRep.save(flatRep))
+    {
+        QFile::remove(cacheFileName);
+        QFile::rename(tmpFileName, cacheFileName);
+    }
+    else
+    {
+        QFile::remove(tmpFileName);
+    }
+}
+
+void ModelViewGadgetWidget::sceneLoaded()
+{
+    ModelLoadResult result = m_LoadWatcher.result();
+    modelLoading = false;
+    if (result.ok)
+    {
+        m_World = result.world;
+        m_ModelBoundingBox= m_World.boundingBox();
+        m_GlView.reframe(m_ModelBoundingBox); // center 3D model in the scene
+        m_GlView.setDistMinAndMax(m_World.boundingBox());
+        loadError = false;
+        if (!mvInitGLSuccess)
+            initializeGL();
+        else
+            m_MotionTimer.start(100);
+    } else {
         loadError = true;
     }
+    updateGL();
 }
 
 void ModelViewGadgetWidget::wheelEvent(QWheelEvent * e)
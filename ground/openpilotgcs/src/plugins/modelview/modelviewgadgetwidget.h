@@ -30,6 +30,7 @@
 
 #include <QtOpenGL/QGLWidget>
 #include <QTimer>
+#include <QtCore/QFutureWatcher>
 
 #include "glc_factory.h"
 #include "viewport/glc_viewport.h"
@@ -41,7 +42,13 @@
 #include "uavobjectmanager.h"
 #include "attitudeactual.h"
 
-
+//! Result of loading an aircraft model on the worker thread
+struct ModelLoadResult
+{
+    ModelLoadResult() : ok(false) {}
+    GLC_World world;
+    bool ok;
+};
 
 class ModelViewGadgetWidget : public QGLWidget
 {
@@ -77,6 +84,9 @@ private:
    void resizeGL(int width, int height);
    // Create GLC_Object to display
    void CreateScene();
+   // Load a model (or its cached binary representation), runs on a worker thread
+   static ModelLoadResult loadWorld(const QString &fileName, const QString &cacheDir);
+   static void saveWorldCache(const GLC_World &world, const QString &cacheFileName);
 
    //Mouse events
    void mousePressEvent(QMouseEvent * e);
@@ -90,6 +100,7 @@ private:
 //////////////////////////////////////////////////////////////////////
 private slots:
     void updateAttitude();
+    void sceneLoaded();
 
 private:
     GLC_Factory* m_pFactory;
@@ -106,8 +117,12 @@ private:
     QString bgFilename;
     bool vboEnable;
     bool loadError;
+    bool modelLoading;
     bool mvInitGLSuccess;
 
+    //! Watches the background model load started by CreateScene()
+    QFutureWatcher<ModelLoadResult> m_LoadWatcher;
+
     AttitudeActual* attActual;
 };
 
@@ -33,6 +33,8 @@
 #include <QtGui/QVBoxLayout>
 #include <QtGui/QClipboard>
 #include <QtGui/QMenu>
+#include <QtGui/QFileDialog>
+#include <QtGui/QMessageBox>
 #include <QStringList>
 #include <QDir>
 #include <QFile>
@@ -428,6 +430,11 @@ void OPMapGadgetWidget::contextMenuEvent(QContextMenuEvent *event)
 
     menu.addAction(reloadAct);
 
+    QMenu tilePackSubMenu(tr("Tile pack"), this);
+    tilePackSubMenu.addAction(importTilePackAct);
+    tilePackSubMenu.addAction(exportTilePackAct);
+    menu.addMenu(&tilePackSubMenu);
+
     menu.addSeparator();
 
 	QMenu maxUpdateRateSubMenu(tr("&Max Update Rate ") + "(" + QString::number(m_maxUpdateRate) + " ms)", this);
@@ -1410,6 +1417,14 @@ void OPMapGadgetWidget::createActions()
     reloadAct->setStatusTip(tr("Reload the map tiles"));
     connect(reloadAct, SIGNAL(triggered()), this, SLOT(onReloadAct_triggered()));
 
+    importTilePackAct = new QAction(tr("&Import..."), this);
+    importTilePackAct->setStatusTip(tr("Add the tiles of an MBTiles tile pack to the map cache"));
+    connect(importTilePackAct, SIGNAL(triggered()), this, SLOT(onImportTilePackAct_triggered()));
+
+    exportTilePackAct = new QAction(tr("&Export..."), this);
+    exportTilePackAct->setStatusTip(tr("Save the cached tiles of the current map type to an MBTiles tile pack"));
+    connect(exportTilePackAct, SIGNAL(triggered()), this, SLOT(onExportTilePackAct_triggered()));
+
     copyMouseLatLonToClipAct = new QAction(tr("Mouse latitude and longitude"), this);
     copyMouseLatLonToClipAct->setStatusTip(tr("Copy the mouse latitude and longitude to the clipboard"));
     connect(copyMouseLatLonToClipAct, SIGNAL(triggered()), this, SLOT(onCopyMouseLatLonToClipAct_triggered()));
@@ -1682,6 +1697,38 @@ void OPMapGadgetWidget::onReloadAct_triggered()
     m_map->ReloadMap();
 }
 
+void OPMapGadgetWidget::onImportTilePackAct_triggered()
+{
+	if (!m_widget || !m_map)
+		return;
+
+    QString pack = QFileDialog::getOpenFileName(this, tr("Import tile pack"), QString(), tr("MBTiles (*.mbtiles);;All files (*)"));
+    if (pack.isEmpty())
+        return;
+
+    // the tiles are stored as the current map type
+    if (!m_map->configuration->ImportMBTiles(pack, m_map->GetMapType()))
+    {
+        QMessageBox::warning(this, tr("Import tile pack"), tr("Could not import %1").arg(pack));
+        return;
+    }
+
+    m_map->ReloadMap();
+}
+
+void OPMapGadgetWidget::onExportTilePackAct_triggered()
+{
+	if (!m_widget || !m_map)
+		return;
+
+    QString pack = QFileDialog::getSaveFileName(this, tr("Export tile pack"), QString(), tr("MBTiles (*.mbtiles);;All files (*)"));
+    if (pack.isEmpty())
+        return;
+
+    if (!m_map->configuration->ExportMBTiles(pack, m_map->GetMapType()))
+        QMessageBox::warning(this, tr("Export tile pack"), tr("Could not export %1").arg(pack));
+}
+
 void OPMapGadgetWidget::onCopyMouseLatLonToClipAct_triggered()
 {
     QClipboard *clipboard = QApplication::clipboard();
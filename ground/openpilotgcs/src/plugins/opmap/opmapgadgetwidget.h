@@ -187,6 +187,8 @@ private slots:
     * @brief mouse right click context menu signals
     */
     void onReloadAct_triggered();
+    void onImportTilePackAct_triggered();
+    void onExportTilePackAct_triggered();
     void onCopyMouseLatLonToClipAct_triggered();
     void onCopyMouseLatToClipAct_triggered();
     void onCopyMouseLonToClipAct_triggered();
@@ -282,6 +284,8 @@ private:
     QAction *closeAct1;
     QAction *closeAct2;
     QAction *reloadAct;
+    QAction *importTilePackAct;
+    QAction *exportTilePackAct;
 	QAction *copyMouseLatLonToClipAct;
     QAction *copyMouseLatToClipAct;
     QAction *copyMouseLonToClipAct;
@@ -47,6 +47,9 @@ SystemHealthGadgetWidget::SystemHealthGadgetWidget(QWidget *parent) : QGraphicsV
     background = new QGraphicsSvgItem();
     foreground = new QGraphicsSvgItem();
     nolink = new QGraphicsSvgItem();
+    timing = new QGraphicsSimpleTextItem();
+    timing->setBrush(Qt::white);
+    timing->setZValue(98);
 
     paint();
 
@@ -57,6 +60,13 @@ SystemHealthGadgetWidget::SystemHealthGadgetWidget(QWidget *parent) : QGraphicsV
     SystemAlarms* obj = dynamic_cast<SystemAlarms*>(objManager->getObject(QString("SystemAlarms")));
     connect(obj, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(updateAlarms(UAVObject*)));
 
+    UAVObject *loopTiming = objManager->getObject(QString("LoopTiming"));
+    if (loopTiming)
+        connect(loopTiming, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(updateLoopTiming(UAVObject*)));
+    UAVObject *eventQueueStats = objManager->getObject(QString("EventQueueStats"));
+    if (eventQueueStats)
+        connect(eventQueueStats, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(updateEventQueues(UAVObject*)));
+
     // Listen to autopilot connection events
     TelemetryManager* telMngr = pm->getObject<TelemetryManager>();
     connect(telMngr, SIGNAL(connected()), this, SLOT(onAutopilotConnect()));
@@ -70,6 +80,7 @@ SystemHealthGadgetWidget::SystemHealthGadgetWidget(QWidget *parent) : QGraphicsV
 void SystemHealthGadgetWidget::onAutopilotConnect()
 {
     nolink->setVisible(false);
+    timing->setVisible(true);
 }
 
 /**
@@ -78,6 +89,68 @@ void SystemHealthGadgetWidget::onAutopilotConnect()
 void SystemHealthGadgetWidget::onAutopilotDisconnect()
 {
     nolink->setVisible(true);
+    timing->setVisible(false);
+}
+
+/**
+  * Show the loop period, jitter and worst execution time of the
+  * time critical loops, skipping the ones not running on this board
+  */
+void SystemHealthGadgetWidget::updateLoopTiming(UAVObject *loopTiming)
+{
+    UAVObjectField *period = loopTiming->getField("PeriodMean");
+    UAVObjectField *jitter = loopTiming->getField("Jitter");
+    UAVObjectField *execution = loopTiming->getField("ExecutionMax");
+    if (!period || !jitter || !execution)
+        return;
+
+    QStringList lines;
+    for (uint i = 0; i < period->getNumElements(); ++i) {
+        if (period->getValue(i).toUInt() == 0)
+            continue;
+        lines << QString("%1: %2us jitter %3us exec %4us")
+                 .arg(period->getElementNames()[i])
+                 .arg(period->getValue(i).toUInt())
+                 .arg(jitter->getValue(i).toUInt())
+                 .arg(execution->getValue(i).toUInt());
+    }
+    loopText = lines.join("\n");
+    timing->setText(loopText + "\n" + queueText);
+}
+
+/**
+  * Show the worst wait of each object event queue, and which object
+  * lost events when a queue overflowed
+  */
+void SystemHealthGadgetWidget::updateEventQueues(UAVObject *eventQueueStats)
+{
+    UAVObjectField *dropped = eventQueueStats->getField("Dropped");
+    UAVObjectField *worst = eventQueueStats->getField("WorstObject");
+    UAVObjectField *latency = eventQueueStats->getField("LatencyMax");
+    UAVObjectField *highWater = eventQueueStats->getField("HighWater");
+    if (!dropped || !worst || !latency || !highWater)
+        return;
+
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    QStringList lines;
+    for (uint i = 0; i < dropped->getNumElements(); ++i) {
+        if (highWater->getValue(i).toUInt() == 0 && dropped->getValue(i).toUInt() == 0)
+            continue;
+        QString line = QString("%1 queue: %2 deep, wait %3us")
+                       .arg(dropped->getElementNames()[i])
+                       .arg(highWater->getValue(i).toUInt())
+                       .arg(latency->getValue(i).toUInt());
+        if (dropped->getValue(i).toUInt() > 0) {
+            UAVObject *obj = objManager->getObject(worst->getValue(i).toUInt());
+            line += QString(", %1 dropped (%2)")
+                    .arg(dropped->getValue(i).toUInt())
+                    .arg(obj ? obj->getName() : QString::number(worst->getValue(i).toUInt(), 16));
+        }
+        lines << line;
+    }
+    queueText = lines.join("\n");
+    timing->setText(loopText + "\n" + queueText);
 }
 
 void SystemHealthGadgetWidget::updateAlarms(UAVObject* systemAlarm)
@@ -148,6 +221,13 @@ void SystemHealthGadgetWidget::setSystemFile(QString dfn)
                nolink->setZValue(100);
            }
 
+           // Timing text sits at the bottom left, sized to the dial
+           QRectF bounds = background->boundingRect();
+           QFont font = timing->font();
+           font.setPixelSize(qMax(1, (int)(bounds.height() / 40)));
+           timing->setFont(font);
+           timing->setPos(bounds.left() + bounds.width() / 50, bounds.bottom() - bounds.height() / 4);
+
          QGraphicsScene *l_scene = scene();
          l_scene->setSceneRect(background->boundingRect());
          fitInView(background, Qt::KeepAspectRatio );
@@ -174,6 +254,7 @@ void SystemHealthGadgetWidget::paint()
     l_scene->addItem(background);
     l_scene->addItem(foreground);
     l_scene->addItem(nolink);
+    l_scene->addItem(timing);
     update();
 }
 
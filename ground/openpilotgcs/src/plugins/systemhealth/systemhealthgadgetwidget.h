@@ -34,6 +34,7 @@
 #include <QGraphicsView>
 #include <QtSvg/QSvgRenderer>
 #include <QtSvg/QGraphicsSvgItem>
+#include <QGraphicsSimpleTextItem>
 
 #include <QFile>
 #include <QTimer>
@@ -55,6 +56,8 @@ protected:
 
 private slots:
    void updateAlarms(UAVObject *systemAlarm); // Called by the systemalarms UAVObject
+   void updateLoopTiming(UAVObject *loopTiming); // Called by the looptiming UAVObject
+   void updateEventQueues(UAVObject *eventQueueStats); // Called by the eventqueuestats UAVObject
    void onAutopilotConnect();
    void onAutopilotDisconnect();
 
@@ -63,6 +66,9 @@ private:
    QGraphicsSvgItem *background;
    QGraphicsSvgItem *foreground;
    QGraphicsSvgItem *nolink;
+   QGraphicsSimpleTextItem *timing;
+   QString loopText;
+   QString queueText;
 
                    // Simple flag to skip rendering if the
    bool fgenabled; // layer does not exist.
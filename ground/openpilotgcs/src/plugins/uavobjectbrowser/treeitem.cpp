@@ -29,31 +29,155 @@
 
 int TreeItem::m_highlightTimeMs = 500;
 
+HighlightManager::HighlightManager(int tickMs, QObject *parent) :
+        QObject(parent),
+        m_tickMs(tickMs),
+        m_highlightTimeMs(0),
+        m_lastTick(0),
+        m_count(0)
+{
+    m_clock.start();
+    m_timer.setInterval(m_tickMs);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(expireTick()));
+    setHighlightTime(500);
+}
+
+void HighlightManager::setHighlightTime(int time)
+{
+    if (time == m_highlightTimeMs && !m_wheel.isEmpty())
+        return;
+    m_highlightTimeMs = time;
+
+    // The wheel must span more than one highlight period so that an item
+    // never lands in the bucket that is currently being expired.
+    QList<TreeItem*> queued;
+    foreach (QSet<TreeItem*> bucket, m_wheel)
+        queued += bucket.toList();
+    m_wheel.clear();
+    m_wheel.resize(time / m_tickMs + 2);
+    m_count = 0;
+    foreach (TreeItem *item, queued) {
+        item->m_highlightSlot = -1;
+        add(item);
+    }
+}
+
+void HighlightManager::add(TreeItem *item)
+{
+    int now = currentTick();
+    if (m_count == 0) {
+        m_lastTick = now;
+        m_timer.start();
+    }
+    if (item->m_highlightSlot >= 0) {
+        m_wheel[item->m_highlightSlot].remove(item);
+        --m_count;
+    }
+    int expires = now + (m_highlightTimeMs + m_tickMs - 1) / m_tickMs;
+    item->m_highlightExpires = expires;
+    item->m_highlightSlot = slotOf(expires);
+    m_wheel[item->m_highlightSlot].insert(item);
+    ++m_count;
+}
+
+void HighlightManager::remove(TreeItem *item)
+{
+    if (item->m_highlightSlot < 0)
+        return;
+    m_wheel[item->m_highlightSlot].remove(item);
+    item->m_highlightSlot = -1;
+    if (--m_count == 0)
+        m_timer.stop();
+}
+
+void HighlightManager::expireTick()
+{
+    int now = currentTick();
+    QList<TreeItem*> expired;
+
+    if (now < m_lastTick) {
+        // QTime wraps after 24 hours, just expire everything queued
+        m_clock.restart();
+        now = 0;
+        for (int i = 0; i < m_wheel.size(); ++i) {
+            expired += m_wheel[i].toList();
+            m_wheel[i].clear();
+        }
+    } else {
+        int ticks = qMin(now - m_lastTick, m_wheel.size());
+        for (int t = now - ticks + 1; t <= now; ++t) {
+            QSet<TreeItem*> &bucket = m_wheel[slotOf(t)];
+            QSet<TreeItem*>::iterator it = bucket.begin();
+            while (it != bucket.end()) {
+                if ((*it)->m_highlightExpires <= now) {
+                    expired.append(*it);
+                    it = bucket.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+    m_lastTick = now;
+
+    m_count -= expired.count();
+    if (m_count == 0)
+        m_timer.stop();
+
+    // removeHighlight() may highlight the item again, so it must be
+    // called only after the item has been taken off the wheel
+    foreach (TreeItem *item, expired) {
+        item->m_highlightSlot = -1;
+        item->removeHighlight();
+    }
+}
+
 TreeItem::TreeItem(const QList<QVariant> &data, TreeItem *parent) :
         QObject(0),
         m_data(data),
         m_parent(parent),
         m_highlight(false),
-        m_changed(false)
+        m_changed(false),
+        m_highlightSlot(-1),
+        m_highlightExpires(0)
 {
-    connect(&m_timer, SIGNAL(timeout()), this, SLOT(removeHighlight()));
 }
 
 TreeItem::TreeItem(const QVariant &data, TreeItem *parent) :
         QObject(0),
         m_parent(parent),
         m_highlight(false),
-        m_changed(false)
+        m_changed(false),
+        m_highlightSlot(-1),
+        m_highlightExpires(0)
 {
     m_data << data << "" << "";
-    connect(&m_timer, SIGNAL(timeout()), this, SLOT(removeHighlight()));
 }
 
 TreeItem::~TreeItem()
 {
+    highlightManager()->remove(this);
     qDeleteAll(m_children);
 }
 
+HighlightManager *TreeItem::highlightManager()
+{
+    // Shared by all browser models; intentionally never deleted so that
+    // items outliving the application object can still unregister.
+    static HighlightManager *manager = 0;
+    if (!manager) {
+        manager = new HighlightManager();
+        manager->setHighlightTime(m_highlightTimeMs);
+    }
+    return manager;
+}
+
+void TreeItem::setHighlightTime(int time)
+{
+    m_highlightTimeMs = time;
+    highlightManager()->setHighlightTime(time);
+}
+
 void TreeItem::appendChild(TreeItem *child)
 {
     m_children.append(child);
@@ -111,13 +235,10 @@ void TreeItem::apply() {
 void TreeItem::setHighlight(bool highlight) {
     m_highlight = highlight;
     m_changed = false;
-    if (highlight) {
-        if (m_timer.isActive()) {
-            m_timer.stop();
-        }
-        m_timer.setSingleShot(true);
-        m_timer.start(m_highlightTimeMs);
-    }
+    if (highlight)
+        highlightManager()->add(this);
+    else
+        highlightManager()->remove(this);
     emit updateHighlight(this);
 }
 
@@ -34,7 +34,44 @@
 #include <QtCore/QList>
 #include <QtCore/QVariant>
 #include <QtCore/QTimer>
+#include <QtCore/QTime>
 #include <QtCore/QObject>
+#include <QtCore/QSet>
+#include <QtCore/QVector>
+
+class TreeItem;
+
+/*
+ * Expires highlights for all tree items from one shared timer.
+ * Items are hashed into a wheel of buckets by expiry tick so that
+ * (re)highlighting and expiring an item are O(1), no matter how many
+ * items the browser shows.
+ */
+class HighlightManager : public QObject
+{
+Q_OBJECT
+public:
+    HighlightManager(int tickMs = 50, QObject *parent = 0);
+
+    void setHighlightTime(int time);
+    void add(TreeItem *item);
+    void remove(TreeItem *item);
+
+private slots:
+    void expireTick();
+
+private:
+    int currentTick() const { return m_clock.elapsed() / m_tickMs; }
+    int slotOf(int tick) const { return tick % m_wheel.size(); }
+
+    QVector< QSet<TreeItem*> > m_wheel;
+    QTimer m_timer;
+    QTime m_clock;
+    int m_tickMs;
+    int m_highlightTimeMs;
+    int m_lastTick;
+    int m_count;
+};
 
 
 class TreeItem : public QObject
@@ -72,7 +109,7 @@ public:
 
     inline bool highlighted() { return m_highlight; }
     void setHighlight(bool highlight);
-    static void setHighlightTime(int time) { m_highlightTimeMs = time; }
+    static void setHighlightTime(int time);
 
     inline bool changed() { return m_changed; }
     inline void setChanged(bool changed) { m_changed = changed; }
@@ -80,10 +117,10 @@ public:
 signals:
     void updateHighlight(TreeItem*);
 
-private slots:
+private:
+    friend class HighlightManager;
     void removeHighlight();
 
-private:
     QList<TreeItem*> m_children;
     // m_data contains: [0] property name, [1] value, [2] unit
     QList<QVariant> m_data;
@@ -91,10 +128,13 @@ private:
     TreeItem *m_parent;
     bool m_highlight;
     bool m_changed;
-    QTimer m_timer;
+    // wheel bucket this item is queued in, -1 if not queued
+    int m_highlightSlot;
+    int m_highlightExpires;
 public:
     static const int dataColumn = 1;
 private:
+    static HighlightManager *highlightManager();
     static int m_highlightTimeMs;
 };
 
@@ -52,6 +52,10 @@ UAVObjectTreeModel::UAVObjectTreeModel(QObject *parent) :
 
     TreeItem::setHighlightTime(m_recentlyUpdatedTimeout);
     setupModelData(objManager);
+
+    m_refreshTimer.setSingleShot(true);
+    m_refreshTimer.setInterval(m_refreshIntervalMs);
+    connect(&m_refreshTimer, SIGNAL(timeout()), this, SLOT(flushUpdates()));
 }
 
 UAVObjectTreeModel::~UAVObjectTreeModel()
@@ -216,23 +220,6 @@ QModelIndex UAVObjectTreeModel::index(int row, int column, const QModelIndex &pa
         return QModelIndex();
 }
 
-QModelIndex UAVObjectTreeModel::index(TreeItem *item)
-{
-    if (item->parent() == 0)
-        return QModelIndex();
-
-    QModelIndex root = index(item->parent());
-
-    for (int i = 0; i < rowCount(root); ++i) {
-        QModelIndex childIndex = index(i, 0, root);
-        TreeItem *child = static_cast<TreeItem*>(childIndex.internalPointer());
-        if (child == item)
-            return childIndex;
-    }
-    Q_ASSERT(false);
-    return QModelIndex();
-}
-
 QModelIndex UAVObjectTreeModel::parent(const QModelIndex &index) const
 {
     if (!index.isValid())
@@ -350,13 +337,10 @@ QVariant UAVObjectTreeModel::headerData(int section, Qt::Orientation orientation
 void UAVObjectTreeModel::highlightUpdatedObject(UAVObject *obj)
 {
     Q_ASSERT(obj);
-    ObjectTreeItem *item = findObjectTreeItem(obj);
-    Q_ASSERT(item);
-    item->setHighlight(true);
-    item->update();
-    QModelIndex itemIndex = index(item);
-    Q_ASSERT(itemIndex != QModelIndex());
-    emit dataChanged(itemIndex, itemIndex);
+    // Only remember the object here, the tree is refreshed from it on the
+    // next flush no matter how many updates arrive in between
+    m_updatedObjects.insert(obj);
+    scheduleFlush();
 }
 
 ObjectTreeItem *UAVObjectTreeModel::findObjectTreeItem(UAVObject *object)
@@ -409,9 +393,57 @@ DataObjectTreeItem *UAVObjectTreeModel::findDataObjectTreeItem(UAVDataObject *ob
 
 void UAVObjectTreeModel::updateHighlight(TreeItem *item)
 {
-    QModelIndex itemIndex = index(item);
-    Q_ASSERT(itemIndex != QModelIndex());
-    emit dataChanged(itemIndex, itemIndex.sibling(itemIndex.row(), TreeItem::dataColumn));
+    m_dirtyItems.insert(item);
+    scheduleFlush();
+}
+
+void UAVObjectTreeModel::scheduleFlush()
+{
+    if (!m_refreshTimer.isActive())
+        m_refreshTimer.start();
 }
 
+void UAVObjectTreeModel::flushUpdates()
+{
+    QSet<UAVObject*> objects = m_updatedObjects;
+    m_updatedObjects.clear();
+    foreach (UAVObject *obj, objects) {
+        ObjectTreeItem *item = findObjectTreeItem(obj);
+        Q_ASSERT(item);
+        item->setHighlight(true);
+        item->update();
+    }
+
+    // setHighlight()/update() above refill m_dirtyItems through the
+    // updateHighlight signal, so only take the set once they are done
+    QSet<TreeItem*> items = m_dirtyItems;
+    m_dirtyItems.clear();
+
+    // Emit one dataChanged range per parent covering all dirty siblings
+    QMap<TreeItem*, QPair<int, int> > ranges;
+    foreach (TreeItem *item, items) {
+        TreeItem *parent = item->parent();
+        if (!parent)
+            continue;
+        int row = item->row();
+        QMap<TreeItem*, QPair<int, int> >::iterator it = ranges.find(parent);
+        if (it == ranges.end()) {
+            ranges.insert(parent, qMakePair(row, row));
+        } else {
+            it->first = qMin(it->first, row);
+            it->second = qMax(it->second, row);
+        }
+    }
+
+    QMap<TreeItem*, QPair<int, int> >::const_iterator it;
+    for (it = ranges.constBegin(); it != ranges.constEnd(); ++it) {
+        TreeItem *parent = it.key();
+        QModelIndex topLeft = createIndex(it->first, 0, parent->child(it->first));
+        QModelIndex bottomRight = createIndex(it->second, TreeItem::dataColumn, parent->child(it->second));
+        emit dataChanged(topLeft, bottomRight);
+    }
 
+    // Nothing new arrived while flushing, don't wake up again for nothing
+    if (m_updatedObjects.isEmpty() && m_dirtyItems.isEmpty())
+        m_refreshTimer.stop();
+}
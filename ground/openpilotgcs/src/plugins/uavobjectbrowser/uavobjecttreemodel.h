@@ -31,6 +31,8 @@
 #include "treeitem.h"
 #include <QAbstractItemModel>
 #include <QtCore/QMap>
+#include <QtCore/QSet>
+#include <QtCore/QTimer>
 #include <QtGui/QColor>
 
 class TopTreeItem;
@@ -42,7 +44,6 @@ class UAVMetaObject;
 class UAVObjectField;
 class UAVObjectManager;
 class QSignalMapper;
-class QTimer;
 
 class UAVObjectTreeModel : public QAbstractItemModel
 {
@@ -77,9 +78,9 @@ public slots:
 private slots:
     void highlightUpdatedObject(UAVObject *obj);
     void updateHighlight(TreeItem*);
+    void flushUpdates();
 
 private:
-    QModelIndex index(TreeItem *item);
     void addDataObject(UAVDataObject *obj);
     void addMetaObject(UAVMetaObject *obj, TreeItem *parent);
     void addArrayField(UAVObjectField *field, TreeItem *parent);
@@ -90,6 +91,7 @@ private:
     void setupModelData(UAVObjectManager *objManager);
     ObjectTreeItem *findObjectTreeItem(UAVObject *obj);
     DataObjectTreeItem *findDataObjectTreeItem(UAVDataObject *obj);
+    void scheduleFlush();
 
     TreeItem *m_rootItem;
     TopTreeItem *m_settingsTree;
@@ -97,6 +99,13 @@ private:
     int m_recentlyUpdatedTimeout;
     QColor m_recentlyUpdatedColor;
     QColor m_manuallyChangedColor;
+
+    // Object updates and highlight changes are collected here and
+    // reported to the views at most once per refresh interval
+    static const int m_refreshIntervalMs = 33; // ~30Hz
+    QTimer m_refreshTimer;
+    QSet<UAVObject*> m_updatedObjects;
+    QSet<TreeItem*> m_dirtyItems;
 };
 
 #endif // UAVOBJECTTREEMODEL_H
@@ -41,6 +41,9 @@ UAVObject::UAVObject(quint32 objID, bool isSingleInst, const QString& name)
     this->instID = 0;
     this->isSingleInst = isSingleInst;
     this->name = name;
+    this->numBytes = 0;
+    this->data = NULL;
+    this->fieldsCreated = false;
     this->mutex = new QMutex(QMutex::Recursive);
 }
 
@@ -53,6 +56,19 @@ void UAVObject::initialize(quint32 instID)
     this->instID = instID;
 }
 
+/**
+ * Initialize the object data without creating the fields, these will be
+ * created by createFields() the first time they are needed
+ * @param data Pointer to that actual object data
+ * @param numBytes Number of bytes in the object (total, including all fields)
+ */
+void UAVObject::initializeData(quint8* data, quint32 numBytes)
+{
+    QMutexLocker locker(mutex);
+    this->numBytes = numBytes;
+    this->data = data;
+}
+
 /**
  * Initialize objects' data fields
  * @param fields List of fields held by the object
@@ -65,6 +81,7 @@ void UAVObject::initializeFields(QList<UAVObjectField*>& fields, quint8* data, q
     this->numBytes = numBytes;
     this->data = data;
     this->fields = fields;
+    this->fieldsCreated = true;
     // Initialize fields
     quint32 offset = 0;
     for (int n = 0; n < fields.length(); ++n)
@@ -75,6 +92,49 @@ void UAVObject::initializeFields(QList<UAVObjectField*>& fields, quint8* data, q
     }
 }
 
+/**
+ * Create the object fields, objects that do not set their fields up
+ * front with initializeFields() must override this
+ */
+void UAVObject::createFields()
+{
+}
+
+/**
+ * Make sure the fields have been created
+ */
+void UAVObject::ensureFields()
+{
+    QMutexLocker locker(mutex);
+    if (!fieldsCreated)
+    {
+        fieldsCreated = true;
+        createFields();
+    }
+}
+
+/**
+ * Byte swap each element of the packed data according to the layout,
+ * used to convert to and from the wire format on big endian hosts
+ */
+void UAVObject::swapLayout(const FieldLayout* layout, quint32 numFields,
+                           const quint8* dataIn, quint8* dataOut, quint32 numBytes)
+{
+    memcpy(dataOut, dataIn, numBytes);
+    for (quint32 n = 0; n < numFields; ++n)
+    {
+        quint32 size = layout[n].numBytesPerElement;
+        if (size == 1)
+            continue;
+        for (quint32 index = 0; index < layout[n].numElements; ++index)
+        {
+            quint32 offset = layout[n].offset + size*index;
+            for (quint32 b = 0; b < size; ++b)
+                dataOut[offset + b] = dataIn[offset + size - 1 - b];
+        }
+    }
+}
+
 /**
  * Called from the fields each time they are updated
  */
@@ -197,6 +257,7 @@ QMutex* UAVObject::getMutex()
 qint32 UAVObject::getNumFields()
 {
     QMutexLocker locker(mutex);
+    ensureFields();
     return fields.count();
 }
 
@@ -206,6 +267,7 @@ qint32 UAVObject::getNumFields()
 QList<UAVObjectField*> UAVObject::getFields()
 {
     QMutexLocker locker(mutex);
+    ensureFields();
     return fields;
 }
 
@@ -216,6 +278,7 @@ QList<UAVObjectField*> UAVObject::getFields()
 UAVObjectField* UAVObject::getField(const QString& name)
 {
     QMutexLocker locker(mutex);
+    ensureFields();
     // Look for field
     for (int n = 0; n < fields.length(); ++n)
     {
@@ -236,6 +299,7 @@ UAVObjectField* UAVObject::getField(const QString& name)
 qint32 UAVObject::pack(quint8* dataOut)
 {
     QMutexLocker locker(mutex);
+    ensureFields();
     qint32 offset = 0;
     for (int n = 0; n < fields.length(); ++n)
     {
@@ -252,6 +316,7 @@ qint32 UAVObject::pack(quint8* dataOut)
 qint32 UAVObject::unpack(const quint8* dataIn)
 {
     QMutexLocker locker(mutex);
+    ensureFields();
     qint32 offset = 0;
     for (int n = 0; n < fields.length(); ++n)
     {
@@ -441,6 +506,7 @@ QString UAVObject::toStringBrief()
 QString UAVObject::toStringData()
 {
     QString sout;
+    ensureFields();
     sout.append("Data:\n");
     for (int n = 0; n < fields.length(); ++n)
     {
@@ -36,6 +36,8 @@
 #include <QString>
 #include <QList>
 #include <QFile>
+#include <QtEndian>
+#include <string.h>
 #include "uavobjectfield.h"
 
 class UAVObjectField;
@@ -81,6 +83,16 @@ public:
             qint32 loggingUpdatePeriod; /** Update period used by the logging module (only if logging mode is PERIODIC) */
     } __attribute__((packed)) Metadata;
 
+    /**
+     * Position of a field in the packed data structure, generated objects
+     * describe their layout with a static table of these
+     */
+    typedef struct {
+            quint32 offset; /** Byte offset of the field in the data structure */
+            quint32 numBytesPerElement; /** Size of one element */
+            quint32 numElements; /** Number of elements in the field */
+    } FieldLayout;
+
 
     UAVObject(quint32 objID, bool isSingleInst, const QString& name);
     void initialize(quint32 instID);
@@ -90,8 +102,8 @@ public:
     QString getName();
     QString getDescription();
     quint32 getNumBytes(); 
-    qint32 pack(quint8* dataOut);
-    qint32 unpack(const quint8* dataIn);
+    virtual qint32 pack(quint8* dataOut);
+    virtual qint32 unpack(const quint8* dataIn);
     bool save();
     bool save(QFile& file);
     bool load();
@@ -135,8 +147,34 @@ protected:
     quint8* data;
     QList<UAVObjectField*> fields;
 
+    void initializeData(quint8* data, quint32 numBytes);
     void initializeFields(QList<UAVObjectField*>& fields, quint8* data, quint32 numBytes);
+    virtual void createFields();
     void setDescription(const QString& description);
+
+    /**
+     * Copy packed object data to or from its little endian wire format.
+     * On little endian hosts this is a plain copy, otherwise each element
+     * is byte swapped according to the field layout.
+     */
+    static inline void copyLittleEndian(const FieldLayout* layout, quint32 numFields,
+                                        const quint8* dataIn, quint8* dataOut, quint32 numBytes)
+    {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        Q_UNUSED(layout);
+        Q_UNUSED(numFields);
+        memcpy(dataOut, dataIn, numBytes);
+#else
+        swapLayout(layout, numFields, dataIn, dataOut, numBytes);
+#endif
+    }
+    static void swapLayout(const FieldLayout* layout, quint32 numFields,
+                           const quint8* dataIn, quint8* dataOut, quint32 numBytes);
+
+private:
+    bool fieldsCreated;
+
+    void ensureFields();
 };
 
 #endif // UAVOBJECT_H
@@ -36,22 +36,61 @@
 const QString $(NAME)::NAME = QString("$(NAME)");
 const QString $(NAME)::DESCRIPTION = QString("$(DESCRIPTION)");
 
+/**
+ * Layout of the fields in the packed data structure
+ */
+const UAVObject::FieldLayout $(NAME)::LAYOUT[] = {
+$(FIELDSLAYOUT)
+};
+
 /**
  * Constructor
  */
 $(NAME)::$(NAME)(): UAVDataObject(OBJID, ISSINGLEINST, ISSETTINGS, NAME)
 {
-    // Create fields
-    QList<UAVObjectField*> fields;
-$(FIELDSINIT)
-    // Initialize object
-    initializeFields(fields, (quint8*)&data, NUMBYTES);
+    // Initialize object, the fields are only created when first needed
+    initializeData((quint8*)&data, NUMBYTES);
     // Set the default field values
     setDefaultFieldValues();
     // Set the object description
     setDescription(DESCRIPTION);
 }
 
+/**
+ * Create the object fields, these are only needed to access the
+ * object by field name so they are not built until requested
+ */
+void $(NAME)::createFields()
+{
+    QList<UAVObjectField*> fields;
+$(FIELDSINIT)
+    initializeFields(fields, (quint8*)&data, NUMBYTES);
+}
+
+/**
+ * Pack the object data into a byte array
+ * @returns The number of bytes copied
+ */
+qint32 $(NAME)::pack(quint8* dataOut)
+{
+    QMutexLocker locker(mutex);
+    copyLittleEndian(LAYOUT, NUMFIELDS, (const quint8*)&data, dataOut, NUMBYTES);
+    return NUMBYTES;
+}
+
+/**
+ * Unpack the object data from a byte array
+ * @returns The number of bytes copied
+ */
+qint32 $(NAME)::unpack(const quint8* dataIn)
+{
+    QMutexLocker locker(mutex);
+    copyLittleEndian(LAYOUT, NUMFIELDS, dataIn, (quint8*)&data, NUMBYTES);
+    emit objectUnpacked(this); // trigger object updated event
+    emit objectUpdated(this);
+    return NUMBYTES;
+}
+
 /**
  * Get the default metadata for this object
  */
@@ -56,6 +56,7 @@ $(DATAFIELDINFO)
     static const bool ISSINGLEINST = $(ISSINGLEINST);
     static const bool ISSETTINGS = $(ISSETTINGS);
     static const quint32 NUMBYTES = sizeof(DataFields);
+    static const quint32 NUMFIELDS = $(NUMFIELDS);
 
     // Functions
     $(NAME)();
@@ -64,11 +65,17 @@ $(DATAFIELDINFO)
     void setData(const DataFields& data);
     Metadata getDefaultMetadata();
     UAVDataObject* clone(quint32 instID);
+    qint32 pack(quint8* dataOut);
+    qint32 unpack(const quint8* dataIn);
 
     static $(NAME)* GetInstance(UAVObjectManager* objMngr, quint32 instID = 0);
 	
+protected:
+    void createFields();
+
 private:
     DataFields data;
+    static const FieldLayout LAYOUT[];
 
     void setDefaultFieldValues();
 
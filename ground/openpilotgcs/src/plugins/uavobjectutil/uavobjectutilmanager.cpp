@@ -81,17 +81,38 @@ UAVObjectManager* UAVObjectUtilManager::getObjectManager() {
   */
 void UAVObjectUtilManager::saveObjectToSD(UAVObject *obj)
 {
-    // Add to queue
-    queue.enqueue(obj);
-    qDebug() << "Enqueue object: " << obj->getName();
+    saveObjectsToSD(QList<UAVObject *>() << obj);
+}
 
+/*
+  Add a set of objects to save in the queue. The objects must already have
+  been sent to the board, they are then persisted with one "ObjectList" save
+  request listing them instead of one request per object.
+  */
+void UAVObjectUtilManager::saveObjectsToSD(const QList<UAVObject *> &objs)
+{
+    if (objs.isEmpty())
+        return;
 
-    // If queue length is one, then start sending (call sendNextObject)
+    qDebug() << "Enqueue" << objs.length() << "object(s) starting with" << objs.first()->getName();
+
+    bool idle = queue.isEmpty();
+    foreach (UAVObject *obj, objs) {
+        // The head of the queue is being saved right now, a batch queued
+        // behind it has not been requested yet and can still take objects
+        bool open = queue.length() > (idle ? 0 : 1);
+        if (open && queue.last().contains(obj))
+            continue;
+        if (open && queue.last().length() < (int)ObjectPersistence::LISTOBJECTID_NUMELEM)
+            queue.last().append(obj);
+        else
+            queue.enqueue(QList<UAVObject *>() << obj);
+    }
+
+    // If the queue was empty, then start sending (call sendNextObject)
     // Otherwise, do nothing, it's sending anyway
-    if (queue.length()==1)
+    if (idle)
         saveNextObject();
-
-
 }
 
 void UAVObjectUtilManager::saveNextObject()
@@ -103,24 +124,34 @@ void UAVObjectUtilManager::saveNextObject()
 
     Q_ASSERT(saveState == IDLE);
 
-    // Get next object from the queue
-    UAVObject* obj = queue.head();
-    qDebug() << "Request board to save object " << obj->getName();
+    // Get next batch of objects from the queue
+    QList<UAVObject *> objs = queue.head();
 
     ObjectPersistence* objper = dynamic_cast<ObjectPersistence*>( getObjectManager()->getObject(ObjectPersistence::NAME) );
     connect(objper, SIGNAL(transactionCompleted(UAVObject*,bool)), this, SLOT(objectPersistenceTransactionCompleted(UAVObject*,bool)));
     connect(objper, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(objectPersistenceUpdated(UAVObject *)));
     saveState = AWAITING_ACK;
-    if (obj != NULL)
-    {
-        ObjectPersistence::DataFields data;
-        data.Operation = ObjectPersistence::OPERATION_SAVE;
+
+    ObjectPersistence::DataFields data;
+    memset(&data, 0, sizeof(data));
+    data.Operation = ObjectPersistence::OPERATION_SAVE;
+    if (objs.length() == 1) {
+        qDebug() << "Request board to save object " << objs.first()->getName();
         data.Selection = ObjectPersistence::SELECTION_SINGLEOBJECT;
-        data.ObjectID = obj->getObjID();
-        data.InstanceID = obj->getInstID();
-        objper->setData(data);
-        objper->updated();
+        data.ObjectID = objs.first()->getObjID();
+        data.InstanceID = objs.first()->getInstID();
+    } else {
+        // Only the listed instances are persisted, in one transaction
+        qDebug() << "Request board to save" << objs.length() << "objects";
+        data.Selection = ObjectPersistence::SELECTION_OBJECTLIST;
+        data.ListLength = objs.length();
+        for (int n = 0; n < objs.length(); ++n) {
+            data.ListObjectID[n] = objs[n]->getObjID();
+            data.ListInstanceID[n] = objs[n]->getInstID();
+        }
     }
+    objper->setData(data);
+    objper->updated();
     // Now: we are going to get two "objectUpdated" messages (one coming from GCS, one coming from Flight, which
     // will confirm the object was properly received by both sides) and then one "transactionCompleted" indicating
     // that the Flight side did not only receive the object but it did receive it without error. Last we will get
@@ -149,16 +180,12 @@ void UAVObjectUtilManager::objectPersistenceTransactionCompleted(UAVObject* obj,
         // the queue:
         saveState = AWAITING_COMPLETED;
         disconnect(obj, SIGNAL(transactionCompleted(UAVObject*,bool)), this, SLOT(objectPersistenceTransactionCompleted(UAVObject*,bool)));
-        failureTimer.start(1000); // Create a timeout
+        // Writing a batch to flash takes longer than a single object
+        failureTimer.start(1000 + 100 * (queue.head().length() - 1)); // Create a timeout
     } else {
         // Can be caused by timeout errors on sending.  Forget it and send next.
         qDebug() << "objectPersistenceTranscationCompleted (error)";
-        UAVObject *obj = getObjectManager()->getObject(ObjectPersistence::NAME);
-        obj->disconnect(this);
-        queue.dequeue(); // We can now remove the object, it failed anyway.
-        saveState = IDLE;
-        emit saveCompleted(obj->getField("ObjectID")->getValue().toInt(), false);
-        saveNextObject();
+        finishSave(false);
     }
 }
 
@@ -173,15 +200,25 @@ void UAVObjectUtilManager::objectPersistenceOperationFailed()
         //TODO: some warning that this operation failed somehow
         // We have to disconnect the object persistence 'updated' signal
         // and ask to save the next object:
-        UAVObject *obj = getObjectManager()->getObject(ObjectPersistence::NAME);
-        obj->disconnect(this);
-        queue.dequeue(); // We can now remove the object, it failed anyway.
-        saveState = IDLE;
-        emit saveCompleted(obj->getField("ObjectID")->getValue().toInt(), false);
-        saveNextObject();
+        finishSave(false);
     }
 }
 
+/**
+  * @brief Report the result for every object of the batch being saved,
+  * drop it from the queue and start on the next one.
+  */
+void UAVObjectUtilManager::finishSave(bool success)
+{
+    UAVObject *objper = getObjectManager()->getObject(ObjectPersistence::NAME);
+    objper->disconnect(this);
+    QList<UAVObject *> objs = queue.dequeue(); // We can now remove the batch, it's done.
+    saveState = IDLE;
+    foreach (UAVObject *obj, objs)
+        emit saveCompleted(obj->getObjID(), success);
+    saveNextObject();
+}
+
 
 
 /**
@@ -198,15 +235,16 @@ void UAVObjectUtilManager::objectPersistenceUpdated(UAVObject * obj)
         // Check flight is saying it completed.  This is the only thing flight should do to trigger an update.
         Q_ASSERT( obj->getField("Operation")->getValue().toString().compare(QString("Completed")) == 0 );
 
-        // Check right object saved
-        UAVObject* savingObj = queue.head();
-        Q_ASSERT( obj->getField("ObjectID")->getValue() == savingObj->getObjID() );
+        // Check right object(s) saved
+        if (queue.head().length() == 1) {
+            UAVObject* savingObj = queue.head().first();
+            Q_ASSERT( obj->getField("ObjectID")->getValue() == savingObj->getObjID() );
+            Q_UNUSED(savingObj);
+        } else {
+            Q_ASSERT( obj->getField("ListLength")->getValue().toInt() == queue.head().length() );
+        }
 
-        obj->disconnect(this);
-        queue.dequeue(); // We can now remove the object, it's done.
-        saveState = IDLE;
-        emit saveCompleted(obj->getField("ObjectID")->getValue().toInt(), true);
-        saveNextObject();
+        finishSave(true);
     }
 }
 
@@ -67,15 +67,18 @@ public:
         QByteArray getBoardDescription();
         UAVObjectManager* getObjectManager();
         void saveObjectToSD(UAVObject *obj);
+        void saveObjectsToSD(const QList<UAVObject *> &objs);
 
 signals:
         void saveCompleted(int objectID, bool status);
 
 private:
 	QMutex *mutex;
-	QQueue<UAVObject *> queue;
+	// Each entry is saved with one ObjectPersistence request
+	QQueue< QList<UAVObject *> > queue;
         enum {IDLE, AWAITING_ACK, AWAITING_COMPLETED} saveState;
 	void saveNextObject();
+	void finishSave(bool success);
         QTimer failureTimer;
 
 private slots:
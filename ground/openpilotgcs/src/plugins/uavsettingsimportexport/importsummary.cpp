@@ -97,15 +97,19 @@ void ImportSummaryDialog::doTheSaving()
     UAVObjectUtilManager *utilManager = pm->getObject<UAVObjectUtilManager>();
     connect(utilManager, SIGNAL(saveCompleted(int,bool)), this, SLOT(updateSaveCompletion()));
 
+    // All imported objects were already sent to the board, save them
+    // together so that the board persists them in one transaction
+    QList<UAVObject *> objs;
     for(int i=0; i < ui->importSummaryList->rowCount(); i++) {
         QString uavObjectName = ui->importSummaryList->item(i,1)->text();
         QCheckBox *box = dynamic_cast<QCheckBox*>(ui->importSummaryList->cellWidget(i,0));
         if (box->isChecked()) {
             UAVObject* obj = objManager->getObject(uavObjectName);
-            utilManager->saveObjectToSD(obj);
-            this->repaint();
+            objs.append(obj);
         }
     }
+    utilManager->saveObjectsToSD(objs);
+    this->repaint();
 }
 
 
@@ -26,7 +26,7 @@
  */
 #include "port.h"
 #include "delay.h"
-port::port(PortSettings settings,QString name):mstatus(port::closed)
+port::port(PortSettings settings,QString name):txWindow(1),mstatus(port::closed)
 {
     timer.start();
     sport = new QextSerialPort(name,settings, QextSerialPort::Polling);
@@ -39,8 +39,18 @@ port::port(PortSettings settings,QString name):mstatus(port::closed)
         mstatus=port::error;
 }
 
+/**
+  For ports that are not backed by a serial device, they provide their own
+  read, write and time functions
+  */
+port::port():txWindow(1),mstatus(port::open),sport(0)
+{
+    timer.start();
+}
+
 port::~port() {
-    sport->close();
+    if(sport)
+        sport->close();
 }
 
 port::portstatus port::status()
@@ -66,6 +76,11 @@ void port::pfSerialWrite(uint8_t c)
     sport->write(cc,1);
 }
 
+void port::pfSerialWriteBuffer(const uint8_t *buf, uint16_t length)
+{
+    sport->write((const char *)buf,length);
+}
+
 uint32_t port::pfGetTime(void)
 {
     return timer.elapsed();
@@ -38,6 +38,7 @@ public:
     enum portstatus{open,closed,error};
     virtual int16_t pfSerialRead(void);			// function to read a character from the serial input stream
     virtual void pfSerialWrite( uint8_t );	// function to write a byte to be sent out the serial port
+    virtual void pfSerialWriteBuffer( const uint8_t *, uint16_t );	// function to write a block to be sent out the serial port
     virtual uint32_t pfGetTime(void);
     uint8_t		retryCount;						// how many times have we tried to transmit the 'send' packet
     uint8_t 	maxRetryCount;					// max. times to try to transmit the 'send' packet
@@ -51,6 +52,10 @@ public:
     uint16_t 	rxBufSize;						// size of the receive buffer.
     uint16_t 	txBufSize;						// size of the transmit buffer.
     uint8_t		*txBuf;							// transmit buffer. REquired to store a copy of packet data in case a retry is needed.
+    uint8_t		txWindow;						// number of packets the transmit buffer can hold
+    uint8_t		window;							// number of packets that may be waiting for an ACK, agreed on at synchronisation
+    uint8_t		txHead;							// transmit buffer slot of the oldest packet waiting for an ACK
+    uint8_t		txCount;						// number of packets waiting for an ACK
     uint8_t		*rxBuf;							// receive buffer. Used to store data as a packet is received.
     uint16_t    sendSynch;      				// flag to indicate that we should send a synchronize packet to the host
     // this is required when switching from the application to the bootloader
@@ -64,8 +69,10 @@ public:
     uint32_t		TxError;
     uint16_t		flags;
     port(PortSettings settings,QString name);
-    ~port();
+    virtual ~port();
     portstatus status();
+protected:
+    port();
 private:
     portstatus mstatus;
     QTime timer;
@@ -141,6 +141,15 @@ void qssp::ssp_Init(const PortConfig_t* const info)
     thisport->rxBufSize 	= info->rxBufSize;
     thisport->txBuf         = info->txBuf;
     thisport->rxBuf         = info->rxBuf;
+    thisport->txWindow      = info->txWindow;
+    if( thisport->txWindow < 1 ) {
+        thisport->txWindow = 1;
+    } else if( thisport->txWindow > SSP_MAX_WINDOW ) {
+        thisport->txWindow = SSP_MAX_WINDOW;
+    }
+    thisport->window        = 1;            // stop and wait until the other end agrees on more
+    thisport->txHead        = 0;
+    thisport->txCount       = 0;
     thisport->retryCount    = 0;
     thisport->sendSynch		= FALSE;		//TRUE;
     thisport->rxSeqNo 		= 255;
@@ -172,14 +181,18 @@ int16_t qssp::ssp_SendProcess( )
     if (thisport->SendState == SSP_AWAITING_ACK ) {
         if (sf_CheckTimeout() == TRUE) {
             if (thisport->retryCount < thisport->maxRetryCount) {
-                // Try again
-                sf_SendPacket();
+                // Try again, starting from the oldest packet that was not acked
+                for( uint8_t x = 0; x < thisport->txCount; x++ ) {
+                    sf_SendPacket( sf_TxSlot(x) );
+                }
+                thisport->retryCount++;
                 sf_SetSendTimeout();
                 value = SSP_TX_WAITING;
             } else {
                 // Give up, # of trys has exceded the limit
                 value = SSP_TX_TIMEOUT;
                 CLEARBIT( thisport->flags, ACK_RECEIVED);
+                thisport->txCount = 0;
                 thisport->SendState = SSP_IDLE;
                 if (debug)
                   qDebug()<<"Send TimeOut!";
@@ -279,10 +292,10 @@ uint16_t   qssp::ssp_SendDataBlock(uint8_t *data, uint16_t length )
  * \param	length = number of bytes to send
  * \return	SSP_TX_BUFOVERRUN = tried to send too much data
  * \return	SSP_TX_WAITING = data sent and waiting for an ack to arrive
- * \return	SSP_TX_BUSY = a packet has already been sent, but not yet acked
+ * \return	SSP_TX_BUSY = the window is full of packets that are not yet acked
  *
  * \note
- *
+ * With a window of 1 this is stop and wait, only one packet can be waiting for its ack.
  */
 int16_t qssp::ssp_SendData(const uint8_t *data, const uint16_t length )
 {
@@ -292,7 +305,7 @@ int16_t qssp::ssp_SendData(const uint8_t *data, const uint16_t length )
     if( (length + 2) > thisport->txBufSize ) {
         // TRYING to send too much data.
         value = SSP_TX_BUFOVERRUN;
-    } else if( thisport->SendState == SSP_IDLE ) {
+    } else if( thisport->SendState != SSP_ACKED && thisport->txCount < thisport->window ) {
 #ifdef ACTIVE_SYNCH
         if( thisport->sendSynch == TRUE )  {
             sf_SendSynchPacket();
@@ -328,10 +341,14 @@ int16_t qssp::ssp_SendData(const uint8_t *data, const uint16_t length )
         CLEARBIT( thisport->flags, ACK_RECEIVED);
         thisport->SendState = SSP_AWAITING_ACK;
         value = SSP_TX_WAITING;
-        thisport->retryCount = 0;				// zero out the retry counter for this transmission
-        sf_MakePacket( thisport->txBuf, data, length, thisport->txSeqNo );
-        sf_SendPacket( );				// punch out the packet to the serial port
-        sf_SetSendTimeout(  );	// do the timeout values
+        uint8_t *packet = sf_TxSlot( thisport->txCount );
+        sf_MakePacket( packet, data, length, thisport->txSeqNo );
+        sf_SendPacket( packet );			// punch out the packet to the serial port
+        if( thisport->txCount++ == 0 ) {
+            // the timeout runs for the oldest packet in the window
+            thisport->retryCount = 1;
+            sf_SetSendTimeout(  );	// do the timeout values
+        }
          if (debug)
              qDebug()<<"Sent DATA PACKET:"<<thisport->txSeqNo;
     } else {
@@ -356,6 +373,9 @@ int16_t qssp::ssp_SendData(const uint8_t *data, const uint16_t length )
  * 		increment try counter
  * 		if number of tries exceed maximum try limit then exit
  * C. goto A
+ *
+ * When the port can hold more than one packet the request offers that window to the other end, the window
+ * it agrees on comes back with the ACK.
  */
 uint16_t qssp::ssp_Synchronise( )
 {
@@ -366,8 +386,12 @@ uint16_t qssp::ssp_Synchronise( )
     thisport->txSeqNo = 0;                        // make this zero to cause the other end to re-synch with us
     SETBIT(thisport->flags, SENT_SYNCH);
     // TODO - should this be using ssp_SendPacketData()??
-    sf_MakePacket( thisport->txBuf, NULL, 0, thisport->txSeqNo );    // construct the packet
-    sf_SendPacket(  );
+    thisport->window  = 1;
+    thisport->txHead  = 0;
+    thisport->txCount = 1;
+    sf_MakePacket( thisport->txBuf, &thisport->txWindow, (thisport->txWindow > 1) ? 1 : 0, thisport->txSeqNo );    // construct the packet
+    sf_SendPacket( thisport->txBuf );
+    thisport->retryCount = 1;
     sf_SetSendTimeout(  );
     thisport->SendState = SSP_AWAITING_ACK;
     packet_status = SSP_TX_WAITING;
@@ -398,23 +422,78 @@ uint16_t qssp::ssp_Synchronise( )
 
 /*!
  * \brief   sends out a preformatted packet for a give port
- * \param   thisport = which port to use.
+ * \param	packet = the packet to send
  * \return  none.
  *
  * \note
  * Packet should be formed through the use of sf_MakePacket before calling this function.
+ * The whole escaped packet goes out in one write to the serial port.
  */
-void qssp::sf_SendPacket()
+void qssp::sf_SendPacket( const uint8_t *packet )
 {
+    // worst case every byte is escaped, plus the SYNC byte
+    uint8_t     frame[1 + 2 * (1 + 1 + 255 + 2)];
     // add 3 to packet data length for: 1 length + 2 CRC (packet overhead)
-    uint8_t packetLen = thisport->txBuf[LENGTH] + 3;
+    uint16_t    packetLen = packet[LENGTH] + 3;
+    uint16_t    n = 0;
+
+    // the SYNC byte starts the packet so it does not get 'escaped'
+    frame[n++] = SYNC;
+    for( uint16_t x = 0; x < packetLen; x++ ) {
+        n += sf_EscapeByte( &frame[n], packet[x] );
+    }
+    thisport->pfSerialWriteBuffer( frame, n );
+}
+
+/*!
+ * \brief   returns a slot of the transmit buffer
+ * \param	n = how many slots after the oldest packet waiting for an ack
+ * \return  pointer to the slot
+ *
+ * \note
+ * Each slot holds a packet of up to txBufSize + 2 bytes.
+ */
+uint8_t *qssp::sf_TxSlot( uint8_t n )
+{
+    uint8_t slot = (thisport->txHead + n) % thisport->txWindow;
+    return &thisport->txBuf[slot * (thisport->txBufSize + 2)];
+}
+
+/*!
+ * \brief   returns the sequence number that follows seqNo
+ * \param   seqNo = sequence number, 0 right after a synchronisation
+ * \return  next sequence number, 1..127
+ *
+ * \note
+ *
+ */
+uint8_t qssp::sf_NextSeqNo( uint8_t seqNo )
+{
+    seqNo = (seqNo & 0x7F) + 1;
+    if( seqNo > 0x7F ) {
+        seqNo = 1;                  // zero is reserved for synchronization requests
+    }
+    return seqNo;
+}
+
+/*!
+ * \brief   works out the window from the one offered in the received synch request or ACK
+ * \return  the window both ends can handle
+ *
+ * \note
+ * The offer is the only data byte of the packet, older implementations send no data and get a window of 1.
+ */
+uint8_t qssp::sf_NegotiateWindow()
+{
+    uint8_t window = 1;
 
-    // use the raw serial write function so the SYNC byte does not get 'escaped'
-    thisport->pfSerialWrite(SYNC);
-    for( uint8_t x = 0; x < packetLen; x++ ) {
-        sf_write_byte(thisport->txBuf[x] );
+    if( thisport->rxBufLen >= 1 && thisport->rxBuf[DATA] > 1 ) {
+        window = thisport->rxBuf[DATA];
+        if( window > thisport->txWindow ) {
+            window = thisport->txWindow;
+        }
     }
-    thisport->retryCount++;
+    return window;
 }
 
 
@@ -460,44 +539,49 @@ void qssp::sf_MakePacket( uint8_t *txBuf, const uint8_t * pdata, uint16_t length
  * \brief   sends out an ack packet to given sequence number
  * \param   thisport = which port to use
  * \param	seqNumber = sequence number of the packet we would like to ack
+ * \param	pdata = data to send with the ack, only used to answer a windowed synch request
+ * \param	length = number of data bytes
  * \return  none.
  *
  * \note
- *
+ * The ack is built in its own buffer so the packets waiting for their ack are kept.
  */
 
-void qssp::sf_SendAckPacket(uint8_t seqNumber)
+void qssp::sf_SendAckPacket(uint8_t seqNumber, const uint8_t *pdata, uint16_t length)
 {
+    uint8_t    ackBuf[5];
     uint8_t    AckSeqNumber = SETBIT( seqNumber, ACK_BIT );
 
     // create the packet, note we pass AckSequenceNumber directly
-    sf_MakePacket( thisport->txBuf, NULL, 0, AckSeqNumber );
-    sf_SendPacket( );
+    sf_MakePacket( ackBuf, pdata, length, AckSeqNumber );
+    sf_SendPacket( ackBuf );
      if (debug)
          qDebug()<<"Sent ACK PACKET:"<<seqNumber;
     // we don't set the timeout for an ACK because we don't ACK our ACKs in this protocol
 }
 
 /*!
- * \brief   writes a byte out the output channel. Adds escape byte where needed
- * \param   thisport = which port to use
+ * \brief   escapes a byte for the output channel. Adds escape byte where needed
+ * \param   out = where to put the escaped byte, room for 2 bytes
  * \param	c = byte to send
- * \return  none.
+ * \return  number of bytes put in out
  *
  * \note
  *
  */
-void qssp::sf_write_byte(uint8_t c )
+uint16_t qssp::sf_EscapeByte( uint8_t *out, uint8_t c )
 {
     if( c == SYNC ) {							// check for SYNC byte
-        thisport->pfSerialWrite( ESC );         // since we are not starting a packet we must ESCAPE the SYNCH byte
-        thisport->pfSerialWrite( ESC_SYNC );    // now send the escaped synch char
+        out[0] = ESC;                           // since we are not starting a packet we must ESCAPE the SYNCH byte
+        out[1] = ESC_SYNC;                      // now send the escaped synch char
+        return 2;
     } else if( c == ESC ) {						// Check for ESC character
-        thisport->pfSerialWrite( ESC );			// if it is, we need to send it twice
-        thisport->pfSerialWrite( ESC );
-    } else {
-        thisport->pfSerialWrite( c );			// otherwise write the byte to serial port
+        out[0] = ESC;                           // if it is, we need to send it twice
+        out[1] = ESC;
+        return 2;
     }
+    out[0] = c;                                 // otherwise send the byte as it is
+    return 1;
 }
 
 /************************************************************************************************************
@@ -733,14 +817,32 @@ int16_t qssp::sf_ReceivePacket()
     int16_t value = FALSE;
 
     if( ISBITSET(thisport->rxBuf[SEQNUM], ACK_BIT ) ) {
-        //  Received an ACK packet, need to check if it matches the previous sent packet
-        if( ( thisport->rxBuf[SEQNUM] & 0x7F) == (thisport->txSeqNo & 0x7f)) {
-            //  It matches the last packet sent by us
-            SETBIT( thisport->txSeqNo, ACK_BIT );
-            thisport->SendState = SSP_ACKED;
+        //  Received an ACK packet, need to check if it matches a packet waiting for its ACK,
+        //  which also acknowledges all the packets sent before it
+        uint8_t ackSeqNo = thisport->rxBuf[SEQNUM] & 0x7F;
+        for( uint8_t x = 0; x < thisport->txCount; x++ ) {
+            if( sf_TxSlot(x)[SEQNUM] != ackSeqNo ) {
+                continue;
+            }
+            if( ackSeqNo == 0 ) {
+                // the answer to our synch request
+                thisport->window = sf_NegotiateWindow();
+                 if (debug)
+                    qDebug()<<"Window:"<<thisport->window;
+            }
+            thisport->txHead = (thisport->txHead + x + 1) % thisport->txWindow;
+            thisport->txCount -= x + 1;
+            if( thisport->txCount == 0 ) {
+                thisport->SendState = SSP_ACKED;
+            } else {
+                // restart the timeout for what is now the oldest packet
+                thisport->retryCount = 1;
+                sf_SetSendTimeout();
+            }
             value = FALSE;
              if (debug)
-                qDebug()<<"Received ACK:"<<(thisport->txSeqNo & 0x7F);
+                qDebug()<<"Received ACK:"<<ackSeqNo;
+            break;
         }
         // else ignore the ACK packet
     } else {
@@ -752,12 +854,23 @@ int16_t qssp::sf_ReceivePacket()
 #ifdef ACTIVE_SYNCH
             thisport->sendSynch = TRUE;
 #endif
-            sf_SendAckPacket(thisport->rxBuf[SEQNUM] );
+            thisport->window = sf_NegotiateWindow();
+            // only a request that offered a window gets one back
+            sf_SendAckPacket(thisport->rxBuf[SEQNUM], &thisport->window, (thisport->rxBufLen >= 1) ? 1 : 0 );
             thisport->rxSeqNo = 0;
             value = FALSE;
         } else if( thisport->rxBuf[SEQNUM] == thisport->rxSeqNo ) {
             // Already seen this packet, just ack it, don't act on the packet.
-            sf_SendAckPacket(thisport->rxBuf[SEQNUM] );
+            sf_SendAckPacket(thisport->rxBuf[SEQNUM], NULL, 0 );
+            value = FALSE;
+        } else if( thisport->window > 1 && thisport->rxBuf[SEQNUM] != sf_NextSeqNo(thisport->rxSeqNo) ) {
+            // Out of sequence, either a resent packet we already have or one that came after
+            // a lost packet. Ack the first kind again, drop the second, the sender goes back
+            // to the lost packet when it times out.
+            uint8_t behind = (thisport->rxSeqNo + 0x7F - thisport->rxBuf[SEQNUM]) % 0x7F;
+            if( thisport->rxSeqNo != 0 && behind < thisport->window ) {
+                sf_SendAckPacket(thisport->rxBuf[SEQNUM], NULL, 0 );
+            }
             value = FALSE;
         } else {
             //New Packet
@@ -772,7 +885,7 @@ int16_t qssp::sf_ReceivePacket()
             // after we send the ACK, it is possible for the host to send a new packet.
             // Thus the application needs to copy the data and reset the receive buffer
             // inside of thisport->pfCallBack()
-            sf_SendAckPacket(thisport->rxBuf[SEQNUM] );
+            sf_SendAckPacket(thisport->rxBuf[SEQNUM], NULL, 0 );
             value = TRUE;
         }
     }
@@ -788,6 +901,15 @@ qssp::qssp(port * info,bool debug):debug(debug)
     thisport->rxBufSize 	= info->rxBufSize;
     thisport->txBuf         = info->txBuf;
     thisport->rxBuf         = info->rxBuf;
+    thisport->txWindow      = info->txWindow;
+    if( thisport->txWindow < 1 ) {
+        thisport->txWindow = 1;
+    } else if( thisport->txWindow > SSP_MAX_WINDOW ) {
+        thisport->txWindow = SSP_MAX_WINDOW;
+    }
+    thisport->window        = 1;            // stop and wait until the other end agrees on more
+    thisport->txHead        = 0;
+    thisport->txCount       = 0;
     thisport->retryCount    = 0;
     thisport->sendSynch		= FALSE;		//TRUE;
     thisport->rxSeqNo 		= 255;
@@ -800,6 +922,23 @@ qssp::qssp(port * info,bool debug):debug(debug)
     thisport->txSeqNo               =0;
     thisport->rxSeqNo               =0;
 }
+/*!
+ * \brief   tells if ssp_SendData can take another packet
+ * \return  true = the window has room
+ */
+bool qssp::ssp_SendReady()
+{
+    return thisport->SendState != SSP_ACKED && thisport->txCount < thisport->window;
+}
+
+/*!
+ * \brief   number of packets that may be waiting for an ack, agreed on at synchronisation
+ */
+uint8_t qssp::ssp_Window()
+{
+    return thisport->window;
+}
+
 void qssp::pfCallBack( uint8_t * buf, uint16_t size)
 {
      if (debug)
@@ -55,6 +55,8 @@
 #define SSP_RX_ACK        	6
 #define SSP_RX_SYNCH      	7
 
+#define SSP_MAX_WINDOW		16	// most packets that may be waiting for an ACK at once, must stay below half the sequence space
+
 
 typedef struct
 {
@@ -70,6 +72,7 @@ typedef struct {
     uint16_t 	rxBufSize;                         	// rcv buffer size.
     uint8_t 	*txBuf;                            	// Length of data in buffer
     uint16_t 	txBufSize;                        	// CRC for data in Packet buff
+    uint8_t 	txWindow;                         	// number of packets of txBufSize + 2 bytes txBuf can hold, 0 or 1 = stop and wait
     uint16_t 	max_retry;                             	// Maximum number of retrys for a single transmit.
     int32_t 	timeoutLen;                          	//  how long to wait for each retry to succeed
     // function returns time in number of seconds that has elapsed from a given reference point
@@ -94,14 +97,17 @@ private:
     /** PRIVATE FUNCTIONS **/
     //static void   	sf_SendSynchPacket( Port_t *thisport );
     uint16_t sf_crc16( uint16_t crc, uint8_t data );
-    void   	sf_write_byte(uint8_t c );
+    uint16_t sf_EscapeByte( uint8_t *out, uint8_t c );
     void   	sf_SetSendTimeout();
     uint16_t sf_CheckTimeout();
     int16_t 	sf_DecodeState(uint8_t c );
     int16_t 	sf_ReceiveState(uint8_t c );
 
-    void   	sf_SendPacket();
-    void   	sf_SendAckPacket(uint8_t seqNumber);
+    void   	sf_SendPacket( const uint8_t *packet );
+    void   	sf_SendAckPacket(uint8_t seqNumber, const uint8_t *pdata, uint16_t length);
+    uint8_t *sf_TxSlot( uint8_t n );
+    uint8_t  sf_NextSeqNo( uint8_t seqNo );
+    uint8_t  sf_NegotiateWindow();
     void     sf_MakePacket( uint8_t *buf, const uint8_t * pdata, uint16_t length, uint8_t seqNo );
     int16_t 	sf_ReceivePacket();
     uint16_t ssp_SendDataBlock(uint8_t *data, uint16_t length );
@@ -116,6 +122,8 @@ public:
     void        ssp_Init( const PortConfig_t* const info);
     int16_t		ssp_ReceiveByte( );
     uint16_t 	ssp_Synchronise(  );
+    bool        ssp_SendReady();
+    uint8_t     ssp_Window();
     qssp(port * info,bool debug);
 };
 
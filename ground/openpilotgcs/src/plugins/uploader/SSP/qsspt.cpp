@@ -26,7 +26,7 @@
  */
 #include "qsspt.h"
 
-qsspt::qsspt(port * info,bool debug):qssp(info,debug),endthread(false),datapending(false),debug(debug)
+qsspt::qsspt(port * info,bool debug):qssp(info,debug),datapending(false),endthread(false),queued(false),sendfailed(false),debug(debug)
 {
 }
 
@@ -36,16 +36,26 @@ void qsspt::run()
     {
         receivestatus=this->ssp_ReceiveProcess();
         sendstatus=this->ssp_SendProcess();
+        if(sendstatus==SSP_TX_TIMEOUT)
+            sendfailed=true;
         msleep(1);
         sendbufmutex.lock();
-        if(datapending && receivestatus==SSP_TX_IDLE)
+        if(datapending && receivestatus==SSP_TX_IDLE && this->ssp_SendReady())
         {
             this->ssp_SendData(mbuf,msize);
             datapending=false;
+            queued=true;
         }
         sendbufmutex.unlock();
-        if(sendstatus==SSP_TX_ACKED)
+        // with a window the sender can go on as soon as its packet is queued,
+        // stop and wait has to wait for the ack
+        if(sendstatus==SSP_TX_ACKED || sendstatus==SSP_TX_TIMEOUT || (queued && this->ssp_Window()>1))
+        {
+            queued=false;
+            msendwait.lock();
             sendwait.wakeAll();
+            msendwait.unlock();
+        }
     }
 
 }
@@ -53,14 +63,20 @@ bool qsspt::sendData(uint8_t * buf,uint16_t size)
 {
     if(datapending)
         return false;
+    msendwait.lock();
     sendbufmutex.lock();
     datapending=true;
     mbuf=buf;
     msize=size;
     sendbufmutex.unlock();
-    msendwait.lock();
     sendwait.wait(&msendwait,10000);
     msendwait.unlock();
+    // a packet sent earlier in the window may have timed out meanwhile
+    if(sendfailed)
+    {
+        sendfailed=false;
+        return false;
+    }
     return true;
 }
 
@@ -49,6 +49,8 @@ private:
     QMutex sendbufmutex;
     bool datapending;
     bool endthread;
+    bool queued;
+    bool sendfailed;
     uint16_t sendstatus;
     uint16_t receivestatus;
     QWaitCondition sendwait;
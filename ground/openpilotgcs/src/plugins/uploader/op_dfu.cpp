@@ -37,6 +37,7 @@ DFUObject::DFUObject(bool _debug,bool _use_serial,QString portname):
     debug(_debug),use_serial(_use_serial),mready(true)
 {
     info = NULL;
+    use_pipeline = false;
 
     qRegisterMetaType<OP_DFU::Status>("Status");
 
@@ -54,6 +55,7 @@ DFUObject::DFUObject(bool _debug,bool _use_serial,QString portname):
         info->rxBufSize 	= MAX_PACKET_DATA_LEN;
         info->txBuf 		= sspTxBuf;
         info->txBufSize 	= MAX_PACKET_DATA_LEN;
+        info->txWindow 	= SSP_TX_WINDOW;
         info->max_retry	= 10;
         info->timeoutLen	= 1000;
         if(info->status()!=port::open)
@@ -82,6 +84,7 @@ DFUObject::DFUObject(bool _debug,bool _use_serial,QString portname):
     {
         send_delay=10;
         use_delay=true;
+        use_pipeline=true;
 //        int numDevices=0;
         QList<USBPortInfo> devices;
         int count=0;
@@ -235,13 +238,17 @@ bool DFUObject::UploadData(qint32 const & numberOfBytes, QByteArray  & data)
     int packetsize;
     float percentage;
     int laspercentage;
+    hidPipeline *pipeline = NULL;
+    if(use_pipeline && !use_serial)
+        pipeline = new hidPipeline(&hidHandle, HID_PIPELINE_DEPTH);
+    uploadCRC = 0xFFFFFFFF;
     for(qint32 packetcount=0;packetcount<numberOfPackets;++packetcount)
     {
         percentage=(float)(packetcount+1)/numberOfPackets*100;
         if(laspercentage!=(int)percentage)
             printProgBar((int)percentage,"UPLOADING");
         laspercentage=(int)percentage;
-        if(packetcount==numberOfPackets)
+        if(packetcount==numberOfPackets-1)
             packetsize=lastPacketCount;
         else
             packetsize=14;
@@ -265,6 +272,26 @@ bool DFUObject::UploadData(qint32 const & numberOfBytes, QByteArray  & data)
         //delay::msleep(send_delay);
 
         //if(StatusRequest()!=OP_DFU::uploading) return false;
+
+        // Same words the bootloader will program, so the CRC covers what was sent
+        for(int x=0;x<packetsize;++x)
+        {
+            quint32 word=(quint8)buf[6+x*4];
+            word=word<<8 | (quint8)buf[7+x*4];
+            word=word<<8 | (quint8)buf[8+x*4];
+            word=word<<8 | (quint8)buf[9+x*4];
+            uploadCRC=CRC32WideFast(uploadCRC,1,&word);
+        }
+
+        if(pipeline)
+        {
+            if(!pipeline->queue(buf, BUF_LEN))
+            {
+                delete pipeline;
+                return false;
+            }
+            continue;
+        }
         int result = sendData(buf, BUF_LEN);
      //   qDebug()<<"sent:"<<result;
         if(result<1)
@@ -276,6 +303,12 @@ bool DFUObject::UploadData(qint32 const & numberOfBytes, QByteArray  & data)
 
     }
     cout<<"\n";
+    if(pipeline)
+    {
+        bool written = pipeline->flush();
+        delete pipeline;
+        return written;
+    }
     // while(true){}
     return true;
 }
@@ -774,7 +807,14 @@ OP_DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &veri
     if(ret != OP_DFU::Last_operation_Success)
         return ret;
 
-    if(verify) {
+    if(verify && use_pipeline) {
+        emit operationProgress(QString("Verifying firmware"));
+        cout<<"Starting code verification\n";
+        if(!VerifyCRC(device, uploadCRC, arr.length())) {
+            cout<<"Verify:FAILED\n";
+            return OP_DFU::abort;
+        }
+    } else if(verify) {
         emit operationProgress(QString("Verifying firmware"));
         cout<<"Starting code verification\n";
         QByteArray arr2;
@@ -793,6 +833,25 @@ OP_DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &veri
 
 
 
+/**
+  Checks the firmware on the device against a CRC worked out on the host,
+  by asking the bootloader for its CRC rather than reading the image back.
+  crc covers the numberOfBytes uploaded, the rest of the device's code
+  space is blank flash and is added here.
+  */
+bool DFUObject::VerifyCRC(int device, quint32 crc, quint32 numberOfBytes)
+{
+    quint32 blank=0xFFFFFFFF;
+    for(quint32 x=numberOfBytes/4;x<devices[device].SizeOfCode/4;++x)
+        crc=CRC32WideFast(crc,1,&blank);
+
+    if(!findDevices() || devices.length()<=device)
+        return false;
+    if (debug)
+        qDebug() << "Host CRC=" << crc << " device CRC=" << devices[device].FW_CRC;
+    return crc==devices[device].FW_CRC;
+}
+
 OP_DFU::Status DFUObject::CompareFirmware(const QString &sfile, const CompareType &type,int device)
 {
     cout<<"Starting Firmware Compare...\n";
@@ -1020,3 +1079,75 @@ int DFUObject::receiveData(void * data,int size)
         }
     }
 }
+
+
+/**
+  Starts the writer thread, reports are written in the order they are queued
+  */
+hidPipeline::hidPipeline(pjrc_rawhid *_handle, int _depth):
+    handle(_handle),depth(_depth),writing(false),failed(false),stopping(false)
+{
+    start();
+}
+
+hidPipeline::~hidPipeline()
+{
+    mutex.lock();
+    stopping=true;
+    changed.wakeAll();
+    mutex.unlock();
+    wait();
+}
+
+/**
+  Queues a report for writing, waits while the queue is full.
+  Returns false once a write has failed, nothing more is sent after that.
+  */
+bool hidPipeline::queue(const char *report, int size)
+{
+    QMutexLocker locker(&mutex);
+    while(reports.length()>=depth && !failed)
+        changed.wait(&mutex);
+    if(failed)
+        return false;
+    reports.enqueue(QByteArray(report,size));
+    changed.wakeAll();
+    return true;
+}
+
+/**
+  Waits until every queued report has been written
+  */
+bool hidPipeline::flush()
+{
+    QMutexLocker locker(&mutex);
+    while((!reports.isEmpty() || writing) && !failed)
+        changed.wait(&mutex);
+    return !failed;
+}
+
+void hidPipeline::run()
+{
+    QMutexLocker locker(&mutex);
+    while(!stopping)
+    {
+        if(reports.isEmpty() || failed)
+        {
+            changed.wait(&mutex);
+            continue;
+        }
+        QByteArray report=reports.dequeue();
+        writing=true;
+        changed.wakeAll();
+        locker.unlock();
+        int result=handle->send(0,report.data(),report.length(),5000);
+        locker.relock();
+        writing=false;
+        if(result<1)
+        {
+            failed=true;
+            reports.clear();
+        }
+        changed.wakeAll();
+    }
+}
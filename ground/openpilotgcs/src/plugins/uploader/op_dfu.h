@@ -9,6 +9,8 @@
 #include <QThread>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QWaitCondition>
+#include <QQueue>
 #include <QMetaType>
 #include <QCryptographicHash>
 #include <QList>
@@ -26,6 +28,8 @@ using namespace std;
 
 #define MAX_PACKET_DATA_LEN	255
 #define MAX_PACKET_BUF_SIZE	(1+1+MAX_PACKET_DATA_LEN+2)
+#define SSP_TX_WINDOW	8	// packets in flight we offer, the bootloader may agree on fewer
+#define HID_PIPELINE_DEPTH	8	// upload reports queued ahead of the USB writes
 
 namespace OP_DFU {
 
@@ -103,6 +107,32 @@ namespace OP_DFU {
     };
 
 
+    // Writes upload reports to the HID device from its own thread. Up to depth
+    // reports wait in the queue, so the next one is ready as soon as a write
+    // returns instead of after the caller has built it.
+    class hidPipeline : public QThread
+    {
+        public:
+        hidPipeline(pjrc_rawhid *handle, int depth);
+        ~hidPipeline();
+        bool queue(const char *report, int size);   // blocks while full, false once a write failed
+        bool flush();                               // waits until every queued report is written
+
+    protected:
+        void run();
+
+    private:
+        pjrc_rawhid *handle;
+        int depth;
+        QQueue<QByteArray> reports;
+        bool writing;
+        bool failed;
+        bool stopping;
+        QMutex mutex;
+        QWaitCondition changed;
+    };
+
+
     class DFUObject : public QThread
     {
         Q_OBJECT;
@@ -149,6 +179,7 @@ namespace OP_DFU {
         int numberOfDevices;
         int send_delay;
         bool use_delay;
+        bool use_pipeline;  // HID only: queue upload reports and verify on the device CRC
 
         // Helper functions:
         QString StatusToString(OP_DFU::Status  const & status);
@@ -171,7 +202,7 @@ namespace OP_DFU {
         qsspt * serialhandle;
         int sendData(void*,int);
         int receiveData(void * data,int size);
-        uint8_t	sspTxBuf[MAX_PACKET_BUF_SIZE];
+        uint8_t	sspTxBuf[SSP_TX_WINDOW * MAX_PACKET_BUF_SIZE];
         uint8_t	sspRxBuf[MAX_PACKET_BUF_SIZE];
         port * info;
 
@@ -184,6 +215,8 @@ namespace OP_DFU {
         void printProgBar( int const & percent,QString const& label);
         bool StartUpload(qint32  const &numberOfBytes, TransferTypes const & type,quint32 crc);
         bool UploadData(qint32 const & numberOfPackets,QByteArray  & data);
+        quint32 uploadCRC;  // CRC of the words sent by the last UploadData
+        bool VerifyCRC(int device, quint32 crc, quint32 numberOfBytes);
 
         // Thread management:
         // Same as startDownload except that we store in an external array:
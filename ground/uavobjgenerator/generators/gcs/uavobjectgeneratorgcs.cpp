@@ -107,6 +107,23 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo* info)
     }
     outInclude.replace(QString("$(DATAFIELDS)"), fields);
 
+    // Replace the $(FIELDSLAYOUT) and $(NUMFIELDS) tags, the layout matches
+    // the packed DataFields structure and is used to pack/unpack the object
+    QString layout;
+    int offset = 0;
+    for (int n = 0; n < info->fields.length(); ++n)
+    {
+        layout.append( QString("    { %1, %2, %3 }%4 // %5\n")
+                       .arg(offset)
+                       .arg(info->fields[n]->numBytes)
+                       .arg(info->fields[n]->numElements)
+                       .arg(n != info->fields.length()-1 ? "," : "")
+                       .arg(info->fields[n]->name) );
+        offset += info->fields[n]->numBytes * info->fields[n]->numElements;
+    }
+    outCode.replace(QString("$(FIELDSLAYOUT)"), layout);
+    outInclude.replace(QString("$(NUMFIELDS)"), QString().setNum(info->fields.length()));
+
     // Replace the $(FIELDSINIT) tag
     QString finit;
     for (int n = 0; n < info->fields.length(); ++n)
@@ -110,6 +110,21 @@ bool UAVObjectGeneratorPython::process_object(ObjectInfo* info)
     }
     outCode.replace(QString("$(DATAFIELDINIT)"), fields);
 
+    // Replace the $(DATAFIELDACCESSORS) tag, the fields are packed in order
+    QString accessors;
+    int offset = 0;
+    for (int n = 0; n < info->fields.length(); ++n)
+    {
+        QString args = QString("self.objId, self.instId, %1, %2, %3, index")
+                .arg(offset).arg(info->fields[n]->type).arg(info->fields[n]->numElements);
+        accessors.append(QString("\tdef get%1(self, index=0):\n").arg(info->fields[n]->name));
+        accessors.append(QString("\t\treturn getFieldValue(%1)\n\n").arg(args));
+        accessors.append(QString("\tdef set%1(self, value, index=0):\n").arg(info->fields[n]->name));
+        accessors.append(QString("\t\tsetFieldValue(%1, value)\n\n").arg(args));
+        offset += info->fields[n]->numBytes * info->fields[n]->numElements;
+    }
+    outCode.replace(QString("$(DATAFIELDACCESSORS)"), accessors);
+
     // Write the Python code
     bool res = writeFileIfDiffrent( pythonOutputPath.absolutePath() + "/" + info->namelc + ".py", outCode );
     if (!res) {
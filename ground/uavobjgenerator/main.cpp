@@ -27,6 +27,9 @@
 #include <QFile>
 #include <QString>
 #include <QStringList>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
+#include <QFuture>
 #include <iostream>
 
 #include "generators/java/uavobjectgeneratorjava.h"
@@ -73,6 +76,36 @@ int usage_err() {
     return RETURN_ERR_USAGE;
 }
 
+/**
+ * result of parsing one xml file
+ */
+struct ParseResult {
+    QString filename;
+    QString error;
+    UAVObjectParser* parser;
+};
+
+/**
+ * parse a single xml file with its own parser, safe to run concurrently
+ */
+ParseResult parseFile(const QFileInfo& fileinfo) {
+    ParseResult result;
+    result.filename = fileinfo.fileName();
+    result.parser = new UAVObjectParser();
+    QString xmlstr = readFile(fileinfo.absoluteFilePath());
+    result.error = result.parser->parseXML(xmlstr, result.filename);
+    return result;
+}
+
+/**
+ * run one language generator, safe to run concurrently with the others
+ */
+template <class Generator>
+bool runGenerator(UAVObjectParser* parser, QString templatepath, QString outputpath) {
+    Generator gen;
+    return gen.generate(parser, templatepath, outputpath);
+}
+
 /**
  * entrance
  */
@@ -139,8 +172,8 @@ int main(int argc, char *argv[])
     xmlPath.setNameFilters(filters);
     QFileInfoList xmlList = xmlPath.entryInfoList();
 
-    // Read in each XML file and parse object(s) in them
-    
+    // Select the XML files to parse
+    QList<QFileInfo> parseList;
     for (int n = 0; n < xmlList.length(); ++n) {
         QFileInfo fileinfo = xmlList[n];
         if (!do_allObjects) {
@@ -152,15 +185,22 @@ int main(int argc, char *argv[])
         }
         if (verbose)
           cout << "Parsing XML file: " << fileinfo.fileName().toStdString() << endl;
-        QString filename = fileinfo.fileName();
-        QString xmlstr = readFile(fileinfo.absoluteFilePath());
-
-        QString res = parser->parseXML(xmlstr, filename);
+        parseList.append(fileinfo);
+    }
 
-        if (!res.isNull()) {
-            cout << "Error parsing " << res.toStdString() << endl;
-            return RETURN_ERR_XML;
-        }
+    // Read in each XML file and parse object(s) in them, all files are parsed
+    // concurrently and then merged in file order so the output is stable
+    QList<ParseResult> parsed = QtConcurrent::blockingMapped< QList<ParseResult> >(parseList, parseFile);
+    QString res;
+    foreach (ParseResult result, parsed) {
+        if (res.isNull() && !result.error.isNull())
+            res = result.error;
+        parser->appendObjects(result.parser);
+        delete result.parser;
+    }
+    if (!res.isNull()) {
+        cout << "Error parsing " << res.toStdString() << endl;
+        return RETURN_ERR_XML;
     }
 
     if (objects_stringlist.length() > 0) {
@@ -195,41 +235,43 @@ int main(int argc, char *argv[])
     if (do_none)
       return RETURN_OK;     
 
+    // The generators only read the parsed objects and write to their own
+    // output directories, so they all run at the same time
+    QList< QFuture<bool> > generators;
+
     // generate flight code if wanted
     if (do_flight|do_all) {
         cout << "generating flight code" << endl ;
-        UAVObjectGeneratorFlight flightgen;
-        flightgen.generate(parser,templatepath,outputpath);
+        generators << QtConcurrent::run(&runGenerator<UAVObjectGeneratorFlight>, parser, templatepath, outputpath);
     }
 
     // generate gcs code if wanted
     if (do_gcs|do_all) {
         cout << "generating gcs code" << endl ;
-        UAVObjectGeneratorGCS gcsgen;
-        gcsgen.generate(parser,templatepath,outputpath);
+        generators << QtConcurrent::run(&runGenerator<UAVObjectGeneratorGCS>, parser, templatepath, outputpath);
     }
 
     // generate java code if wanted
     if (do_java|do_all) {
         cout << "generating java code" << endl ;
-        UAVObjectGeneratorJava javagen;
-        javagen.generate(parser,templatepath,outputpath);
+        generators << QtConcurrent::run(&runGenerator<UAVObjectGeneratorJava>, parser, templatepath, outputpath);
     }
 
     // generate python code if wanted
     if (do_python|do_all) {
         cout << "generating python code" << endl ;
-        UAVObjectGeneratorPython pygen;
-        pygen.generate(parser,templatepath,outputpath);
+        generators << QtConcurrent::run(&runGenerator<UAVObjectGeneratorPython>, parser, templatepath, outputpath);
     }
 
     // generate matlab code if wanted
     if (do_matlab|do_all) {
         cout << "generating matlab code" << endl ;
-        UAVObjectGeneratorMatlab matlabgen;
-        matlabgen.generate(parser,templatepath,outputpath);
+        generators << QtConcurrent::run(&runGenerator<UAVObjectGeneratorMatlab>, parser, templatepath, outputpath);
     }
 
+    foreach (QFuture<bool> generator, generators)
+        generator.waitForFinished();
+
     return RETURN_OK;
 }
 
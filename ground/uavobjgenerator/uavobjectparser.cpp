@@ -233,6 +233,18 @@ QString UAVObjectParser::parseXML(QString& xml, QString& filename)
     return QString();
 }
 
+/**
+ * Take over the objects parsed by another parser, appending them after
+ * the objects already known. Used to merge files parsed concurrently.
+ */
+void UAVObjectParser::appendObjects(UAVObjectParser* other)
+{
+    objInfo.append(other->objInfo);
+    other->objInfo.clear();
+    all_units.append(other->all_units);
+    all_units.removeDuplicates();
+}
+
 /**
  * Calculate the unique object ID based on the object information.
  * The ID will change if the object definition changes, this is intentional
@@ -104,6 +104,7 @@ public:
     // Functions
     UAVObjectParser();
     QString parseXML(QString& xml, QString& filename);
+    void appendObjects(UAVObjectParser* other);
     int getNumObjects();
     QList<ObjectInfo*> getObjectInfo();
     QString getObjectName(int objIndex);